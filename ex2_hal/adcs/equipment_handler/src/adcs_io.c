@@ -19,6 +19,7 @@
 #include <stdlib.h>
 #include "adcs_io.h"
 #include "adcs_types.h"
+#include "mem_pool/mem_pool.h"
 
 static QueueHandle_t adcsQueue;
 static uint8_t adcsBuffer;
@@ -54,6 +55,10 @@ ADCS_returnState init_adcs_io() {
     if (adcs_uart_mutex == NULL)
         return ADCS_UART_FAILED;
 
+    vQueueAddToRegistry(tx_semphr, "adcs_tx");
+    vQueueAddToRegistry(adcsQueue, "adcs_rx");
+    vQueueAddToRegistry(adcs_uart_mutex, "adcs_uart");
+
     adcsBuffer = 0;
     xSemaphoreGive(adcs_uart_mutex);
     sciReceive(ADCS_SCI, 1, &adcsBuffer);
@@ -104,7 +109,7 @@ ADCS_returnState send_uart_telecommand(uint8_t *command, uint32_t length) {
 
     // Stuff the command
     uint8_t stuffed_length = length;
-    uint8_t *stuffed_command = (uint8_t *)pvPortMalloc((length + 10) * sizeof(uint8_t));
+    uint8_t *stuffed_command = (uint8_t *)pool_malloc((length + 10) * sizeof(uint8_t));
     if (stuffed_command == NULL) {
         xSemaphoreGive(adcs_uart_mutex);
         return ADCS_MALLOC_FAILED;
@@ -112,9 +117,9 @@ ADCS_returnState send_uart_telecommand(uint8_t *command, uint32_t length) {
     adcs_byte_stuff(command, stuffed_command, length, &stuffed_length);
 
     // Form the command frame
-    uint8_t *frame = (uint8_t *)pvPortMalloc((stuffed_length + ADCS_TC_HEADER_SZ) * sizeof(uint8_t));
+    uint8_t *frame = (uint8_t *)pool_malloc((stuffed_length + ADCS_TC_HEADER_SZ) * sizeof(uint8_t));
     if (frame == NULL) {
-        vPortFree(stuffed_command);
+        pool_free(stuffed_command);
         xSemaphoreGive(adcs_uart_mutex);
         return ADCS_MALLOC_FAILED;
     }
@@ -123,14 +128,14 @@ ADCS_returnState send_uart_telecommand(uint8_t *command, uint32_t length) {
     memcpy((frame + 2), stuffed_command, stuffed_length);
     *(frame + stuffed_length + 2) = ADCS_ESC_CHAR;
     *(frame + stuffed_length + 3) = ADCS_EOM;
-    vPortFree(stuffed_command);
+    pool_free(stuffed_command);
 
     // Send the command frame
     sciSend(ADCS_SCI, stuffed_length + ADCS_TC_HEADER_SZ, frame);
 
     if (xSemaphoreTake(tx_semphr, UART_TIMEOUT_MS) != pdTRUE) {
         xSemaphoreGive(adcs_uart_mutex);
-        vPortFree(frame);
+        pool_free(frame);
         return ADCS_UART_FAILED;
     } // TODO: create response if it times out.
 
@@ -141,7 +146,7 @@ ADCS_returnState send_uart_telecommand(uint8_t *command, uint32_t length) {
     while (received < ADCS_TC_ANS_LEN) {
         if (xQueueReceive(adcsQueue, reply + received, UART_TIMEOUT_MS) == pdFAIL) {
             xSemaphoreGive(adcs_uart_mutex);
-            vPortFree(frame);
+            pool_free(frame);
             return ADCS_UART_FAILED;
         } else {
             received++;
@@ -151,7 +156,7 @@ ADCS_returnState send_uart_telecommand(uint8_t *command, uint32_t length) {
     ADCS_returnState TC_err_flag = (ADCS_returnState)reply[3];
     xSemaphoreGive(adcs_uart_mutex);
     xQueueReset(adcsQueue);
-    vPortFree(frame);
+    pool_free(frame);
     return TC_err_flag;
 }
 
@@ -169,7 +174,7 @@ ADCS_returnState send_uart_telecommand(uint8_t *command, uint32_t length) {
 ADCS_returnState send_uart_telecommand_no_reply(uint8_t *command, uint32_t length) {
 
     // Form the command frame
-    uint8_t *frame = (uint8_t *)pvPortMalloc((length + ADCS_TC_HEADER_SZ) * sizeof(uint8_t));
+    uint8_t *frame = (uint8_t *)pool_malloc((length + ADCS_TC_HEADER_SZ) * sizeof(uint8_t));
     if (frame == NULL) {
         return ADCS_MALLOC_FAILED;
     }
@@ -184,11 +189,11 @@ ADCS_returnState send_uart_telecommand_no_reply(uint8_t *command, uint32_t lengt
     sciSend(ADCS_SCI, length + ADCS_TC_HEADER_SZ, frame);
 
     if (xSemaphoreTake(tx_semphr, UART_TIMEOUT_MS) != pdTRUE) {
-        vPortFree(frame);
+        pool_free(frame);
         return ADCS_UART_FAILED;
     } // TODO: create response if it times out.
 
-    vPortFree(frame);
+    pool_free(frame);
     return ADCS_OK;
 }
 
@@ -253,7 +258,7 @@ ADCS_returnState request_uart_telemetry(uint8_t TM_ID, uint8_t *telemetry, uint3
 
     int received = 0;
 
-    uint8_t *reply = (uint8_t *)pvPortMalloc(length + ADCS_TM_HEADER_SZ);
+    uint8_t *reply = (uint8_t *)pool_malloc(length + ADCS_TM_HEADER_SZ);
     if (reply == NULL) {
         xSemaphoreGive(adcs_uart_mutex);
         return ADCS_MALLOC_FAILED;
@@ -264,9 +269,15 @@ ADCS_returnState request_uart_telemetry(uint8_t TM_ID, uint8_t *telemetry, uint3
     uint8_t ending_bytes_index = 0;
 
     while (!end_of_message) {
+        if (received >= length + ADCS_TM_HEADER_SZ) {
+            // Longer than the telemetry frame requested. Don't run off the end of the buffer
+            xSemaphoreGive(adcs_uart_mutex);
+            pool_free(reply);
+            return ADCS_UART_FAILED;
+        }
         if (xQueueReceive(adcsQueue, reply + received, UART_TIMEOUT_MS) == pdFAIL) {
             xSemaphoreGive(adcs_uart_mutex);
-            vPortFree(reply);
+            pool_free(reply);
             return ADCS_UART_FAILED;
         } else {
             // Check for EOM
@@ -283,9 +294,9 @@ ADCS_returnState request_uart_telemetry(uint8_t TM_ID, uint8_t *telemetry, uint3
     }
 
     // Destuff the reply
-    uint8_t *thin_reply = (uint8_t *)pvPortMalloc((received - ADCS_TM_HEADER_SZ) * sizeof(uint8_t));
+    uint8_t *thin_reply = (uint8_t *)pool_malloc((received - ADCS_TM_HEADER_SZ) * sizeof(uint8_t));
     if (thin_reply == NULL) {
-        vPortFree(reply);
+        pool_free(reply);
         xSemaphoreGive(adcs_uart_mutex);
         return ADCS_MALLOC_FAILED;
     }
@@ -295,8 +306,8 @@ ADCS_returnState request_uart_telemetry(uint8_t TM_ID, uint8_t *telemetry, uint3
     for (int i = 0; i < thin_length; i++) {
         *(telemetry + i) = *(thin_reply + i);
     }
-    vPortFree(reply);
-    vPortFree(thin_reply);
+    pool_free(reply);
+    pool_free(thin_reply);
     xSemaphoreGive(adcs_uart_mutex);
     xQueueReset(adcsQueue);
     return ADCS_OK;
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file athena_sensors.h
+ * @date Oct. 19, 2026
+ */
+
+#ifndef ATHENA_SENSORS_H
+#define ATHENA_SENSORS_H
+
+#include <FreeRTOS.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "services.h"
+#include "tempsense_athena.h"
+
+#define ATHENA_SENSOR_PERIOD_MS 1000
+#define ATHENA_SENSOR_MIN_PERIOD_MS 100
+
+/* Each new sample moves the average 1 / (1 << ATHENA_SENSOR_EMA_SHIFT) of the way */
+#define ATHENA_SENSOR_EMA_SHIFT 3
+
+/* Averages older than this are not used for housekeeping */
+#define ATHENA_SENSOR_MAX_AGE pdMS_TO_TICKS(10 * ATHENA_SENSOR_PERIOD_MS)
+
+typedef struct {
+    int32_t last;     // most recent sample
+    int32_t average;  // exponential moving average
+    int32_t min;      // lowest sample since the last reset
+    int32_t max;      // highest sample since the last reset
+    uint32_t samples; // samples since the last reset. 0 means the other fields are not set
+    uint32_t errors;  // failed reads since boot
+} athena_sensor_stat;
+
+typedef struct {
+    athena_sensor_stat temp[NUM_TEMP_SENSOR]; // TMP421 local temperature in ten thousandths of a degree C
+    athena_sensor_stat bus_mv;                // INA226 bus voltage in mV
+    athena_sensor_stat shunt_uv;              // INA226 shunt voltage in uV
+    TickType_t updated;                       // tick count of the last poll
+} athena_sensors_t;
+
+SAT_returnState start_athena_sensor_daemon(void);
+
+bool athena_sensors_get(athena_sensors_t *sensors);
+
+void athena_sensors_reset_extremes(void);
+
+void athena_sensors_set_period(uint32_t period_ms);
+
+#endif // ATHENA_SENSORS_H
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file sd_array.h
+ * @date Oct. 19, 2026
+ */
+
+#ifndef SD_ARRAY_H
+#define SD_ARRAY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sd_io.h"
+
+/* Values of SD_ARRAY_MODE, set in config.h */
+#define SD_ARRAY_NONE 0   // each card is a volume of its own
+#define SD_ARRAY_STRIPE 1 // both cards make up VOL0, runs of sectors alternate between them
+#define SD_ARRAY_MIRROR 2 // both cards hold all of VOL0
+
+#ifndef SD_ARRAY_MODE
+#define SD_ARRAY_MODE SD_ARRAY_NONE
+#endif
+
+#define SD_ARRAY_CARDS 2
+
+/* Sectors on each card, as fdisk reports them */
+#define SD_ARRAY_CARD_SECTORS 3717120U
+
+/* Sectors of the stripe put on one card before moving to the other */
+#define SD_ARRAY_STRIPE_SECTORS 8U
+
+/* Last sector of each mirrored card records which cards hold the current data */
+#define SD_ARRAY_RECORD_SECTOR (SD_ARRAY_CARD_SECTORS - 1U)
+
+/* Sectors of VOL0, used by redconf.c */
+#if SD_ARRAY_MODE == SD_ARRAY_STRIPE
+#define SD_ARRAY_SECTORS (SD_ARRAY_CARDS * SD_ARRAY_CARD_SECTORS)
+#elif SD_ARRAY_MODE == SD_ARRAY_MIRROR
+#define SD_ARRAY_SECTORS SD_ARRAY_RECORD_SECTOR
+#else
+#define SD_ARRAY_SECTORS SD_ARRAY_CARD_SECTORS
+#endif
+
+/* Tries at a mirrored write before the card is dropped from the mirror */
+#define SD_ARRAY_WRITE_TRIES 3
+
+/* Read errors in a row before a mirrored card is dropped from the mirror */
+#define SD_ARRAY_READ_FAIL_LIMIT 8
+
+/* Stack of the task started by sd_array_rebuild_start */
+#define SD_ARRAY_REBUILD_STACK_SIZE 500
+
+/* Each new sector moves the average time 1 / (1 << SD_ARRAY_EMA_SHIFT) of the way */
+#define SD_ARRAY_EMA_SHIFT 3
+
+typedef enum {
+    SD_CARD_OFFLINE = 0, // not used, failed or out of date
+    SD_CARD_ONLINE,      // read and written
+    SD_CARD_REBUILDING,  // written, and being copied to from the other card
+} sd_card_state;
+
+typedef struct {
+    sd_card_state state;
+    uint32_t reads;        // sectors read
+    uint32_t writes;       // sectors written
+    uint32_t errors;       // failed sector reads and writes, every try counted
+    uint32_t avg_read_us;  // moving average time to read a sector
+    uint32_t max_read_us;  // longest time to read a sector
+    uint32_t avg_write_us; // moving average time to write a sector
+    uint32_t max_write_us; // longest time to write a sector
+    uint32_t rebuilt;      // sectors copied to the card by the last rebuild
+} sd_array_card_stats;
+
+typedef void (*sd_array_progress)(uint32_t rebuilt, uint32_t total, void *arg);
+
+SDRESULTS sd_array_open(void);
+
+SDRESULTS sd_array_read(uint32_t sector, uint32_t count, void *buffer);
+
+SDRESULTS sd_array_write(uint32_t sector, uint32_t count, const void *buffer);
+
+SDRESULTS sd_array_rebuild(sd_array_progress progress, void *arg);
+
+SDRESULTS sd_array_rebuild_start(void);
+
+bool sd_array_rebuild_cancel(void);
+
+bool sd_array_get_stats(uint8_t card, sd_array_card_stats *out);
+
+#endif // SD_ARRAY_H
@@ -23,3 +23,4 @@
 
 void inittemp_all(void);
 int gettemp_all(long *temparray);
+int gettemp(int index, long *temp);
@@ -19,10 +19,6 @@ int i2cSlaveWriteReg(uint8_t sadd, uint8_t reg, uint8_t data);
 uint8_t i2cSlaveRead1ByteReg(uint8_t sadd, uint8_t reg);
 uint16_t i2cSlaveRead2ByteReg(uint8_t sadd, uint8_t reg);
 
-long calc_temp_pos(uint16_t reg);
-
-long calc_temp_neg(uint16_t reg);
-
 // int temp_from_uint16(uint16_t reg);
 
 // int tmp421_update_device(uint8_t sadd, uint16_t * localtemp, uint16_t * remotetemp);
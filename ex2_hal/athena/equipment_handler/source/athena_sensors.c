@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file athena_sensors.c
+ * @date Oct. 19, 2026
+ *
+ * Background poller for the Athena board sensors.
+ *
+ * The TMP421 temperature sensors and the INA226 power monitor are read at a
+ * fixed rate by a low priority task, which keeps a moving average and the
+ * extremes of each. Housekeeping, the CLI and diagnostics copy the latest
+ * statistics instead of waiting on the I2C bus.
+ */
+
+#include "athena_sensors.h"
+
+#include <os_semphr.h>
+#include <os_task.h>
+#include <stddef.h>
+
+#include "HL_i2c.h"
+#include "calibration/calibration.h"
+#include "ina226.h"
+#include "system.h"
+#include "task_manager/task_manager.h"
+
+#define ATHENA_SENSOR_STACK_SIZE 256
+
+#define ATHENA_INA226_I2C i2cREG2
+#define ATHENA_INA226_ADDR 0x40
+
+static athena_sensors_t sensors;
+static SemaphoreHandle_t sensors_lock = NULL;
+static uint32_t period_ms = ATHENA_SENSOR_PERIOD_MS;
+static uint32_t wdt_counter = 0;
+
+static uint32_t prv_get_wdt_counter() { return wdt_counter; }
+
+static void stat_add(athena_sensor_stat *stat, int32_t value) {
+    if (stat->samples == 0) {
+        stat->average = value;
+        stat->min = value;
+        stat->max = value;
+    } else {
+        stat->average += (value - stat->average) / (1 << ATHENA_SENSOR_EMA_SHIFT);
+        if (value < stat->min) {
+            stat->min = value;
+        }
+        if (value > stat->max) {
+            stat->max = value;
+        }
+    }
+    stat->last = value;
+    stat->samples++;
+}
+
+static void stat_update(athena_sensor_stat *stat, bool ok, int32_t value) {
+    if (ok) {
+        stat_add(stat, value);
+    } else {
+        stat->errors++;
+    }
+}
+
+static void athena_sensor_poll(void) {
+    long temp[NUM_TEMP_SENSOR];
+    bool temp_ok[NUM_TEMP_SENSOR];
+    uint16_t bus = 0;
+    uint16_t shunt = 0;
+    int i;
+
+    // Read everything before taking the lock so readers never wait on the bus
+    for (i = 0; i < NUM_TEMP_SENSOR; i++) {
+        temp_ok[i] = gettemp(i, &temp[i]) == 0;
+    }
+    bool bus_ok = INA226_RegisterGet(ATHENA_INA226_I2C, ATHENA_INA226_ADDR, INA226_RegBusV, &bus) == 0;
+    bool shunt_ok = INA226_RegisterGet(ATHENA_INA226_I2C, ATHENA_INA226_ADDR, INA226_RegShuntV, &shunt) == 0;
+
+    xSemaphoreTake(sensors_lock, portMAX_DELAY);
+    for (i = 0; i < NUM_TEMP_SENSOR; i++) {
+        stat_update(&sensors.temp[i], temp_ok[i], temp[i]);
+    }
+    stat_update(&sensors.bus_mv, bus_ok, calibration_convert(&cal_ina226_bus_mv, bus));
+    stat_update(&sensors.shunt_uv, shunt_ok, calibration_convert(&cal_ina226_shunt_uv, shunt));
+    sensors.updated = xTaskGetTickCount();
+    xSemaphoreGive(sensors_lock);
+}
+
+static void athena_sensor_daemon(void *pvParameters) {
+    inittemp_all();
+    for (;;) {
+        wdt_counter++;
+        athena_sensor_poll();
+        vTaskDelay(pdMS_TO_TICKS(period_ms));
+    }
+}
+
+/**
+ * @brief
+ *      Start the task polling the Athena sensors
+ * @return SAT_returnState
+ *      SATR_OK or SATR_ERROR
+ */
+SAT_returnState start_athena_sensor_daemon(void) {
+#if ATHENA_IS_STUBBED == 0
+    TaskHandle_t handle;
+    taskFunctions funcs = {0};
+    funcs.getCounterFunction = prv_get_wdt_counter;
+
+    sensors_lock = xSemaphoreCreateMutex();
+    if (sensors_lock == NULL) {
+        return SATR_ERROR;
+    }
+    if (xTaskCreate(athena_sensor_daemon, "athena_sensors", ATHENA_SENSOR_STACK_SIZE, NULL,
+                    ATHENA_SENSOR_TASK_PRIO, &handle) != pdPASS) {
+        return SATR_ERROR;
+    }
+    ex2_register(handle, funcs);
+#endif
+    return SATR_OK;
+}
+
+/**
+ * @brief
+ *      Copy the latest sensor statistics without touching the bus
+ * @param out
+ *      Where to copy the statistics
+ * @return
+ *      true if the sensors have been polled within ATHENA_SENSOR_MAX_AGE
+ */
+bool athena_sensors_get(athena_sensors_t *out) {
+    if (sensors_lock == NULL) {
+        return false;
+    }
+    xSemaphoreTake(sensors_lock, portMAX_DELAY);
+    *out = sensors;
+    xSemaphoreGive(sensors_lock);
+    return out->updated != 0 && (xTaskGetTickCount() - out->updated) < ATHENA_SENSOR_MAX_AGE;
+}
+
+/**
+ * @brief
+ *      Restart the min and max of every sensor from the next sample. Averages are kept
+ */
+void athena_sensors_reset_extremes(void) {
+    if (sensors_lock == NULL) {
+        return;
+    }
+    xSemaphoreTake(sensors_lock, portMAX_DELAY);
+    athena_sensor_stat *stats = (athena_sensor_stat *)&sensors;
+    size_t count = offsetof(athena_sensors_t, updated) / sizeof(athena_sensor_stat);
+    size_t i;
+    for (i = 0; i < count; i++) {
+        if (stats[i].samples != 0) {
+            stats[i].min = stats[i].last;
+            stats[i].max = stats[i].last;
+            stats[i].samples = 1;
+        }
+    }
+    xSemaphoreGive(sensors_lock);
+}
+
+/**
+ * @brief
+ *      Change how often the sensors are polled
+ * @param period
+ *      Milliseconds between polls, at least ATHENA_SENSOR_MIN_PERIOD_MS
+ */
+void athena_sensors_set_period(uint32_t period) {
+    if (period < ATHENA_SENSOR_MIN_PERIOD_MS) {
+        period = ATHENA_SENSOR_MIN_PERIOD_MS;
+    }
+    period_ms = period;
+}
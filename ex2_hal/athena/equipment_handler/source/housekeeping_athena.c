@@ -18,6 +18,7 @@
  */
 
 #include "housekeeping_athena.h"
+#include "athena_sensors.h"
 #include <stdlib.h>
 #include <string.h>
 #include <csp/csp_endian.h>
@@ -37,6 +38,15 @@ int HAL_get_temp_all(long *temparray) {
 #if ATHENA_IS_STUBBED == 1
     return 0;
 #else
+    athena_sensors_t sensors;
+    if (athena_sensors_get(&sensors)) {
+        int i;
+        for (i = 0; i < ATHENA_TEMP_ARRAY_SIZE; i++) {
+            temparray[i] = sensors.temp[i].average;
+        }
+        return 0;
+    }
+    // The poller is not running or has stalled, read the sensors directly
     return gettemp_all(temparray);
 #endif
 }
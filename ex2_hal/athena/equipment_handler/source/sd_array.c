@@ -0,0 +1,590 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file sd_array.c
+ * @date Oct. 19, 2026
+ *
+ * Both SD cards presented to Reliance Edge as the one block device of VOL0.
+ *
+ * In stripe mode the volume is twice the size of a card and every run of
+ * SD_ARRAY_STRIPE_SECTORS sectors goes to the other card from the last, so
+ * files are spread over both. Losing either card loses the volume.
+ *
+ * In mirror mode every sector is written to both cards and read from the
+ * card that has been answering quicker, falling back to the other on an
+ * error. A card that keeps failing is dropped and the volume carries on with
+ * the one left. The last sector of each card holds a count that is raised
+ * whenever a card drops out, so a card that missed writes is known to be
+ * out of date after a reset too. It stays out until it is rebuilt by copying
+ * the other card onto it, which is done by a task of its own while the
+ * volume is in use, and can be cancelled.
+ *
+ * Both cards are on the one SPI bus and Reliance Edge only issues one
+ * request at a time, so sectors are transferred one after another. The time
+ * taken by each sector is measured with the PMU cycle counter.
+ */
+
+#include "sd_array.h"
+
+#include <FreeRTOS.h>
+#include <os_semphr.h>
+#include <os_task.h>
+#include <string.h>
+
+#include "HL_sys_pmu.h"
+#include "HL_system.h"
+#include "logger/logger.h"
+#include "system.h"
+
+#define SD_ARRAY_RECORD_MAGIC 0x53444D52
+
+/* One run of mirrored reads in this many is sent to the slower card so its average stays current */
+#define SD_ARRAY_PROBE_RUNS 16
+
+/* Sectors a rebuild copies each time it takes the lock */
+#define SD_ARRAY_REBUILD_BATCH 32
+
+/* Time between rebuild progress messages */
+#define SD_ARRAY_REBUILD_REPORT pdMS_TO_TICKS(10000)
+
+typedef struct {
+    uint32_t magic;
+    uint32_t epoch; // raised each time a card drops out of the mirror
+} mirror_record_t;
+
+static sd_array_card_stats cards[SD_ARRAY_CARDS];
+static uint8_t read_failures[SD_ARRAY_CARDS]; // failed reads in a row
+static uint32_t epoch = 0;
+static uint32_t read_runs = 0;
+static uint8_t sector_buffer[SD_BLK_SIZE];
+static bool rebuild_cancelled = false; // the rebuild stops at its next batch
+static SemaphoreHandle_t array_lock = NULL;
+
+static void prv_get_lock(void) {
+    if (array_lock == NULL) {
+        array_lock = xSemaphoreCreateMutex();
+    }
+    xSemaphoreTake(array_lock, portMAX_DELAY);
+}
+
+static void prv_give_lock(void) { xSemaphoreGive(array_lock); }
+
+/* The PMU can only be read privileged, and Reliance Edge is called from user mode tasks */
+static uint32_t cycle_count(void) {
+    RAISE_PRIVILEGE;
+    uint32_t cycles = _pmuGetCycleCount_();
+    RESET_PRIVILEGE;
+    return cycles;
+}
+
+static void time_add(uint32_t *average, uint32_t *max, uint32_t samples, uint32_t start) {
+    uint32_t us = (cycle_count() - start) / GCLK_FREQ;
+    if (samples == 1) {
+        *average = us;
+    } else {
+        *average = *average - (*average >> SD_ARRAY_EMA_SHIFT) + (us >> SD_ARRAY_EMA_SHIFT);
+    }
+    if (us > *max) {
+        *max = us;
+    }
+}
+
+/* Must hold the lock */
+static SDRESULTS card_read(uint8_t card, uint32_t sector, uint8_t *buffer) {
+    sd_array_card_stats *stats = &cards[card];
+    uint32_t start = cycle_count();
+    SDRESULTS res = SD_Read(card, buffer, sector, 0, SD_BLK_SIZE);
+    if (res != SD_OK) {
+        stats->errors++;
+        return res;
+    }
+    stats->reads++;
+    time_add(&stats->avg_read_us, &stats->max_read_us, stats->reads, start);
+    return SD_OK;
+}
+
+/* Must hold the lock */
+static SDRESULTS card_write(uint8_t card, uint32_t sector, const uint8_t *buffer) {
+    sd_array_card_stats *stats = &cards[card];
+    uint32_t start = cycle_count();
+    SDRESULTS res = SD_Write(card, buffer, sector);
+    if (res != SD_OK) {
+        stats->errors++;
+        return res;
+    }
+    stats->writes++;
+    time_add(&stats->avg_write_us, &stats->max_write_us, stats->writes, start);
+    return SD_OK;
+}
+
+#if SD_ARRAY_MODE == SD_ARRAY_STRIPE
+
+/* Card holding a sector of the volume, and where on that card it is */
+static uint8_t stripe_card(uint32_t sector, uint32_t *card_sector) {
+    uint32_t run = sector / SD_ARRAY_STRIPE_SECTORS;
+    *card_sector = run / SD_ARRAY_CARDS * SD_ARRAY_STRIPE_SECTORS + sector % SD_ARRAY_STRIPE_SECTORS;
+    return run % SD_ARRAY_CARDS;
+}
+
+#else
+
+static uint8_t online_cards(void) {
+    uint8_t card, online = 0;
+    for (card = 0; card < SD_ARRAY_CARDS; card++) {
+        if (cards[card].state == SD_CARD_ONLINE) {
+            online++;
+        }
+    }
+    return online;
+}
+
+/* Must hold the lock. Uses sector_buffer */
+static SDRESULTS write_record(uint8_t card) {
+    mirror_record_t record = {SD_ARRAY_RECORD_MAGIC, epoch};
+    memset(sector_buffer, 0, sizeof(sector_buffer));
+    memcpy(sector_buffer, &record, sizeof(record));
+    return SD_Write(card, sector_buffer, SD_ARRAY_RECORD_SECTOR);
+}
+
+/* Must hold the lock. Uses sector_buffer */
+static bool read_record(uint8_t card, uint32_t *card_epoch) {
+    mirror_record_t record;
+    if (SD_Read(card, sector_buffer, SD_ARRAY_RECORD_SECTOR, 0, SD_BLK_SIZE) != SD_OK) {
+        return false;
+    }
+    memcpy(&record, sector_buffer, sizeof(record));
+    *card_epoch = record.epoch;
+    return record.magic == SD_ARRAY_RECORD_MAGIC;
+}
+
+/* Must hold the lock. Marks the cards still in the mirror so the dropped one is known to be out of date */
+static void raise_epoch(void) {
+    uint8_t card;
+    epoch++;
+    for (card = 0; card < SD_ARRAY_CARDS; card++) {
+        if (cards[card].state == SD_CARD_ONLINE && write_record(card) != SD_OK) {
+            sys_log(ERROR, "Failed to update the mirror record of SD card %d", card);
+        }
+    }
+}
+
+/* Must hold the lock */
+static void drop_card(uint8_t card, const char *reason) {
+    cards[card].state = SD_CARD_OFFLINE;
+    raise_epoch();
+    sys_log(ERROR, "SD card %d dropped from the mirror, %s", card, reason);
+}
+
+/* Must hold the lock. Decides which cards hold the current data once both have been initialized */
+static SDRESULTS mirror_open(void) {
+    uint32_t card_epoch[SD_ARRAY_CARDS];
+    bool valid[SD_ARRAY_CARDS] = {false};
+    bool any_valid = false;
+    uint8_t card;
+
+    for (card = 0; card < SD_ARRAY_CARDS; card++) {
+        if (cards[card].state != SD_CARD_ONLINE || !read_record(card, &card_epoch[card])) {
+            continue;
+        }
+        valid[card] = true;
+        if (!any_valid || card_epoch[card] > epoch) {
+            epoch = card_epoch[card];
+        }
+        any_valid = true;
+    }
+
+    if (!any_valid) {
+        // A new pair of cards, both start out current
+        epoch = 0;
+    } else {
+        for (card = 0; card < SD_ARRAY_CARDS; card++) {
+            if (cards[card].state == SD_CARD_ONLINE && (!valid[card] || card_epoch[card] != epoch)) {
+                cards[card].state = SD_CARD_OFFLINE;
+                sys_log(WARN, "SD card %d is out of date, rebuild it to return it to the mirror", card);
+            }
+        }
+    }
+
+    if (online_cards() == 0) {
+        return SD_NOINIT;
+    }
+    if (!any_valid || online_cards() < SD_ARRAY_CARDS) {
+        raise_epoch();
+    }
+    return SD_OK;
+}
+
+/* Must hold the lock. The card a run of reads starts on */
+static uint8_t read_card(void) {
+    uint8_t card = cards[1].avg_read_us < cards[0].avg_read_us ? 1 : 0;
+    if (++read_runs % SD_ARRAY_PROBE_RUNS == 0) {
+        card = (card + 1) % SD_ARRAY_CARDS;
+    }
+    return card;
+}
+
+/* Must hold the lock. Read one sector from the first card that can */
+static SDRESULTS mirror_read(uint8_t first, uint32_t sector, uint8_t *buffer) {
+    uint8_t i;
+    for (i = 0; i < SD_ARRAY_CARDS; i++) {
+        uint8_t card = (first + i) % SD_ARRAY_CARDS;
+        if (cards[card].state != SD_CARD_ONLINE) {
+            continue;
+        }
+        if (card_read(card, sector, buffer) == SD_OK) {
+            read_failures[card] = 0;
+            return SD_OK;
+        }
+        if (++read_failures[card] >= SD_ARRAY_READ_FAIL_LIMIT && online_cards() > 1) {
+            drop_card(card, "reads keep failing");
+        }
+    }
+    return SD_ERROR;
+}
+
+/* Must hold the lock. Write one sector to every card in use, succeeds if a current card has it */
+static SDRESULTS mirror_write(uint32_t sector, const uint8_t *buffer) {
+    bool written = false;
+    uint8_t card, tries;
+
+    for (card = 0; card < SD_ARRAY_CARDS; card++) {
+        if (cards[card].state == SD_CARD_OFFLINE) {
+            continue;
+        }
+        SDRESULTS res = SD_ERROR;
+        for (tries = 0; tries < SD_ARRAY_WRITE_TRIES && res != SD_OK; tries++) {
+            res = card_write(card, sector, buffer);
+        }
+        if (res == SD_OK) {
+            written |= cards[card].state == SD_CARD_ONLINE;
+        } else if (cards[card].state == SD_CARD_REBUILDING || online_cards() > 1) {
+            // The last current card is kept, the write fails instead
+            drop_card(card, "a write failed");
+        }
+    }
+    return written ? SD_OK : SD_ERROR;
+}
+
+#endif
+
+/**
+ * @brief
+ *      Initialize both cards and work out which of them can be used
+ * @details
+ *      Called by Reliance Edge when VOL0 is formatted or mounted
+ * @return
+ *      SD_OK if the volume can be used, in mirror mode possibly with one card
+ */
+SDRESULTS sd_array_open(void) {
+    SDRESULTS res = SD_OK;
+    uint8_t card;
+
+    prv_get_lock();
+    for (card = 0; card < SD_ARRAY_CARDS; card++) {
+        cards[card].state = SD_Init(card) == SD_OK ? SD_CARD_ONLINE : SD_CARD_OFFLINE;
+        read_failures[card] = 0;
+        if (cards[card].state == SD_CARD_OFFLINE) {
+            sys_log(ERROR, "SD card %d failed to initialize", card);
+            res = SD_NOINIT;
+        }
+    }
+#if SD_ARRAY_MODE != SD_ARRAY_STRIPE
+    res = mirror_open();
+#endif
+    prv_give_lock();
+    return res;
+}
+
+/**
+ * @brief
+ *      Read sectors of the volume
+ * @param sector
+ *      First sector to read
+ * @param count
+ *      Number of sectors to read
+ * @param buffer
+ *      Where to put them, count * SD_BLK_SIZE bytes
+ * @return
+ *      SD_OK if every sector was read
+ */
+SDRESULTS sd_array_read(uint32_t sector, uint32_t count, void *buffer) {
+    uint8_t *data = (uint8_t *)buffer;
+    SDRESULTS res = SD_OK;
+    uint32_t i;
+
+    if (count > SD_ARRAY_SECTORS || sector > SD_ARRAY_SECTORS - count) {
+        return SD_PARERR;
+    }
+    prv_get_lock();
+#if SD_ARRAY_MODE == SD_ARRAY_STRIPE
+    for (i = 0; i < count && res == SD_OK; i++) {
+        uint32_t card_sector;
+        uint8_t card = stripe_card(sector + i, &card_sector);
+        res = card_read(card, card_sector, &data[i * SD_BLK_SIZE]);
+    }
+#else
+    uint8_t first = read_card();
+    for (i = 0; i < count && res == SD_OK; i++) {
+        res = mirror_read(first, sector + i, &data[i * SD_BLK_SIZE]);
+    }
+#endif
+    prv_give_lock();
+    return res;
+}
+
+/**
+ * @brief
+ *      Write sectors of the volume
+ * @param sector
+ *      First sector to write
+ * @param count
+ *      Number of sectors to write
+ * @param buffer
+ *      Data to write, count * SD_BLK_SIZE bytes
+ * @return
+ *      SD_OK if every sector was written
+ */
+SDRESULTS sd_array_write(uint32_t sector, uint32_t count, const void *buffer) {
+    const uint8_t *data = (const uint8_t *)buffer;
+    SDRESULTS res = SD_OK;
+    uint32_t i;
+
+    if (count > SD_ARRAY_SECTORS || sector > SD_ARRAY_SECTORS - count) {
+        return SD_PARERR;
+    }
+    prv_get_lock();
+    for (i = 0; i < count && res == SD_OK; i++) {
+#if SD_ARRAY_MODE == SD_ARRAY_STRIPE
+        uint32_t card_sector;
+        uint8_t card = stripe_card(sector + i, &card_sector);
+        res = card_write(card, card_sector, &data[i * SD_BLK_SIZE]);
+#else
+        res = mirror_write(sector + i, &data[i * SD_BLK_SIZE]);
+#endif
+    }
+    prv_give_lock();
+    return res;
+}
+
+#if SD_ARRAY_MODE == SD_ARRAY_MIRROR
+
+static bool rebuild_running = false; // a rebuild task has been started and not finished
+
+/* Must hold the lock. The card a rebuild would copy onto, SD_ARRAY_CARDS if there is none */
+static uint8_t rebuild_target(void) {
+    uint8_t target = 0;
+    while (target < SD_ARRAY_CARDS && cards[target].state != SD_CARD_OFFLINE) {
+        target++;
+    }
+    return online_cards() == 0 ? SD_ARRAY_CARDS : target;
+}
+
+static void rebuild_progress(uint32_t rebuilt, uint32_t total, void *arg) {
+    TickType_t *last_report = (TickType_t *)arg;
+    TickType_t now = xTaskGetTickCount();
+
+    if (now - *last_report >= SD_ARRAY_REBUILD_REPORT) {
+        *last_report = now;
+        sys_log(INFO, "SD rebuild at sector %u of %u", rebuilt, total);
+    }
+}
+
+static void sd_array_rebuild_daemon(void *pvParameters) {
+    TickType_t start = xTaskGetTickCount();
+    TickType_t last_report = start;
+
+    if (sd_array_rebuild(rebuild_progress, &last_report) == SD_OK) {
+        sys_log(INFO, "SD rebuild took %u s", (xTaskGetTickCount() - start) / configTICK_RATE_HZ);
+    }
+    prv_get_lock();
+    rebuild_running = false;
+    prv_give_lock();
+    vTaskDelete(NULL);
+}
+
+#endif
+
+/**
+ * @brief
+ *      Copy the current card of the mirror onto the one that dropped out
+ * @details
+ *      The volume can be used meanwhile. Writes go to both cards, reads
+ *      only to the current one until the copy is finished. Takes as long as
+ *      copying the whole card, see sd_array_rebuild_start to run it in a task
+ * @param progress
+ *      Called after each batch of sectors is copied, may be NULL
+ * @param arg
+ *      Passed to progress
+ * @return
+ *      SD_PARERR if not mirroring or there is nothing to rebuild,
+ *      SD_OK once the card is back in the mirror, SD_ERROR if it failed or was cancelled
+ */
+SDRESULTS sd_array_rebuild(sd_array_progress progress, void *arg) {
+#if SD_ARRAY_MODE != SD_ARRAY_MIRROR
+    return SD_PARERR;
+#else
+    SDRESULTS res = SD_OK;
+    uint32_t sector = 0;
+    bool cancelled = false;
+    uint8_t target, i, tries;
+
+    prv_get_lock();
+    target = rebuild_target();
+    if (target == SD_ARRAY_CARDS) {
+        prv_give_lock();
+        return SD_PARERR;
+    }
+    rebuild_cancelled = false;
+    res = SD_Init(target);
+    if (res == SD_OK) {
+        cards[target].state = SD_CARD_REBUILDING;
+        cards[target].rebuilt = 0;
+        read_failures[target] = 0;
+    }
+    prv_give_lock();
+    if (res != SD_OK) {
+        sys_log(ERROR, "SD card %d failed to initialize", target);
+        return res;
+    }
+    sys_log(INFO, "Rebuilding SD card %d", target);
+
+    while (sector < SD_ARRAY_SECTORS && res == SD_OK) {
+        prv_get_lock();
+        cancelled = rebuild_cancelled;
+        if (cancelled) {
+            res = SD_ERROR;
+        }
+        for (i = 0; res == SD_OK && i < SD_ARRAY_REBUILD_BATCH && sector < SD_ARRAY_SECTORS; i++) {
+            if (cards[target].state != SD_CARD_REBUILDING) {
+                // Dropped by a write to the volume
+                res = SD_ERROR;
+                break;
+            }
+            res = mirror_read(target, sector, sector_buffer);
+            if (res != SD_OK) {
+                break;
+            }
+            for (tries = 0; tries < SD_ARRAY_WRITE_TRIES; tries++) {
+                res = card_write(target, sector, sector_buffer);
+                if (res == SD_OK) {
+                    break;
+                }
+            }
+            if (res != SD_OK) {
+                drop_card(target, "the rebuild failed to write");
+                break;
+            }
+            sector++;
+        }
+        cards[target].rebuilt = sector;
+        prv_give_lock();
+        if (progress != NULL) {
+            progress(sector, SD_ARRAY_SECTORS, arg);
+        }
+    }
+
+    prv_get_lock();
+    if (res == SD_OK) {
+        res = write_record(target);
+    }
+    if (res == SD_OK) {
+        cards[target].state = SD_CARD_ONLINE;
+    } else if (cards[target].state == SD_CARD_REBUILDING) {
+        cards[target].state = SD_CARD_OFFLINE;
+    }
+    prv_give_lock();
+    if (res == SD_OK) {
+        sys_log(INFO, "SD card %d is back in the mirror", target);
+    } else if (cancelled) {
+        sys_log(WARN, "Rebuild of SD card %d cancelled at sector %u", target, sector);
+    } else {
+        sys_log(ERROR, "Rebuild of SD card %d stopped at sector %u", target, sector);
+    }
+    return res;
+#endif
+}
+
+/**
+ * @brief
+ *      Start a task that rebuilds the card that dropped out of the mirror
+ * @details
+ *      Progress is logged, and shown by sd_array_get_stats
+ * @return
+ *      SD_PARERR if not mirroring, a rebuild is already running or there is
+ *      nothing to rebuild, SD_OK once the task is started
+ */
+SDRESULTS sd_array_rebuild_start(void) {
+#if SD_ARRAY_MODE != SD_ARRAY_MIRROR
+    return SD_PARERR;
+#else
+    prv_get_lock();
+    if (rebuild_running || rebuild_target() == SD_ARRAY_CARDS) {
+        prv_give_lock();
+        return SD_PARERR;
+    }
+    rebuild_running = true;
+    prv_give_lock();
+
+    if (xTaskCreate(sd_array_rebuild_daemon, "sd_rebuild", SD_ARRAY_REBUILD_STACK_SIZE, NULL,
+                    SD_REBUILD_TASK_PRIO, NULL) != pdPASS) {
+        prv_get_lock();
+        rebuild_running = false;
+        prv_give_lock();
+        return SD_ERROR;
+    }
+    return SD_OK;
+#endif
+}
+
+/**
+ * @brief
+ *      Stop a rebuild in progress
+ * @details
+ *      The rebuild stops once the batch of sectors it is copying is done,
+ *      and the card stays out of the mirror
+ * @return
+ *      false if no rebuild is in progress
+ */
+bool sd_array_rebuild_cancel(void) {
+    bool rebuilding = false;
+    uint8_t card;
+
+    prv_get_lock();
+    for (card = 0; card < SD_ARRAY_CARDS; card++) {
+        rebuilding |= cards[card].state == SD_CARD_REBUILDING;
+    }
+    rebuild_cancelled |= rebuilding;
+    prv_give_lock();
+    return rebuilding;
+}
+
+/**
+ * @brief
+ *      Copy out the state and statistics of one card
+ * @param card
+ *      Card to get, below SD_ARRAY_CARDS
+ * @param out
+ *      Where to copy the statistics
+ * @return
+ *      false once card is past the last one, or if the cards are not an array
+ */
+bool sd_array_get_stats(uint8_t card, sd_array_card_stats *out) {
+    if (SD_ARRAY_MODE == SD_ARRAY_NONE || card >= SD_ARRAY_CARDS) {
+        return false;
+    }
+    prv_get_lock();
+    *out = cards[card];
+    prv_give_lock();
+    return true;
+}
@@ -38,8 +38,15 @@ void inittemp_all(void) {
 int gettemp_all(long *temparray) {
     int i;
     for (i = 0; i < NUM_TEMP_SENSOR; i++) {
-        tmp421_read(tmp_addr[i], CHANNEL_LOCAL, &temparray[i]); // assuming we want to read remote channel
+        gettemp(i, &temparray[i]);
         vTaskDelay(ATHENA_TEMPSENSE_DELAY);
     }
     return 0;
 }
+
+int gettemp(int index, long *temp) {
+    if (index < 0 || index >= NUM_TEMP_SENSOR) {
+        return 1;
+    }
+    return tmp421_read(tmp_addr[index], CHANNEL_LOCAL, temp); // assuming we want to read remote channel
+}
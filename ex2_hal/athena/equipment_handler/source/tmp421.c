@@ -24,6 +24,7 @@
 //#include <linux/sysfs.h>
 
 #include "tmp421.h"
+#include "calibration/calibration.h"
 #include "HL_i2c.h"
 #include "i2c_io.h"
 #include "stdio.h"
@@ -142,15 +143,14 @@ uint16_t i2cSlaveRead2ByteReg(uint8_t sadd, uint8_t reg) {
     return value;
 }
 
-long calc_temp_pos(uint16_t reg) {
-    /* Mask out status bits */
-    int temp = reg & ~0xf;
-
-    return (temp * 10000 + 128) / 256;
+/* Like i2cSlaveRead1ByteReg, but reports a failed transfer. Returns 0 on success */
+static int tmp421_read_reg(uint8_t sadd, uint8_t reg, uint8_t *value) {
+    if (i2c_Send(i2cREG2, sadd, 1, &reg) != 0) {
+        return -1;
+    }
+    return i2c_Receive(i2cREG2, sadd, 1, value);
 }
 
-long calc_temp_neg(uint16_t reg) { return (((~(reg >> 8) + 1) & 0x7F) * -10000) + ((reg >> 4) & 0xF) * 625; }
-
 // int temp_from_u16(uint16_t reg) {
 //	/* Mask out status bits */
 //	int temp = reg & ~0xf;
@@ -196,28 +196,25 @@ long calc_temp_neg(uint16_t reg) { return (((~(reg >> 8) + 1) & 0x7F) * -10000)
 
 // Note that because val is stored as an integer, the actual temperature is the decimal integer value shifted 4
 // digits to the right Ex: val == 276875 means a measurement of 27.6875 degrees C
+// Returns 0 on success, 1 for an invalid channel and -1 if the bus transfer failed, leaving val unchanged
 int tmp421_read(uint8_t sadd, int channel, long *val) {
 
     uint8_t temp[2] = {0};
     uint16_t temp16 = 0;
 
-    if (channel == CHANNEL_LOCAL) {
-        temp[0] = i2cSlaveRead1ByteReg(sadd, TMP421_TEMP_MSB[0]);
-        int delay;
-        for (delay = 0; delay < 0x1000; delay++)
-            ; // temporary fix... don't want delay down the road
-        temp[1] = i2cSlaveRead1ByteReg(sadd, TMP421_TEMP_LSB[0]);
-        temp16 = (((uint16_t)(temp[0])) << 8) | temp[1];
-    } else if (channel == CHANNEL_REMOTE) {
-        temp[0] = i2cSlaveRead1ByteReg(sadd, TMP421_TEMP_MSB[1]);
-        int delay;
-        for (delay = 0; delay < 0x1000; delay++)
-            ; // temporary fix... don't want delay down the road
-        temp[1] = i2cSlaveRead1ByteReg(sadd, TMP421_TEMP_LSB[1]);
-        temp16 = (((uint16_t)(temp[0])) << 8) | temp[1];
-    } else {
+    if (channel != CHANNEL_LOCAL && channel != CHANNEL_REMOTE) {
         return 1;
     }
+    if (tmp421_read_reg(sadd, TMP421_TEMP_MSB[channel], &temp[0]) != 0) {
+        return -1;
+    }
+    int delay;
+    for (delay = 0; delay < 0x1000; delay++)
+        ; // temporary fix... don't want delay down the road
+    if (tmp421_read_reg(sadd, TMP421_TEMP_LSB[channel], &temp[1]) != 0) {
+        return -1;
+    }
+    temp16 = (((uint16_t)(temp[0])) << 8) | temp[1];
 
     // switch (attr) {
     //	// case hwmon_temp_input:
@@ -225,11 +222,7 @@ int tmp421_read(uint8_t sadd, int channel, long *val) {
     //			*val = temp_from_u16(tmp421->temp[channel]);
     //		else
 
-    if (temp16 & 0x8000 == 0x8000) {
-        *val = calc_temp_neg(temp16);
-    } else {
-        *val = calc_temp_pos(temp16);
-    }
+    *val = calibration_convert(&cal_temp12_ten_thousandth_c, temp16);
 
     return 0;
     // case hwmon_temp_fault:
@@ -7,11 +7,11 @@
 #include "nmea_daemon.h"
 #include "FreeRTOS.h"
 #include "os_task.h"
-#include <string.h>
 #include "util/service_utilities.h"
 #include "system.h"
 #include "task_manager/task_manager.h"
 #include "NMEAParser.h"
+#include "skytraq_gps.h"
 
 #define NMEA_TASK_SIZE 384
 
@@ -26,20 +26,22 @@ void NMEA_daemon() {
     ex2_log("NMEA task started");
 
     init_NMEA();
-    static char NMEA_buf[NMEASENTENCE_MAXLENGTH];
+    nmea_line_t line;
 
     for (;;) {
-        memset(NMEA_buf, 0, NMEASENTENCE_MAXLENGTH);
         wdt_counter++;
 
-        while (xQueueReceive(NMEA_queue, NMEA_buf, DELAY_WAIT_INTERVAL) != pdPASS) {
+        while (xQueueReceive(NMEA_queue, &line, DELAY_WAIT_INTERVAL) != pdPASS) {
             wdt_counter++;
+            gps_check_output_mode();
         }
-        int i;
-        for (i = 0; i < strlen(NMEA_buf); i++) {
-            NMEAParser_encode(NMEA_buf[i]);
+        // The sentence is parsed where the interrupt stored it
+        if (line.type == NMEA_LINE_NAV) {
+            NMEAParser_parse_nav((uint8_t *)NMEAParser_get_line(&line), line.length);
+        } else {
+            NMEAParser_parse_sentence(NMEAParser_get_line(&line), line.length);
         }
-        ex2_log("NMEA message received: %s", NMEA_buf);
+        gps_check_output_mode();
     }
 }
 
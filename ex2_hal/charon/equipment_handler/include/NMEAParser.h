@@ -14,7 +14,7 @@
 #include "FreeRTOS.h"
 #include "NMEA_types.h"
 #include "os_queue.h"
-#include "os_semphr.h"
+#include "skytraq_nav.h"
 
 #define NMEA_GGA 0
 #define NMEA_GSA 1
@@ -45,30 +45,72 @@ enum {
     GPS_INVALID_COURSE = 0xFFFF
 };
 
-#define NMEA_QUEUE_ITEM_SIZE NMEASENTENCE_MAXLENGTH
-#define NMEA_QUEUE_MAX_LEN 2
+/*
+ * The UART interrupt writes each sentence straight into one of these line
+ * buffers and queues only its index. A buffer is not reused until the
+ * sentence in it has been parsed: at most NMEA_QUEUE_MAX_LEN are queued, one
+ * is being parsed and one is being received. Binary navigation data messages
+ * go through the same buffers when the receiver is in binary output mode.
+ */
+#define NMEA_QUEUE_MAX_LEN 4
+#define NMEA_LINE_SLOTS (NMEA_QUEUE_MAX_LEN + 2)
+
+typedef enum {
+    NMEA_LINE_SENTENCE, // NMEA text sentence
+    NMEA_LINE_NAV,      // Skytraq binary navigation data message
+} nmea_line_type;
+
+typedef struct {
+    uint8_t slot;   // line buffer holding the sentence
+    uint8_t length; // bytes including the line ending
+    uint8_t type;   // nmea_line_type
+} nmea_line_t;
+
+#define NMEA_QUEUE_ITEM_SIZE sizeof(nmea_line_t)
 
 extern QueueHandle_t NMEA_queue;
 
-extern SemaphoreHandle_t NMEA_mutex;
+/* Latest decoded value of every supported sentence, published together */
+typedef struct {
+    GPGGA_s gga;
+    GPGSA_s gsa;
+    GPGSV_s gsv;
+    GPRMC_s rmc;
+    skytraq_nav_t nav;
+} nmea_fix_t;
+
+typedef struct {
+    uint32_t parsed;          // sentences decoded
+    uint32_t checksum_errors; // sentences with a bad checksum
+    uint32_t malformed;       // missing '$' or checksum, or too many terms
+    uint32_t unsupported;     // valid sentences of a type that isn't decoded, or without a fix
+    uint32_t dropped;         // sentences lost because the queue was full or the line too long
+    uint32_t nav_parsed;      // binary navigation messages decoded
+    uint32_t nav_errors;      // binary navigation messages with a bad checksum or length
+} nmea_stats_t;
 
 bool init_NMEA();
 
-static GPGGA_s GPGGA;
-static GPGSA_s GPGSA;
-static GPGSV_s GPGSV;
-static GPRMC_s GPRMC;
+void NMEAParser_receive_from_isr(char c, BaseType_t *woken);
+char *NMEAParser_get_line(const nmea_line_t *line);
+bool NMEAParser_parse_sentence(char *sentence, uint32_t length);
+void NMEAParser_receive_nav_from_isr(const uint8_t *frame, uint32_t length, BaseType_t *woken);
+bool NMEAParser_parse_nav(const uint8_t *frame, uint32_t length);
 
+bool NMEAParser_get_fix(nmea_fix_t *output);
 bool NMEAParser_get_GPGGA(GPGGA_s *output);
 bool NMEAParser_get_GPGSA(GPGSA_s *output);
 bool NMEAParser_get_GPGSV(GPGSV_s *output);
 bool NMEAParser_get_GPRMC(GPRMC_s *output);
+bool NMEAParser_get_nav(skytraq_nav_t *output);
+void NMEAParser_get_stats(nmea_stats_t *stats);
 
-bool NMEAParser_encode(char c);
+/* These must only be called from the NMEA daemon, or before it starts */
 void NMEAParser_clear_GPGGA(void);      // set GPGGA storage to invalid
 void NMEAParser_clear_GPGSA(void);      // set GPGSA storage to invalid
 void NMEAParser_clear_GPGSV(void);      // set GPGSV storage to invalid
 void NMEAParser_clear_GPRMC(void);      // set GPRMC storage to invalid
+void NMEAParser_clear_nav(void);        // set navigation data storage to invalid
 void NMEAParser_reset_all_values(void); // set all storage to invalid
 
 #endif
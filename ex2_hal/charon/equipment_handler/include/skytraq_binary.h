@@ -37,6 +37,10 @@ GPS_RETURNSTATE skytraq_configure_nmea_output_rate(uint8_t GGA_interval, uint8_t
                                                    uint8_t RMC_interval, uint8_t VTG_interval,
                                                    uint8_t ZDA_interval, skytraq_update_attributes attribute);
 
+GPS_RETURNSTATE configure_message_type(skytraq_message_type type, skytraq_update_attributes attribute);
+
+GPS_RETURNSTATE skytraq_configure_nav_message_interval(uint8_t interval, skytraq_update_attributes attribute);
+
 GPS_RETURNSTATE skytraq_configure_power_mode(skytraq_power_mode mode, skytraq_update_attributes attribute);
 
 GPS_RETURNSTATE skytraq_get_gps_time(uint8_t *reply, uint16_t reply_len);
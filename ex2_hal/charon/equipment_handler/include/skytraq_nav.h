@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file skytraq_nav.h
+ * @date Oct. 19, 2026
+ */
+
+#ifndef SKYTRAQ_NAV_H
+#define SKYTRAQ_NAV_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+
+/* Navigation data message (0xA8), sent once per fix when binary output is enabled */
+#define SKYTRAQ_NAV_PAYLOAD_LENGTH 59
+#define SKYTRAQ_FRAME_OVERHEAD 7 // 0xA0 0xA1, length, checksum, 0x0D 0x0A
+#define SKYTRAQ_NAV_FRAME_LENGTH (SKYTRAQ_NAV_PAYLOAD_LENGTH + SKYTRAQ_FRAME_OVERHEAD)
+
+/* GPS time is ahead of UTC by this many seconds, last changed at the start of 2017 */
+#define SKYTRAQ_GPS_LEAP_SECONDS 18
+
+typedef enum {
+    SKYTRAQ_FIX_NONE = 0,
+    SKYTRAQ_FIX_2D = 1,
+    SKYTRAQ_FIX_3D = 2,
+    SKYTRAQ_FIX_3D_DGPS = 3,
+} skytraq_fix_mode;
+
+typedef struct {
+    uint8_t fix_mode;             // skytraq_fix_mode
+    uint8_t numsats;              // number of satellites used for fix
+    uint16_t week;                // GPS week number
+    uint32_t tow;                 // time of week in hundredths of a second
+    int32_t latitude;             // latitude in ten millionths of a degree
+    int32_t longitude;            // longitude in ten millionths of a degree
+    int32_t ellipsoid_altitude;   // altitude above the ellipsoid in centimeters
+    int32_t altitude;             // altitude above mean sea level in centimeters
+    uint16_t gdop, pdop, hdop;    // dilution of precision scaled by 100
+    uint16_t vdop, tdop;          // (i.e. 120 corresponds to a dop of 1.2)
+    int32_t ecef_x, ecef_y, ecef_z;    // ECEF position in centimeters
+    int32_t ecef_vx, ecef_vy, ecef_vz; // ECEF velocity in centimeters per second
+    TickType_t _logtime;               // relative time packet was received
+} skytraq_nav_t;
+
+bool skytraq_decode_nav(const uint8_t *frame, uint32_t length, skytraq_nav_t *nav);
+
+time_t skytraq_nav_unix_time(const skytraq_nav_t *nav, uint32_t ms_since_fix);
+
+#endif // SKYTRAQ_NAV_H
@@ -7,22 +7,36 @@
 
 #include "NMEAParser.h"
 #include "FreeRTOS.h"
-#include "os_semphr.h"
 #include "os_task.h"
 #include <string.h>
 
-static int NMEAParser_termcmp(const char *str1, const char *str2);
 static int NMEAParser_hexToInt(char hex);
-static int32_t NMEAParser_parse_decimal(char *p);
-static void NMEAParser_parse_degrees(char *p, int32_t *upper, int32_t *lower);
-static bool NMEAParser_decode_sentence();
+static uint32_t NMEAParser_parse_uint(const char *p);
+static int32_t NMEAParser_parse_decimal(const char *p);
+static void NMEAParser_parse_degrees(const char *p, int32_t *upper, int32_t *lower);
 
-static char _sentence[NMEASENTENCE_MAXLENGTH];
-static int _char_offset;
+/* Readers give up if the fix is republished this many times while they copy it */
+#define NMEA_READ_RETRIES 4
 
 QueueHandle_t NMEA_queue;
 
-SemaphoreHandle_t NMEA_mutex;
+/* Written by the UART interrupt, see NMEA_LINE_SLOTS */
+static char nmea_lines[NMEA_LINE_SLOTS][NMEASENTENCE_MAXLENGTH];
+static uint8_t rx_slot = 0;
+static uint8_t rx_length = 0;
+static bool rx_overflow = false;
+
+/*
+ * The NMEA daemon decodes into working and then copies it to the published
+ * buffer readers are not using. fix_sequence is odd while a copy is in
+ * progress and bit 1 selects the buffer to read, so readers never block the
+ * daemon and always see all four sentences from the same point in time.
+ */
+static nmea_fix_t working;
+static nmea_fix_t published[2];
+static volatile uint32_t fix_sequence = 0;
+
+static nmea_stats_t stats;
 
 const static GPGGA_s GPGGA_invalid = {._time = GPS_INVALID_TIME,
                                       ._latitude_lower = GPS_INVALID_ANGLE,
@@ -60,6 +74,19 @@ const static GPRMC_s GPRMC_invalid = {._time = GPS_INVALID_TIME,
                                       ._date = GPS_INVALID_DATE,
                                       ._logtime = (TickType_t)GPS_INVALID_FIX_TIME};
 
+const static skytraq_nav_t nav_invalid = {.fix_mode = SKYTRAQ_FIX_NONE,
+                                          .numsats = GPS_INVALID_SATELLITES,
+                                          .latitude = GPS_INVALID_ANGLE,
+                                          .longitude = GPS_INVALID_ANGLE,
+                                          .ellipsoid_altitude = GPS_INVALID_ALTITUDE,
+                                          .altitude = GPS_INVALID_ALTITUDE,
+                                          .gdop = GPS_INVALID_DOP,
+                                          .pdop = GPS_INVALID_DOP,
+                                          .hdop = GPS_INVALID_DOP,
+                                          .vdop = GPS_INVALID_DOP,
+                                          .tdop = GPS_INVALID_DOP,
+                                          ._logtime = (TickType_t)GPS_INVALID_FIX_TIME};
+
 /**
  * @brief sets initial memory values for NMEA
  *
@@ -68,10 +95,6 @@ const static GPRMC_s GPRMC_invalid = {._time = GPS_INVALID_TIME,
  */
 bool init_NMEA() {
     NMEA_queue = xQueueCreate(NMEA_QUEUE_MAX_LEN, NMEA_QUEUE_ITEM_SIZE);
-    NMEA_mutex = xSemaphoreCreateRecursiveMutex();
-    if (NMEA_mutex == NULL) {
-        return false;
-    }
     if (NMEA_queue == NULL) {
         return false;
     }
@@ -79,6 +102,42 @@ bool init_NMEA() {
     return true;
 }
 
+/**
+ * @brief copy working to the published buffer readers are not using
+ *
+ */
+static void NMEAParser_publish(void) {
+    uint32_t next = ((fix_sequence >> 1) + 1) & 1;
+    fix_sequence++;
+    memcpy(&published[next], &working, sizeof(working));
+    fix_sequence++;
+}
+
+/**
+ * @brief get a consistent copy of the latest GGA, GSA, GSV and RMC data
+ *
+ * @param output struct * to store the fix
+ * @return true success
+ * @return false the fix kept changing while it was copied
+ */
+bool NMEAParser_get_fix(nmea_fix_t *output) {
+    int attempt;
+    for (attempt = 0; attempt < NMEA_READ_RETRIES; attempt++) {
+        uint32_t start = fix_sequence;
+        memcpy(output, &published[(start >> 1) & 1], sizeof(nmea_fix_t));
+        // The buffer is only rewritten by the second publish that starts after start was read
+        if (fix_sequence - (start & ~1U) < 3) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool NMEAParser_is_recent(TickType_t logtime) {
+    return (logtime != (TickType_t)GPS_INVALID_FIX_TIME) &&
+           (xTaskGetTickCount() - logtime < GPS_AGE_INVALID_THRESHOLD);
+}
+
 /**
  * @brief gets latest incoming GPGGA packet
  *
@@ -87,17 +146,14 @@ bool init_NMEA() {
  * @return false failure
  */
 bool NMEAParser_get_GPGGA(GPGGA_s *output) {
-    TickType_t tickCount = xTaskGetTickCount();
-
-    xSemaphoreTakeRecursive(NMEA_mutex, portMAX_DELAY);
-    if ((GPGGA._logtime != GPS_INVALID_FIX_TIME) && (tickCount - GPGGA._logtime < GPS_AGE_INVALID_THRESHOLD)) {
-        memcpy(output, &GPGGA, sizeof(GPGGA_s));
-        xSemaphoreGiveRecursive(NMEA_mutex);
-        return true;
+    nmea_fix_t fix;
+    if (!NMEAParser_get_fix(&fix) || !NMEAParser_is_recent(fix.gga._logtime)) {
+        return false;
     }
-    xSemaphoreGiveRecursive(NMEA_mutex);
-    return false;
+    *output = fix.gga;
+    return true;
 }
+
 /**
  * @brief get latest GPGSA packet
  *
@@ -106,16 +162,12 @@ bool NMEAParser_get_GPGGA(GPGGA_s *output) {
  * @return false failure
  */
 bool NMEAParser_get_GPGSA(GPGSA_s *output) {
-    TickType_t tickCount = xTaskGetTickCount();
-
-    xSemaphoreTakeRecursive(NMEA_mutex, portMAX_DELAY);
-    if ((GPGSA._logtime != GPS_INVALID_FIX_TIME) && (tickCount - GPGSA._logtime < GPS_AGE_INVALID_THRESHOLD)) {
-        memcpy(output, &GPGSA, sizeof(GPGSA_s));
-        xSemaphoreGiveRecursive(NMEA_mutex);
-        return true;
+    nmea_fix_t fix;
+    if (!NMEAParser_get_fix(&fix) || !NMEAParser_is_recent(fix.gsa._logtime)) {
+        return false;
     }
-    xSemaphoreGiveRecursive(NMEA_mutex);
-    return false;
+    *output = fix.gsa;
+    return true;
 }
 
 /**
@@ -126,17 +178,12 @@ bool NMEAParser_get_GPGSA(GPGSA_s *output) {
  * @return false failure
  */
 bool NMEAParser_get_GPGSV(GPGSV_s *output) {
-    TickType_t tickCount = xTaskGetTickCount();
-
-    xSemaphoreTakeRecursive(NMEA_mutex, portMAX_DELAY);
-    if ((GPGSV._logtime != GPS_INVALID_FIX_TIME) && (tickCount - GPGSV._logtime < GPS_AGE_INVALID_THRESHOLD)) {
-        memcpy(output, &GPGSV, sizeof(GPGSV_s));
-        xSemaphoreGiveRecursive(NMEA_mutex);
-        return true;
+    nmea_fix_t fix;
+    if (!NMEAParser_get_fix(&fix) || !NMEAParser_is_recent(fix.gsv._logtime)) {
+        return false;
     }
-
-    xSemaphoreGiveRecursive(NMEA_mutex);
-    return false;
+    *output = fix.gsv;
+    return true;
 }
 
 /**
@@ -147,27 +194,48 @@ bool NMEAParser_get_GPGSV(GPGSV_s *output) {
  * @return false failure
  */
 bool NMEAParser_get_GPRMC(GPRMC_s *output) {
-    TickType_t tickCount = xTaskGetTickCount();
+    nmea_fix_t fix;
+    if (!NMEAParser_get_fix(&fix) || !NMEAParser_is_recent(fix.rmc._logtime)) {
+        return false;
+    }
+    *output = fix.rmc;
+    return true;
+}
 
-    xSemaphoreTakeRecursive(NMEA_mutex, portMAX_DELAY);
-    if ((GPRMC._logtime != GPS_INVALID_FIX_TIME) && (tickCount - GPRMC._logtime < GPS_AGE_INVALID_THRESHOLD)) {
-        memcpy(output, &GPRMC, sizeof(GPRMC_s));
-        xSemaphoreGiveRecursive(NMEA_mutex);
-        return true;
+/**
+ * @brief get latest binary navigation data
+ *
+ * @param output struct * to store the navigation data
+ * @return true success
+ * @return false failure
+ */
+bool NMEAParser_get_nav(skytraq_nav_t *output) {
+    nmea_fix_t fix;
+    if (!NMEAParser_get_fix(&fix) || !NMEAParser_is_recent(fix.nav._logtime)) {
+        return false;
     }
-    xSemaphoreGiveRecursive(NMEA_mutex);
-    return false;
+    *output = fix.nav;
+    return true;
 }
 
+/**
+ * @brief get the parser counters
+ *
+ * @param output struct * to store the counters
+ */
+void NMEAParser_get_stats(nmea_stats_t *output) { *output = stats; }
+
 /**
  * @brief reset all packet storage to invalid values
  *
  */
 void NMEAParser_reset_all_values(void) {
-    NMEAParser_clear_GPGSV();
-    NMEAParser_clear_GPRMC();
-    NMEAParser_clear_GPGGA();
-    NMEAParser_clear_GPGSA();
+    working.gga = GPGGA_invalid;
+    working.gsa = GPGSA_invalid;
+    working.gsv = GPGSV_invalid;
+    working.rmc = GPRMC_invalid;
+    working.nav = nav_invalid;
+    NMEAParser_publish();
 }
 
 /**
@@ -175,9 +243,8 @@ void NMEAParser_reset_all_values(void) {
  *
  */
 void NMEAParser_clear_GPGGA(void) {
-    xSemaphoreTakeRecursive(NMEA_mutex, portMAX_DELAY);
-    memcpy(&GPGGA, &GPGGA_invalid, sizeof(GPGGA_s));
-    xSemaphoreGiveRecursive(NMEA_mutex);
+    working.gga = GPGGA_invalid;
+    NMEAParser_publish();
 }
 
 /**
@@ -185,9 +252,8 @@ void NMEAParser_clear_GPGGA(void) {
  *
  */
 void NMEAParser_clear_GPGSA(void) {
-    xSemaphoreTakeRecursive(NMEA_mutex, portMAX_DELAY);
-    memcpy(&GPGSA, &GPGSA_invalid, sizeof(GPGSA_s));
-    xSemaphoreGiveRecursive(NMEA_mutex);
+    working.gsa = GPGSA_invalid;
+    NMEAParser_publish();
 }
 
 /**
@@ -195,9 +261,8 @@ void NMEAParser_clear_GPGSA(void) {
  *
  */
 void NMEAParser_clear_GPGSV(void) {
-    xSemaphoreTakeRecursive(NMEA_mutex, portMAX_DELAY);
-    memcpy(&GPGSV, &GPGSV_invalid, sizeof(GPGSV_s));
-    xSemaphoreGiveRecursive(NMEA_mutex);
+    working.gsv = GPGSV_invalid;
+    NMEAParser_publish();
 }
 
 /**
@@ -205,298 +270,371 @@ void NMEAParser_clear_GPGSV(void) {
  *
  */
 void NMEAParser_clear_GPRMC(void) {
-    xSemaphoreTakeRecursive(NMEA_mutex, portMAX_DELAY);
-    memcpy(&GPRMC, &GPRMC_invalid, sizeof(GPRMC_s));
-    xSemaphoreGiveRecursive(NMEA_mutex);
+    working.rmc = GPRMC_invalid;
+    NMEAParser_publish();
 }
 
 /**
- * @brief string names for each packet type
+ * @brief reset navigation data to invalid values
  *
  */
-const char _GPGGA_TERM[7] = "$GPGGA";
-const char _GPGLL_TERM[7] = "$GPGLL";
-const char _GPGSA_TERM[7] = "$GPGSA";
-const char _GPGSV_TERM[7] = "$GPGSV";
-const char _GPRMC_TERM[7] = "$GPRMC";
-const char _GPVTG_TERM[7] = "$GPVTG";
-const char _GPZDA_TERM[7] = "$GPZDA";
+void NMEAParser_clear_nav(void) {
+    working.nav = nav_invalid;
+    NMEAParser_publish();
+}
 
 /**
- * @brief takes NMEA string one char at a time until \n
+ * @brief store one byte of an NMEA sentence. Called from the UART interrupt
  *
- * @param c character to register with decoder
- * @return true data decoded
- * @return false data failure
+ * Queues the line buffer once the whole sentence has arrived. Sentences that
+ * don't fit in a line buffer, or arrive while the queue is full, are dropped.
+ *
+ * @param c received character
+ * @param woken set to pdTRUE if queueing the sentence woke a higher priority task
  */
-bool NMEAParser_encode(char c) {
-    bool new_data = false;
-    if (c == '\n') {
-        if (_sentence[_char_offset - 4] == '*') // checksum exists
-        {
-            int checksum = NMEAParser_hexToInt(_sentence[_char_offset - 2]) +
-                           NMEAParser_hexToInt(_sentence[_char_offset - 3]) * 16;
-            _char_offset -= 5;
-            while (_sentence[_char_offset] && _sentence[_char_offset] != '$')
-                checksum ^= _sentence[_char_offset--];
-            if (checksum == 0) // checksum is valid
-            {
-                xSemaphoreTakeRecursive(NMEA_mutex, portMAX_DELAY);
-                new_data = NMEAParser_decode_sentence();
-                xSemaphoreGiveRecursive(NMEA_mutex);
-            }
-            _char_offset = 0;
-            _sentence[0] = 0;
+void NMEAParser_receive_from_isr(char c, BaseType_t *woken) {
+    if (rx_length < NMEASENTENCE_MAXLENGTH) {
+        nmea_lines[rx_slot][rx_length++] = c;
+    } else {
+        rx_overflow = true;
+    }
+    if (c != '\n') {
+        return;
+    }
+
+    nmea_line_t line = {rx_slot, rx_length, NMEA_LINE_SENTENCE};
+    if (!rx_overflow && NMEA_queue != NULL && xQueueSendToBackFromISR(NMEA_queue, &line, woken) == pdPASS) {
+        rx_slot = (rx_slot + 1) % NMEA_LINE_SLOTS;
+    } else {
+        stats.dropped++;
+    }
+    rx_length = 0;
+    rx_overflow = false;
+}
+
+/**
+ * @brief queue a binary navigation data message. Called from the UART interrupt
+ *
+ * @param frame complete binary message
+ * @param length bytes in frame
+ * @param woken set to pdTRUE if queueing the message woke a higher priority task
+ */
+void NMEAParser_receive_nav_from_isr(const uint8_t *frame, uint32_t length, BaseType_t *woken) {
+    if (length > NMEASENTENCE_MAXLENGTH) {
+        stats.dropped++;
+        return;
+    }
+    // Sentences and binary messages never interleave, so no sentence is in rx_slot
+    memcpy(nmea_lines[rx_slot], frame, length);
+    nmea_line_t line = {rx_slot, (uint8_t)length, NMEA_LINE_NAV};
+    if (NMEA_queue != NULL && xQueueSendToBackFromISR(NMEA_queue, &line, woken) == pdPASS) {
+        rx_slot = (rx_slot + 1) % NMEA_LINE_SLOTS;
+    } else {
+        stats.dropped++;
+    }
+    rx_length = 0;
+    rx_overflow = false;
+}
+
+/**
+ * @brief decode a binary navigation data message
+ *
+ * Messages without a fix are counted but don't replace the last fix.
+ *
+ * @param frame complete binary message
+ * @param length bytes in frame
+ * @return true the message held a fix and was published
+ * @return false the message was invalid or had no fix
+ */
+bool NMEAParser_parse_nav(const uint8_t *frame, uint32_t length) {
+    skytraq_nav_t nav;
+    if (frame == NULL || !skytraq_decode_nav(frame, length, &nav)) {
+        stats.nav_errors++;
+        return false;
+    }
+    stats.nav_parsed++;
+    if (nav.fix_mode == SKYTRAQ_FIX_NONE) {
+        return false;
+    }
+    nav._logtime = xTaskGetTickCount();
+    working.nav = nav;
+    NMEAParser_publish();
+    return true;
+}
+
+/**
+ * @brief get the sentence a queued line refers to
+ *
+ * @param line item received from NMEA_queue
+ * @return char * start of the sentence, or NULL if the line is invalid
+ */
+char *NMEAParser_get_line(const nmea_line_t *line) {
+    if (line->slot >= NMEA_LINE_SLOTS || line->length > NMEASENTENCE_MAXLENGTH) {
+        return NULL;
+    }
+    return nmea_lines[line->slot];
+}
+
+/* Returns the term, or an empty string if the sentence is too short to have it */
+static const char *NMEAParser_term(char **terms, uint32_t count, uint32_t index) {
+    return index < count ? terms[index] : "";
+}
+
+static bool NMEAParser_decode_GGA(char **terms, uint32_t count, TickType_t logtime) {
+    GPGGA_s gga = GPGGA_invalid;
+    const char *quality = NMEAParser_term(terms, count, 5);
+    const char *term;
+
+    if (*quality <= '0') {
+        return false; // no fix
+    }
+    gga._logtime = logtime;
+    gga._fixquality = *quality - '0';
+    if (*(term = NMEAParser_term(terms, count, 0))) { // UTC Time
+        gga._time = NMEAParser_parse_decimal(term);
+    }
+    if (*(term = NMEAParser_term(terms, count, 1))) { // Latitude and indicator
+        NMEAParser_parse_degrees(term, &gga._latitude_upper, &gga._latitude_lower);
+        if (*NMEAParser_term(terms, count, 2) == 'S') {
+            gga._latitude_upper = -gga._latitude_upper;
+        }
+    }
+    if (*(term = NMEAParser_term(terms, count, 3))) { // Longitude and indicator
+        NMEAParser_parse_degrees(term, &gga._longitude_upper, &gga._longitude_lower);
+        if (*NMEAParser_term(terms, count, 4) == 'W') {
+            gga._longitude_upper = -gga._longitude_upper;
         }
-    } else
-        _sentence[_char_offset++] = c;
-    return new_data;
+    }
+    if (*(term = NMEAParser_term(terms, count, 6))) { // Number of Satellites (tracked/used for fix)
+        gga._numsats = (uint8_t)NMEAParser_parse_uint(term);
+    }
+    if (*(term = NMEAParser_term(terms, count, 7))) { // HDOP
+        gga._hdop = (uint16_t)NMEAParser_parse_decimal(term);
+    }
+    if (*(term = NMEAParser_term(terms, count, 8))) { // Altitude
+        gga._altitude = NMEAParser_parse_decimal(term);
+    }
+    working.gga = gga;
+    return true;
+}
+
+static bool NMEAParser_decode_GSA(char **terms, uint32_t count, TickType_t logtime) {
+    GPGSA_s gsa = GPGSA_invalid;
+    const char *fixtype = NMEAParser_term(terms, count, 1);
+    const char *term;
+
+    if (*fixtype <= '1') {
+        return false; // no fix
+    }
+    gsa._logtime = logtime;
+    gsa._fixtype = *fixtype - '0';
+    if (*(term = NMEAParser_term(terms, count, 14))) { // PDOP
+        gsa._pdop = (uint16_t)NMEAParser_parse_decimal(term);
+    }
+    if (*(term = NMEAParser_term(terms, count, 15))) { // HDOP
+        gsa._hdop = (uint16_t)NMEAParser_parse_decimal(term);
+    }
+    if (*(term = NMEAParser_term(terms, count, 16))) { // VDOP
+        gsa._vdop = (uint16_t)NMEAParser_parse_decimal(term);
+    }
+    working.gsa = gsa;
+    return true;
+}
+
+/*
+ * Satellites in view are spread over several GSV sentences. The SNR average is
+ * only updated once every sentence of a group has been received in order.
+ */
+static bool NMEAParser_decode_GSV(char **terms, uint32_t count, TickType_t logtime) {
+    GPGSV_s *gsv = &working.gsv;
+    uint8_t sentences = (uint8_t)NMEAParser_parse_uint(NMEAParser_term(terms, count, 0));
+    uint8_t sentence = (uint8_t)NMEAParser_parse_uint(NMEAParser_term(terms, count, 1));
+    uint32_t i;
+
+    if (sentence == 0 || sentence > sentences) {
+        return false;
+    }
+    if (sentence == 1) {
+        gsv->_new_snr_total = 0;
+        gsv->_snr_count = 0;
+    } else if (sentence != gsv->_gsv_sentence + 1 || sentences != gsv->_gsv_sentences) {
+        // Missed part of the group, wait for the start of the next one
+        gsv->_gsv_sentence = 0;
+        return false;
+    }
+    gsv->_gsv_sentences = sentences;
+    gsv->_gsv_sentence = sentence;
+    gsv->_numsats_visible = (uint8_t)NMEAParser_parse_uint(NMEAParser_term(terms, count, 2));
+    gsv->_logtime = logtime;
+
+    // Each satellite has 4 terms: PRN, elevation, azimuth, SNR. The SNR is empty when not tracking
+    for (i = 6; i < count; i += 4) {
+        if (terms[i][0] >= '0' && terms[i][0] <= '9') {
+            gsv->_snr_count++;
+            gsv->_new_snr_total += NMEAParser_parse_decimal(terms[i]);
+        }
+    }
+    if (sentence == sentences) {
+        if (gsv->_snr_count > 0) {
+            gsv->_snr_total = gsv->_new_snr_total;
+            gsv->_snr_avg = gsv->_snr_total / gsv->_snr_count;
+        } else {
+            gsv->_snr_total = GPS_INVALID_SNR;
+            gsv->_snr_avg = GPS_INVALID_SNR;
+        }
+    }
+    return true;
+}
+
+static bool NMEAParser_decode_RMC(char **terms, uint32_t count, TickType_t logtime) {
+    GPRMC_s rmc = GPRMC_invalid;
+    const char *term;
+
+    if (*NMEAParser_term(terms, count, 1) != 'A') {
+        return false; // data not valid
+    }
+    rmc._logtime = logtime;
+    if (*(term = NMEAParser_term(terms, count, 0))) { // UTC Time
+        rmc._time = NMEAParser_parse_decimal(term);
+    }
+    if (*(term = NMEAParser_term(terms, count, 2))) { // Latitude and indicator
+        NMEAParser_parse_degrees(term, &rmc._latitude_upper, &rmc._latitude_lower);
+        if (*NMEAParser_term(terms, count, 3) == 'S') {
+            rmc._latitude_upper = -rmc._latitude_upper;
+        }
+    }
+    if (*(term = NMEAParser_term(terms, count, 4))) { // Longitude and indicator
+        NMEAParser_parse_degrees(term, &rmc._longitude_upper, &rmc._longitude_lower);
+        if (*NMEAParser_term(terms, count, 5) == 'W') {
+            rmc._longitude_upper = -rmc._longitude_upper;
+        }
+    }
+    if (*(term = NMEAParser_term(terms, count, 6))) { // Speed
+        rmc._speed = NMEAParser_parse_decimal(term);
+    }
+    if (*(term = NMEAParser_term(terms, count, 7))) { // Course
+        rmc._course = NMEAParser_parse_decimal(term);
+    }
+    if (*(term = NMEAParser_term(terms, count, 8))) { // UTC Date
+        rmc._date = NMEAParser_parse_decimal(term) / 100;
+    }
+    working.rmc = rmc;
+    return true;
 }
 
 /**
- * @brief decodes sentence contained in glocal _sentence
+ * @brief sentence types that are decoded, matched against the sentence id after the talker id
  *
- * @return true sentence was valid
- * @return false sentence was invalid
+ * Add additional NMEA sentence types here
  */
-static bool NMEAParser_decode_sentence() {
-    TickType_t logtime = xTaskGetTickCount();
-
-    // determine sentence type
-    int sentence_type;
-    char title[7];
-    int i;
-    for (i = 0; i < 6; i++)
-        title[i] = _sentence[i];
-    title[6] = 0;
-    if (!NMEAParser_termcmp(title, _GPGGA_TERM))
-        sentence_type = NMEA_GGA;
-    else if (!NMEAParser_termcmp(title, _GPGSA_TERM))
-        sentence_type = NMEA_GSA;
-    else if (!NMEAParser_termcmp(title, _GPGSV_TERM))
-        sentence_type = NMEA_GSV;
-    else if (!NMEAParser_termcmp(title, _GPRMC_TERM))
-        sentence_type = NMEA_RMC;
-
-    // Add additional NMEA sentence type here
+static const struct {
+    char type[4];
+    bool (*decode)(char **terms, uint32_t count, TickType_t logtime);
+} NMEAParser_decoders[] = {
+    {"GGA", NMEAParser_decode_GGA},
+    {"GSA", NMEAParser_decode_GSA},
+    {"GSV", NMEAParser_decode_GSV},
+    {"RMC", NMEAParser_decode_RMC},
+};
+
+#define NMEA_DECODER_COUNT (sizeof(NMEAParser_decoders) / sizeof(NMEAParser_decoders[0]))
 
-    else
-        sentence_type = NMEA_UNKNOWN;
+/**
+ * @brief decode one complete sentence and publish the result
+ *
+ * The sentence is split into terms in place and its checksum is calculated in
+ * the same pass, so nothing is copied. Any talker id is accepted.
+ *
+ * @param sentence sentence starting with '$'. It is modified
+ * @param length length of the sentence, optionally including "\r\n"
+ * @return true sentence was valid and decoded
+ * @return false sentence was invalid, unsupported or reported no fix
+ */
+bool NMEAParser_parse_sentence(char *sentence, uint32_t length) {
+    char *terms[NMEASENTENCE_MAXTERMS + 1];
+    uint32_t count = 0;
+    uint8_t checksum = 0;
+    uint32_t i;
 
-    if (sentence_type == NMEA_UNKNOWN)
+    if (sentence == NULL) {
         return false;
+    }
+    while (length > 0 && (sentence[length - 1] == '\n' || sentence[length - 1] == '\r')) {
+        length--;
+    }
+    if (length < 4 || sentence[0] != '$') {
+        stats.malformed++;
+        return false;
+    }
 
-    char *p;
-    p = _sentence;
-
-    while (*p++ != ',')
-        ; // skip to next term
-
-    // verify validity of sentences (if possible)
-    bool data_valid = false;
-    switch (sentence_type) {
-        int i;
-    case NMEA_GGA:
-        for (i = 0; i < 5; i++) // skip over sentence until start of 5th term
-            while (*p++ != ',')
-                ;
-        data_valid = *p > '0';
-        break;
-    case NMEA_GSA:
-        for (i = 0; i < 1; i++)
-            while (*p++ != ',')
-                ;
-        data_valid = *p > '1';
-        break;
-    case NMEA_GSV:
-        data_valid = true;
-        break;
-    case NMEA_RMC:
-        for (i = 0; i < 1; i++)
-            while (*p++ != ',')
-                ;
-        data_valid = *p == 'A';
-        break;
-
-        // Add validity checking for additional NMEA sentences here
-    }
-    p = _sentence;
-
-    if (!data_valid)
+    terms[count++] = &sentence[1];
+    for (i = 1; i < length && sentence[i] != '*'; i++) {
+        checksum ^= (uint8_t)sentence[i];
+        if (sentence[i] == ',') {
+            if (count > NMEASENTENCE_MAXTERMS) {
+                stats.malformed++;
+                return false;
+            }
+            sentence[i] = '\0';
+            terms[count++] = &sentence[i + 1];
+        }
+    }
+    // Exactly two hex digits must follow the '*'
+    if (i + 3 != length) {
+        stats.malformed++;
+        return false;
+    }
+    sentence[i] = '\0';
+    int high = NMEAParser_hexToInt(sentence[i + 1]);
+    int low = NMEAParser_hexToInt(sentence[i + 2]);
+    if (high < 0 || low < 0) {
+        stats.malformed++;
+        return false;
+    }
+    if (((high << 4) | low) != checksum) {
+        stats.checksum_errors++;
         return false;
+    }
 
-    // reset whichever sentence struct we're decoding
-    switch (sentence_type) {
-    case NMEA_GGA:
-        NMEAParser_clear_GPGGA();
-        GPGGA._logtime = logtime;
-        break;
-    case NMEA_GSA:
-        NMEAParser_clear_GPGSA();
-        GPGSA._logtime = logtime;
-        break;
-    case NMEA_GSV:
-        NMEAParser_clear_GPGSV();
-        GPGSV._logtime = logtime;
-        break;
-    case NMEA_RMC:
-        NMEAParser_clear_GPRMC();
-        GPRMC._logtime = logtime;
-        break;
-    }
-
-    while (*p++ != ',')
-        ; // advance to first term after sentence id/title
-
-    // decode data
-    int term_number = 0;
+    // Sentence id is a 2 character talker id followed by the 3 character type
+    const char *id = terms[0];
     bool decoded = false;
-    while (!decoded) {
-        switch (sentence_type) {
-        case NMEA_GGA:
-            switch (term_number) {
-            case 0: // UTC Time
-                //_last_time_fix = logtime;
-                GPGGA._time = NMEAParser_parse_decimal(p);
-                break;
-            case 1: // Latitude
-                //_last_position_fix = logtime;
-                NMEAParser_parse_degrees(p, &(GPGGA._latitude_upper), &(GPGGA._latitude_lower));
-                break;
-            case 2: // Latitude Indicator
-                GPGGA._latitude_upper = *p == 'S' ? -GPGGA._latitude_upper : GPGGA._latitude_upper;
-                break;
-            case 3: // Longitude
-                NMEAParser_parse_degrees(p, &(GPGGA._longitude_upper), &(GPGGA._longitude_lower));
-                break;
-            case 4: // Longitude Indicator
-                GPGGA._longitude_upper = *p == 'W' ? -GPGGA._longitude_upper : GPGGA._longitude_upper;
-                break;
-            case 5: // Fix Quality
-                GPGGA._fixquality = *p - '0';
-                break;
-            case 6: // Number of Satellites (tracked/used for fix)
-                GPGGA._numsats = (*p - '0') * 10 + *(p + 1) - '0';
-                break;
-            case 7: // HDOP
-                GPGGA._hdop = (short)NMEAParser_parse_decimal(p);
-                break;
-            case 8: // Altitude
-                GPGGA._altitude = NMEAParser_parse_decimal(p);
-                break;
-            }
-            break;
-        case NMEA_GSA:
-            switch (term_number) {
-            case 1: // Fix Type
-                GPGSA._fixtype = *p - '0';
-                break;
-            case 14: // PDOP
-                GPGSA._pdop = (short)NMEAParser_parse_decimal(p);
-                break;
-            case 15: // HDOP
-                GPGSA._hdop = (short)NMEAParser_parse_decimal(p);
-                break;
-            case 16: // VDOP
-                GPGSA._vdop = (short)NMEAParser_parse_decimal(p);
+    if (strlen(id) == 5) {
+        for (i = 0; i < NMEA_DECODER_COUNT; i++) {
+            if (memcmp(&id[2], NMEAParser_decoders[i].type, 3) == 0) {
+                decoded = NMEAParser_decoders[i].decode(&terms[1], count - 1, xTaskGetTickCount());
                 break;
             }
-            break;
-        case NMEA_GSV:
-            switch (term_number) {
-            case 0: // GSV Sentence Count
-                GPGSV._gsv_sentences = *p - '0';
-                break;
-            case 1: // GSV Current Sentence Number
-                GPGSV._gsv_sentence = *p - '0';
-                break;
-            case 2: // Number of Satellites (in view)
-                GPGSV._numsats_visible = (*p - '0') * 10 + *(p + 1) - '0';
-                break;
-            case 6:  // SNR 1
-            case 10: // SNR 2
-            case 14: // SNR 3
-            case 18: // SNR 4
-                if (*p >= '0' && *p <= '9' && *(p + 1) >= '0' && *(p + 1) <= '9')
-                    GPGSV._snr_count++;
-                GPGSV._new_snr_total += NMEAParser_parse_decimal(p);
-                char *ptemp;
-                ptemp = p;
-                while (*ptemp != ',' && *ptemp != '*')
-                    ptemp++;
-                if ((GPGSV._gsv_sentence == GPGSV._gsv_sentences) &&
-                    (*ptemp == '*')) // check to see if multiline gsv message is complete
-                {
-                    GPGSV._snr_total = GPGSV._new_snr_total;
-                    GPGSV._snr_avg = GPGSV._snr_total / GPGSV._snr_count;
-                    GPGSV._new_snr_total = 0;
-                    GPGSV._snr_count = 0;
-                }
-                break;
-            }
-            break;
-        case NMEA_RMC:
-            switch (term_number) {
-            case 0: // UTC Time
-                //_last_time_fix = logtime;
-                GPRMC._time = NMEAParser_parse_decimal(p);
-                break;
-            case 2: // Latitude
-                //_last_position_fix = logtime;
-                NMEAParser_parse_degrees(p, &(GPRMC._latitude_upper), &(GPRMC._latitude_lower));
-                break;
-            case 3: // Latitude Indicator
-                GPRMC._latitude_upper = *p == 'S' ? -GPRMC._latitude_upper : GPRMC._latitude_upper;
-                break;
-            case 4: // Longitude
-                NMEAParser_parse_degrees(p, &(GPRMC._longitude_upper), &(GPRMC._longitude_lower));
-                break;
-            case 5: // Longitude Indicator
-                GPRMC._longitude_upper = *p == 'W' ? -GPRMC._longitude_upper : GPRMC._longitude_upper;
-                break;
-            case 6: // Speed
-                GPRMC._speed = NMEAParser_parse_decimal(p);
-                break;
-            case 7: // Course
-                GPRMC._course = NMEAParser_parse_decimal(p);
-                break;
-            case 8: // UTC Date
-                GPRMC._date = NMEAParser_parse_decimal(p) / 100;
-                break;
-            }
-            break;
-
-            // Add functionality for additional NMEA sentences here
         }
-        while (*p != ',' && *p != '*')
-            p++;
-        p++;
-        term_number++;
-        if (*(p - 1) == '*') {
-            decoded = true;
-        }
-        if (term_number > NMEASENTENCE_MAXTERMS)
-            return false;
     }
+    if (!decoded) {
+        stats.unsupported++;
+        return false;
+    }
+    NMEAParser_publish();
+    stats.parsed++;
     return true;
 }
 
-static int NMEAParser_termcmp(const char *str1, const char *str2) {
-    while (*str1 && (*str1 == *str2))
-        str1++, str2++;
-    return (*str1 > *str2) - (*str2 > *str1);
-}
-
 static int NMEAParser_hexToInt(char hex) {
     if (hex >= 'A' && hex <= 'F')
         return hex - 'A' + 10;
     else if (hex >= 'a' && hex <= 'f')
         return hex - 'a' + 10;
-    else
+    else if (hex >= '0' && hex <= '9')
         return hex - '0';
+    else
+        return -1;
+}
+
+static uint32_t NMEAParser_parse_uint(const char *p) {
+    uint32_t ret = 0;
+    while (*p >= '0' && *p <= '9')
+        ret = ret * 10 + *p++ - '0';
+    return ret;
 }
 
-static int32_t NMEAParser_parse_decimal(char *p) {
+static int32_t NMEAParser_parse_decimal(const char *p) {
     bool neg = *p == '-';
     if (neg)
         p++;
@@ -514,7 +652,7 @@ static int32_t NMEAParser_parse_decimal(char *p) {
     return neg ? -ret : ret;
 }
 
-static void NMEAParser_parse_degrees(char *p, int32_t *upper, int32_t *lower) {
+static void NMEAParser_parse_degrees(const char *p, int32_t *upper, int32_t *lower) {
     long deg = 0L;
     while ((*(p + 2) != '.') && (*p >= '0' && *p <= '9'))
         deg = deg * 10L + *p++ - '0';
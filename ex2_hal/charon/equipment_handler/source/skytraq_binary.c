@@ -3,6 +3,7 @@
 #include "HL_sci.h"
 #include "NMEAParser.h"
 #include "os_queue.h"
+#include "os_semphr.h"
 #include "skytraq_binary_types.h"
 #include "system.h"
 #include <string.h>
@@ -196,13 +197,21 @@ GPS_RETURNSTATE skytraq_send_message_with_reply(uint8_t *payload, uint16_t size,
 // TODO: should I really keep this?
 static inline void increment_buffer(int *buf) { *buf += 1; }
 
+static void reset_binary_buffer(void) {
+    // Only the bytes written need clearing, the rest of the buffer is still zero
+    memset(binary_message_buffer, 0, bin_buff_loc);
+    bin_buff_loc = 0;
+    current_line_type = none;
+}
+
 /**
  * @brief interrupt handler for receiving byte from skytraq
  *
- * Will send data to appropriate queue, be it binary queue for communication messages or NMEA task queue
+ * Will send data to appropriate queue, be it binary queue for communication messages or NMEA task queue.
+ * Binary messages are framed by their payload length since the payload may contain line endings.
  *
  */
-void get_byte() {
+void get_byte(BaseType_t *woken) {
     uint8_t in = byte;
 
     if (current_line_type == none) {
@@ -213,23 +222,46 @@ void get_byte() {
         case 0xA0:
             current_line_type = binary;
             break;
+        default:
+            return;
         };
     }
 
+    // NMEA sentences go straight into the parser's line buffers
+    if (current_line_type == nmea) {
+        NMEAParser_receive_from_isr((char)in, woken);
+        if (in == '\n') {
+            current_line_type = none;
+        }
+        return;
+    }
+
     binary_message_buffer[bin_buff_loc] = in;
     increment_buffer(&bin_buff_loc);
-    if (in == '\n') {
-        if (current_line_type == binary) {
-            if (binary_queue != NULL)
-                xQueueSendToBackFromISR(binary_queue, binary_message_buffer, pdFALSE);
-        } else if (current_line_type == nmea) {
-            if (NMEA_queue != NULL)
-                xQueueSendToBackFromISR(NMEA_queue, binary_message_buffer, pdFALSE);
-        }
-        bin_buff_loc = 0;
-        memset(binary_message_buffer, 0, BUFSIZE);
-        current_line_type = none;
+    if (bin_buff_loc == 2 && in != 0xA1) {
+        reset_binary_buffer(); // not a start sequence
+        return;
+    }
+    if (bin_buff_loc < header_size) {
+        return;
+    }
+
+    uint8_t *message = (uint8_t *)binary_message_buffer;
+    int message_size = ((message[2] << 8) | message[3]) + header_size + footer_size;
+    if (message_size > BUFSIZE) {
+        reset_binary_buffer(); // too long for any reply we expect
+        return;
+    }
+    if (bin_buff_loc < message_size) {
+        return;
     }
+
+    if (message[4] == NAVIGATION_DATA_MESSAGE) {
+        NMEAParser_receive_nav_from_isr(message, message_size, woken);
+    } else if (binary_queue != NULL) {
+        xQueueSendToBackFromISR(binary_queue, binary_message_buffer, woken);
+    }
+    reset_binary_buffer();
 }
 
 /**
@@ -243,7 +275,7 @@ void gps_sciNotification(sciBASE_t *sci, unsigned flags) {
 
     switch (flags) {
     case SCI_RX_INT:
-        get_byte();
+        get_byte(&xHigherPriorityTaskWoken);
         sciReceive(sci, 1, &byte);
         portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
         break;
@@ -380,6 +412,17 @@ GPS_RETURNSTATE configure_message_type(skytraq_message_type type, skytraq_update
     return skytraq_send_message(payload, length);
 }
 
+GPS_RETURNSTATE skytraq_configure_nav_message_interval(uint8_t interval, skytraq_update_attributes attribute) {
+    uint16_t length = 3;
+    uint8_t payload[3];
+
+    payload[0] = CONFIGURE_NAV_MESSAGE_INTERVAL;
+    payload[1] = interval;
+    payload[2] = attribute;
+
+    return skytraq_send_message(payload, length);
+}
+
 GPS_RETURNSTATE skytraq_configure_power_mode(skytraq_power_mode mode, skytraq_update_attributes attribute) {
     uint16_t length = 3;
     uint8_t payload[3];
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file skytraq_nav.c
+ * @date Oct. 19, 2026
+ *
+ * Decoder for the Skytraq binary navigation data message.
+ *
+ * Every field is a big endian integer at a fixed offset, already in the
+ * fixed point units the rest of the GPS driver uses, so decoding is a handful
+ * of loads instead of splitting and converting NMEA text.
+ */
+
+#include "skytraq_nav.h"
+#include "ex2_time.h"
+#include "skytraq_binary_types.h"
+
+/* Unix time at the start of GPS week 0, January 6 1980 */
+#define GPS_EPOCH_UNIX ((time_t)315964800UL)
+
+static uint16_t get_u16(const uint8_t *p) { return ((uint16_t)p[0] << 8) | p[1]; }
+
+static uint32_t get_u32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+/**
+ * @brief decode a navigation data message
+ *
+ * @param frame complete binary message, from the 0xA0 0xA1 start sequence to the 0x0D 0x0A end sequence
+ * @param length bytes in frame
+ * @param nav struct to store the decoded message. _logtime is not set
+ * @return true success
+ * @return false frame is not a valid navigation data message
+ */
+bool skytraq_decode_nav(const uint8_t *frame, uint32_t length, skytraq_nav_t *nav) {
+    if (length != SKYTRAQ_NAV_FRAME_LENGTH || frame[0] != 0xA0 || frame[1] != 0xA1 ||
+        get_u16(&frame[2]) != SKYTRAQ_NAV_PAYLOAD_LENGTH || frame[length - 2] != 0x0D ||
+        frame[length - 1] != 0x0A) {
+        return false;
+    }
+
+    const uint8_t *p = &frame[4];
+    uint8_t checksum = 0;
+    int i;
+    for (i = 0; i < SKYTRAQ_NAV_PAYLOAD_LENGTH; i++) {
+        checksum ^= p[i];
+    }
+    if (checksum != p[SKYTRAQ_NAV_PAYLOAD_LENGTH] || p[0] != NAVIGATION_DATA_MESSAGE) {
+        return false;
+    }
+
+    nav->fix_mode = p[1];
+    nav->numsats = p[2];
+    nav->week = get_u16(&p[3]);
+    nav->tow = get_u32(&p[5]);
+    nav->latitude = (int32_t)get_u32(&p[9]);
+    nav->longitude = (int32_t)get_u32(&p[13]);
+    nav->ellipsoid_altitude = (int32_t)get_u32(&p[17]);
+    nav->altitude = (int32_t)get_u32(&p[21]);
+    nav->gdop = get_u16(&p[25]);
+    nav->pdop = get_u16(&p[27]);
+    nav->hdop = get_u16(&p[29]);
+    nav->vdop = get_u16(&p[31]);
+    nav->tdop = get_u16(&p[33]);
+    nav->ecef_x = (int32_t)get_u32(&p[35]);
+    nav->ecef_y = (int32_t)get_u32(&p[39]);
+    nav->ecef_z = (int32_t)get_u32(&p[43]);
+    nav->ecef_vx = (int32_t)get_u32(&p[47]);
+    nav->ecef_vy = (int32_t)get_u32(&p[51]);
+    nav->ecef_vz = (int32_t)get_u32(&p[55]);
+    return true;
+}
+
+/**
+ * @brief convert the GPS time of a fix to UTC
+ *
+ * @param nav decoded navigation data message
+ * @param ms_since_fix milliseconds since the message was received, added to the time of the fix
+ * @return time_t UTC unix time
+ */
+time_t skytraq_nav_unix_time(const skytraq_nav_t *nav, uint32_t ms_since_fix) {
+    uint32_t seconds_of_week = (nav->tow * 10 + ms_since_fix) / 1000;
+    return GPS_EPOCH_UNIX + (time_t)nav->week * SECS_PER_WEEK + seconds_of_week - SKYTRAQ_GPS_LEAP_SECONDS;
+}
@@ -17,6 +17,9 @@
  * @date    2021-12-29
  */
 
+#ifndef HOUSEKEEPING_CHARON_H
+#define HOUSEKEEPING_CHARON_H
+
 #include <stdint.h>
 #include "skytraq_binary_types.h"
 #include "ads7128.h"
@@ -27,3 +30,5 @@ typedef struct __attribute__((packed)) {
 } charon_housekeeping;
 
 GPS_RETURNSTATE Charon_getHK(charon_housekeeping *hk);
+
+#endif /* HOUSEKEEPING_CHARON_H */
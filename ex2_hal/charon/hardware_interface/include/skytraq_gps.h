@@ -15,6 +15,11 @@
 #include <stdint.h>
 #include "ex2_time.h"
 
+typedef enum gps_output_mode {
+    GPS_OUTPUT_NMEA,   // NMEA text sentences
+    GPS_OUTPUT_BINARY, // binary navigation data messages
+} gps_output_mode;
+
 bool gps_get_altitude(uint32_t *alt);
 
 GPS_RETURNSTATE gps_configure_message_types(uint8_t GGA, uint8_t GSA, uint8_t GSV, uint8_t RMC);
@@ -25,6 +30,12 @@ GPS_RETURNSTATE gps_skytraq_get_software_version(uint32_t *version);
 
 GPS_RETURNSTATE gps_disable_NMEA_output(void);
 
+GPS_RETURNSTATE gps_configure_output_mode(gps_output_mode mode);
+
+gps_output_mode gps_get_output_mode(void);
+
+void gps_check_output_mode(void);
+
 bool gps_get_position(int32_t *latitude_upper, int32_t *latitude_lower, int32_t *longitude_upper,
                       int32_t *longitude_lower);
 
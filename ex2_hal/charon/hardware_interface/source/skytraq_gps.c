@@ -8,12 +8,24 @@
 #include <stdbool.h>
 #include <string.h>
 #include "ex2_time.h"
+#include "logger/logger.h"
 
 bool GGA_ENABLED = false;
 bool GSA_ENABLED = false;
 bool GSV_ENABLED = false;
 bool RMC_ENABLED = false;
 
+// One navigation data message per fix
+#define GPS_NAV_INTERVAL 1
+// NMEA output used when binary navigation data isn't available
+#define GPS_FALLBACK_RMC_INTERVAL 3
+// Fall back to NMEA if no navigation data message arrives for this long
+#define GPS_NAV_TIMEOUT_MS 30000
+
+static gps_output_mode output_mode = GPS_OUTPUT_NMEA;
+static uint32_t last_nav_count = 0;
+static TickType_t last_nav_tick = 0;
+
 struct gps_date {
     int day;
     int month;
@@ -47,8 +59,8 @@ time_t make_unix(struct gps_time *g_t, struct gps_date *g_d) {
 bool gps_skytraq_driver_init() {
     skytraq_binary_init();
 
-    GPS_RETURNSTATE gps_enable_all = gps_configure_message_types(0, 0, 0, 3);
-    if (gps_enable_all != GPS_SUCCESS) {
+    if (gps_configure_output_mode(GPS_OUTPUT_BINARY) != GPS_SUCCESS &&
+        gps_configure_output_mode(GPS_OUTPUT_NMEA) != GPS_SUCCESS) {
         return false;
     }
     vTaskDelay(200 * portTICK_PERIOD_MS);
@@ -87,6 +99,72 @@ GPS_RETURNSTATE gps_configure_message_types(uint8_t GGA, uint8_t GSA, uint8_t GS
     return skytraq_configure_nmea_output_rate(GGA, GSA, GSV, 0, RMC, 0, 0, UPDATE_TO_FLASH);
 }
 
+/**
+ * @brief Select binary navigation data or NMEA output from the skytraq
+ *
+ * Binary mode sends one fixed size navigation data message per fix, which is
+ * decoded without any string handling. NMEA mode outputs RMC sentences.
+ *
+ * @param mode output to select
+ * @return GPS_RETURNSTATE
+ */
+GPS_RETURNSTATE gps_configure_output_mode(gps_output_mode mode) {
+    GPS_RETURNSTATE result;
+    if (mode == GPS_OUTPUT_BINARY) {
+        result = configure_message_type(BINARY_MESSAGE, UPDATE_TO_SRAM);
+        if (result == GPS_SUCCESS) {
+            result = skytraq_configure_nav_message_interval(GPS_NAV_INTERVAL, UPDATE_TO_SRAM);
+        }
+    } else {
+        result = configure_message_type(NMEA_MESSAGE, UPDATE_TO_SRAM);
+        if (result == GPS_SUCCESS) {
+            result = gps_configure_message_types(0, 0, 0, GPS_FALLBACK_RMC_INTERVAL);
+        }
+    }
+    if (result == GPS_SUCCESS) {
+        if (mode == GPS_OUTPUT_BINARY) {
+            // NMEA sentences stop when binary output is selected
+            GGA_ENABLED = GSA_ENABLED = GSV_ENABLED = RMC_ENABLED = false;
+        }
+        output_mode = mode;
+        last_nav_tick = xTaskGetTickCount();
+    }
+    return result;
+}
+
+/**
+ * @brief Get the output currently selected on the skytraq
+ */
+gps_output_mode gps_get_output_mode(void) { return output_mode; }
+
+/**
+ * @brief Fall back to NMEA output if binary navigation data stopped arriving
+ *
+ * Called periodically by the NMEA daemon. Navigation data messages without a
+ * fix still count as arriving, so this only triggers if the receiver stopped
+ * sending them, for example after it reset to its NMEA default.
+ */
+void gps_check_output_mode(void) {
+    if (output_mode != GPS_OUTPUT_BINARY) {
+        return;
+    }
+    nmea_stats_t stats;
+    NMEAParser_get_stats(&stats);
+    TickType_t now = xTaskGetTickCount();
+    if (stats.nav_parsed != last_nav_count) {
+        last_nav_count = stats.nav_parsed;
+        last_nav_tick = now;
+        return;
+    }
+    if (now - last_nav_tick < pdMS_TO_TICKS(GPS_NAV_TIMEOUT_MS)) {
+        return;
+    }
+    sys_log(WARN, "No GPS navigation data for %d ms, falling back to NMEA", GPS_NAV_TIMEOUT_MS);
+    if (gps_configure_output_mode(GPS_OUTPUT_NMEA) != GPS_SUCCESS) {
+        last_nav_tick = now; // try again after another timeout
+    }
+}
+
 /**
  * @brief Disable all gps messages
  *
@@ -235,6 +313,13 @@ bool gps_get_utc_time(time_t *utc_time) {
 
     struct gps_time g_t;
     struct gps_date g_d;
+    skytraq_nav_t nav;
+
+    // binary navigation data already holds the time as integers
+    if (NMEAParser_get_nav(&nav)) {
+        *utc_time = skytraq_nav_unix_time(&nav, (xTaskGetTickCount() - nav._logtime) * portTICK_PERIOD_MS);
+        return true;
+    }
 
     // this will take GPRMC time
     bool RMC = RMC_ENABLED;
@@ -263,6 +348,11 @@ bool gps_get_utc_time(time_t *utc_time) {
 bool gps_get_altitude(uint32_t *alt) {
     bool GGA = GGA_ENABLED;
     GPGGA_s GGA_s;
+    skytraq_nav_t nav;
+    if (NMEAParser_get_nav(&nav) && nav.fix_mode >= SKYTRAQ_FIX_3D) {
+        *alt = nav.altitude;
+        return true;
+    }
     if (GGA) {
         bool GGA_valid = NMEAParser_get_GPGGA(&GGA_s);
         if (GGA_valid) {
@@ -273,6 +363,15 @@ bool gps_get_altitude(uint32_t *alt) {
     return false;
 }
 
+/* Split ten millionths of a degree into whole degrees, carrying the sign, and the fraction */
+static void split_degrees(int32_t angle, int32_t *upper, int32_t *lower) {
+    *upper = angle / 10000000;
+    *lower = angle % 10000000;
+    if (*lower < 0) {
+        *lower = -*lower;
+    }
+}
+
 /**
  * @brief Gets latest position update from GPS in ten millionths of a degree
  *
@@ -291,6 +390,13 @@ bool gps_get_position(int32_t *latitude_upper, int32_t *latitude_lower, int32_t
     bool RMC = RMC_ENABLED;
     GPGGA_s GGA_s;
     GPRMC_s RMC_s;
+    skytraq_nav_t nav;
+
+    if (NMEAParser_get_nav(&nav)) {
+        split_degrees(nav.latitude, latitude_upper, latitude_lower);
+        split_degrees(nav.longitude, longitude_upper, longitude_lower);
+        return true;
+    }
 
     if (RMC) {
         bool RMC_valid = NMEAParser_get_GPRMC(&RMC_s);
@@ -326,6 +432,11 @@ bool gps_get_position(int32_t *latitude_upper, int32_t *latitude_lower, int32_t
 bool gps_get_visible_satellite_count(uint8_t *numsats) {
     bool GGA = GGA_ENABLED;
     GPGGA_s GGA_s;
+    skytraq_nav_t nav;
+    if (NMEAParser_get_nav(&nav)) {
+        *numsats = nav.numsats;
+        return true;
+    }
     if (GGA) {
         bool GGA_valid = NMEAParser_get_GPGGA(&GGA_s);
         if (GGA_valid) {
@@ -18,6 +18,7 @@
  */
 
 #include "dfgm_handler.h"
+#include "calibration/calibration.h"
 
 #include "FreeRTOS.h"
 #include "HL_sci.h"
@@ -63,13 +64,6 @@ static int DFGM_runtime = 0;
 static int collecting_HK = 0;
 static int firstPacketFlag = 1;
 
-// Makes HK conversions & calculations easier via looping through each array
-const float HK_scales[] = {HK_SCALE_0, HK_SCALE_1, HK_SCALE_2, HK_SCALE_3, HK_SCALE_4,  HK_SCALE_5,
-                           HK_SCALE_6, HK_SCALE_7, HK_SCALE_8, HK_SCALE_9, HK_SCALE_10, HK_SCALE_11};
-
-const float HK_offsets[] = {HK_OFFSET_0, HK_OFFSET_1, HK_OFFSET_2, HK_OFFSET_3, HK_OFFSET_4,  HK_OFFSET_5,
-                            HK_OFFSET_6, HK_OFFSET_7, HK_OFFSET_8, HK_OFFSET_9, HK_OFFSET_10, HK_OFFSET_11};
-
 // Coefficients for 1 Hz filter
 double filter[81] = {
     0.014293879,    0.014285543,    0.014260564,    0.014219019,   0.014161035,   0.014086794,   0.013996516,
@@ -134,10 +128,9 @@ static void DFGM_convertRawMagData(dfgm_packet_t *const data) {
  * @return None
  */
 static void DFGM_convertRaw_HK_data(dfgm_packet_t *const data) {
-    for (int i = 0; i < 12; i++) {
-        float HK_value = ((float)(data->HK[i]) * HK_scales[i] + HK_offsets[i]);
-        data->HK[i] = (uint16_t)HK_value;
-    };
+    for (int i = 0; i < CALIBRATION_DFGM_HK_COUNT; i++) {
+        data->HK[i] = (uint16_t)calibration_convert(&cal_dfgm_hk[i], data->HK[i]);
+    }
 }
 
 /**
@@ -26,6 +26,10 @@
 
 #define SET_TELEMETRY_PERIOD 255
 #define EPS_REQUEST_TIMEOUT 1000
+// How often the EPS daemon refreshes telemetry
+#define EPS_REFRESH_PERIOD_MS 5000
+// Power channel and battery mode reads accept telemetry up to this old
+#define EPS_TELEMETRY_MAX_AGE pdMS_TO_TICKS(EPS_REFRESH_PERIOD_MS + EPS_REQUEST_TIMEOUT)
 #define EPS_INSTANTANEOUS_TELEMETRY 7
 #define EPS_POWER_CONTROL 14
 #define OFF 0
@@ -121,6 +125,10 @@ typedef enum eps_mode eps_mode_e;
 
 SAT_returnState eps_refresh_instantaneous_telemetry();
 SAT_returnState eps_refresh_startup_telemetry();
+SAT_returnState eps_refresh_if_older(TickType_t max_age);
+TickType_t eps_get_telemetry_age();
+void eps_set_refresh_period(uint32_t period_ms);
+SAT_returnState start_eps_daemon();
 eps_instantaneous_telemetry_t get_eps_instantaneous_telemetry();
 eps_startup_telemetry_t get_eps_startup_telemetry();
 void EPS_getHK(eps_instantaneous_telemetry_t *telembuf, eps_startup_telemetry_t *telem_startup_buf);
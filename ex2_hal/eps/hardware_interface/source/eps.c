@@ -33,51 +33,160 @@
 
 #include "eps.h"
 #include "services.h"
+#include "task_manager/task_manager.h"
+#include "telemetry/telemetry_store.h"
+
+#define EPS_STARTUP_REQUEST_TIMEOUT 10000
+#define EPS_DAEMON_STACK_SIZE 256
 
 void prv_instantaneous_telemetry_letoh(eps_instantaneous_telemetry_t *telembuf);
 void prv_startup_telemetry(eps_startup_telemetry_t *telem_startup_buf);
-static inline void prv_set_instantaneous_telemetry(eps_instantaneous_telemetry_t telembuf);
-static inline void prv_set_startup_telemetry(eps_startup_telemetry_t telem_startup_buf);
+static inline void prv_set_instantaneous_telemetry(const eps_instantaneous_telemetry_t *telembuf);
+static inline void prv_set_startup_telemetry(const eps_startup_telemetry_t *telem_startup_buf);
 static inline void prv_get_lock(eps_t *eps);
 static inline void prv_give_lock(eps_t *eps);
 static eps_t *prv_get_eps();
+static bool prv_telemetry_request(uint8_t cmd, void *reply, int reply_len, uint32_t timeout);
 
 struct eps_t {
     eps_instantaneous_telemetry_t hk_telemetery;
     eps_startup_telemetry_t hk_startup_telemetry;
     SemaphoreHandle_t eps_lock;
+    SemaphoreHandle_t request_lock; // serializes requests on telemetry_conn
+    csp_conn_t *telemetry_conn;     // kept open between requests, NULL until the first one
+    TickType_t telemetry_updated;   // tick count of the last instantaneous telemetry refresh
+    bool telemetry_valid;           // false until the first refresh and after a power channel change
+    bool startup_valid;             // hk_startup_telemetry is from the boot in hk_telemetery.bootCnt
 };
 
 static eps_t prvEps;
 
+static uint32_t refresh_period_ms = EPS_REFRESH_PERIOD_MS;
+static uint32_t wdt_counter = 0;
+
+static uint32_t prv_get_wdt_counter() { return wdt_counter; }
+
 /*------------------------------Public-------------------------------------*/
 
 SAT_returnState eps_refresh_instantaneous_telemetry() {
     uint8_t cmd = 0; // 'subservice' command
     eps_instantaneous_telemetry_t telembuf;
-    int res = csp_ping(EPS_APP_ID, EPS_REQUEST_TIMEOUT, 100, CSP_O_NONE);
 
-    if (csp_transaction_w_opts(CSP_PRIO_LOW, EPS_APP_ID, EPS_INSTANTANEOUS_TELEMETRY, EPS_REQUEST_TIMEOUT, &cmd,
-                               sizeof(cmd), &telembuf, sizeof(eps_instantaneous_telemetry_t), CSP_O_CRC32) <= 1)
+    if (!prv_telemetry_request(cmd, &telembuf, sizeof(eps_instantaneous_telemetry_t), EPS_REQUEST_TIMEOUT))
         return SATR_ERROR;
     // data is little endian, must convert to host order
     // refer to the NanoAvionics datasheet for details
     prv_instantaneous_telemetry_letoh(&telembuf);
-    prv_set_instantaneous_telemetry(telembuf);
+    prv_set_instantaneous_telemetry(&telembuf);
+    telemetry_write(TLM_EPS, &telembuf, sizeof(telembuf), true);
     return SATR_OK;
 }
 
+/**
+ * @brief
+ *      Fetch startup telemetry, unless the cached copy is from the current EPS boot
+ * @details
+ *      Startup telemetry only changes when the EPS reboots, which shows up as a
+ *      new bootCnt in the instantaneous telemetry
+ */
 SAT_returnState eps_refresh_startup_telemetry() {
     uint8_t cmd = 1; // ' subservice' command defined in ICD Section 24.2.2
     eps_startup_telemetry_t telem_startup_buf;
+    eps_t *eps = prv_get_eps();
 
-    if (csp_transaction_w_opts(CSP_PRIO_LOW, EPS_APP_ID, EPS_INSTANTANEOUS_TELEMETRY, 10000, &cmd, sizeof(cmd),
-                               &telem_startup_buf, sizeof(eps_startup_telemetry_t), CSP_O_CRC32) <= 1)
+    prv_get_lock(eps);
+    bool cached = eps->startup_valid;
+    prv_give_lock(eps);
+    if (cached)
+        return SATR_OK;
+
+    if (!prv_telemetry_request(cmd, &telem_startup_buf, sizeof(eps_startup_telemetry_t),
+                               EPS_STARTUP_REQUEST_TIMEOUT))
         return SATR_ERROR;
     // data is little endian, must convert to host order
     // refer to the NanoAvionics datasheet for details
     prv_startup_telemetry_letoh(&telem_startup_buf);
-    prv_set_startup_telemetry(telem_startup_buf);
+    prv_set_startup_telemetry(&telem_startup_buf);
+    telemetry_write(TLM_EPS_STARTUP, &telem_startup_buf, sizeof(telem_startup_buf), true);
+    return SATR_OK;
+}
+
+/**
+ * @brief
+ *      Refresh EPS telemetry only if the cached copy is at least max_age ticks old
+ * @details
+ *      The EPS daemon refreshes every EPS_REFRESH_PERIOD_MS, so callers asking
+ *      for anything older than that are answered without a CAN round trip
+ * @param max_age
+ *      Oldest telemetry the caller accepts
+ * @return
+ *      SATR_OK if the cached telemetry is now younger than max_age
+ */
+SAT_returnState eps_refresh_if_older(TickType_t max_age) {
+    if (eps_get_telemetry_age() < max_age)
+        return SATR_OK;
+    if (eps_refresh_instantaneous_telemetry() != SATR_OK)
+        return SATR_ERROR;
+    return eps_refresh_startup_telemetry();
+}
+
+/**
+ * @brief
+ *      Ticks since instantaneous telemetry was last refreshed
+ * @return
+ *      portMAX_DELAY if there is no telemetry, or it was invalidated by a power channel change
+ */
+TickType_t eps_get_telemetry_age() {
+    eps_t *eps = prv_get_eps();
+    TickType_t age = portMAX_DELAY;
+    prv_get_lock(eps);
+    if (eps->telemetry_valid) {
+        age = xTaskGetTickCount() - eps->telemetry_updated;
+    }
+    prv_give_lock(eps);
+    return age;
+}
+
+/**
+ * @brief
+ *      Change how often the EPS daemon refreshes telemetry
+ * @param period_ms
+ *      Refresh period, at least EPS_REQUEST_TIMEOUT
+ */
+void eps_set_refresh_period(uint32_t period_ms) {
+    if (period_ms < EPS_REQUEST_TIMEOUT) {
+        period_ms = EPS_REQUEST_TIMEOUT;
+    }
+    refresh_period_ms = period_ms;
+}
+
+/**
+ * @brief
+ *      Keeps the EPS telemetry cache and the telemetry store fresh, so
+ *      readers don't each have to ask the EPS
+ */
+static void eps_daemon(void *pvParameters) {
+    for (;;) {
+        wdt_counter++;
+        // Skipped if another task refreshed within the period
+        eps_refresh_if_older(pdMS_TO_TICKS(refresh_period_ms));
+        vTaskDelay(pdMS_TO_TICKS(refresh_period_ms));
+    }
+}
+
+SAT_returnState start_eps_daemon() {
+#if EPS_IS_STUBBED == 0
+    TaskHandle_t eps_handle;
+    taskFunctions eps_funcs = {0};
+    eps_funcs.getCounterFunction = prv_get_wdt_counter;
+
+    prv_get_eps();
+    if (xTaskCreate(eps_daemon, "eps_daemon", EPS_DAEMON_STACK_SIZE, NULL, EPS_TASK_PRIO, &eps_handle) !=
+        pdPASS) {
+        return SATR_ERROR;
+    }
+    ex2_register(eps_handle, eps_funcs);
+#endif
     return SATR_OK;
 }
 
@@ -191,14 +300,14 @@ void EPS_getHK(eps_instantaneous_telemetry_t *telembuf, eps_startup_telemetry_t
 }
 
 eps_mode_e get_eps_batt_mode() {
-    eps_refresh_instantaneous_telemetry();
+    eps_refresh_if_older(EPS_TELEMETRY_MAX_AGE);
     eps_instantaneous_telemetry_t eps = get_eps_instantaneous_telemetry();
     return (eps_mode_e)eps.battMode;
 }
 
 /* Gets the status of the power channel */
 uint8_t eps_get_pwr_chnl(uint8_t pwr_chnl_port) {
-    eps_refresh_instantaneous_telemetry();
+    eps_refresh_if_older(EPS_TELEMETRY_MAX_AGE);
     eps_instantaneous_telemetry_t eps = get_eps_instantaneous_telemetry();
     uint32_t outputStatus = eps.outputStatus; // a codeword that has the status of all channels
     uint8_t pwr_chnl_status = (uint8_t)(outputStatus >> (pwr_chnl_port - 1)) & 1; // chnl_port : 1-18
@@ -215,6 +324,12 @@ int8_t eps_set_pwr_chnl(uint8_t pwr_chnl_port, bool status) {
     // delay = 0 so cmd{4] = cmd[5] = 0
     csp_transaction_w_opts(CSP_PRIO_LOW, EPS_APP_ID, EPS_POWER_CONTROL, EPS_REQUEST_TIMEOUT, &cmd, sizeof(cmd),
                            &response, sizeof(response), CSP_O_CRC32);
+
+    // The cached output status is out of date, make the next reader ask the EPS
+    eps_t *eps = prv_get_eps();
+    prv_get_lock(eps);
+    eps->telemetry_valid = false;
+    prv_give_lock(eps);
     return response[1];
 }
 
@@ -244,10 +359,45 @@ static eps_t *prv_get_eps() {
     if (!prvEps.eps_lock) {
         prvEps.eps_lock = xSemaphoreCreateMutex();
     }
+    if (!prvEps.request_lock) {
+        prvEps.request_lock = xSemaphoreCreateMutex();
+    }
     configASSERT(prvEps.eps_lock);
+    configASSERT(prvEps.request_lock);
     return &prvEps;
 }
 
+/**
+ * @brief
+ *      Send a telemetry request on the persistent connection and wait for the reply
+ * @details
+ *      The connection is closed after any failure, otherwise a reply that
+ *      arrived late would be read as the answer to the next request
+ * @return
+ *      true if a reply of reply_len bytes was received
+ */
+static bool prv_telemetry_request(uint8_t cmd, void *reply, int reply_len, uint32_t timeout) {
+    eps_t *eps = prv_get_eps();
+    bool success = false;
+
+    xSemaphoreTake(eps->request_lock, portMAX_DELAY);
+    if (eps->telemetry_conn == NULL) {
+        eps->telemetry_conn =
+            csp_connect(CSP_PRIO_LOW, EPS_APP_ID, EPS_INSTANTANEOUS_TELEMETRY, timeout, CSP_O_CRC32);
+    }
+    if (eps->telemetry_conn != NULL) {
+        int received =
+            csp_transaction_persistent(eps->telemetry_conn, timeout, &cmd, sizeof(cmd), reply, reply_len);
+        success = received > 1;
+        if (!success) {
+            csp_close(eps->telemetry_conn);
+            eps->telemetry_conn = NULL;
+        }
+    }
+    xSemaphoreGive(eps->request_lock);
+    return success;
+}
+
 static inline void prv_get_lock(eps_t *eps) {
     configASSERT(eps->eps_lock);
     xSemaphoreTake(eps->eps_lock, portMAX_DELAY);
@@ -258,10 +408,15 @@ static inline void prv_give_lock(eps_t *eps) {
     xSemaphoreGive(eps->eps_lock);
 }
 
-static inline void prv_set_instantaneous_telemetry(eps_instantaneous_telemetry_t telembuf) {
+static inline void prv_set_instantaneous_telemetry(const eps_instantaneous_telemetry_t *telembuf) {
     eps_t *eps = prv_get_eps();
     prv_get_lock(eps);
-    eps->hk_telemetery = telembuf;
+    eps->hk_telemetery = *telembuf;
+    eps->telemetry_updated = xTaskGetTickCount();
+    eps->telemetry_valid = true;
+    if (eps->hk_startup_telemetry.bootCnt != telembuf->bootCnt) {
+        eps->startup_valid = false; // the EPS rebooted
+    }
     prv_give_lock(eps);
     return;
 }
@@ -300,10 +455,11 @@ void prv_instantaneous_telemetry_letoh(eps_instantaneous_telemetry_t *telembuf)
     telembuf->timestampInS = csp_letohd(telembuf->timestampInS);
 }
 
-static inline void prv_set_startup_telemetry(eps_startup_telemetry_t telem_startup_buf) {
+static inline void prv_set_startup_telemetry(const eps_startup_telemetry_t *telem_startup_buf) {
     eps_t *eps = prv_get_eps();
     prv_get_lock(eps);
-    eps->hk_startup_telemetry = telem_startup_buf;
+    eps->hk_startup_telemetry = *telem_startup_buf;
+    eps->startup_valid = true;
     prv_give_lock(eps);
     return;
 }
@@ -62,6 +62,7 @@
 #define AD7291_T_ALERT_STATUS 0x20
 
 #define AD7291_VOLTAGE_LIMIT_COUNT 8
+#define AD7291_CHANNEL_COUNT 8
 
 // AD7291 TSENSE Average setting
 #define AD7291_TSENSE_AVG true
@@ -100,6 +101,10 @@ int adc_set_register_pointer(uint8_t slave_addr, uint8_t reg_sel);
 // return the raw value from the adc
 int adc_get_raw(uint8_t slave_addr, unsigned short *data, unsigned char *ch);
 
+// read every channel in channel_mask in one transfer
+int adc_read_burst(uint8_t slave_addr, uint8_t channel_mask, unsigned short raw[AD7291_CHANNEL_COUNT],
+                   uint8_t *read_mask);
+
 // calculate the vin voltage value
 float adc_calculate_vin(unsigned short value, float vref);
 
@@ -111,6 +116,8 @@ float adc_calculate_sensor_pd(unsigned short value, float vref);
 
 // convert internal temp sensor value
 float adc_get_tsense_temp(uint8_t slave_addr, float vref);
+int adc_get_tsense_raw(uint8_t slave_addr, unsigned short *data);
+float adc_convert_tsense(unsigned short value);
 // convert all channels raw
 void adc_get_all_raw(void);
 
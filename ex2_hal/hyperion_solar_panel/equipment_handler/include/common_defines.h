@@ -36,6 +36,7 @@
 #define ADC_CHANNEL_5 1 << 2
 #define ADC_CHANNEL_6 1 << 1
 #define ADC_CHANNEL_7 1 << 0
+#define ADC_CHANNEL(n) (0x80U >> (n)) // command register bit of channel n
 
 // Temperature Sensor (LMT70) constants
 #define TEMP_VOLT_MAX 1.375f // V
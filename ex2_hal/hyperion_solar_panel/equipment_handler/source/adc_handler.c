@@ -20,10 +20,19 @@
 #include <FreeRTOS.h>
 #include <os_task.h>
 #include "adc_handler.h"
+#include "calibration/calibration.h"
 #include "i2c_io.h"
 #include <stdint.h>
 #include "system.h"
 
+// Devices that adc_read_burst() has put in autocycle mode, and with which channels
+#define AD7291_MAX_DEVICES 8
+
+static struct {
+    uint8_t slave_addr; // 0 if the entry is unused
+    uint8_t channel_mask;
+} autocycle_devices[AD7291_MAX_DEVICES];
+
 /**
  * @brief
  * 		Initialize ADC_Handler
@@ -144,6 +153,109 @@ int adc_get_raw(uint8_t slave_addr, unsigned short *data, unsigned char *ch) {
     return ret;
 }
 
+static int autocycle_find(uint8_t slave_addr) {
+    int i;
+    for (i = 0; i < AD7291_MAX_DEVICES; i++) {
+        if (autocycle_devices[i].slave_addr == slave_addr) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief
+ * 		Enable all channels in channel_mask with autocycle, unless the ADC is already set up that way
+ * @return
+ * 		0: success
+ *      -1: fail
+ */
+static int adc_autocycle_init(uint8_t slave_addr, uint8_t channel_mask) {
+    int i = autocycle_find(slave_addr);
+    if (i >= 0 && autocycle_devices[i].channel_mask == channel_mask) {
+        return 0;
+    }
+    int ret = adc_set_command_reg(slave_addr, channel_mask, AD7291_EXT_REF_SET, AD7291_TSENSE_SET,
+                                  AD7291_NOISE_DELAY_SET, AD7291_RESET_SET, 1);
+    if (ret != 0) {
+        return -1;
+    }
+    if (i < 0) {
+        i = autocycle_find(0);
+    }
+    if (i >= 0) {
+        autocycle_devices[i].slave_addr = slave_addr;
+        autocycle_devices[i].channel_mask = channel_mask;
+    }
+    return 0;
+}
+
+static void adc_autocycle_forget(uint8_t slave_addr) {
+    int i = autocycle_find(slave_addr);
+    if (i >= 0) {
+        autocycle_devices[i].slave_addr = 0;
+    }
+}
+
+/**
+ * @brief
+ * 		Read the conversion results of several channels in one I2C transfer
+ * @details
+ * 		The first call for a device enables every channel in channel_mask in
+ *      autocycle mode, so the AD7291 keeps converting them in sequence. Each
+ *      read of the conversion result register then returns the next channel,
+ *      tagged with its channel number, so all of them come back in a single
+ *      burst. One extra result is read since the first one may be stale.
+ *      The device is set up again after any failure, for example if the panel
+ *      was power cycled.
+ * @param channel_mask
+ * 		Channels to read, see ADC_CHANNEL()
+ * @param raw
+ * 		Raw value of each channel, indexed by channel number
+ * @param read_mask
+ * 		Set to the channels that were read
+ * @return
+ * 		0: every channel in channel_mask was read
+ *      -1: fail
+ */
+int adc_read_burst(uint8_t slave_addr, uint8_t channel_mask, unsigned short raw[AD7291_CHANNEL_COUNT],
+                   uint8_t *read_mask) {
+    uint8_t buffer[2 * (AD7291_CHANNEL_COUNT + 1)];
+    int count = 0;
+    int i;
+
+    *read_mask = 0;
+    for (i = 0; i < AD7291_CHANNEL_COUNT; i++) {
+        if (channel_mask & ADC_CHANNEL(i)) {
+            count++;
+        }
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    if (adc_autocycle_init(slave_addr, channel_mask) != 0 ||
+        adc_set_register_pointer(slave_addr, AD7291_VOLTAGE) != 0 ||
+        adc_read(buffer, 2 * (count + 1), slave_addr) != 0) {
+        adc_autocycle_forget(slave_addr);
+        return -1;
+    }
+
+    for (i = 0; i <= count; i++) {
+        unsigned short value = (buffer[2 * i] << 8) | buffer[2 * i + 1];
+        unsigned char ch = value >> 12;
+        if (ch < AD7291_CHANNEL_COUNT && (channel_mask & ADC_CHANNEL(ch))) {
+            raw[ch] = value & 0x0FFF;
+            *read_mask |= ADC_CHANNEL(ch);
+        }
+    }
+    if (*read_mask != channel_mask) {
+        adc_autocycle_forget(slave_addr);
+        return -1;
+    }
+    return 0;
+}
+
 /**
  * @brief
  * 		Converts the given raw ADC value to voltage (mV), relative to reference voltage.
@@ -178,44 +290,9 @@ float adc_calculate_vin(unsigned short value, float vref) {
  * 		Value in celsius.
  */
 float adc_calculate_sensor_temp(unsigned short value, float vref) {
-    float celsius = 0;
-    int i = 0;
-
-    // change into mv
-    float temp_voltage = adc_calculate_vin(value, vref);
-
-    // Conversion parameters from temperature sensor datasheet
-    // https://www.ti.com/lit/ds/symlink/lmt70.pdf?HQS=dis-dk-null-digikeymode-dsf-pf-null-wwe&ts=1622648303670
-    // float voltage_vect[22] = {1375.219,
-    // 1350.441,1300.593,1250.398,1199.884,1149.070,1097.987,1046.647,995.050,943.227,891.178,838.882,786.36,733.608,680.654,627.49,574.117,520.551,466.76,412.739,358.164,302.785};
-    // float slope[22] =
-    // {4.958,4.976,5.002,5.036,5.066,5.108,5.121,5.134,5.171,5.194,5.217,5.241,5.264,5.285,5.306,5.327,5.347,5.368,5.391,5.43,5.498,5.538};
-    // float temps[22] = {-55,-50,-40,-30,-20,-10,0,10,20,30,40,50,60,70,80,90,100,110,120,130,140,150};
-
-    float voltage_vect[39] = {100,  150,    200,  250,    300,    350,    400,    450,    500,   550,
-                              600,  650,    700,  750,    800,    850,    900,    950,    1000,  1050,
-                              1100, 1150,   1200, 1250,   1300,   1350,   1400,   1450,   1500,  1550.5,
-                              1601, 1651.5, 1702, 1752.5, 1805.5, 1858.5, 1911.5, 1964.5, 2017.5};
-    float temps[39] = {-40, -35, -30, -35, -20, -15, -10, -5,  0,   5,   10,  15,  20,
-                       25,  30,  35,  40,  45,  50,  55,  60,  65,  70,  75,  80,  85,
-                       90,  95,  100, 105, 110, 115, 120, 125, 130, 135, 140, 145, 150};
-
-    // interpolates between the previously defined voltage to temperature conversions.
-
-    if (temp_voltage >= voltage_vect[38]) { // If above the highest piecewise voltage
-        celsius = temps[38] + (temp_voltage - voltage_vect[38]) / 10;
-    } else if (temp_voltage <= voltage_vect[0]) { // If beneath the lowest piecewise voltage
-        celsius = temps[0] + (temp_voltage - voltage_vect[0]) / 10;
-    } else {
-        for (i = 1; i < 37; i++) {
-            if ((temp_voltage <= voltage_vect[i + 1]) && (temp_voltage > voltage_vect[i])) {
-                celsius = temps[i] + (temp_voltage - voltage_vect[i]) / 10;
-                break;
-            }
-        }
-    }
-
-    return celsius;
+    // The LMT70 table is indexed by counts at the nominal reference
+    unsigned short counts = (unsigned short)((float)value * vref / ADC_VREF);
+    return (float)calibration_convert(&cal_lmt70_centi_c, counts) / 100;
 }
 
 /**
@@ -298,30 +375,40 @@ float adc_calculate_sensor_pd(unsigned short value, float vref) {
  * 		Temperature value in celsius
  */
 float adc_get_tsense_temp(uint8_t slave_addr, float vref) {
-    uint8_t reg_sel;
     unsigned short data = 0;
+    adc_get_tsense_raw(slave_addr, &data);
+    return adc_convert_tsense(data);
+}
+
+/**
+ * @brief
+ * 		Read the raw internal temperature sensor value, for conversion with adc_convert_tsense()
+ * @return
+ * 		0: success
+ *      -1: fail
+ */
+int adc_get_tsense_raw(uint8_t slave_addr, unsigned short *data) {
+    uint8_t reg_sel;
     unsigned char ch = 0;
-    // printf("\n ADC TEMP RESULTS: \r\n Channel    Result \r\n");
-    // loops through and requests conversion results from all channels
     if (AD7291_TSENSE_AVG == true) {
         reg_sel = AD7291_T_AVERAGE;
     } else {
         reg_sel = AD7291_T_SENSE;
     }
 
-    adc_set_register_pointer(slave_addr, reg_sel);
+    if (adc_set_register_pointer(slave_addr, reg_sel) != 0) {
+        return -1;
+    }
     vTaskDelay(AD7291_INIT_DELAY_TICKS);
-    adc_get_raw(slave_addr, &data, &ch);
-    float temp_celsius = AD7291_BAD_TEMP;
-    unsigned short value = data;
-    temp_celsius =
-        (float)(value >> 11) * (float)(-512) + (float)((value - ((value >> 11) << 11)) >> 10) * (float)(256) +
-        (float)((value - ((value >> 10) << 10)) >> 9) * (128) +
-        (float)((value - ((value >> 9) << 9)) >> 8) * (64) + (float)((value - ((value >> 8) << 8)) >> 7) * (32) +
-        (float)((value - ((value >> 7) << 7)) >> 6) * (16) + (float)((value - ((value >> 6) << 6)) >> 5) * (8) +
-        (float)((value - ((value >> 5) << 5)) >> 4) * (4) + (float)((value - ((value >> 4) << 4)) >> 3) * (2) +
-        (float)((value - ((value >> 3) << 3)) >> 2) * (1) + (float)((value - ((value >> 2) << 2)) >> 1) * (0.5) +
-        (float)((value - ((value >> 1) << 1)) >> 0) * (0.25);
-    // printf("%d          %.2f \r\n", ch, temp_celsius);
-    return temp_celsius;
+    return adc_get_raw(slave_addr, data, &ch);
+}
+
+/**
+ * @brief
+ * 		Convert a raw internal temperature sensor value to celsius
+ * @details
+ * 		The value is a 12 bit two's complement number of quarter degrees
+ */
+float adc_convert_tsense(unsigned short value) {
+    return (float)calibration_convert(&cal_ad7291_tsense_centi_c, value) / 100;
 }
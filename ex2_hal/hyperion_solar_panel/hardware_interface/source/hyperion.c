@@ -17,6 +17,7 @@
  * @date    2021-06-04
  */
 #include "hyperion.h"
+#include "calibration/calibration.h"
 #include "os_portmacro.h"
 #include "os_projdefs.h"
 
@@ -310,222 +311,190 @@ void hyperion_config_3_value(config_3_panel_t panel, config_3_channel_type_t cha
     }
 }
 
-void Hyperion_config1_getHK(Hyperion_HouseKeeping *hyperion_hk) {
-    // NADIR TEMP 1
-    hyperion_config_2_value(CONFIG_2_PANEL_NADIR, CONFIG_2_CHANNEL_PD_1, &hyperion_hk->Nadir_Temp1);
-
-    // NADIR Temp Adc
-    hyperion_hk->Nadir_Temp_Adc = adc_get_tsense_temp(PANEL_SLAVE_ADDR_NADIR, ADC_VREF);
-
-    // Port TEMP 1 2 3
-    hyperion_config_1_value(CONFIG_1_PANEL_P, CONFIG_1_CHANNEL_TEMP_1, &hyperion_hk->Port_Temp1);
-    hyperion_config_1_value(CONFIG_1_PANEL_P, CONFIG_1_CHANNEL_TEMP_2, &hyperion_hk->Port_Temp2);
-    hyperion_config_1_value(CONFIG_1_PANEL_P, CONFIG_1_CHANNEL_TEMP_3, &hyperion_hk->Port_Temp3);
-
-    // Port Temp Adc
-    hyperion_hk->Port_Temp_Adc = adc_get_tsense_temp(PANEL_SLAVE_ADDR_PORT, ADC_VREF);
-
-    // Port Dep Temp 1 2 3
-    hyperion_config_1_value(CONFIG_1_PANEL_PD, CONFIG_1_CHANNEL_TEMP_1, &hyperion_hk->Port_Dep_Temp1);
-    hyperion_config_1_value(CONFIG_1_PANEL_PD, CONFIG_1_CHANNEL_TEMP_2, &hyperion_hk->Port_Dep_Temp2);
-    hyperion_config_1_value(CONFIG_1_PANEL_PD, CONFIG_1_CHANNEL_TEMP_3, &hyperion_hk->Port_Dep_Temp3);
-
-    // Port Dep Temp Adc
-    hyperion_hk->Port_Dep_Temp_Adc = adc_get_tsense_temp(PANEL_SLAVE_ADDR_PORT_DEPLOYABLE, ADC_VREF);
-
-    // Star Temp 1 2 3
-    hyperion_config_1_value(CONFIG_1_PANEL_S, CONFIG_1_CHANNEL_TEMP_1, &hyperion_hk->Star_Temp1);
-    hyperion_config_1_value(CONFIG_1_PANEL_S, CONFIG_1_CHANNEL_TEMP_2, &hyperion_hk->Star_Temp2);
-    hyperion_config_1_value(CONFIG_1_PANEL_S, CONFIG_1_CHANNEL_TEMP_3, &hyperion_hk->Star_Temp3);
-
-    // Star Temp Adc
-    hyperion_hk->Star_Temp_Adc = adc_get_tsense_temp(PANEL_SLAVE_ADDR_STARBOARD, ADC_VREF);
-
-    // Star Dep Temp 1 2 3
-    hyperion_config_1_value(CONFIG_1_PANEL_SD, CONFIG_1_CHANNEL_TEMP_1, &hyperion_hk->Star_Dep_Temp1);
-    hyperion_config_1_value(CONFIG_1_PANEL_SD, CONFIG_1_CHANNEL_TEMP_2, &hyperion_hk->Star_Dep_Temp2);
-    hyperion_config_1_value(CONFIG_1_PANEL_SD, CONFIG_1_CHANNEL_TEMP_3, &hyperion_hk->Star_Dep_Temp3);
-
-    // Star Dep Adc
-    hyperion_hk->Star_Dep_Temp_Adc = adc_get_tsense_temp(PANEL_SLAVE_ADDR_STARBOARD_DEPLOYABLE, ADC_VREF);
-
-    // Zenith Temp 1 2 3
-    hyperion_config_1_value(CONFIG_1_PANEL_Z, CONFIG_1_CHANNEL_TEMP_1, &hyperion_hk->Zenith_Temp1);
-    hyperion_config_1_value(CONFIG_1_PANEL_Z, CONFIG_1_CHANNEL_TEMP_2, &hyperion_hk->Zenith_Temp2);
-    hyperion_config_1_value(CONFIG_1_PANEL_Z, CONFIG_1_CHANNEL_TEMP_3, &hyperion_hk->Zenith_Temp3);
-
-    // Zenith Temp Adc
-    hyperion_hk->Zenith_Temp_Adc = adc_get_tsense_temp(PANEL_SLAVE_ADDR_ZENITH, ADC_VREF);
-
-    // Nadir Pd 1
-    hyperion_config_2_value(CONFIG_2_PANEL_NADIR, CONFIG_2_CHANNEL_PD_1, &hyperion_hk->Nadir_Pd1);
-
-    // Port Pd 1 2 3
-    hyperion_config_1_value(CONFIG_1_PANEL_P, CONFIG_1_CHANNEL_PD_1, &hyperion_hk->Port_Pd1);
-    hyperion_config_1_value(CONFIG_1_PANEL_P, CONFIG_1_CHANNEL_PD_2, &hyperion_hk->Port_Pd2);
-    hyperion_config_1_value(CONFIG_1_PANEL_P, CONFIG_1_CHANNEL_PD_3, &hyperion_hk->Port_Pd3);
-
-    // Port Dep Pd 1 2 3
-    hyperion_config_1_value(CONFIG_1_PANEL_PD, CONFIG_1_CHANNEL_PD_1, &hyperion_hk->Port_Dep_Pd1);
-    hyperion_config_1_value(CONFIG_1_PANEL_PD, CONFIG_1_CHANNEL_PD_2, &hyperion_hk->Port_Dep_Pd2);
-    hyperion_config_1_value(CONFIG_1_PANEL_PD, CONFIG_1_CHANNEL_PD_3, &hyperion_hk->Port_Dep_Pd3);
-
-    // Star Pd 1 2 3
-    hyperion_config_1_value(CONFIG_1_PANEL_S, CONFIG_1_CHANNEL_PD_1, &hyperion_hk->Star_Pd1);
-    hyperion_config_1_value(CONFIG_1_PANEL_S, CONFIG_1_CHANNEL_PD_2, &hyperion_hk->Star_Pd2);
-    hyperion_config_1_value(CONFIG_1_PANEL_S, CONFIG_1_CHANNEL_PD_3, &hyperion_hk->Star_Pd3);
-
-    // Star Dep Pd 1 2 3
-    hyperion_config_1_value(CONFIG_1_PANEL_SD, CONFIG_1_CHANNEL_PD_1, &hyperion_hk->Star_Dep_Pd1);
-    hyperion_config_1_value(CONFIG_1_PANEL_SD, CONFIG_1_CHANNEL_PD_2, &hyperion_hk->Star_Dep_Pd2);
-    hyperion_config_1_value(CONFIG_1_PANEL_SD, CONFIG_1_CHANNEL_PD_3, &hyperion_hk->Star_Dep_Pd3);
-
-    // Zenith Pd 1 2 3
-    hyperion_config_1_value(CONFIG_1_PANEL_Z, CONFIG_1_CHANNEL_PD_1, &hyperion_hk->Zenith_Pd1);
-    hyperion_config_1_value(CONFIG_1_PANEL_Z, CONFIG_1_CHANNEL_PD_2, &hyperion_hk->Zenith_Pd2);
-    hyperion_config_1_value(CONFIG_1_PANEL_Z, CONFIG_1_CHANNEL_PD_3, &hyperion_hk->Zenith_Pd3);
-
-    // Port Voltage
-    hyperion_config_1_value(CONFIG_1_PANEL_P, CONFIG_1_CHANNEL_VOLT, &hyperion_hk->Port_Voltage);
-
-    // Port Dep Voltage
-    hyperion_config_1_value(CONFIG_1_PANEL_PD, CONFIG_1_CHANNEL_VOLT, &hyperion_hk->Port_Dep_Voltage);
-
-    // Star Voltage
-    hyperion_config_1_value(CONFIG_1_PANEL_S, CONFIG_1_CHANNEL_VOLT, &hyperion_hk->Star_Voltage);
+/*
+ * Housekeeping reads every channel of a panel's AD7291 in one burst, see
+ * adc_read_burst(), then converts the raw values once all panels are sampled.
+ * The layouts give the ADC channel wired to each sensor.
+ */
+#define HYPERION_NO_CHANNEL 0xFF
+
+typedef struct {
+    uint8_t temp[3];
+    uint8_t pd[3];
+    uint8_t voltage;
+    uint8_t current;
+} hyperion_panel_layout;
+
+static const hyperion_panel_layout layout_3u = {{0, 1, 2}, {3, 4, 5}, 6, 7};
+static const hyperion_panel_layout layout_2u = {
+    {0, 1, HYPERION_NO_CHANNEL}, {2, 3, HYPERION_NO_CHANNEL}, 4, 5};
+static const hyperion_panel_layout layout_nadir = {{0, HYPERION_NO_CHANNEL, HYPERION_NO_CHANNEL},
+                                                   {1, HYPERION_NO_CHANNEL, HYPERION_NO_CHANNEL},
+                                                   HYPERION_NO_CHANNEL,
+                                                   HYPERION_NO_CHANNEL};
+
+typedef struct {
+    uint8_t read_mask; // channels read successfully
+    unsigned short raw[AD7291_CHANNEL_COUNT];
+    bool tsense_valid;
+    unsigned short tsense;
+} hyperion_panel_sample;
+
+typedef struct {
+    int8_t temp[3];
+    int8_t temp_adc;
+    uint8_t pd[3];
+    uint16_t voltage;
+    uint16_t current;
+} hyperion_panel_hk;
+
+static uint8_t layout_mask(const hyperion_panel_layout *layout) {
+    const uint8_t *channels = (const uint8_t *)layout;
+    uint8_t mask = 0;
+    int i;
+    for (i = 0; i < sizeof(*layout); i++) {
+        if (channels[i] != HYPERION_NO_CHANNEL) {
+            mask |= ADC_CHANNEL(channels[i]);
+        }
+    }
+    return mask;
+}
 
-    // Star Dep Voltage
-    hyperion_config_1_value(CONFIG_1_PANEL_SD, CONFIG_1_CHANNEL_VOLT, &hyperion_hk->Star_Dep_Voltage);
+static void sample_panel(uint8_t slave_addr, uint8_t tsense_addr, const hyperion_panel_layout *layout,
+                         hyperion_panel_sample *sample) {
+    adc_read_burst(slave_addr, layout_mask(layout), sample->raw, &sample->read_mask);
+    sample->tsense_valid = adc_get_tsense_raw(tsense_addr, &sample->tsense) == 0;
+}
 
-    // Zenith Voltage
-    hyperion_config_1_value(CONFIG_1_PANEL_Z, CONFIG_1_CHANNEL_VOLT, &hyperion_hk->Zenith_Voltage);
+static bool sample_has(const hyperion_panel_sample *sample, uint8_t channel) {
+    return channel != HYPERION_NO_CHANNEL && (sample->read_mask & ADC_CHANNEL(channel));
+}
 
-    // Port Current
-    hyperion_config_1_value(CONFIG_1_PANEL_P, CONFIG_1_CHANNEL_CURR, &hyperion_hk->Port_Current);
+static void convert_panel(const hyperion_panel_layout *layout, const hyperion_panel_sample *sample,
+                          hyperion_panel_hk *hk) {
+    uint16_t temp_raw[3] = {0};
+    uint16_t pd_raw[3] = {0};
+    int32_t temp[3];
+    int32_t pd[3];
+    int i;
+
+    for (i = 0; i < 3; i++) {
+        if (layout->temp[i] != HYPERION_NO_CHANNEL) {
+            temp_raw[i] = sample->raw[layout->temp[i]];
+        }
+        if (layout->pd[i] != HYPERION_NO_CHANNEL) {
+            pd_raw[i] = sample->raw[layout->pd[i]];
+        }
+    }
+    calibration_convert_n(&cal_lmt70_centi_c, temp_raw, temp, 3);
+    calibration_convert_n(&cal_hyperion_pd, pd_raw, pd, 3);
+
+    for (i = 0; i < 3; i++) {
+        if (layout->temp[i] == HYPERION_NO_CHANNEL) {
+            hk->temp[i] = HYPERION_2U_TEMP_PLACEHOLDER;
+        } else if (sample_has(sample, layout->temp[i])) {
+            hk->temp[i] = (int8_t)(temp[i] / 100);
+        } else {
+            hk->temp[i] = AD7291_BAD_TEMP;
+        }
+
+        if (layout->pd[i] == HYPERION_NO_CHANNEL) {
+            hk->pd[i] = HYPERION_2U_PD_PLACEHOLDER;
+        } else if (sample_has(sample, layout->pd[i])) {
+            hk->pd[i] = (uint8_t)pd[i];
+        } else {
+            hk->pd[i] = AD7291_BAD_PD;
+        }
+    }
 
-    // Port Dep Current
-    hyperion_config_1_value(CONFIG_1_PANEL_PD, CONFIG_1_CHANNEL_CURR, &hyperion_hk->Port_Dep_Current);
+    hk->temp_adc = AD7291_BAD_TEMP;
+    if (sample->tsense_valid) {
+        hk->temp_adc = (int8_t)(calibration_convert(&cal_ad7291_tsense_centi_c, sample->tsense) / 100);
+    }
+    hk->voltage = 0;
+    if (sample_has(sample, layout->voltage)) {
+        hk->voltage = calibration_convert(&cal_hyperion_mv, sample->raw[layout->voltage]);
+    }
+    hk->current = 0;
+    if (sample_has(sample, layout->current)) {
+        hk->current = calibration_convert(&cal_hyperion_ma, sample->raw[layout->current]);
+    }
+}
 
-    // Star Current
-    hyperion_config_1_value(CONFIG_1_PANEL_S, CONFIG_1_CHANNEL_CURR, &hyperion_hk->Star_Current);
+#define STORE_PANEL(hyperion_hk, prefix, panel)                                                                   \
+    do {                                                                                                          \
+        (hyperion_hk)->prefix##_Temp1 = (panel).temp[0];                                                          \
+        (hyperion_hk)->prefix##_Temp2 = (panel).temp[1];                                                          \
+        (hyperion_hk)->prefix##_Temp3 = (panel).temp[2];                                                          \
+        (hyperion_hk)->prefix##_Temp_Adc = (panel).temp_adc;                                                      \
+        (hyperion_hk)->prefix##_Pd1 = (panel).pd[0];                                                              \
+        (hyperion_hk)->prefix##_Pd2 = (panel).pd[1];                                                              \
+        (hyperion_hk)->prefix##_Pd3 = (panel).pd[2];                                                              \
+        (hyperion_hk)->prefix##_Voltage = (panel).voltage;                                                        \
+        (hyperion_hk)->prefix##_Current = (panel).current;                                                        \
+    } while (0)
+
+#define STORE_NADIR(hyperion_hk, panel)                                                                           \
+    do {                                                                                                          \
+        (hyperion_hk)->Nadir_Temp1 = (panel).temp[0];                                                             \
+        (hyperion_hk)->Nadir_Temp_Adc = (panel).temp_adc;                                                         \
+        (hyperion_hk)->Nadir_Pd1 = (panel).pd[0];                                                                 \
+    } while (0)
+
+enum { PANEL_NADIR, PANEL_PORT, PANEL_PORT_DEP, PANEL_STAR, PANEL_STAR_DEP, PANEL_ZENITH, PANEL_COUNT };
 
-    // Star Dep Current
-    hyperion_config_1_value(CONFIG_1_PANEL_SD, CONFIG_1_CHANNEL_CURR, &hyperion_hk->Star_Dep_Current);
+void Hyperion_config1_getHK(Hyperion_HouseKeeping *hyperion_hk) {
+    static const uint8_t addresses[PANEL_COUNT] = {
+        PANEL_SLAVE_ADDR_NADIR,     PANEL_SLAVE_ADDR_PORT,     PANEL_SLAVE_ADDR_PORT_DEPLOYABLE,
+        PANEL_SLAVE_ADDR_STARBOARD, PANEL_SLAVE_ADDR_STARBOARD_DEPLOYABLE, PANEL_SLAVE_ADDR_ZENITH};
+    hyperion_panel_sample samples[PANEL_COUNT];
+    hyperion_panel_hk panels[PANEL_COUNT];
+    int i;
+
+    for (i = 0; i < PANEL_COUNT; i++) {
+        sample_panel(addresses[i], addresses[i], i == PANEL_NADIR ? &layout_nadir : &layout_3u, &samples[i]);
+    }
+    for (i = 0; i < PANEL_COUNT; i++) {
+        convert_panel(i == PANEL_NADIR ? &layout_nadir : &layout_3u, &samples[i], &panels[i]);
+    }
 
-    // Zenith Current
-    hyperion_config_1_value(CONFIG_1_PANEL_Z, CONFIG_1_CHANNEL_CURR, &hyperion_hk->Zenith_Current);
+    STORE_NADIR(hyperion_hk, panels[PANEL_NADIR]);
+    STORE_PANEL(hyperion_hk, Port, panels[PANEL_PORT]);
+    STORE_PANEL(hyperion_hk, Port_Dep, panels[PANEL_PORT_DEP]);
+    STORE_PANEL(hyperion_hk, Star, panels[PANEL_STAR]);
+    STORE_PANEL(hyperion_hk, Star_Dep, panels[PANEL_STAR_DEP]);
+    STORE_PANEL(hyperion_hk, Zenith, panels[PANEL_ZENITH]);
 }
 
 void Hyperion_config3_getHK(Hyperion_HouseKeeping *hyperion_hk) {
-    // NADIR TEMP 1
-    hyperion_config_2_value(CONFIG_2_PANEL_NADIR, CONFIG_2_CHANNEL_TEMP_1, &hyperion_hk->Nadir_Temp1);
-
-    // NADIR Temp Adc
-    hyperion_hk->Nadir_Temp_Adc = adc_get_tsense_temp(PANEL_SLAVE_ADDR_NADIR2U, ADC_VREF);
-
-#if HYPERION_PANEL_2U_LIMITED == 0
-    // Port 2U TEMP 1 2
-    hyperion_config_3_value(CONFIG_3_PANEL_P2U, CONFIG_3_CHANNEL_TEMP_1, &hyperion_hk->Port_Temp1);
-    hyperion_config_3_value(CONFIG_3_PANEL_P2U, CONFIG_3_CHANNEL_TEMP_2, &hyperion_hk->Port_Temp2);
-    hyperion_hk->Port_Temp3 = HYPERION_2U_TEMP_PLACEHOLDER;
-
-    // Port 2U Temp Adc
-    hyperion_config_3_value(CONFIG_3_PANEL_P2U, CONFIG_3_ADC_TEMP, &hyperion_hk->Port_Temp_Adc);
-
-    // Port Dep Temp 1 2
-    hyperion_config_3_value(CONFIG_3_PANEL_PD2U, CONFIG_3_CHANNEL_TEMP_1, &hyperion_hk->Port_Dep_Temp1);
-    hyperion_config_3_value(CONFIG_3_PANEL_PD2U, CONFIG_3_CHANNEL_TEMP_2, &hyperion_hk->Port_Dep_Temp2);
-    hyperion_hk->Port_Dep_Temp3 = HYPERION_2U_TEMP_PLACEHOLDER;
-
-    // Port Dep Temp Adc
-    hyperion_config_3_value(CONFIG_3_PANEL_PD2U, CONFIG_3_ADC_TEMP, &hyperion_hk->Port_Dep_Temp_Adc);
+    static const uint8_t addresses[PANEL_COUNT] = {
+        PANEL_SLAVE_ADDR_NADIR,       PANEL_SLAVE_ADDR_PORT2U,     PANEL_SLAVE_ADDR_PORT_DEPLOYABLE2U,
+        PANEL_SLAVE_ADDR_STARBOARD2U, PANEL_SLAVE_ADDR_STARBOARD_DEPLOYABLE2U, PANEL_SLAVE_ADDR_ZENITH2U};
+    hyperion_panel_sample samples[PANEL_COUNT] = {0};
+    hyperion_panel_hk panels[PANEL_COUNT];
+    int i;
+
+    for (i = 0; i < PANEL_COUNT; i++) {
+#if HYPERION_PANEL_2U_LIMITED == 1
+        if (i == PANEL_PORT || i == PANEL_PORT_DEP) {
+            continue;
+        }
 #endif
+        // The nadir ADC temperature comes from the Nadir 2U panel in this configuration
+        uint8_t tsense_addr = i == PANEL_NADIR ? PANEL_SLAVE_ADDR_NADIR2U : addresses[i];
+        sample_panel(addresses[i], tsense_addr, i == PANEL_NADIR ? &layout_nadir : &layout_2u, &samples[i]);
+    }
 
-    // Star Temp 1 2
-    hyperion_config_3_value(CONFIG_3_PANEL_S2U, CONFIG_3_CHANNEL_TEMP_1, &hyperion_hk->Star_Temp1);
-    hyperion_config_3_value(CONFIG_3_PANEL_S2U, CONFIG_3_CHANNEL_TEMP_2, &hyperion_hk->Star_Temp2);
-    hyperion_hk->Star_Temp3 = HYPERION_2U_TEMP_PLACEHOLDER;
-
-    // Star Temp Adc
-    hyperion_config_3_value(CONFIG_3_PANEL_S2U, CONFIG_3_ADC_TEMP, &hyperion_hk->Star_Temp_Adc);
-
-    // Star Dep Temp 1 2
-    hyperion_config_3_value(CONFIG_3_PANEL_SD2U, CONFIG_3_CHANNEL_TEMP_1, &hyperion_hk->Star_Dep_Temp1);
-    hyperion_config_3_value(CONFIG_3_PANEL_SD2U, CONFIG_3_CHANNEL_TEMP_2, &hyperion_hk->Star_Dep_Temp2);
-    hyperion_hk->Star_Dep_Temp3 = HYPERION_2U_TEMP_PLACEHOLDER;
-
-    // Star Dep Adc
-    hyperion_config_3_value(CONFIG_3_PANEL_SD2U, CONFIG_3_ADC_TEMP, &hyperion_hk->Star_Dep_Temp_Adc);
-
-    // Zenith Temp 1 2
-    hyperion_config_3_value(CONFIG_3_PANEL_Z2U, CONFIG_3_CHANNEL_TEMP_1, &hyperion_hk->Zenith_Temp1);
-    hyperion_config_3_value(CONFIG_3_PANEL_Z2U, CONFIG_3_CHANNEL_TEMP_2, &hyperion_hk->Zenith_Temp2);
-    hyperion_hk->Zenith_Temp3 = HYPERION_2U_TEMP_PLACEHOLDER;
-
-    // Zenith Temp Adc
-    hyperion_config_3_value(CONFIG_3_PANEL_Z2U, CONFIG_3_ADC_TEMP, &hyperion_hk->Zenith_Temp_Adc);
-
-    // Nadir Pd 1
-    hyperion_config_2_value(CONFIG_2_PANEL_NADIR, CONFIG_2_CHANNEL_PD_1, &hyperion_hk->Nadir_Pd1);
-
-#if HYPERION_PANEL_2U_LIMITED == 0
-    // Port 2U Pd 1 2
-    hyperion_config_3_value(CONFIG_3_PANEL_P2U, CONFIG_3_CHANNEL_PD_1, &hyperion_hk->Port_Pd1);
-    hyperion_config_3_value(CONFIG_3_PANEL_P2U, CONFIG_3_CHANNEL_PD_2, &hyperion_hk->Port_Pd2);
-    hyperion_hk->Port_Pd3 = HYPERION_2U_PD_PLACEHOLDER;
-
-    // Port 2U Dep Pd 1 2 3
-    hyperion_config_3_value(CONFIG_3_PANEL_PD2U, CONFIG_3_CHANNEL_PD_1, &hyperion_hk->Port_Dep_Pd1);
-    hyperion_config_3_value(CONFIG_3_PANEL_PD2U, CONFIG_3_CHANNEL_PD_2, &hyperion_hk->Port_Dep_Pd2);
-    hyperion_hk->Port_Dep_Pd3 = HYPERION_2U_PD_PLACEHOLDER;
-#endif
-
-    // Star 2U Pd 1 2
-    hyperion_config_3_value(CONFIG_3_PANEL_S2U, CONFIG_3_CHANNEL_PD_1, &hyperion_hk->Star_Pd1);
-    hyperion_config_3_value(CONFIG_3_PANEL_S2U, CONFIG_3_CHANNEL_PD_2, &hyperion_hk->Star_Pd2);
-    hyperion_hk->Star_Pd3 = HYPERION_2U_PD_PLACEHOLDER;
-
-    // Star Dep 2U Pd 1 2
-    hyperion_config_3_value(CONFIG_3_PANEL_SD2U, CONFIG_3_CHANNEL_PD_1, &hyperion_hk->Star_Dep_Pd1);
-    hyperion_config_3_value(CONFIG_3_PANEL_SD2U, CONFIG_3_CHANNEL_PD_2, &hyperion_hk->Star_Dep_Pd2);
-    hyperion_hk->Star_Dep_Pd3 = HYPERION_2U_PD_PLACEHOLDER;
-
-    // Zenith 2U Pd 1 2
-    hyperion_config_3_value(CONFIG_3_PANEL_Z2U, CONFIG_3_CHANNEL_PD_1, &hyperion_hk->Zenith_Pd1);
-    hyperion_config_3_value(CONFIG_3_PANEL_Z2U, CONFIG_3_CHANNEL_PD_2, &hyperion_hk->Zenith_Pd2);
-    hyperion_hk->Zenith_Pd3 = HYPERION_2U_PD_PLACEHOLDER;
-
-#if HYPERION_PANEL_2U_LIMITED == 0
-    // Port 2U Voltage
-    hyperion_config_3_value(CONFIG_3_PANEL_P2U, CONFIG_3_CHANNEL_VOLT, &hyperion_hk->Port_Voltage);
-
-    // Port Dep 2U Voltage
-    hyperion_config_3_value(CONFIG_3_PANEL_PD2U, CONFIG_3_CHANNEL_VOLT, &hyperion_hk->Port_Dep_Voltage);
-#endif
-
-    // Star 2U Voltage
-    hyperion_config_3_value(CONFIG_3_PANEL_S2U, CONFIG_3_CHANNEL_VOLT, &hyperion_hk->Star_Voltage);
-
-    // Star Dep 2U Voltage
-    hyperion_config_3_value(CONFIG_3_PANEL_SD2U, CONFIG_3_CHANNEL_VOLT, &hyperion_hk->Star_Dep_Voltage);
-
-    // Zenith 2U Voltage
-    hyperion_config_3_value(CONFIG_3_PANEL_Z2U, CONFIG_3_CHANNEL_VOLT, &hyperion_hk->Zenith_Voltage);
+    for (i = 0; i < PANEL_COUNT; i++) {
+        convert_panel(i == PANEL_NADIR ? &layout_nadir : &layout_2u, &samples[i], &panels[i]);
+    }
 
+    STORE_NADIR(hyperion_hk, panels[PANEL_NADIR]);
 #if HYPERION_PANEL_2U_LIMITED == 0
-    // Port 2U Current
-    hyperion_config_3_value(CONFIG_3_PANEL_P2U, CONFIG_3_CHANNEL_CURR, &hyperion_hk->Port_Current);
-
-    // Port Dep 2U Current
-    hyperion_config_3_value(CONFIG_3_PANEL_PD2U, CONFIG_3_CHANNEL_CURR, &hyperion_hk->Port_Dep_Current);
+    STORE_PANEL(hyperion_hk, Port, panels[PANEL_PORT]);
+    STORE_PANEL(hyperion_hk, Port_Dep, panels[PANEL_PORT_DEP]);
 #endif
-
-    // Star 2U Current
-    hyperion_config_3_value(CONFIG_3_PANEL_S2U, CONFIG_3_CHANNEL_CURR, &hyperion_hk->Star_Current);
-
-    // Star Dep 2U Current
-    hyperion_config_3_value(CONFIG_3_PANEL_SD2U, CONFIG_3_CHANNEL_CURR, &hyperion_hk->Star_Dep_Current);
-
-    // Zenith 2U Current
-    hyperion_config_3_value(CONFIG_3_PANEL_Z2U, CONFIG_3_CHANNEL_CURR, &hyperion_hk->Zenith_Current);
+    STORE_PANEL(hyperion_hk, Star, panels[PANEL_STAR]);
+    STORE_PANEL(hyperion_hk, Star_Dep, panels[PANEL_STAR_DEP]);
+    STORE_PANEL(hyperion_hk, Zenith, panels[PANEL_ZENITH]);
 }
@@ -22,6 +22,7 @@
 #define INCLUDE_IRIS_SPI_H_
 
 #include "FreeRTOS.h"
+#include "HL_spi.h"
 
 typedef enum {
     IRIS_ACK = 0,
@@ -31,6 +32,7 @@ typedef enum {
 
 #define DUMMY_BYTE 0xFF
 #define IRIS_WAIT_FOR_ACK vTaskDelay(pdMS_TO_TICKS(20))
+#define IRIS_TRANSFER_TIMEOUT pdMS_TO_TICKS(500)
 
 void iris_spi_init();
 void iris_spi_send(uint16_t *tx_data, uint16_t data_length);
@@ -41,5 +43,9 @@ void iris_spi_delay(uint16_t timeout);
 IrisLowLevelReturn iris_send_command(uint16_t command);
 IrisLowLevelReturn iris_send_data(uint16_t *tx_buffer, uint16_t data_length);
 IrisLowLevelReturn iris_get_data(uint16_t *rx_buffer, uint16_t data_length); // Data length is obtained from IRIS
+IrisLowLevelReturn iris_get_data_start(uint16_t *rx_buffer, uint16_t data_length);
+IrisLowLevelReturn iris_get_data_finish(void);
+
+void iris_spiEndNotification(spiBASE_t *spi);
 
 #endif /* INCLUDE_IRIS_SPI_H_ */
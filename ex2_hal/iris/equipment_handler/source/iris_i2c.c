@@ -60,5 +60,5 @@ int iris_write_packet(void *buf_tx_data, uint16_t data_length) {
  *   Returns 0 data read, <0 if unable to read data.
  **/
 int iris_read_packet(void *buf_rx_data, uint16_t data_length) {
-    return i2c_Receive(IRIS_I2C, IRIS_SLAVE_ADDR, data_length, &buf_rx_data);
+    return i2c_Receive(IRIS_I2C, IRIS_SLAVE_ADDR, data_length, buf_rx_data);
 }
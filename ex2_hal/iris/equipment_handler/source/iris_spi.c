@@ -26,6 +26,8 @@
  */
 
 #include "FreeRTOS.h"
+#include "os_semphr.h"
+#include <stdbool.h>
 #include <stdlib.h>
 
 #include "iris_spi.h"
@@ -37,6 +39,12 @@
 
 spiDAT1_t dataconfig;
 
+/* Clocked out while receiving, so every word of a read has something to send */
+static uint16_t tx_dummy_buffer[IMAGE_TRANSFER_SIZE];
+
+static SemaphoreHandle_t transfer_done = NULL;
+static volatile bool transfer_armed = false;
+
 /**
  * @brief
  *   Pull slave select low via GPIO pin
@@ -69,6 +77,33 @@ void iris_spi_init() {
     dataconfig.CSNR = SPI_CS_1;
 
     gioSetDirection(hetPORT1, 0xFFFFFFFF);
+
+    uint16_t i;
+    for (i = 0; i < IMAGE_TRANSFER_SIZE; i++) {
+        tx_dummy_buffer[i] = DUMMY_BYTE;
+    }
+    if (transfer_done == NULL) {
+        transfer_done = xSemaphoreCreateBinary();
+    }
+}
+
+/**
+ * @brief
+ *   Called from the SPI interrupt when a transmit or receive block completes.
+ *   Wakes the task waiting in iris_get_data_finish once both have
+ *
+ * @param[in] spi
+ *   SPI module that raised the notification
+ **/
+void iris_spiEndNotification(spiBASE_t *spi) {
+    portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+    if (!transfer_armed || SpiTxStatus(spi) != SPI_COMPLETED || SpiRxStatus(spi) != SPI_COMPLETED) {
+        return;
+    }
+    transfer_armed = false;
+    xSemaphoreGiveFromISR(transfer_done, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
 
 /**
@@ -229,17 +264,64 @@ IrisLowLevelReturn iris_send_data(uint16_t *tx_buffer, uint16_t data_length) {
  *   Number of bytes to receive
  *
  * @return
- *   Returns TODO: Need to figure out a better return type
+ *   Returns IRIS_ACK once the data is received, IRIS_LL_ERROR if not
  **/
 IrisLowLevelReturn iris_get_data(uint16_t *rx_buffer, uint16_t data_length) {
-    uint16_t tx_dummy = 0xFF;
+    IrisLowLevelReturn ret;
+
+    ret = iris_get_data_start(rx_buffer, data_length);
+    if (ret == IRIS_ACK) {
+        ret = iris_get_data_finish();
+    }
+    iris_spi_delay(1000);
+
+    return ret;
+}
+
+/**
+ * @brief
+ *   Starts receiving data of size data_length and returns while the SPI
+ *   interrupt clocks it in, so the caller can work on a previous block.
+ *   Must be followed by iris_get_data_finish
+ *
+ * @param[in] rx_buffer
+ *   Pointer to receive data buffer, untouched by the caller until finished
+ *
+ * @param[in] data_length
+ *   Number of bytes to receive, at most IMAGE_TRANSFER_SIZE
+ *
+ * @return
+ *   Returns IRIS_LL_ERROR if the transfer could not be started
+ **/
+IrisLowLevelReturn iris_get_data_start(uint16_t *rx_buffer, uint16_t data_length) {
+    if (transfer_done == NULL || data_length > IMAGE_TRANSFER_SIZE) {
+        return IRIS_LL_ERROR;
+    }
+    xSemaphoreTake(transfer_done, 0); // Drop a completion left by a timed out transfer
 
     NSS_LOW();
     iris_spi_delay(10000);
-    iris_spi_send_and_get(&tx_dummy, rx_buffer, data_length);
-    iris_spi_delay(1000);
-    NSS_HIGH();
-    iris_spi_delay(1000);
+    transfer_armed = true;
+    spiSendAndGetData(IRIS_SPI, &dataconfig, data_length, tx_dummy_buffer, rx_buffer);
 
     return IRIS_ACK;
 }
+
+/**
+ * @brief
+ *   Blocks until the transfer begun by iris_get_data_start completes
+ *
+ * @return
+ *   Returns IRIS_ACK once the data is in the buffer, IRIS_LL_ERROR on timeout
+ **/
+IrisLowLevelReturn iris_get_data_finish(void) {
+    IrisLowLevelReturn ret = IRIS_ACK;
+
+    if (xSemaphoreTake(transfer_done, IRIS_TRANSFER_TIMEOUT) != pdTRUE) {
+        transfer_armed = false;
+        ret = IRIS_LL_ERROR;
+    }
+    NSS_HIGH();
+
+    return ret;
+}
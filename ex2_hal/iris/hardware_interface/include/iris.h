@@ -43,6 +43,7 @@ typedef enum {
     IRIS_HAL_OK = 0,
     IRIS_HAL_FAILURE = 1,
     IRIS_HAL_ERROR = 2,
+    IRIS_HAL_BUSY = 3, // Iris is being reprogrammed
 } Iris_HAL_return;
 
 // Legal Iris commands
@@ -91,6 +92,9 @@ typedef struct __attribute__((__packed__)) {
     uint16_t MIN_3V_voltage;
 } IRIS_Housekeeping;
 
+/* Receives each image chunk while the next one is read from Iris. Only the low byte of each word is data */
+typedef Iris_HAL_return (*iris_image_sink)(const uint16_t *chunk, uint32_t offset, uint16_t length, void *arg);
+
 typedef struct __attribute__((__packed__)) {
     uint16_t sensor_reg_addr;
     uint8_t sensor_data;
@@ -100,7 +104,7 @@ typedef struct __attribute__((__packed__)) {
 Iris_HAL_return iris_init();
 Iris_HAL_return iris_take_pic();
 Iris_HAL_return iris_get_image_length(uint32_t *image_length);
-Iris_HAL_return iris_transfer_image(uint32_t image_length);
+Iris_HAL_return iris_transfer_image(uint32_t image_length, iris_image_sink sink, void *arg);
 Iris_HAL_return iris_get_image_count(uint16_t *image_count);
 Iris_HAL_return iris_toggle_sensor(uint8_t toggle);
 Iris_HAL_return iris_get_housekeeping(IRIS_Housekeeping *hk_data);
@@ -36,6 +36,12 @@
 #define N_OPC_CHECK_VERSION 0xFE
 #define OPC_GO 0x21 // Go opcode
 #define N_OPC_GO 0xDE
+#define OPC_READ 0x11 // Read memory opcode
+#define N_OPC_READ 0xEE
+
+/* Replies of the bootloader */
+#define BL_ACK 0x79
+#define BL_NACK 0x1F
 
 #define FLASH_MEM_BASE_ADDR 0x08000000
 #define FLASH_MEM_PAGE_SIZE 128
@@ -48,6 +54,11 @@
 #define MASS_ERASE_PACKET_LENGTH 1025
 #define NUM_PAGES_TO_ERASE 1
 
+/* Most bytes one write or read memory command can move */
+#define BL_MAX_TRANSFER 256
+/* Most pages erase_pages takes at once */
+#define BL_MAX_ERASE_PAGES 32
+
 void BOOT_LOW();
 void BOOT_HIGH();
 void POWER_OFF();
@@ -60,3 +71,6 @@ int iris_erase_page(uint16_t page_num);
 int iris_check_bootloader_version();
 int iris_go_to(uint32_t start_addr);
 int iris_mass_erase_flash();
+int iris_write_memory(uint32_t flash_addr, const uint8_t *buffer, uint16_t length);
+int iris_read_memory(uint32_t flash_addr, uint8_t *buffer, uint16_t length);
+int iris_erase_pages(uint16_t first_page, uint16_t num_pages);
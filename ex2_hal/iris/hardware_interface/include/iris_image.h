@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file iris_image.h
+ * @date Oct. 19, 2026
+ */
+
+#ifndef IRIS_IMAGE_H
+#define IRIS_IMAGE_H
+
+#include <stdint.h>
+
+#include "iris.h"
+
+#define IRIS_IMAGE_DEFAULT_PATH "VOL0:/IRIS.IMG"
+#define IRIS_IMAGE_PATH_MAX 32
+
+/* Chunks are gathered into writes of this many bytes, a multiple of the file system block size */
+#define IRIS_IMAGE_WRITE_SIZE (4 * IMAGE_TRANSFER_SIZE)
+
+/* The file is synced and the checkpoint rewritten each time this many more bytes are stored */
+#define IRIS_IMAGE_CHECKPOINT_BYTES (32 * IRIS_IMAGE_WRITE_SIZE)
+
+typedef struct {
+    uint32_t image_length; // bytes in the image
+    uint32_t resumed_at;   // bytes already stored by an interrupted transfer, 0 if started afresh
+    uint32_t crc;          // CRC-32 of the whole image
+    uint32_t elapsed_ms;   // time spent reading and storing
+    uint32_t bytes_per_s;  // bytes stored per second, excluding those already stored
+} iris_image_report;
+
+Iris_HAL_return iris_image_store(const char *path, iris_image_report *report);
+
+uint32_t iris_image_crc(uint32_t crc, const uint8_t *data, uint32_t length);
+
+#endif /* IRIS_IMAGE_H */
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file iris_program.h
+ * @date Oct. 19, 2026
+ */
+
+#ifndef IRIS_PROGRAM_H
+#define IRIS_PROGRAM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "iris.h"
+#include "iris_bootloader_cmds.h"
+#include "iris_image.h"
+
+#define IRIS_PROGRAM_PATH_MAX IRIS_IMAGE_PATH_MAX
+
+/* Largest image that fits in the flash of Iris */
+#define IRIS_PROGRAM_MAX_SIZE (FLASH_NUM_PAGES * FLASH_MEM_PAGE_SIZE)
+
+/* Bytes read from the SD card at once, and erased with one command. A whole number of pages */
+#define IRIS_PROGRAM_CHUNK (16 * FLASH_MEM_PAGE_SIZE)
+
+/* The progress is saved each time this many more bytes are programmed and verified */
+#define IRIS_PROGRAM_CHECKPOINT_BYTES (4 * IRIS_PROGRAM_CHUNK)
+
+/* Times a chunk is erased and written again after it fails to verify */
+#define IRIS_PROGRAM_RETRIES 2
+
+/* Longest wait for the SD card to fill a buffer */
+#define IRIS_PROGRAM_READ_WAIT pdMS_TO_TICKS(5000)
+
+#define IRIS_PROGRAM_STACK_SIZE 512
+#define IRIS_PROGRAM_READER_STACK_SIZE 256
+
+typedef enum {
+    IRIS_PROGRAM_IDLE = 0,
+    IRIS_PROGRAM_RUNNING = 1,
+    IRIS_PROGRAM_DONE = 2,
+    IRIS_PROGRAM_FAILED = 3,
+} iris_program_state;
+
+typedef struct {
+    uint32_t state;        // iris_program_state
+    uint32_t image_length; // bytes in the image being programmed
+    uint32_t programmed;   // bytes written and read back so far
+    uint32_t resumed_at;   // bytes programmed by an interrupted run, 0 if started afresh
+    uint32_t crc;          // CRC-32 of the bytes programmed
+    uint32_t elapsed_ms;   // time spent since the run started
+} iris_program_status;
+
+Iris_HAL_return iris_program_start(const char *path);
+
+void iris_program_get_status(iris_program_status *status);
+
+bool iris_program_running(void);
+
+#endif /* IRIS_PROGRAM_H */
@@ -127,14 +127,26 @@ Iris_HAL_return iris_get_image_length(uint32_t *image_length) {
  *   Sends a transfer image command to Iris, and expects to receive the
  *   image data of size image_length
  *
+ * @details
+ *   Chunks are read into two buffers in turn. While one is being filled by
+ *   the SPI interrupt, the other is handed to the sink, so storing the image
+ *   overlaps with reading it
+ *
  * @param[in] image_length
  *   Number of bytes expected to be received from Iris
  *
+ * @param[in] sink
+ *   Called with each chunk in order, the last one holding only the
+ *   remaining bytes. Returning anything but IRIS_HAL_OK aborts the transfer
+ *
+ * @param[in] arg
+ *   Passed through to the sink
+ *
  * @return
  *   Returns IRIS_HAL_OK if equipment handler returns IRIS_ACK, else IRIS_HAL_ERROR
  **/
-Iris_HAL_return iris_transfer_image(uint32_t image_length) {
-    uint16_t num_transfer;
+Iris_HAL_return iris_transfer_image(uint32_t image_length, iris_image_sink sink, void *arg) {
+    uint32_t num_transfer;
     IrisLowLevelReturn ret;
 
     controller_state = SEND_COMMAND;
@@ -154,21 +166,41 @@ Iris_HAL_return iris_transfer_image(uint32_t image_length) {
         }
         case GET_DATA: // Get image data in chunks/blocks
         {
-            static uint16_t image_data_buffer[IMAGE_TRANSFER_SIZE];
-            memset(image_data_buffer, 0, IMAGE_TRANSFER_SIZE);
-            num_transfer = (uint16_t)((image_length + (IMAGE_TRANSFER_SIZE - 1)) /
-                                      IMAGE_TRANSFER_SIZE); // TODO: Ceiling division not working 100%
+            static uint16_t image_data_buffer[2][IMAGE_TRANSFER_SIZE];
+            uint8_t filling = 0;
+            num_transfer = (image_length + (IMAGE_TRANSFER_SIZE - 1)) / IMAGE_TRANSFER_SIZE;
 
-            IRIS_WAIT_FOR_STATE_TRANSITION;
+            controller_state = FINISH;
+            if (num_transfer == 0) {
+                break;
+            }
+            ret = iris_get_data_start(image_data_buffer[filling], IMAGE_TRANSFER_SIZE);
             for (uint32_t count_transfer = 0; count_transfer < num_transfer; count_transfer++) {
-                ret = iris_get_data(image_data_buffer, IMAGE_TRANSFER_SIZE);
-                // TODO: Do something with the received data (e.g transfer it to the SD card)
-                // Or just get the data and send it forward to the next stage. Prefer not to have too
-                // much data processing in driver code
-
-                // memset(image_data_buffer, 0, IMAGE_TRANSFER_SIZE);
+                if (ret == IRIS_ACK) {
+                    ret = iris_get_data_finish();
+                }
+                if (ret != IRIS_ACK) {
+                    controller_state = ERROR_STATE;
+                    break;
+                }
+                const uint16_t *chunk = image_data_buffer[filling];
+                uint32_t offset = count_transfer * IMAGE_TRANSFER_SIZE;
+                uint32_t remaining = image_length - offset;
+
+                // Start on the next chunk before handing this one on
+                filling ^= 1;
+                if (count_transfer + 1 < num_transfer) {
+                    ret = iris_get_data_start(image_data_buffer[filling], IMAGE_TRANSFER_SIZE);
+                }
+                if (sink(chunk, offset, remaining < IMAGE_TRANSFER_SIZE ? remaining : IMAGE_TRANSFER_SIZE,
+                         arg) != IRIS_HAL_OK) {
+                    if (count_transfer + 1 < num_transfer && ret == IRIS_ACK) {
+                        iris_get_data_finish();
+                    }
+                    controller_state = ERROR_STATE;
+                    break;
+                }
             }
-            controller_state = FINISH;
             break;
         }
         case FINISH: {
@@ -106,6 +106,32 @@ void iris_post_sequence() {
     POWER_ON();
 }
 
+/* Send one part of a command and wait for the bootloader to acknowledge it */
+static int send_and_ack(uint8_t *packet, uint16_t length) {
+    uint8_t rx_data = 0;
+    if (iris_write_packet(packet, length) < 0 || iris_read_packet(&rx_data, 1) < 0) {
+        return -1;
+    }
+    return rx_data == BL_ACK ? 0 : -1;
+}
+
+/* Send a command opcode and its complement, and wait for the bootloader to accept it */
+static int send_opcode(uint8_t opcode, uint8_t n_opcode) {
+    uint8_t packet[2] = {opcode, n_opcode};
+    return send_and_ack(packet, 2);
+}
+
+/* Send a flash address followed by its checksum */
+static int send_address(uint32_t flash_addr) {
+    uint8_t packet[5];
+    packet[0] = (flash_addr >> (8 * 3)) & 0xff;
+    packet[1] = (flash_addr >> (8 * 2)) & 0xff;
+    packet[2] = (flash_addr >> (8 * 1)) & 0xff;
+    packet[3] = (flash_addr >> (8 * 0)) & 0xff;
+    packet[4] = packet[0] ^ packet[1] ^ packet[2] ^ packet[3];
+    return send_and_ack(packet, 5);
+}
+
 /**
  * @brief
  *   Write page in flash memory on Iris
@@ -217,6 +243,119 @@ int iris_erase_page(uint16_t page_num) {
     return ret;
 }
 
+/**
+ * @brief
+ *   Write up to BL_MAX_TRANSFER bytes to flash memory on Iris in one command
+ *
+ * @param[in] flash_addr
+ *   Starting flash address, the pages must be erased
+ *
+ * @param[in] buffer
+ *   Data to write
+ *
+ * @param[in] length
+ *   Bytes to write, a multiple of 4 up to BL_MAX_TRANSFER
+ *
+ * @return
+ *   Returns 0 data written, <0 if the bootloader refused any step.
+ **/
+int iris_write_memory(uint32_t flash_addr, const uint8_t *buffer, uint16_t length) {
+    static uint8_t packet[BL_MAX_TRANSFER + 2];
+    uint8_t checksum;
+    uint16_t i;
+
+    if (length == 0 || length > BL_MAX_TRANSFER) {
+        return -1;
+    }
+    if (send_opcode(OPC_WRITE, N_OPC_WRITE) < 0 || send_address(flash_addr) < 0) {
+        return -1;
+    }
+
+    packet[0] = length - 1;
+    checksum = packet[0];
+    for (i = 0; i < length; i++) {
+        packet[i + 1] = buffer[i];
+        checksum ^= buffer[i];
+    }
+    packet[length + 1] = checksum;
+    return send_and_ack(packet, length + 2);
+}
+
+/**
+ * @brief
+ *   Read up to BL_MAX_TRANSFER bytes of flash memory on Iris
+ *
+ * @param[in] flash_addr
+ *   Starting flash address
+ *
+ * @param[out] buffer
+ *   Where to store the data read
+ *
+ * @param[in] length
+ *   Bytes to read, up to BL_MAX_TRANSFER
+ *
+ * @return
+ *   Returns 0 data read, <0 if the bootloader refused any step.
+ **/
+int iris_read_memory(uint32_t flash_addr, uint8_t *buffer, uint16_t length) {
+    uint8_t packet[2];
+
+    if (length == 0 || length > BL_MAX_TRANSFER) {
+        return -1;
+    }
+    if (send_opcode(OPC_READ, N_OPC_READ) < 0 || send_address(flash_addr) < 0) {
+        return -1;
+    }
+    packet[0] = length - 1;
+    packet[1] = packet[0] ^ 0xFF;
+    if (send_and_ack(packet, 2) < 0) {
+        return -1;
+    }
+    return iris_read_packet(buffer, length);
+}
+
+/**
+ * @brief
+ *   Erase consecutive pages of flash memory on Iris with one command
+ *
+ * @param[in] first_page
+ *   First page to erase, from 0 to FLASH_NUM_PAGES - 1
+ *
+ * @param[in] num_pages
+ *   Pages to erase, up to BL_MAX_ERASE_PAGES
+ *
+ * @return
+ *   Returns 0 pages erased, <0 if the bootloader refused any step.
+ **/
+int iris_erase_pages(uint16_t first_page, uint16_t num_pages) {
+    static uint8_t packet[2 * BL_MAX_ERASE_PAGES + 1];
+    uint8_t checksum = 0x00;
+    uint16_t i;
+
+    if (num_pages == 0 || num_pages > BL_MAX_ERASE_PAGES || first_page + num_pages > FLASH_NUM_PAGES) {
+        return -1;
+    }
+    if (send_opcode(OPC_ERASE, N_OPC_ERASE) < 0) {
+        return -1;
+    }
+
+    packet[0] = ((num_pages - 1) >> 8) & 0xff;
+    packet[1] = (num_pages - 1) & 0xff;
+    packet[2] = packet[0] ^ packet[1];
+    if (send_and_ack(packet, 3) < 0) {
+        return -1;
+    }
+
+    for (i = 0; i < num_pages; i++) {
+        packet[2 * i] = ((first_page + i) >> 8) & 0xff;
+        packet[2 * i + 1] = (first_page + i) & 0xff;
+        checksum ^= packet[2 * i] ^ packet[2 * i + 1];
+    }
+    packet[2 * num_pages] = checksum;
+    // The bootloader holds its reply until the pages are erased
+    return send_and_ack(packet, 2 * num_pages + 1);
+}
+
 /**
  * @brief
  *   Checks i2c bootloader version on Iris
@@ -238,7 +377,7 @@ int iris_check_bootloader_version(uint8_t *version) {
     memset(packet, 0, 2);
 
     /* Read bootloader version */
-    iris_read_packet(&version, 1);
+    iris_read_packet(version, 1);
 
     /* Wait for ACK/NACK */
     iris_read_packet(&rx_data, 1);
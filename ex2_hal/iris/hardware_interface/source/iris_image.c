@@ -0,0 +1,231 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file iris_image.c
+ * @date Oct. 19, 2026
+ *
+ * Stores the image held by Iris to a file on the SD card.
+ *
+ * iris_transfer_image reads the next chunk while this file packs the last
+ * one into a buffer of whole file system blocks, so every write lands on a
+ * block boundary and no block is read back to be modified. A CRC-32 of the
+ * image is kept as the chunks arrive.
+ *
+ * Every IRIS_IMAGE_CHECKPOINT_BYTES the file is synced and the progress is
+ * saved. If a transfer is cut short, the next one to the same file picks up
+ * from the last checkpoint. Iris can only send an image from the start, so
+ * the chunks already stored are still read but not written again.
+ */
+
+#include "iris_image.h"
+
+#include "FreeRTOS.h"
+#include "os_task.h"
+#include <redposix.h>
+#include <string.h>
+
+#include "logger.h"
+
+static const char checkpoint_file[] = "VOL0:/IRISimg.CKP";
+
+typedef struct {
+    char path[IRIS_IMAGE_PATH_MAX];
+    uint32_t image_length;
+    uint32_t stored; // bytes of the image synced to the file
+    uint32_t crc;    // CRC-32 of those bytes
+} iris_checkpoint_t;
+
+typedef struct {
+    int32_t file;
+    iris_checkpoint_t progress;
+    uint32_t skip;         // bytes stored before this transfer began
+    uint32_t checkpointed; // progress.stored when the checkpoint was last saved
+    uint32_t fill;         // bytes waiting in write_buffer
+    uint32_t crc;          // CRC-32 of everything received, including write_buffer
+} image_store_t;
+
+static uint8_t write_buffer[IRIS_IMAGE_WRITE_SIZE];
+
+/* CRC-32 (IEEE 802.3), reflected, one nibble at a time */
+static const uint32_t crc_nibble[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+/**
+ * @brief
+ *      Continue a CRC-32 over more data
+ * @param crc
+ *      CRC of the data so far, 0 to start
+ * @param data
+ *      Data to add
+ * @param length
+ *      Number of bytes in data
+ * @return
+ *      CRC of all the data
+ */
+uint32_t iris_image_crc(uint32_t crc, const uint8_t *data, uint32_t length) {
+    crc = ~crc;
+    while (length--) {
+        crc ^= *data++;
+        crc = (crc >> 4) ^ crc_nibble[crc & 0x0F];
+        crc = (crc >> 4) ^ crc_nibble[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+static void save_checkpoint(image_store_t *store) {
+    if (red_fsync(store->file) != 0) {
+        sys_log(ERROR, "Failed to sync Iris image '%s'\n", store->progress.path);
+        return;
+    }
+    int32_t fout = red_open(checkpoint_file, RED_O_CREAT | RED_O_TRUNC | RED_O_WRONLY);
+    if (fout == -1) {
+        sys_log(ERROR, "Failed to open or create file to write: '%s'\n", checkpoint_file);
+        return;
+    }
+    if (red_write(fout, &store->progress, sizeof(store->progress)) != sizeof(store->progress)) {
+        sys_log(ERROR, "Failed to write to file: '%s'\n", checkpoint_file);
+    } else {
+        store->checkpointed = store->progress.stored;
+    }
+    red_close(fout);
+}
+
+/* Open the image file, after the stored part of it if an earlier transfer of the same image was cut short */
+static int32_t open_image(image_store_t *store, const char *path, uint32_t image_length) {
+    iris_checkpoint_t saved;
+    int32_t fin = red_open(checkpoint_file, RED_O_RDONLY);
+    if (fin != -1) {
+        int32_t read = red_read(fin, &saved, sizeof(saved));
+        red_close(fin);
+        if (read == sizeof(saved) && strncmp(saved.path, path, IRIS_IMAGE_PATH_MAX) == 0 &&
+            saved.image_length == image_length && saved.stored <= image_length) {
+            int32_t file = red_open(path, RED_O_RDWR);
+            if (file != -1 && red_lseek(file, 0, RED_SEEK_END) >= (int64_t)saved.stored &&
+                red_lseek(file, saved.stored, RED_SEEK_SET) == (int64_t)saved.stored) {
+                store->progress = saved;
+                store->skip = saved.stored;
+                store->checkpointed = saved.stored;
+                store->crc = saved.crc;
+                return file;
+            }
+            if (file != -1) {
+                red_close(file);
+            }
+        }
+    }
+
+    strncpy(store->progress.path, path, IRIS_IMAGE_PATH_MAX - 1);
+    store->progress.image_length = image_length;
+    return red_open(path, RED_O_CREAT | RED_O_TRUNC | RED_O_WRONLY);
+}
+
+static Iris_HAL_return store_chunk(const uint16_t *chunk, uint32_t offset, uint16_t length, void *arg) {
+    image_store_t *store = (image_store_t *)arg;
+    uint16_t i;
+
+    if (offset < store->skip) {
+        return IRIS_HAL_OK;
+    }
+    uint8_t *packed = &write_buffer[store->fill];
+    for (i = 0; i < length; i++) {
+        packed[i] = (uint8_t)chunk[i];
+    }
+    store->crc = iris_image_crc(store->crc, packed, length);
+    store->fill += length;
+
+    if (store->fill < IRIS_IMAGE_WRITE_SIZE && offset + length < store->progress.image_length) {
+        return IRIS_HAL_OK;
+    }
+    if (red_write(store->file, write_buffer, store->fill) != (int32_t)store->fill) {
+        sys_log(ERROR, "Failed to write to file: '%s'\n", store->progress.path);
+        return IRIS_HAL_ERROR;
+    }
+    store->progress.stored += store->fill;
+    store->progress.crc = store->crc;
+    store->fill = 0;
+
+    if (store->progress.stored - store->checkpointed >= IRIS_IMAGE_CHECKPOINT_BYTES &&
+        store->progress.stored < store->progress.image_length) {
+        save_checkpoint(store);
+    }
+    return IRIS_HAL_OK;
+}
+
+/**
+ * @brief
+ *      Read the image held by Iris into a file
+ * @details
+ *      Resumes an earlier transfer of the same image to the same file if
+ *      one was cut short, otherwise replaces the file
+ * @param path
+ *      File to store the image in, shorter than IRIS_IMAGE_PATH_MAX
+ * @param report
+ *      Filled in with the image length, CRC and throughput
+ * @return
+ *      IRIS_HAL_OK if the whole image was stored
+ */
+Iris_HAL_return iris_image_store(const char *path, iris_image_report *report) {
+    image_store_t store = {0};
+    uint32_t image_length;
+    Iris_HAL_return ret;
+
+    memset(report, 0, sizeof(*report));
+    if (strlen(path) >= IRIS_IMAGE_PATH_MAX) {
+        return IRIS_HAL_ERROR;
+    }
+    ret = iris_get_image_length(&image_length);
+    if (ret != IRIS_HAL_OK) {
+        return ret;
+    }
+
+    store.file = open_image(&store, path, image_length);
+    if (store.file == -1) {
+        sys_log(ERROR, "Failed to open or create file to write: '%s'\n", path);
+        return IRIS_HAL_ERROR;
+    }
+    if (store.skip != 0) {
+        sys_log(INFO, "Resuming Iris image '%s' at byte %u of %u", path, store.skip, image_length);
+    }
+
+    TickType_t start = xTaskGetTickCount();
+    ret = iris_transfer_image(image_length, store_chunk, &store);
+    uint32_t elapsed_ms = (xTaskGetTickCount() - start) * portTICK_PERIOD_MS;
+
+    if (ret != IRIS_HAL_OK) {
+        if (store.progress.stored != store.checkpointed) {
+            save_checkpoint(&store);
+        }
+        red_close(store.file);
+        sys_log(ERROR, "Iris image '%s' stopped at byte %u of %u", path, store.progress.stored, image_length);
+        return ret;
+    }
+    if (red_close(store.file) != 0) {
+        sys_log(ERROR, "Failed to close Iris image '%s'\n", path);
+        return IRIS_HAL_ERROR;
+    }
+    if (store.skip != 0 || store.checkpointed != 0) {
+        red_unlink(checkpoint_file);
+    }
+
+    report->image_length = image_length;
+    report->resumed_at = store.skip;
+    report->crc = store.crc;
+    report->elapsed_ms = elapsed_ms;
+    report->bytes_per_s = elapsed_ms ? (uint32_t)((uint64_t)(image_length - store.skip) * 1000 / elapsed_ms) : 0;
+    sys_log(INFO, "Iris image '%s': %u bytes in %u ms, %u B/s, CRC-32 0x%08X", path, image_length, elapsed_ms,
+            report->bytes_per_s, report->crc);
+    return IRIS_HAL_OK;
+}
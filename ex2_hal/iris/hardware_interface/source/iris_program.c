@@ -0,0 +1,361 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file iris_program.c
+ * @date Oct. 19, 2026
+ *
+ * Reprograms the flash of Iris through its I2C bootloader from an image on
+ * the SD card.
+ *
+ * The work runs in its own task so the Iris service can answer status
+ * requests meanwhile. A second task reads the image a chunk at a time into
+ * two buffers, so the next chunk comes off the SD card while the last one is
+ * going over I2C. Each chunk is erased with one command and written in
+ * BL_MAX_TRANSFER byte bursts, and every burst is read back and compared
+ * before the next one is written. Every reply of the bootloader is checked,
+ * and a chunk that fails is erased and written again.
+ *
+ * Every IRIS_PROGRAM_CHECKPOINT_BYTES the progress is saved with a CRC-32 of
+ * the part of the image programmed. A later run of the same image checks
+ * that CRC against the file and carries on from there.
+ */
+
+#include "iris_program.h"
+
+#include "FreeRTOS.h"
+#include "os_queue.h"
+#include "os_semphr.h"
+#include "os_task.h"
+#include <redposix.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "logger.h"
+#include "system.h"
+
+static const char checkpoint_file[] = "VOL0:/IRISprog.CKP";
+
+typedef struct {
+    char path[IRIS_PROGRAM_PATH_MAX];
+    uint32_t image_length;
+    uint32_t programmed; // bytes of the image programmed and verified
+    uint32_t crc;        // CRC-32 of those bytes
+} iris_program_checkpoint_t;
+
+typedef struct {
+    uint8_t buffer;  // index into chunk_buffer
+    uint16_t length; // bytes in the buffer, 0 if the file could not be read
+} chunk_t;
+
+static uint8_t chunk_buffer[2][IRIS_PROGRAM_CHUNK];
+static uint8_t write_buffer[BL_MAX_TRANSFER];
+static uint8_t verify_buffer[BL_MAX_TRANSFER];
+
+static int32_t image_file; // positioned after the part of the image already programmed
+static iris_program_checkpoint_t progress;
+static iris_program_status status;
+
+static QueueHandle_t filled = NULL; // chunks read, for the programmer
+static QueueHandle_t empty = NULL;  // buffers programmed, for the reader
+static SemaphoreHandle_t reader_done = NULL;
+static SemaphoreHandle_t status_lock = NULL;
+static volatile bool stop_reader = false;
+
+static void set_status(iris_program_state state, TickType_t start) {
+    xSemaphoreTake(status_lock, portMAX_DELAY);
+    status.state = state;
+    status.elapsed_ms = (xTaskGetTickCount() - start) * portTICK_PERIOD_MS;
+    status.programmed = progress.programmed;
+    status.crc = progress.crc;
+    xSemaphoreGive(status_lock);
+}
+
+static void save_checkpoint(void) {
+    int32_t fout = red_open(checkpoint_file, RED_O_CREAT | RED_O_TRUNC | RED_O_WRONLY);
+    if (fout == -1) {
+        sys_log(ERROR, "Failed to open or create file to write: '%s'\n", checkpoint_file);
+        return;
+    }
+    if (red_write(fout, &progress, sizeof(progress)) != sizeof(progress)) {
+        sys_log(ERROR, "Failed to write to file: '%s'\n", checkpoint_file);
+    }
+    red_close(fout);
+}
+
+/* Bytes of the image an earlier run already programmed, 0 unless the file still matches what was programmed */
+static uint32_t find_resume_point(void) {
+    iris_program_checkpoint_t saved;
+    uint32_t crc = 0;
+    uint32_t offset = 0;
+
+    int32_t fin = red_open(checkpoint_file, RED_O_RDONLY);
+    if (fin == -1) {
+        return 0;
+    }
+    int32_t read = red_read(fin, &saved, sizeof(saved));
+    red_close(fin);
+    if (read != sizeof(saved) || strncmp(saved.path, progress.path, IRIS_PROGRAM_PATH_MAX) != 0 ||
+        saved.image_length != progress.image_length || saved.programmed > saved.image_length ||
+        saved.programmed % IRIS_PROGRAM_CHUNK != 0) {
+        return 0;
+    }
+
+    while (offset < saved.programmed) {
+        if (red_read(image_file, chunk_buffer[0], IRIS_PROGRAM_CHUNK) != IRIS_PROGRAM_CHUNK) {
+            return 0;
+        }
+        crc = iris_image_crc(crc, chunk_buffer[0], IRIS_PROGRAM_CHUNK);
+        offset += IRIS_PROGRAM_CHUNK;
+    }
+    if (crc != saved.crc) {
+        return 0;
+    }
+    progress.programmed = saved.programmed;
+    progress.crc = saved.crc;
+    return saved.programmed;
+}
+
+/**
+ * @brief
+ *      Reader task, fills the buffers the programmer has finished with
+ * @param void* param
+ * @return None
+ */
+static void iris_sd_reader(void *param) {
+    uint32_t offset = progress.programmed;
+    chunk_t chunk;
+
+    while (offset < progress.image_length && !stop_reader) {
+        if (xQueueReceive(empty, &chunk.buffer, pdMS_TO_TICKS(100)) != pdTRUE) {
+            continue;
+        }
+        uint32_t length = progress.image_length - offset;
+        if (length > IRIS_PROGRAM_CHUNK) {
+            length = IRIS_PROGRAM_CHUNK;
+        }
+        if (red_read(image_file, chunk_buffer[chunk.buffer], length) != (int32_t)length) {
+            sys_log(ERROR, "Failed to read Iris image '%s' at byte %u\n", progress.path, offset);
+            length = 0;
+        }
+        chunk.length = length;
+        xQueueSendToBack(filled, &chunk, 0);
+        if (length == 0) {
+            break;
+        }
+        offset += length;
+    }
+    xSemaphoreGive(reader_done);
+    vTaskDelete(NULL);
+}
+
+/* Erase, write and read back one chunk, trying again if any step fails */
+static Iris_HAL_return program_chunk(uint32_t offset, const uint8_t *data, uint16_t length) {
+    uint16_t first_page = offset / FLASH_MEM_PAGE_SIZE;
+    uint16_t num_pages = (length + FLASH_MEM_PAGE_SIZE - 1) / FLASH_MEM_PAGE_SIZE;
+    uint8_t attempt;
+
+    for (attempt = 0; attempt <= IRIS_PROGRAM_RETRIES; attempt++) {
+        uint16_t done = 0;
+        if (iris_erase_pages(first_page, num_pages) < 0) {
+            continue;
+        }
+        while (done < length) {
+            uint16_t burst = length - done;
+            if (burst > BL_MAX_TRANSFER) {
+                burst = BL_MAX_TRANSFER;
+            }
+            // The bootloader writes whole double words, pad the tail of the image with erased bytes
+            uint16_t padded = (burst + 7) & ~7;
+            memset(write_buffer, 0xFF, padded);
+            memcpy(write_buffer, &data[done], burst);
+
+            uint32_t flash_addr = FLASH_MEM_BASE_ADDR + offset + done;
+            if (iris_write_memory(flash_addr, write_buffer, padded) < 0 ||
+                iris_read_memory(flash_addr, verify_buffer, padded) < 0 ||
+                memcmp(write_buffer, verify_buffer, padded) != 0) {
+                break;
+            }
+            done += burst;
+        }
+        if (done == length) {
+            return IRIS_HAL_OK;
+        }
+        sys_log(WARN, "Iris flash at 0x%08X failed to program or verify, attempt %d", FLASH_MEM_BASE_ADDR + offset,
+                attempt + 1);
+    }
+    return IRIS_HAL_ERROR;
+}
+
+/**
+ * @brief
+ *      Programmer task, writes the chunks the reader fills to Iris
+ * @param void* param
+ * @return None
+ */
+static void iris_programmer(void *param) {
+    uint32_t checkpointed = progress.programmed;
+    TickType_t start = xTaskGetTickCount();
+    Iris_HAL_return ret = IRIS_HAL_OK;
+    chunk_t chunk;
+    uint8_t i;
+
+    xQueueReset(filled);
+    xQueueReset(empty);
+    for (i = 0; i < 2; i++) {
+        xQueueSendToBack(empty, &i, 0);
+    }
+    stop_reader = false;
+    if (xTaskCreate(iris_sd_reader, "iris_sd_read", IRIS_PROGRAM_READER_STACK_SIZE, NULL, IRIS_PROGRAM_TASK_PRIO,
+                    NULL) != pdPASS) {
+        ex2_log("FAILED TO CREATE TASK iris_sd_read\n");
+        red_close(image_file);
+        set_status(IRIS_PROGRAM_FAILED, start);
+        vTaskDelete(NULL);
+    }
+
+    iris_pre_sequence();
+    while (progress.programmed < progress.image_length) {
+        if (xQueueReceive(filled, &chunk, IRIS_PROGRAM_READ_WAIT) != pdTRUE || chunk.length == 0) {
+            ret = IRIS_HAL_ERROR;
+            break;
+        }
+        ret = program_chunk(progress.programmed, chunk_buffer[chunk.buffer], chunk.length);
+        if (ret != IRIS_HAL_OK) {
+            break;
+        }
+        progress.crc = iris_image_crc(progress.crc, chunk_buffer[chunk.buffer], chunk.length);
+        progress.programmed += chunk.length;
+        xQueueSendToBack(empty, &chunk.buffer, 0);
+
+        if (progress.programmed - checkpointed >= IRIS_PROGRAM_CHECKPOINT_BYTES &&
+            progress.programmed < progress.image_length) {
+            save_checkpoint();
+            checkpointed = progress.programmed;
+        }
+        set_status(IRIS_PROGRAM_RUNNING, start);
+    }
+    iris_post_sequence();
+
+    stop_reader = true;
+    xSemaphoreTake(reader_done, portMAX_DELAY);
+    red_close(image_file);
+
+    if (ret != IRIS_HAL_OK) {
+        if (progress.programmed != checkpointed) {
+            save_checkpoint();
+        }
+        sys_log(ERROR, "Iris programming from '%s' stopped at byte %u of %u", progress.path, progress.programmed,
+                progress.image_length);
+        set_status(IRIS_PROGRAM_FAILED, start);
+    } else {
+        red_unlink(checkpoint_file);
+        set_status(IRIS_PROGRAM_DONE, start);
+        sys_log(INFO, "Iris programmed from '%s': %u bytes in %u ms, CRC-32 0x%08X", progress.path,
+                progress.image_length, status.elapsed_ms, progress.crc);
+    }
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief
+ *      Start reprogramming Iris from an image file
+ * @details
+ *      Returns once the programming task is running. Resumes an earlier
+ *      run of the same image if one was cut short
+ * @param path
+ *      File holding the image, shorter than IRIS_PROGRAM_PATH_MAX
+ * @return
+ *      IRIS_HAL_ERROR if already programming or the file is unusable
+ */
+Iris_HAL_return iris_program_start(const char *path) {
+    if (status_lock == NULL) {
+        status_lock = xSemaphoreCreateMutex();
+        filled = xQueueCreate(2, sizeof(chunk_t));
+        empty = xQueueCreate(2, sizeof(uint8_t));
+        reader_done = xSemaphoreCreateBinary();
+        if (status_lock == NULL || filled == NULL || empty == NULL || reader_done == NULL) {
+            return IRIS_HAL_ERROR;
+        }
+    }
+    if (status.state == IRIS_PROGRAM_RUNNING || strlen(path) >= IRIS_PROGRAM_PATH_MAX) {
+        return IRIS_HAL_ERROR;
+    }
+
+    image_file = red_open(path, RED_O_RDONLY);
+    if (image_file == -1) {
+        sys_log(ERROR, "Failed to open file to read: '%s'\n", path);
+        return IRIS_HAL_ERROR;
+    }
+    int64_t image_length = red_lseek(image_file, 0, RED_SEEK_END);
+    if (image_length <= 0 || image_length > IRIS_PROGRAM_MAX_SIZE || red_lseek(image_file, 0, RED_SEEK_SET) != 0) {
+        sys_log(ERROR, "Iris image '%s' is empty or larger than the flash", path);
+        red_close(image_file);
+        return IRIS_HAL_ERROR;
+    }
+
+    memset(&progress, 0, sizeof(progress));
+    strncpy(progress.path, path, IRIS_PROGRAM_PATH_MAX - 1);
+    progress.image_length = (uint32_t)image_length;
+    uint32_t resumed_at = find_resume_point();
+    if (red_lseek(image_file, resumed_at, RED_SEEK_SET) != (int64_t)resumed_at) {
+        red_close(image_file);
+        return IRIS_HAL_ERROR;
+    }
+    if (resumed_at != 0) {
+        sys_log(INFO, "Resuming Iris programming from '%s' at byte %u of %u", path, resumed_at,
+                progress.image_length);
+    }
+
+    xSemaphoreTake(status_lock, portMAX_DELAY);
+    memset(&status, 0, sizeof(status));
+    status.state = IRIS_PROGRAM_RUNNING;
+    status.image_length = progress.image_length;
+    status.programmed = progress.programmed;
+    status.resumed_at = resumed_at;
+    status.crc = progress.crc;
+    xSemaphoreGive(status_lock);
+
+    if (xTaskCreate(iris_programmer, "iris_program", IRIS_PROGRAM_STACK_SIZE, NULL, IRIS_PROGRAM_TASK_PRIO,
+                    NULL) != pdPASS) {
+        ex2_log("FAILED TO CREATE TASK iris_program\n");
+        red_close(image_file);
+        set_status(IRIS_PROGRAM_FAILED, xTaskGetTickCount());
+        return IRIS_HAL_ERROR;
+    }
+    return IRIS_HAL_OK;
+}
+
+/**
+ * @brief
+ *      Copy out the progress of the current or last programming run
+ * @param out
+ *      Where to copy the status
+ */
+void iris_program_get_status(iris_program_status *out) {
+    if (status_lock == NULL) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    xSemaphoreTake(status_lock, portMAX_DELAY);
+    *out = status;
+    xSemaphoreGive(status_lock);
+}
+
+/**
+ * @brief
+ *      Check whether a programming run holds the Iris bus
+ * @return
+ *      true from iris_program_start until the programming task finishes
+ */
+bool iris_program_running(void) { return status.state == IRIS_PROGRAM_RUNNING; }
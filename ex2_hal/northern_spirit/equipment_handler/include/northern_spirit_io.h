@@ -26,11 +26,15 @@
 #define NS_SEMAPHORE_TIMEOUT_MS pdMS_TO_TICKS(500)
 #define NS_UART_TIMEOUT_MS pdMS_TO_TICKS(1000)
 #define NS_UART_LONG_TIMEOUT_MS pdMS_TO_TICKS(5000)
+/* Time to send length bytes, about a millisecond each at 9600 baud */
+#define NS_TX_TIMEOUT(length) (NS_SEMAPHORE_TIMEOUT_MS + pdMS_TO_TICKS(2 * (length)))
 
 NS_return init_ns_io();
 
 NS_return NS_sendAndReceive(uint8_t *command, uint32_t command_length, uint8_t *answer, uint8_t answer_length);
 NS_return NS_sendOnly(uint8_t *command, uint32_t command_length);
+NS_return NS_sendStart(uint8_t *data, uint32_t length);
+NS_return NS_sendFinish(uint32_t length);
 NS_return NS_expectResponse(uint8_t *response, uint8_t length);
 void NS_resetQueue(void);
 
@@ -31,6 +31,7 @@
 
 #include "system.h"
 #include "northern_spirit_io.h"
+#include "mem_pool/mem_pool.h"
 #include "os_queue.h"
 #include "os_semphr.h"
 #include <stdbool.h>
@@ -95,7 +96,7 @@ NS_return NS_sendAndReceive(uint8_t *command, uint32_t command_length, uint8_t *
     }
 
     uint8_t received = 0;
-    uint8_t *reply = (uint8_t *)pvPortMalloc(answer_length * sizeof(uint8_t));
+    uint8_t *reply = (uint8_t *)pool_malloc(answer_length * sizeof(uint8_t));
 
     if (reply == NULL) {
         xQueueReset(nsQueue);
@@ -105,7 +106,7 @@ NS_return NS_sendAndReceive(uint8_t *command, uint32_t command_length, uint8_t *
 
     while (received < answer_length) {
         if (xQueueReceive(nsQueue, (reply + received), NS_UART_TIMEOUT_MS) != pdPASS) {
-            vPortFree(reply);
+            pool_free(reply);
             xSemaphoreGive(uart_mutex);
             return NS_UART_FAIL;
         } else {
@@ -115,7 +116,7 @@ NS_return NS_sendAndReceive(uint8_t *command, uint32_t command_length, uint8_t *
     xQueueReset(nsQueue);
     memcpy(answer, reply, answer_length);
 
-    vPortFree(reply);
+    pool_free(reply);
     xSemaphoreGive(uart_mutex);
     return NS_OK;
 }
@@ -135,6 +136,25 @@ NS_return NS_sendOnly(uint8_t *command, uint32_t command_length) {
     return NS_OK;
 }
 
+/* Starts sending from an interrupt and keeps the UART, data must stay untouched until NS_sendFinish */
+NS_return NS_sendStart(uint8_t *data, uint32_t length) {
+    if (xSemaphoreTake(uart_mutex, NS_SEMAPHORE_TIMEOUT_MS) != pdTRUE) {
+        return NS_UART_BUSY;
+    }
+    sciSend(PAYLOAD_SCI, length, data);
+    return NS_OK;
+}
+
+/* Waits for the data given to NS_sendStart to go out and releases the UART */
+NS_return NS_sendFinish(uint32_t length) {
+    NS_return ret = NS_OK;
+    if (xSemaphoreTake(ns_tx_semphr, NS_TX_TIMEOUT(length)) != pdTRUE) {
+        ret = NS_UART_FAIL;
+    }
+    xSemaphoreGive(uart_mutex);
+    return ret;
+}
+
 NS_return NS_expectResponse(uint8_t *response, uint8_t length) {
     if (xSemaphoreTake(uart_mutex, NS_SEMAPHORE_TIMEOUT_MS) != pdTRUE) {
         return NS_UART_BUSY;
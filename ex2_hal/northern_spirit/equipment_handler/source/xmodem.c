@@ -35,10 +35,36 @@
  */
 
 #include "xmodem.h"
+#include "base_64.h"
 #include "northern_spirit_io.h"
+#include "service_dispatcher.h"
+#include <stdbool.h>
 #include <string.h>
 #include <redposix.h>
 
+/* CRC16 implementation acording to CCITT standards */
+
+static const unsigned short crc16tab[256] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7, 0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad,
+    0xe1ce, 0xf1ef, 0x1231, 0x0210, 0x3273, 0x2252, 0x52b5, 0x4294, 0x72f7, 0x62d6, 0x9339, 0x8318, 0xb37b, 0xa35a,
+    0xd3bd, 0xc39c, 0xf3ff, 0xe3de, 0x2462, 0x3443, 0x0420, 0x1401, 0x64e6, 0x74c7, 0x44a4, 0x5485, 0xa56a, 0xb54b,
+    0x8528, 0x9509, 0xe5ee, 0xf5cf, 0xc5ac, 0xd58d, 0x3653, 0x2672, 0x1611, 0x0630, 0x76d7, 0x66f6, 0x5695, 0x46b4,
+    0xb75b, 0xa77a, 0x9719, 0x8738, 0xf7df, 0xe7fe, 0xd79d, 0xc7bc, 0x48c4, 0x58e5, 0x6886, 0x78a7, 0x0840, 0x1861,
+    0x2802, 0x3823, 0xc9cc, 0xd9ed, 0xe98e, 0xf9af, 0x8948, 0x9969, 0xa90a, 0xb92b, 0x5af5, 0x4ad4, 0x7ab7, 0x6a96,
+    0x1a71, 0x0a50, 0x3a33, 0x2a12, 0xdbfd, 0xcbdc, 0xfbbf, 0xeb9e, 0x9b79, 0x8b58, 0xbb3b, 0xab1a, 0x6ca6, 0x7c87,
+    0x4ce4, 0x5cc5, 0x2c22, 0x3c03, 0x0c60, 0x1c41, 0xedae, 0xfd8f, 0xcdec, 0xddcd, 0xad2a, 0xbd0b, 0x8d68, 0x9d49,
+    0x7e97, 0x6eb6, 0x5ed5, 0x4ef4, 0x3e13, 0x2e32, 0x1e51, 0x0e70, 0xff9f, 0xefbe, 0xdfdd, 0xcffc, 0xbf1b, 0xaf3a,
+    0x9f59, 0x8f78, 0x9188, 0x81a9, 0xb1ca, 0xa1eb, 0xd10c, 0xc12d, 0xf14e, 0xe16f, 0x1080, 0x00a1, 0x30c2, 0x20e3,
+    0x5004, 0x4025, 0x7046, 0x6067, 0x83b9, 0x9398, 0xa3fb, 0xb3da, 0xc33d, 0xd31c, 0xe37f, 0xf35e, 0x02b1, 0x1290,
+    0x22f3, 0x32d2, 0x4235, 0x5214, 0x6277, 0x7256, 0xb5ea, 0xa5cb, 0x95a8, 0x8589, 0xf56e, 0xe54f, 0xd52c, 0xc50d,
+    0x34e2, 0x24c3, 0x14a0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405, 0xa7db, 0xb7fa, 0x8799, 0x97b8, 0xe75f, 0xf77e,
+    0xc71d, 0xd73c, 0x26d3, 0x36f2, 0x0691, 0x16b0, 0x6657, 0x7676, 0x4615, 0x5634, 0xd94c, 0xc96d, 0xf90e, 0xe92f,
+    0x99c8, 0x89e9, 0xb98a, 0xa9ab, 0x5844, 0x4865, 0x7806, 0x6827, 0x18c0, 0x08e1, 0x3882, 0x28a3, 0xcb7d, 0xdb5c,
+    0xeb3f, 0xfb1e, 0x8bf9, 0x9bd8, 0xabbb, 0xbb9a, 0x4a75, 0x5a54, 0x6a37, 0x7a16, 0x0af1, 0x1ad0, 0x2ab3, 0x3a92,
+    0xfd2e, 0xed0f, 0xdd6c, 0xcd4d, 0xbdaa, 0xad8b, 0x9de8, 0x8dc9, 0x7c26, 0x6c07, 0x5c64, 0x4c45, 0x3ca2, 0x2c83,
+    0x1ce0, 0x0cc1, 0xef1f, 0xff3e, 0xcf5d, 0xdf7c, 0xaf9b, 0xbfba, 0x8fd9, 0x9ff8, 0x6e17, 0x7e36, 0x4e55, 0x5e74,
+    0x2e93, 0x3eb2, 0x0ed1, 0x1ef0};
+
 int _inbyte(unsigned short timeout) {
     uint8_t b;
     if (NS_expectResponse(&b, 1) == NS_OK) {
@@ -53,10 +79,11 @@ void _outbyte(int c) {
 }
 
 unsigned short crc16_ccitt(const void *buf, int len) {
-    register int counter;
-    register unsigned short crc = 0;
+    const unsigned char *data = buf;
+    unsigned short crc = 0;
+    int counter;
     for (counter = 0; counter < len; counter++)
-        crc = (crc << 8) ^ crc16tab[((crc >> 8) ^ *(char *)buf++) & 0x00FF];
+        crc = (crc << 8) ^ crc16tab[((crc >> 8) ^ data[counter]) & 0x00FF];
     return crc;
 }
 
@@ -169,122 +196,163 @@ int xmodemReceive(unsigned char *dest, int destsz) {
     }
 }
 
-int xmodemTransmit(int32_t filedes, uint64_t filesz) {
-#ifdef TRANSMIT_XMODEM_1K
-    unsigned char xbuff[1030]; /* 1024 for XModem 1k + 3 head chars + 2 crc + nul */
-#else
-    unsigned char xbuff[134]; /* 128 for XModem + 3 head chars + 2 crc + nul */
-#endif
+typedef struct {
+    unsigned char frame[XMODEM_1K_BLOCK_SIZE + 5]; /* 3 head chars + data + 2 crc */
+    int frame_length; /* bytes to send, 0 past the end of the file */
+    int file_bytes;   /* bytes of the file the block carries */
+} xmodem_block;
+
+/* One block is on the wire while the next is read from the file into the other */
+static xmodem_block blocks[2];
+
+/* Read the next part of the file into a block, returns the bytes read or -1 if the file can't be read */
+static int prepare_block(xmodem_block *block, int32_t filedes, uint64_t remaining, unsigned char packetno,
+                         int bufsz, int crc) {
+    static unsigned char file_data[XMODEM_FILE_BYTES(XMODEM_1K_BLOCK_SIZE)];
+    int32_t want = XMODEM_FILE_BYTES(bufsz);
+    int i, c;
+
+    if (remaining < (uint64_t)want)
+        want = remaining;
+    block->frame_length = 0;
+    block->file_bytes = 0;
+    if (want == 0)
+        return 0;
+
+    int32_t got = red_read(filedes, file_data, want);
+    if (got <= 0)
+        return got == 0 ? 0 : -1;
 
+    block->frame[0] = bufsz == XMODEM_1K_BLOCK_SIZE ? STX : SOH;
+    block->frame[1] = packetno;
+    block->frame[2] = ~packetno;
+    memset(&block->frame[3], 0, bufsz);
+    c = base64_encode_to(file_data, got, (char *)&block->frame[3]);
+    if (c < bufsz)
+        block->frame[3 + c] = CTRLZ;
+    if (crc) {
+        unsigned short ccrc = crc16_ccitt(&block->frame[3], bufsz);
+        block->frame[bufsz + 3] = (ccrc >> 8) & 0xFF;
+        block->frame[bufsz + 4] = ccrc & 0xFF;
+    } else {
+        unsigned char ccks = 0;
+        for (i = 3; i < bufsz + 3; ++i) {
+            ccks += block->frame[i];
+        }
+        block->frame[bufsz + 3] = ccks;
+    }
+    block->frame_length = bufsz + 4 + (crc ? 1 : 0);
+    block->file_bytes = got;
+    return got;
+}
+
+/*
+ * Sends a file, returns the bytes of the file sent or <0 on failure.
+ *
+ * A receiver asking for CRC-16 gets XMODEM-1K blocks unless TRANSMIT_XMODEM_1K
+ * is 0, one asking for a checksum gets 128 byte blocks. A receiver that NAKs
+ * the first 1K block may not know XMODEM-1K, so that block and the rest are
+ * sent as 128 byte blocks. Later 1K blocks are sent again on a NAK, and only
+ * fall back once one has been NAKed XMODEM_1K_NAK_LIMIT times. Each block
+ * goes out in one sciSend, and the next block is read and encoded while it
+ * is on the wire.
+ */
+int xmodemTransmit(int32_t filedes, uint64_t filesz) {
     int bufsz, crc = -1;
     unsigned char packetno = 1;
-    int i, c, len = 0;
+    int c, len = 0;
     int retry;
+    int cur = 0;
 
-    for (;;) {
-        for (retry = 0; retry < 16; ++retry) {
-            if ((c = _inbyte((DLY_1S) << 1)) >= 0) {
-                switch (c) {
-                case 'C':
-                    crc = 1;
-                    goto start_trans;
-                case NAK:
-                    crc = 0;
-                    goto start_trans;
-                case CAN:
-                    if ((c = _inbyte(DLY_1S)) == CAN) {
-                        _outbyte(ACK);
-                        flushinput();
-                        return -1; /* canceled by remote */
-                    }
-                    break;
-                default:
-                    break;
+    for (retry = 0; retry < 16; ++retry) {
+        if ((c = _inbyte((DLY_1S) << 1)) >= 0) {
+            switch (c) {
+            case 'C':
+                crc = 1;
+                goto start_trans;
+            case NAK:
+                crc = 0;
+                goto start_trans;
+            case CAN:
+                if ((c = _inbyte(DLY_1S)) == CAN) {
+                    _outbyte(ACK);
+                    flushinput();
+                    return -1; /* canceled by remote */
                 }
+                break;
+            default:
+                break;
             }
         }
-        _outbyte(CAN);
-        _outbyte(CAN);
-        _outbyte(CAN);
-        flushinput();
-        return -2; /* no sync */
+    }
+    _outbyte(CAN);
+    _outbyte(CAN);
+    _outbyte(CAN);
+    flushinput();
+    return -2; /* no sync */
 
-        for (;;) {
-        start_trans:
-#ifdef TRANSMIT_XMODEM_1K
-            xbuff[0] = STX;
-            bufsz = 1024;
-#else
-            xbuff[0] = SOH;
-            bufsz = 128;
-#endif
-            xbuff[1] = packetno;
-            xbuff[2] = ~packetno;
-            c = filesz - len;
+start_trans:
+    bufsz = crc && TRANSMIT_XMODEM_1K ? XMODEM_1K_BLOCK_SIZE : XMODEM_BLOCK_SIZE;
+    if (prepare_block(&blocks[cur], filedes, filesz, packetno, bufsz, crc) < 0)
+        return -1;
 
-            if (c > bufsz)
-                c = bufsz;
-            if (c > 0) {
-                // Transmit next xmodem packet
-                memset(&xbuff[3], 0, bufsz);
-                int32_t iErr = red_read(filedes, xbuff, 96);
-                if (iErr == -1) {
-                    return iErr;
-                } else {
-                    char *temp = base64_encode(xbuff, iErr, &c);
-                    memcpy(xbuff, temp, c);
-                }
-                if (c < bufsz)
-                    xbuff[3 + c] = CTRLZ;
-                if (crc) {
-                    unsigned short ccrc = crc16_ccitt(&xbuff[3], bufsz);
-                    xbuff[bufsz + 3] = (ccrc >> 8) & 0xFF;
-                    xbuff[bufsz + 4] = ccrc & 0xFF;
-                } else {
-                    unsigned char ccks = 0;
-                    for (i = 3; i < bufsz + 3; ++i) {
-                        ccks += xbuff[i];
-                    }
-                    xbuff[bufsz + 3] = ccks;
-                }
-                for (retry = 0; retry < MAXRETRANS; ++retry) {
-                    for (i = 0; i < bufsz + 4 + (crc ? 1 : 0); ++i) {
-                        _outbyte(xbuff[i]);
-                    }
-                    if ((c = _inbyte(DLY_1S)) >= 0) {
-                        switch (c) {
-                        case ACK:
-                            ++packetno;
-                            len += bufsz;
-                            goto start_trans;
-                        case CAN:
-                            if ((c = _inbyte(DLY_1S)) == CAN) {
-                                _outbyte(ACK);
-                                flushinput();
-                                return -1; /* canceled by remote */
-                            }
-                            break;
-                        case NAK:
-                        default:
-                            break;
-                        }
-                    }
-                }
-                _outbyte(CAN);
-                _outbyte(CAN);
-                _outbyte(CAN);
-                flushinput();
-                return -4; /* xmit error */
-            } else {
-                // Reached end of transmission
-                for (retry = 0; retry < 10; ++retry) {
-                    _outbyte(EOT);
-                    if ((c = _inbyte((DLY_1S) << 1)) == ACK)
-                        break;
-                }
+    while (blocks[cur].frame_length > 0) {
+        xmodem_block *block = &blocks[cur];
+        bool prepared = false;
+        int next = 0;
+        int naks = 0;
+
+        for (retry = 0; retry < MAXRETRANS; ++retry) {
+            bool sending = NS_sendStart(block->frame, block->frame_length) == NS_OK;
+            if (!prepared) {
+                // Read ahead while the UART sends this block
+                next = prepare_block(&blocks[cur ^ 1], filedes, filesz - len - block->file_bytes,
+                                     (unsigned char)(packetno + 1), bufsz, crc);
+                prepared = true;
+            }
+            if (!sending || NS_sendFinish(block->frame_length) != NS_OK)
+                continue;
+
+            if ((c = _inbyte(DLY_1S)) == ACK)
+                break;
+            if (c == NAK && bufsz == XMODEM_1K_BLOCK_SIZE && next >= 0 &&
+                (len == 0 || ++naks >= XMODEM_1K_NAK_LIMIT)) {
+                // Go back to the start of this block and send it again as a 128 byte block
+                bufsz = XMODEM_BLOCK_SIZE;
+                if (red_lseek(filedes, -(int64_t)(block->file_bytes + next), RED_SEEK_CUR) < 0 ||
+                    prepare_block(block, filedes, filesz - len, packetno, bufsz, crc) < 0)
+                    return -1;
+                prepared = false;
+                continue;
+            }
+            if (c == CAN && (c = _inbyte(DLY_1S)) == CAN) {
+                _outbyte(ACK);
                 flushinput();
-                return (c == ACK) ? len : -5;
+                return -1; /* canceled by remote */
             }
         }
+        if (retry == MAXRETRANS) {
+            _outbyte(CAN);
+            _outbyte(CAN);
+            _outbyte(CAN);
+            flushinput();
+            return -4; /* xmit error */
+        }
+        if (next < 0)
+            return -1;
+        // An upload runs on a service worker for as long as the file takes
+        service_dispatcher_feed();
+        ++packetno;
+        len += block->file_bytes;
+        cur ^= 1;
+    }
+
+    // Reached end of transmission
+    for (retry = 0; retry < 10; ++retry) {
+        _outbyte(EOT);
+        if ((c = _inbyte((DLY_1S) << 1)) == ACK)
+            break;
     }
+    flushinput();
+    return (c == ACK) ? len : -5;
 }
@@ -19,6 +19,7 @@
  */
 
 #include "sTransmitter.h"
+#include "calibration/calibration.h"
 #include <stdint.h>
 #include "HL_i2c.h"
 #include "i2c_io.h"
@@ -99,16 +100,7 @@ uint16_t append_bytes(uint8_t b1, uint8_t b2) {
  *      Returns temperature in degrees Celsius
  */
 float calculateTemp(uint16_t b) {
-    float temperature = 0;
-    b = b >> S_TEMP_BITSHIFT;
-
-    // Check signed bit
-    if (b & 0b100000000000) {
-        temperature = -S_TEMP_SCALING * (float)((~b & S_TEMP_BITMASK) + 1);
-    } else {
-        temperature = S_TEMP_SCALING * (float)(b & S_TEMP_BITMASK);
-    }
-    return temperature;
+    return (float)calibration_convert(&cal_temp12_ten_thousandth_c, b) / 10000;
 }
 
 /**
@@ -42,6 +42,8 @@ typedef enum {
 
     GET_NS_PAYLOAD_WATCHDOG_TIMEOUT = 12,
     SET_NS_PAYLOAD_WATCHDOG_TIMEOUT = 13,
+
+    GET_TASK_STATS = 14,
 } General_Subtype;
 
 typedef enum { bootloader = 'B', golden = 'G', application = 'A' } reboot_mode;
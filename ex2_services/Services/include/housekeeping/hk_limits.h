@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file hk_limits.h
+ * @date Oct. 19, 2026
+ */
+
+#ifndef HK_LIMITS_H
+#define HK_LIMITS_H
+
+#include <stdint.h>
+
+#include "housekeeping/housekeeping_service.h"
+
+#define HK_LIMIT_COUNT 16
+
+/* Longest "section.name" of a recorded field, with its terminator */
+#define HK_LIMIT_FIELD_LEN 36
+
+typedef struct __attribute__((packed)) {
+    char field[HK_LIMIT_FIELD_LEN]; // recorded field as "section.name", e.g. "EPS_hk.vBatt"
+    uint8_t element;                // array element, 0 for scalars
+    uint8_t enabled;                // 0 to ignore this slot
+    float low;                      // trips below this value
+    float high;                     // trips above this value
+    float max_rate;                 // trips when the value changes by more than this per second, 0 to not check
+} hk_limit_t;
+
+uint32_t hk_limits_check(const All_systems_housekeeping *hk);
+
+Result hk_limits_set(uint8_t index, const hk_limit_t *limit);
+
+void hk_limits_get(hk_limit_t limits[HK_LIMIT_COUNT]);
+
+#endif /* HK_LIMITS_H */
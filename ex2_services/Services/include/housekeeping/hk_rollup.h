@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file hk_rollup.h
+ * @date Oct. 19, 2026
+ */
+
+#ifndef HK_ROLLUP_H
+#define HK_ROLLUP_H
+
+#include <csp/csp.h>
+#include <stdint.h>
+
+#include "housekeeping/housekeeping_service.h"
+
+typedef enum {
+    HK_ROLLUP_5MIN = 0,
+    HK_ROLLUP_1HOUR = 1,
+    HK_ROLLUP_1DAY = 2,
+    HK_ROLLUP_LEVELS
+} hk_rollup_resolution;
+
+typedef enum {
+    HK_ROLLUP_MIN = 0,
+    HK_ROLLUP_MAX = 1,
+    HK_ROLLUP_MEAN = 2,
+    HK_ROLLUP_LAST = 3,
+    HK_ROLLUP_STATS
+} hk_rollup_stat;
+
+/* Reply layout: subservice, status, resolution, statistic, then one housekeeping record */
+#define HK_ROLLUP_RESOLUTION_BYTE 2
+#define HK_ROLLUP_STAT_BYTE 3
+#define HK_ROLLUP_RECORD_BYTE 4
+
+void hk_rollup_add(const All_systems_housekeeping *hk);
+
+Result hk_rollup_transmit(csp_conn_t *conn, uint8_t resolution, uint32_t start, uint32_t end);
+
+#endif /* HK_ROLLUP_H */
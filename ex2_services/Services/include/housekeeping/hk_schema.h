@@ -0,0 +1,332 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file hk_schema.h
+ * @date Oct. 19, 2026
+ */
+
+#ifndef HK_SCHEMA_H
+#define HK_SCHEMA_H
+
+#include <stdint.h>
+
+typedef enum { HK_U8, HK_I8, HK_U16, HK_I16, HK_U32, HK_I32, HK_F32, HK_F64 } hk_type_t;
+
+typedef enum { HK_BIG_ENDIAN, HK_LITTLE_ENDIAN } hk_byte_order_t;
+
+/*
+ * One list per subsystem struct, in struct order. Each entry is
+ * X(m, o, field, type, count) where m and o are the section member and byte
+ * order passed through from HK_RECORD_SECTIONS. Adding a field to a struct
+ * without adding it here fails the size check in hk_schema.c
+ */
+#define HK_TIMEORDER_FIELDS(X, m, o)                                                                              \
+    X(m, o, final, HK_U8, 1)                                                                                      \
+    X(m, o, UNIXtimestamp, HK_U32, 1)                                                                             \
+    X(m, o, dataPosition, HK_U16, 1)
+
+#define HK_ADCS_FIELDS(X, m, o)                                                                                   \
+    X(m, o, Estimated_Angular_Rate_X, HK_F32, 1)                                                                  \
+    X(m, o, Estimated_Angular_Rate_Y, HK_F32, 1)                                                                  \
+    X(m, o, Estimated_Angular_Rate_Z, HK_F32, 1)                                                                  \
+    X(m, o, Estimated_Angular_Angle_X, HK_F32, 1)                                                                 \
+    X(m, o, Estimated_Angular_Angle_Y, HK_F32, 1)                                                                 \
+    X(m, o, Estimated_Angular_Angle_Z, HK_F32, 1)                                                                 \
+    X(m, o, Sat_Position_ECI_X, HK_F32, 1)                                                                        \
+    X(m, o, Sat_Position_ECI_Y, HK_F32, 1)                                                                        \
+    X(m, o, Sat_Position_ECI_Z, HK_F32, 1)                                                                        \
+    X(m, o, Sat_Velocity_ECI_X, HK_F32, 1)                                                                        \
+    X(m, o, Sat_Velocity_ECI_Y, HK_F32, 1)                                                                        \
+    X(m, o, Sat_Velocity_ECI_Z, HK_F32, 1)                                                                        \
+    X(m, o, Sat_Position_LLH_X, HK_F32, 1)                                                                        \
+    X(m, o, Sat_Position_LLH_Y, HK_F32, 1)                                                                        \
+    X(m, o, Sat_Position_LLH_Z, HK_F32, 1)                                                                        \
+    X(m, o, ECEF_Position_X, HK_I16, 1)                                                                           \
+    X(m, o, ECEF_Position_Y, HK_I16, 1)                                                                           \
+    X(m, o, ECEF_Position_Z, HK_I16, 1)                                                                           \
+    X(m, o, Coarse_Sun_Vector_X, HK_F32, 1)                                                                       \
+    X(m, o, Coarse_Sun_Vector_Y, HK_F32, 1)                                                                       \
+    X(m, o, Coarse_Sun_Vector_Z, HK_F32, 1)                                                                       \
+    X(m, o, Fine_Sun_Vector_X, HK_F32, 1)                                                                         \
+    X(m, o, Fine_Sun_Vector_Y, HK_F32, 1)                                                                         \
+    X(m, o, Fine_Sun_Vector_Z, HK_F32, 1)                                                                         \
+    X(m, o, Nadir_Vector_X, HK_F32, 1)                                                                            \
+    X(m, o, Nadir_Vector_Y, HK_F32, 1)                                                                            \
+    X(m, o, Nadir_Vector_Z, HK_F32, 1)                                                                            \
+    X(m, o, Wheel_Speed_X, HK_F32, 1)                                                                             \
+    X(m, o, Wheel_Speed_Y, HK_F32, 1)                                                                             \
+    X(m, o, Wheel_Speed_Z, HK_F32, 1)                                                                             \
+    X(m, o, Mag_Field_Vector_X, HK_F32, 1)                                                                        \
+    X(m, o, Mag_Field_Vector_Y, HK_F32, 1)                                                                        \
+    X(m, o, Mag_Field_Vector_Z, HK_F32, 1)                                                                        \
+    X(m, o, TC_num, HK_U16, 1)                                                                                    \
+    X(m, o, TM_num, HK_U16, 1)                                                                                    \
+    X(m, o, CommsStat_flags, HK_U8, 6)                                                                            \
+    X(m, o, Wheel1_Current, HK_F32, 1)                                                                            \
+    X(m, o, Wheel2_Current, HK_F32, 1)                                                                            \
+    X(m, o, Wheel3_Current, HK_F32, 1)                                                                            \
+    X(m, o, CubeSense1_Current, HK_F32, 1)                                                                        \
+    X(m, o, CubeSense2_Current, HK_F32, 1)                                                                        \
+    X(m, o, CubeControl_Current3v3, HK_F32, 1)                                                                    \
+    X(m, o, CubeControl_Current5v0, HK_F32, 1)                                                                    \
+    X(m, o, CubeStar_Current, HK_F32, 1)                                                                          \
+    X(m, o, CubeStar_Temp, HK_F32, 1)                                                                             \
+    X(m, o, Magnetorquer_Current, HK_F32, 1)                                                                      \
+    X(m, o, MCU_Temp, HK_F32, 1)                                                                                  \
+    X(m, o, Rate_Sensor_Temp_X, HK_I16, 1)                                                                        \
+    X(m, o, Rate_Sensor_Temp_Y, HK_I16, 1)                                                                        \
+    X(m, o, Rate_Sensor_Temp_Z, HK_I16, 1)
+
+#define HK_ATHENA_FIELDS(X, m, o)                                                                                 \
+    X(m, o, temparray, HK_I32, ATHENA_TEMP_ARRAY_SIZE)                                                            \
+    X(m, o, boot_cnt, HK_U16, 1)                                                                                  \
+    X(m, o, last_reset_reason, HK_U8, 1)                                                                          \
+    X(m, o, OBC_mode, HK_U8, 1)                                                                                   \
+    X(m, o, OBC_uptime, HK_U16, 1)                                                                                \
+    X(m, o, solar_panel_supply_curr, HK_U8, 1)                                                                    \
+    X(m, o, OBC_software_ver, HK_U8, 1)                                                                           \
+    X(m, o, cmds_received, HK_U16, 1)                                                                             \
+    X(m, o, pckts_uncovered_by_FEC, HK_U16, 1)
+
+#define HK_EPS_FIELDS(X, m, o)                                                                                    \
+    X(m, o, cmd, HK_U8, 1)                                                                                        \
+    X(m, o, status, HK_I8, 1)                                                                                     \
+    X(m, o, timestampInS, HK_F64, 1)                                                                              \
+    X(m, o, uptimeInS, HK_U32, 1)                                                                                 \
+    X(m, o, bootCnt, HK_U32, 1)                                                                                   \
+    X(m, o, wdt_gs_time_left, HK_U32, 1)                                                                          \
+    X(m, o, wdt_gs_counter, HK_U32, 1)                                                                            \
+    X(m, o, mpptConverterVoltage, HK_U16, 4)                                                                      \
+    X(m, o, curSolarPanels, HK_U16, 8)                                                                            \
+    X(m, o, vBatt, HK_U16, 1)                                                                                     \
+    X(m, o, curSolar, HK_U16, 1)                                                                                  \
+    X(m, o, curBattIn, HK_U16, 1)                                                                                 \
+    X(m, o, curBattOut, HK_U16, 1)                                                                                \
+    X(m, o, curOutput, HK_U16, 18)                                                                                \
+    X(m, o, AOcurOutput, HK_U16, 2)                                                                               \
+    X(m, o, OutputConverterVoltage, HK_U16, 8)                                                                    \
+    X(m, o, outputConverterState, HK_U8, 1)                                                                       \
+    X(m, o, outputStatus, HK_U32, 1)                                                                              \
+    X(m, o, outputFaultStatus, HK_U32, 1)                                                                         \
+    X(m, o, protectedOutputAccessCnt, HK_U16, 1)                                                                  \
+    X(m, o, outputOnDelta, HK_U16, 18)                                                                            \
+    X(m, o, outputOffDelta, HK_U16, 18)                                                                           \
+    X(m, o, outputFaultCnt, HK_U8, 18)                                                                            \
+    X(m, o, temp, HK_I8, 14)                                                                                      \
+    X(m, o, battMode, HK_U8, 1)                                                                                   \
+    X(m, o, mpptMode, HK_U8, 1)                                                                                   \
+    X(m, o, batHeaterMode, HK_U8, 1)                                                                              \
+    X(m, o, batHeaterState, HK_U8, 1)                                                                             \
+    X(m, o, PingWdt_toggles, HK_U16, 1)                                                                           \
+    X(m, o, PingWdt_turnOffs, HK_U8, 1)
+
+#define HK_EPS_STARTUP_FIELDS(X, m, o)                                                                            \
+    X(m, o, cmd, HK_U8, 1)                                                                                        \
+    X(m, o, status, HK_I8, 1)                                                                                     \
+    X(m, o, timestamp, HK_F64, 1)                                                                                 \
+    X(m, o, last_reset_reason_reg, HK_U32, 1)                                                                     \
+    X(m, o, bootCnt, HK_U32, 1)                                                                                   \
+    X(m, o, FallbackConfigUsed, HK_U8, 1)                                                                         \
+    X(m, o, rtcInit, HK_U8, 1)                                                                                    \
+    X(m, o, rtcClkSourceLSE, HK_U8, 1)                                                                            \
+    X(m, o, Fram4kPartitionInit, HK_I8, 1)                                                                        \
+    X(m, o, Fram520kPartitionInit, HK_I8, 1)                                                                      \
+    X(m, o, intFlashPartitionInit, HK_I8, 1)                                                                      \
+    X(m, o, FSInit, HK_I8, 1)                                                                                     \
+    X(m, o, FTInit, HK_I8, 1)                                                                                     \
+    X(m, o, supervisorInit, HK_I8, 1)                                                                             \
+    X(m, o, uart1App, HK_U8, 1)                                                                                   \
+    X(m, o, uart2App, HK_U8, 1)                                                                                   \
+    X(m, o, tmp107Init, HK_I8, 1)
+
+/* UHF_housekeeping comes from the UHF library, so this list is checked against it at build time */
+#define HK_UHF_FIELDS(X, m, o)                                                                                    \
+    X(m, o, freq, HK_U32, 1)                                                                                      \
+    X(m, o, pipe_t, HK_U32, 1)                                                                                    \
+    X(m, o, beacon_t, HK_U32, 1)                                                                                  \
+    X(m, o, audio_t, HK_U32, 1)                                                                                   \
+    X(m, o, uptime, HK_U32, 1)                                                                                    \
+    X(m, o, pckts_out, HK_U32, 1)                                                                                 \
+    X(m, o, pckts_in, HK_U32, 1)                                                                                  \
+    X(m, o, pckts_in_crc16, HK_U32, 1)                                                                            \
+    X(m, o, temperature, HK_F32, 1)                                                                               \
+    X(m, o, scw, HK_U8, SCW_LEN)
+
+#define HK_SBAND_FIELDS(X, m, o)                                                                                  \
+    X(m, o, Output_Power, HK_F32, 1)                                                                              \
+    X(m, o, PA_Temp, HK_F32, 1)                                                                                   \
+    X(m, o, Top_Temp, HK_F32, 1)                                                                                  \
+    X(m, o, Bottom_Temp, HK_F32, 1)                                                                               \
+    X(m, o, Bat_Current, HK_F32, 1)                                                                               \
+    X(m, o, Bat_Voltage, HK_F32, 1)                                                                               \
+    X(m, o, PA_Current, HK_F32, 1)                                                                                \
+    X(m, o, PA_Voltage, HK_F32, 1)
+
+#define HK_HYPERION_FIELDS(X, m, o)                                                                               \
+    X(m, o, Nadir_Temp1, HK_I8, 1)                                                                                \
+    X(m, o, Nadir_Temp_Adc, HK_I8, 1)                                                                             \
+    X(m, o, Port_Temp1, HK_I8, 1)                                                                                 \
+    X(m, o, Port_Temp2, HK_I8, 1)                                                                                 \
+    X(m, o, Port_Temp3, HK_I8, 1)                                                                                 \
+    X(m, o, Port_Temp_Adc, HK_I8, 1)                                                                              \
+    X(m, o, Port_Dep_Temp1, HK_I8, 1)                                                                             \
+    X(m, o, Port_Dep_Temp2, HK_I8, 1)                                                                             \
+    X(m, o, Port_Dep_Temp3, HK_I8, 1)                                                                             \
+    X(m, o, Port_Dep_Temp_Adc, HK_I8, 1)                                                                          \
+    X(m, o, Star_Temp1, HK_I8, 1)                                                                                 \
+    X(m, o, Star_Temp2, HK_I8, 1)                                                                                 \
+    X(m, o, Star_Temp3, HK_I8, 1)                                                                                 \
+    X(m, o, Star_Temp_Adc, HK_I8, 1)                                                                              \
+    X(m, o, Star_Dep_Temp1, HK_I8, 1)                                                                             \
+    X(m, o, Star_Dep_Temp2, HK_I8, 1)                                                                             \
+    X(m, o, Star_Dep_Temp3, HK_I8, 1)                                                                             \
+    X(m, o, Star_Dep_Temp_Adc, HK_I8, 1)                                                                          \
+    X(m, o, Zenith_Temp1, HK_I8, 1)                                                                               \
+    X(m, o, Zenith_Temp2, HK_I8, 1)                                                                               \
+    X(m, o, Zenith_Temp3, HK_I8, 1)                                                                               \
+    X(m, o, Zenith_Temp_Adc, HK_I8, 1)                                                                            \
+    X(m, o, Nadir_Pd1, HK_U8, 1)                                                                                  \
+    X(m, o, Port_Pd1, HK_U8, 1)                                                                                   \
+    X(m, o, Port_Pd2, HK_U8, 1)                                                                                   \
+    X(m, o, Port_Pd3, HK_U8, 1)                                                                                   \
+    X(m, o, Port_Dep_Pd1, HK_U8, 1)                                                                               \
+    X(m, o, Port_Dep_Pd2, HK_U8, 1)                                                                               \
+    X(m, o, Port_Dep_Pd3, HK_U8, 1)                                                                               \
+    X(m, o, Star_Pd1, HK_U8, 1)                                                                                   \
+    X(m, o, Star_Pd2, HK_U8, 1)                                                                                   \
+    X(m, o, Star_Pd3, HK_U8, 1)                                                                                   \
+    X(m, o, Star_Dep_Pd1, HK_U8, 1)                                                                               \
+    X(m, o, Star_Dep_Pd2, HK_U8, 1)                                                                               \
+    X(m, o, Star_Dep_Pd3, HK_U8, 1)                                                                               \
+    X(m, o, Zenith_Pd1, HK_U8, 1)                                                                                 \
+    X(m, o, Zenith_Pd2, HK_U8, 1)                                                                                 \
+    X(m, o, Zenith_Pd3, HK_U8, 1)                                                                                 \
+    X(m, o, Port_Voltage, HK_U16, 1)                                                                              \
+    X(m, o, Port_Dep_Voltage, HK_U16, 1)                                                                          \
+    X(m, o, Star_Voltage, HK_U16, 1)                                                                              \
+    X(m, o, Star_Dep_Voltage, HK_U16, 1)                                                                          \
+    X(m, o, Zenith_Voltage, HK_U16, 1)                                                                            \
+    X(m, o, Port_Current, HK_U16, 1)                                                                              \
+    X(m, o, Port_Dep_Current, HK_U16, 1)                                                                          \
+    X(m, o, Star_Current, HK_U16, 1)                                                                              \
+    X(m, o, Star_Dep_Current, HK_U16, 1)                                                                          \
+    X(m, o, Zenith_Current, HK_U16, 1)
+
+#define HK_CHARON_FIELDS(X, m, o)                                                                                 \
+    X(m, o, crc, HK_U16, 1)                                                                                       \
+    X(m, o, temparray, HK_I8, 8)
+
+#define HK_DFGM_FIELDS(X, m, o)                                                                                   \
+    X(m, o, coreVoltage, HK_U16, 1)                                                                               \
+    X(m, o, sensorTemp, HK_U16, 1)                                                                                \
+    X(m, o, refTemp, HK_U16, 1)                                                                                   \
+    X(m, o, boardTemp, HK_U16, 1)                                                                                 \
+    X(m, o, posRailVoltage, HK_U16, 1)                                                                            \
+    X(m, o, inputVoltage, HK_U16, 1)                                                                              \
+    X(m, o, refVoltage, HK_U16, 1)                                                                                \
+    X(m, o, inputCurrent, HK_U16, 1)                                                                              \
+    X(m, o, reserved1, HK_U16, 1)                                                                                 \
+    X(m, o, reserved2, HK_U16, 1)                                                                                 \
+    X(m, o, reserved3, HK_U16, 1)                                                                                 \
+    X(m, o, reserved4, HK_U16, 1)
+
+#define HK_NS_FIELDS(X, m, o)                                                                                     \
+    X(m, o, temp0, HK_I16, 1)                                                                                     \
+    X(m, o, temp1, HK_I16, 1)                                                                                     \
+    X(m, o, temp2, HK_I16, 1)                                                                                     \
+    X(m, o, temp3, HK_I16, 1)                                                                                     \
+    X(m, o, eNIM0, HK_I16, 1)                                                                                     \
+    X(m, o, eNIM1, HK_I16, 1)                                                                                     \
+    X(m, o, eNIM2, HK_I16, 1)                                                                                     \
+    X(m, o, ram_avail, HK_I16, 1)                                                                                 \
+    X(m, o, lowest_img_num, HK_I16, 1)                                                                            \
+    X(m, o, first_blank_img_num, HK_I16, 1)
+
+#define HK_IRIS_FIELDS(X, m, o)                                                                                   \
+    X(m, o, vis_temp, HK_U16, 1)                                                                                  \
+    X(m, o, nir_temp, HK_U16, 1)                                                                                  \
+    X(m, o, flash_temp, HK_U16, 1)                                                                                \
+    X(m, o, gate_temp, HK_U16, 1)                                                                                 \
+    X(m, o, imagenum, HK_U8, 1)                                                                                   \
+    X(m, o, software_version, HK_U8, 1)                                                                           \
+    X(m, o, errornum, HK_U8, 1)                                                                                   \
+    X(m, o, MAX_5V_voltage, HK_U16, 1)                                                                            \
+    X(m, o, MAX_5V_power, HK_U16, 1)                                                                              \
+    X(m, o, MAX_3V_voltage, HK_U16, 1)                                                                            \
+    X(m, o, MAX_3V_power, HK_U16, 1)                                                                              \
+    X(m, o, MIN_5V_voltage, HK_U16, 1)                                                                            \
+    X(m, o, MIN_3V_voltage, HK_U16, 1)
+
+/*
+ * Sections of All_systems_housekeeping as X(member, type, fields, order).
+ * The record sections are what is stored on the SD card and sent to the
+ * ground, in this order. Order is the byte order on the ground; the EPS
+ * sends little endian and the ground tools expect it unchanged.
+ * The local sections follow the record and are only kept on board.
+ */
+#define HK_RECORD_SECTIONS(X)                                                                                     \
+    X(hk_timeorder, hk_time_and_order, HK_TIMEORDER_FIELDS, HK_BIG_ENDIAN)                                        \
+    X(adcs_hk, ADCS_HouseKeeping, HK_ADCS_FIELDS, HK_BIG_ENDIAN)                                                  \
+    X(Athena_hk, athena_housekeeping, HK_ATHENA_FIELDS, HK_BIG_ENDIAN)                                            \
+    X(EPS_hk, eps_instantaneous_telemetry_t, HK_EPS_FIELDS, HK_LITTLE_ENDIAN)                                     \
+    X(UHF_hk, UHF_housekeeping, HK_UHF_FIELDS, HK_BIG_ENDIAN)                                                     \
+    X(S_band_hk, Sband_Housekeeping, HK_SBAND_FIELDS, HK_BIG_ENDIAN)                                              \
+    X(hyperion_hk, Hyperion_HouseKeeping, HK_HYPERION_FIELDS, HK_BIG_ENDIAN)                                      \
+    X(charon_hk, charon_housekeeping, HK_CHARON_FIELDS, HK_BIG_ENDIAN)                                            \
+    X(DFGM_hk, DFGM_Housekeeping, HK_DFGM_FIELDS, HK_BIG_ENDIAN)                                                  \
+    X(NS_hk, ns_telemetry, HK_NS_FIELDS, HK_BIG_ENDIAN)
+
+#define HK_LOCAL_SECTIONS(X)                                                                                      \
+    X(EPS_startup_hk, eps_startup_telemetry_t, HK_EPS_STARTUP_FIELDS, HK_LITTLE_ENDIAN)                           \
+    X(IRIS_hk, IRIS_Housekeeping, HK_IRIS_FIELDS, HK_BIG_ENDIAN)
+
+#define HK_SECTION_ID(member, type, fields, order) HK_SECTION_##member,
+
+typedef enum { HK_RECORD_SECTIONS(HK_SECTION_ID) HK_LOCAL_SECTIONS(HK_SECTION_ID) HK_SECTION_COUNT } hk_section_t;
+
+/* Bit for a section in a mask of sections, e.g. HK_SECTION_BIT(EPS_hk) */
+#define HK_SECTION_BIT(member) (1UL << HK_SECTION_##member)
+#define HK_ALL_SECTIONS ((1UL << HK_SECTION_COUNT) - 1)
+
+typedef struct {
+    const char *section; // member of All_systems_housekeeping
+    const char *name;    // field in the section's struct
+    uint16_t offset;     // from the start of All_systems_housekeeping, and of the record if recorded
+    uint8_t width;       // bytes per element
+    uint8_t count;       // elements, 1 unless the field is an array
+    uint8_t type;        // hk_type_t
+    uint8_t order;       // hk_byte_order_t
+    uint8_t recorded;    // 1 if the field is part of the stored record
+    uint8_t section_id;  // hk_section_t
+} hk_field_t;
+
+#define HK_FIELD_ELEMENTS(m, o, f, t, n) +(n)
+#define HK_SECTION_ELEMENTS(member, type, fields, order) fields(HK_FIELD_ELEMENTS, member, order)
+
+/* Number of values in a record, counting each array element */
+#define HK_RECORD_ELEMENTS (0 HK_RECORD_SECTIONS(HK_SECTION_ELEMENTS))
+
+/* Every field of All_systems_housekeeping, record fields first and in record order */
+extern const hk_field_t hk_schema[];
+extern const uint16_t hk_schema_length;
+
+void hk_schema_to_ground(void *hk);
+
+double hk_schema_get(const hk_field_t *field, const void *element);
+
+void hk_schema_set(const hk_field_t *field, void *element, double value);
+
+void hk_schema_fill(void *hk, int32_t value);
+
+#endif /* HK_SCHEMA_H */
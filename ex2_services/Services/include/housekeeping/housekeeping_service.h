@@ -36,6 +36,8 @@
 #include "ns_payload.h"
 #include "iris.h"
 
+#include "housekeeping/hk_schema.h"
+
 /* Housekeeping service address & port*/
 
 #define HK_PARAMETERS_REPORT 25
@@ -43,6 +45,9 @@
 
 #define ATHENA_TEMP_ARRAY_SIZE 2
 
+/* Seconds between stored housekeeping records while no limit is tripped */
+#define HK_STORE_PERIOD_S 120
+
 #define HK_PR_ERR -1
 #define HK_PR_OK 0
 
@@ -52,7 +57,15 @@ typedef enum { FILE_EXISTS = 1, FILE_NOT_EXIST = 0 } Found_file;
 
 typedef enum { SUCCESS = 0, FAILURE = 1 } Result;
 
-typedef enum { GET_HK = 0, SET_MAX_FILES = 1, GET_MAX_FILES = 2 } subservice;
+typedef enum {
+    GET_HK = 0,
+    SET_MAX_FILES = 1,
+    GET_MAX_FILES = 2,
+    GET_LATEST_HK = 3,
+    GET_ROLLUP = 4,
+    SET_LIMIT = 5,
+    GET_LIMITS = 6
+} subservice;
 
 /*hk data sample*/
 typedef enum { EPS, ADCS, OBC, COMMS } hardware;
@@ -66,32 +79,32 @@ typedef struct __attribute__((packed)) {
     uint16_t dataPosition;  // Use to place datasets in chronological order
 } hk_time_and_order;
 
+#define HK_SECTION_MEMBER(member, type, fields, order) type member;
+
+/* Members come from hk_schema.h. The stored record is every section up to EPS_startup_hk */
 typedef struct __attribute__((packed)) {
-    hk_time_and_order hk_timeorder; // debugging time and file order
-
-    // TODO:
-    ADCS_HouseKeeping adcs_hk;              // ADCS housekeeping struct
-    athena_housekeeping Athena_hk;          // Athena housekeeping struct
-    eps_instantaneous_telemetry_t EPS_hk;   // EPS telemetry struct
-    eps_startup_telemetry_t EPS_startup_hk; // EPS startup telemetry struct
-    UHF_housekeeping UHF_hk;                // UHF status struct
-    Sband_Housekeeping S_band_hk;           // S-band housekeeping struct
-    Hyperion_HouseKeeping hyperion_hk;      // Hyperion housekeeping
-    charon_housekeeping charon_hk;          // Charon housekeeping
-    DFGM_Housekeeping DFGM_hk;              // DFGM housekeeping struct
-    ns_telemetry NS_hk;                     // Northern SPIRIT housekeeping
-    IRIS_Housekeeping IRIS_hk;              // Iris housekeeping struct
+    HK_RECORD_SECTIONS(HK_SECTION_MEMBER)
+    HK_LOCAL_SECTIONS(HK_SECTION_MEMBER)
 } All_systems_housekeeping;
 
+#define HK_SECTION_SIZE(member, type, fields, order) sizeof(type) +
+
+/* Bytes in one stored or transmitted housekeeping record */
+#define HK_RECORD_SIZE (HK_RECORD_SECTIONS(HK_SECTION_SIZE) 0)
+
 SAT_returnState start_housekeeping_service(void);
 
 /*This function called every interval to collect data periodically*/
 Result populate_and_store_hk_data(void);
 
+Result collect_hk_from_devices(All_systems_housekeeping *all_hk_data, uint32_t sections);
+Result store_hk_data(All_systems_housekeeping *hk);
+
 uint16_t get_size_of_housekeeping(All_systems_housekeeping *all_hk_data);
 
 uint16_t get_file_id_from_timestamp(uint32_t timestamp);
 Result load_historic_hk_data(uint16_t file_num, All_systems_housekeeping *all_hk_data);
 Result set_max_files(uint16_t new_max);
+void get_latest_hk(All_systems_housekeeping *all_hk_data);
 
 #endif /* HOUSEKEEPING_SERVICE_H */
@@ -22,8 +22,45 @@
 #define LOGGERSERVICE_H
 
 #include "services.h"
+#include <stdint.h>
 
-typedef enum { GET_FILE = 0, GET_OLD_FILE = 1, GET_FILE_SIZE = 2, SET_FILE_SIZE = 3 } logger_subservice;
+typedef enum {
+    GET_FILE = 0,
+    GET_OLD_FILE = 1,
+    GET_FILE_SIZE = 2,
+    SET_FILE_SIZE = 3,
+    STREAM_LOG = 4
+} logger_subservice;
+
+/* STREAM_LOG selects where in the log to start */
+typedef enum {
+    LOG_STREAM_RANGE = 0, // arg is the byte offset, length the number of bytes (0 for the rest of the file)
+    LOG_STREAM_TAIL = 1,  // arg is the number of lines to return, counting only lines that pass the level filter
+    LOG_STREAM_SINCE = 2, // arg is an uptime in seconds. Returns the lines logged since then in the current boot
+} log_stream_mode;
+
+/*
+ * STREAM_LOG request, big endian, after the subservice byte.
+ *
+ * The log is sent back as a series of packets on the same connection, each
+ * laid out as log_stream_reply_t followed by the log text. The last packet has
+ * last set. A negative status means the request failed.
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t old_file;    // 0 for the current log, 1 for the rotated one
+    uint8_t mode;        // log_stream_mode
+    uint8_t max_level;   // SysLog_Level. Lines less severe than this are skipped
+    uint16_t chunk_size; // log bytes per packet, 0 to fill each CSP buffer
+    uint32_t arg;
+    uint32_t length;
+} log_stream_request_t;
+
+typedef struct __attribute__((packed)) {
+    int8_t status;
+    uint8_t last;
+    uint16_t sequence;
+    uint32_t next_offset; // file offset after the last byte read, to resume a LOG_STREAM_RANGE request
+} log_stream_reply_t;
 
 SAT_returnState start_logger_service(void);
 
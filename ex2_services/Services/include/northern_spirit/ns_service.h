@@ -41,7 +41,6 @@ typedef enum {
     NS_GET_SW_VERSION
 } ns_payload_service_subtype;
 
-void ns_payload_service(void *param);
 SAT_returnState ns_payload_service_app(csp_packet_t *pkt);
 
 SAT_returnState start_ns_payload_service(void);
@@ -44,7 +44,6 @@
 #include "logger.h"
 #include "util/service_utilities.h"
 
-#define SCHEDULER_SIZE 1000
 #define EX2_SEMAPHORE_WAIT 8000
 #define MAX_NUM_CMDS 5
 #define MAX_DATA_LEN 12     //TODO: determine if this is the best max length
@@ -104,7 +103,6 @@ typedef enum { SET_SCHEDULE = 0, GET_SCHEDULE = 1 , REPLACE_SCHEDULE = 2, DELETE
 
 SAT_returnState scheduler_service_app(csp_packet_t *gs_cmds, SemaphoreHandle_t scheduleSemaphore);
 //SAT_returnState scheduler_service_app(char *gs_cmds);
-SAT_returnState scheduler_service(SemaphoreHandle_t scheduleSemaphore);
 SAT_returnState start_scheduler_service(void);
 int calc_cmd_frequency(scheduled_commands_t* cmds, int number_of_cmds, scheduled_commands_unix_t *sorted_cmds);
 SAT_returnState sort_cmds(scheduled_commands_unix_t *sorted_cmds, int number_of_cmds);
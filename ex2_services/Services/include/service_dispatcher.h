@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file service_dispatcher.h
+ * @date Oct. 19, 2026
+ */
+
+#ifndef SERVICE_DISPATCHER_H
+#define SERVICE_DISPATCHER_H
+
+#include <csp/csp.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "services.h"
+
+#define SERVICE_WORKER_COUNT 3
+#define SERVICE_DISPATCHER_SIZE 256
+#define SERVICE_HANDLERS_MAX 16
+
+/* Workers bulk services may hold at once, the rest are kept for quick ones */
+#define SERVICE_BULK_WORKERS 1
+
+/* Stack of each worker, enough for the hungriest handler */
+#define SERVICE_WORKER_SIZE 1536
+
+/* Accepted connections that can wait for a worker */
+#define SERVICE_PENDING_LEN 8
+
+typedef enum {
+    SERVICE_PRIO_HIGH = 0,
+    SERVICE_PRIO_NORMAL = 1,
+    SERVICE_PRIO_LOW = 2,
+} service_priority_t;
+
+/* Reads and answers the packets of one connection. The dispatcher closes the connection after */
+typedef void (*service_handler_t)(csp_conn_t *conn);
+
+typedef struct {
+    const char *name;            // used in logs and statistics
+    uint8_t port;                // CSP port the service listens on
+    service_handler_t handler;   // called on a worker for each connection
+    service_priority_t priority; // orders the wait for a worker, all workers run at NORMAL_SERVICE_PRIO
+    uint8_t max_concurrent;      // connections of this service handled at once
+    bool bulk;                   // long running, limited to SERVICE_BULK_WORKERS workers
+} service_entry_t;
+
+typedef struct {
+    uint32_t connections;  // connections handled
+    uint32_t rejected;     // connections closed because too many were waiting
+    uint32_t max_wait_ms;  // longest time from accept to a worker taking the connection
+    uint32_t max_run_ms;   // longest time spent in the handler
+    uint32_t total_run_ms; // time spent in the handler over all connections
+} service_stats_t;
+
+SAT_returnState service_dispatcher_register(const service_entry_t *entry);
+
+SAT_returnState start_service_dispatcher(void);
+
+bool service_dispatcher_get_stats(uint8_t index, const char **name, service_stats_t *stats);
+
+void service_dispatcher_feed(void);
+
+#endif /* SERVICE_DISPATCHER_H */
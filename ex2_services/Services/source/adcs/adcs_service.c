@@ -19,11 +19,9 @@
 
 #include <string.h>
 #include "adcs/adcs_service.h"
+#include "service_dispatcher.h"
 #include "task_manager/task_manager.h"
 
-static uint32_t svc_wdt_counter = 0;
-static uint32_t get_svc_wdt_counter() { return svc_wdt_counter; }
-
 SAT_returnState adcs_service_app(csp_packet_t *packet) {
     uint8_t ser_subtype = (uint8_t)packet->data[SUBSERVICE_BYTE];
     int8_t status;
@@ -1523,79 +1521,46 @@ SAT_returnState adcs_service_app(csp_packet_t *packet) {
 
 /**
  * @brief
- *      FreeRTOS adcs server task
+ *      Handle a connection to the adcs service
  * @details
- *      Accepts incoming adcs service packets and executes the
- * application
- * @param void* param
+ *      Reads incoming adcs service packets and executes the application.
+ *      Run on a service worker, which closes the connection afterwards
+ * @param conn
+ *      Connection accepted by the service dispatcher
  * @return None
  */
-void adcs_service(void *param) {
-    // create socket
-    csp_socket_t *sock = csp_socket(CSP_SO_HMACREQ);
-
-    // bind the adcs service to socket
-    csp_bind(sock, TC_ADCS_SERVICE);
-
-    // create connections backlog queue
-    csp_listen(sock, SERVICE_BACKLOG_LEN);
-
-    // pointer to current connection and packet
-    csp_conn_t *conn;
+static void adcs_connection(csp_conn_t *conn) {
     csp_packet_t *packet;
-    // process incoming connection
-    while (1) {
-        svc_wdt_counter++;
-
-        // wait for connection, timeout
-        if ((conn = csp_accept(sock, DELAY_WAIT_TIMEOUT)) == NULL) {
-            svc_wdt_counter++;
-            /* timeout */
-            continue;
-        }
-        svc_wdt_counter++;
 
-        // read packets. timeout is 50ms
-        while ((packet = csp_read(conn, 50)) != NULL) {
-            if (adcs_service_app(packet) != SATR_OK) {
-                // something went wrong in the service
-                ex2_log("Error");
+    while ((packet = csp_read(conn, 50)) != NULL) {
+        service_dispatcher_feed();
+        if (adcs_service_app(packet) != SATR_OK) {
+            // something went wrong in the service
+            ex2_log("Error");
+            csp_buffer_free(packet);
+        } else {
+            if (!csp_send(conn, packet, 50)) {
                 csp_buffer_free(packet);
-            } else {
-                if (!csp_send(conn, packet, 50)) {
-                    csp_buffer_free(packet);
-                }
             }
         }
-
-        // close current connection
-        csp_close(conn);
     }
 }
 
 /**
  * @brief
- *      Start the adcs server task
+ *      Register the adcs service
  * @details
- *      Starts the FreeRTOS task responsible for accepting incoming
- *      adcs service requests
+ *      Adds the adcs connection handler to the service dispatcher
  * @param None
  * @return SAT_returnState
  *      success report
  */
 SAT_returnState start_adcs_service(void) {
-    TaskHandle_t svc_tsk;
-    taskFunctions svc_funcs = {0};
-    svc_funcs.getCounterFunction = get_svc_wdt_counter;
-
-    // create adcs service
-    if (xTaskCreate((TaskFunction_t)adcs_service, "adcs_service", 1536, NULL, NORMAL_SERVICE_PRIO, &svc_tsk) !=
-        pdPASS) {
-        ex2_log("FAILED TO CREATE TASK start_adcs_service\n");
+    service_entry_t entry = {"adcs_service", TC_ADCS_SERVICE, adcs_connection, SERVICE_PRIO_LOW, 1, true};
+    if (service_dispatcher_register(&entry) != SATR_OK) {
+        ex2_log("FAILED TO REGISTER adcs_service\n");
         return SATR_ERROR;
     }
-
-    ex2_register(svc_tsk, svc_funcs);
     ex2_log("ADCS service started\n");
 
     int32_t iErr = red_mkdir("adcs");
@@ -32,15 +32,20 @@
 #include "cli/cli.h"
 #include "system.h"
 #include "util/service_utilities.h"
+#include "service_dispatcher.h"
 #include "task_manager/task_manager.h"
 #include "printf.h"
 #include "rtcmk.h"
 #include "cli/fs_utils.h"
 #include "bl_eeprom.h"
-
-static uint32_t svc_wdt_counter = 0;
-
-static uint32_t get_svc_wdt_counter() { return svc_wdt_counter; }
+#include "task_stats/task_stats.h"
+#include "trace/trace_recorder.h"
+#include "mem_pool/mem_pool.h"
+#include "athena_sensors.h"
+#include "sd_array.h"
+#include "diagnostic/diagnostic.h"
+#include "image_verify/image_verify.h"
+#include "logger/logger.h"
 
 /*
  * Command Implementations
@@ -259,6 +264,228 @@ static BaseType_t prvEchoCommand(char *pcWriteBuffer, size_t xWriteBufferLen, co
     return xReturn;
 }
 
+static BaseType_t prvTaskStatsCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
+    // One task is printed per call so the output never has to fit in a single buffer
+    static uint32_t index = 0;
+    task_stats_entry_t entry;
+
+    if (index == 0) {
+        snprintf(pcWriteBuffer, xWriteBufferLen, "%-16s %4s %7s %7s %6s %8s %10s\n", "Task", "Prio", "CPU10s",
+                 "CPU60s", "Stack", "Switches", "MaxLat(us)");
+        index++;
+        return pdTRUE;
+    }
+    if (task_stats_get(&entry, index - 1, 1) == 0) {
+        index = 0;
+        snprintf(pcWriteBuffer, xWriteBufferLen, "\n");
+        return pdFALSE;
+    }
+    snprintf(pcWriteBuffer, xWriteBufferLen, "%-16.16s %4d %4d.%02d%% %4d.%02d%% %6d %8u %10u\n", entry.name,
+             entry.priority, entry.cpu_short / 100, entry.cpu_short % 100, entry.cpu_long / 100,
+             entry.cpu_long % 100, entry.stack_hwm, entry.context_switches, entry.max_latency_us);
+    index++;
+    return pdTRUE;
+}
+
+static BaseType_t prvSvcStatsCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
+    // One service is printed per call, the same as taskstats
+    static uint8_t index = 0;
+    const char *name;
+    service_stats_t stats;
+
+    if (index == 0) {
+        snprintf(pcWriteBuffer, xWriteBufferLen, "%-16s %8s %8s %11s %10s %10s\n", "Service", "Conns", "Rejected",
+                 "MaxWait(ms)", "MaxRun(ms)", "AvgRun(ms)");
+        index++;
+        return pdTRUE;
+    }
+    if (!service_dispatcher_get_stats(index - 1, &name, &stats)) {
+        index = 0;
+        snprintf(pcWriteBuffer, xWriteBufferLen, "\n");
+        return pdFALSE;
+    }
+    snprintf(pcWriteBuffer, xWriteBufferLen, "%-16.16s %8u %8u %11u %10u %10u\n", name, stats.connections,
+             stats.rejected, stats.max_wait_ms, stats.max_run_ms,
+             stats.connections ? stats.total_run_ms / stats.connections : 0);
+    index++;
+    return pdTRUE;
+}
+
+static BaseType_t prvHealthCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
+    // One subsystem is printed per call, the same as taskstats
+    static uint8_t index = 0;
+    const char *name;
+    health_stats_t stats;
+
+    if (index == 0) {
+        snprintf(pcWriteBuffer, xWriteBufferLen, "%-12s %8s %8s %8s %8s\n", "Subsystem", "Probes", "Failed",
+                 "Cycles", "CycFail");
+        index++;
+        return pdTRUE;
+    }
+    if (!diagnostic_get_stats(index - 1, &name, &stats)) {
+        index = 0;
+        snprintf(pcWriteBuffer, xWriteBufferLen, "\n");
+        return pdFALSE;
+    }
+    snprintf(pcWriteBuffer, xWriteBufferLen, "%-12.12s %8u %8u %8u %8u\n", name, stats.probes, stats.failed_probes,
+             stats.power_cycles, stats.failed_cycles);
+    index++;
+    return pdTRUE;
+}
+
+static BaseType_t prvImageVerifyCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
+    static const char *const states[] = {"unchecked", "valid", "INVALID", "missing"};
+    image_verify_status app, golden;
+
+    image_verify_get_status(IMAGE_APPLICATION, &app);
+    image_verify_get_status(IMAGE_GOLDEN, &golden);
+    snprintf(pcWriteBuffer, xWriteBufferLen,
+             "Application: %s, %s check took %u ms at %u s\nGolden: %s, %s check took %u ms at %u s\n",
+             states[app.state], app.signature ? "signature" : "full", app.elapsed_ms, app.checked_at,
+             states[golden.state], golden.signature ? "signature" : "full", golden.elapsed_ms, golden.checked_at);
+    return pdFALSE;
+}
+
+static BaseType_t prvTraceCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
+    BaseType_t parameter_len;
+    const char *parameter = FreeRTOS_CLIGetParameter(pcCommandString, 1, &parameter_len);
+
+    if (strncmp(parameter, "on", parameter_len) == 0) {
+        trace_enable(true);
+    } else if (strncmp(parameter, "off", parameter_len) == 0) {
+        trace_enable(false);
+    } else if (strncmp(parameter, "flush", parameter_len) == 0) {
+        int32_t written = trace_flush();
+        if (written < 0) {
+            snprintf(pcWriteBuffer, xWriteBufferLen, "Failed to write %s\n", TRACE_FILE);
+        } else {
+            snprintf(pcWriteBuffer, xWriteBufferLen, "Wrote %d events to %s\n", written, TRACE_FILE);
+        }
+        return pdFALSE;
+    } else if (strncmp(parameter, "status", parameter_len) != 0) {
+        snprintf(pcWriteBuffer, xWriteBufferLen, "Invalid trace command\n");
+        return pdFALSE;
+    }
+    snprintf(pcWriteBuffer, xWriteBufferLen, "Recording: %s\nPending: %u\nDropped: %u\n",
+             trace_is_enabled() ? "on" : "off", trace_pending(), trace_dropped());
+    return pdFALSE;
+}
+
+static BaseType_t prvMemStatsCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
+    // The heap is printed on the first call and then one pool per call
+    static uint32_t index = 0;
+    mem_pool_stats_t pool;
+
+    if (index == 0) {
+        mem_heap_stats_t heap;
+        mem_heap_get_stats(&heap);
+        snprintf(pcWriteBuffer, xWriteBufferLen,
+                 "Heap free: %u\nHeap min free: %u\nHeap fallbacks: %u\nMalloc failures: %u\n"
+                 "%6s %6s %6s %6s %8s %8s %8s\n",
+                 heap.heap_free, heap.heap_min_free, heap.heap_fallbacks, heap.malloc_failures, "Size", "Blocks",
+                 "Used", "Max", "Allocs", "Failures", "Corrupt");
+        index++;
+        return pdTRUE;
+    }
+    if (!mem_pool_get_stats(index - 1, &pool)) {
+        index = 0;
+        snprintf(pcWriteBuffer, xWriteBufferLen, "\n");
+        return pdFALSE;
+    }
+    snprintf(pcWriteBuffer, xWriteBufferLen, "%6d %6d %6d %6d %8u %8u %8u\n", pool.block_size, pool.blocks,
+             pool.used, pool.high_water, pool.allocs, pool.failures, pool.corruptions);
+    index++;
+    return pdTRUE;
+}
+
+static BaseType_t prvAthenaCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
+    // The header is printed on the first call and then one sensor per call
+    static uint32_t index = 0;
+    athena_sensors_t sensors;
+    const athena_sensor_stat *stat;
+    const char *name;
+
+    if (!athena_sensors_get(&sensors)) {
+        index = 0;
+        snprintf(pcWriteBuffer, xWriteBufferLen, "Athena sensors not polled\n");
+        return pdFALSE;
+    }
+    if (index == 0) {
+        snprintf(pcWriteBuffer, xWriteBufferLen, "%-12s %8s %8s %8s %8s %6s\n", "Sensor", "Last", "Average", "Min",
+                 "Max", "Errors");
+        index++;
+        return pdTRUE;
+    }
+    if (index <= NUM_TEMP_SENSOR) {
+        stat = &sensors.temp[index - 1];
+        name = "temp(1e-4C)";
+    } else if (index == NUM_TEMP_SENSOR + 1) {
+        stat = &sensors.bus_mv;
+        name = "bus(mV)";
+    } else {
+        stat = &sensors.shunt_uv;
+        name = "shunt(uV)";
+    }
+    snprintf(pcWriteBuffer, xWriteBufferLen, "%-12s %8d %8d %8d %8d %6u\n", name, stat->last, stat->average,
+             stat->min, stat->max, stat->errors);
+    if (index == NUM_TEMP_SENSOR + 2) {
+        index = 0;
+        return pdFALSE;
+    }
+    index++;
+    return pdTRUE;
+}
+
+static BaseType_t prvSdArrayCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
+    // The header is printed on the first call and then one card per call
+    static const char *const states[] = {"offline", "online", "rebuild"};
+    static uint8_t index = 0;
+    sd_array_card_stats card;
+    BaseType_t parameter_len;
+    const char *parameter = FreeRTOS_CLIGetParameter(pcCommandString, 1, &parameter_len);
+
+    if (strncmp(parameter, "rebuild", parameter_len) == 0) {
+        SDRESULTS res = sd_array_rebuild_start();
+        if (res == SD_OK) {
+            snprintf(pcWriteBuffer, xWriteBufferLen, "Rebuild started, see sdarray stats\n");
+        } else {
+            snprintf(pcWriteBuffer, xWriteBufferLen, "Rebuild not started: %d\n", res);
+        }
+        return pdFALSE;
+    } else if (strncmp(parameter, "cancel", parameter_len) == 0) {
+        if (sd_array_rebuild_cancel()) {
+            snprintf(pcWriteBuffer, xWriteBufferLen, "Rebuild cancelled\n");
+        } else {
+            snprintf(pcWriteBuffer, xWriteBufferLen, "No rebuild in progress\n");
+        }
+        return pdFALSE;
+    } else if (strncmp(parameter, "stats", parameter_len) != 0) {
+        snprintf(pcWriteBuffer, xWriteBufferLen, "Invalid sdarray command\n");
+        return pdFALSE;
+    }
+    if (index == 0) {
+        if (!sd_array_get_stats(0, &card)) {
+            snprintf(pcWriteBuffer, xWriteBufferLen, "SD cards are not an array\n");
+            return pdFALSE;
+        }
+        snprintf(pcWriteBuffer, xWriteBufferLen, "%-4s %-8s %10s %10s %6s %9s %9s %9s %9s %10s\n", "Card", "State",
+                 "Reads", "Writes", "Errors", "AvgRd(us)", "MaxRd(us)", "AvgWr(us)", "MaxWr(us)", "Rebuilt");
+        index++;
+        return pdTRUE;
+    }
+    if (!sd_array_get_stats(index - 1, &card)) {
+        index = 0;
+        snprintf(pcWriteBuffer, xWriteBufferLen, "\n");
+        return pdFALSE;
+    }
+    snprintf(pcWriteBuffer, xWriteBufferLen, "%-4d %-8s %10u %10u %6u %9u %9u %9u %9u %10u\n", index - 1,
+             states[card.state], card.reads, card.writes, card.errors, card.avg_read_us, card.max_read_us,
+             card.avg_write_us, card.max_write_us, card.rebuilt);
+    index++;
+    return pdTRUE;
+}
+
 /*
  * Command Struct Definitions
  *
@@ -275,6 +502,26 @@ static const CLI_Command_Definition_t xImageTypeCommand = {"imagetype", "imagety
 static const CLI_Command_Definition_t xRebootCommand = {"reboot", "reboot:\n\tReboot to a mode. Can be B, G, or A\n", prvRebootCommand, 1};
 static const CLI_Command_Definition_t xBootInfoCommand = {"bootinfo", "bootinfo:\n\tGives a breakdown of the boot info\n", prvBootInfoCommand, 0};
 static const CLI_Command_Definition_t xUptimeCommand = {"uptime", "uptime:\n\tGet uptime in seconds\n", prvUptimeCommand, 0};
+static const CLI_Command_Definition_t xTaskStatsCommand = {
+    "taskstats", "taskstats:\n\tPer task CPU usage, free stack, context switches and worst wake up latency\n",
+    prvTaskStatsCommand, 0};
+static const CLI_Command_Definition_t xSvcStatsCommand = {
+    "svcstats", "svcstats:\n\tPer service connections, queue wait and handler run time\n", prvSvcStatsCommand,
+    0};
+static const CLI_Command_Definition_t xHealthCommand = {
+    "health", "health:\n\tSubsystem watchdog probes and power cycles\n", prvHealthCommand, 0};
+static const CLI_Command_Definition_t xImageVerifyCommand = {
+    "imgverify", "imgverify:\n\tResult and duration of the last check of each image\n", prvImageVerifyCommand, 0};
+static const CLI_Command_Definition_t xTraceCommand = {
+    "trace", "trace:\n\tKernel event trace. Can be on, off, flush or status\n", prvTraceCommand, 1};
+static const CLI_Command_Definition_t xMemStatsCommand = {
+    "memstats", "memstats:\n\tHeap usage and block pool statistics\n", prvMemStatsCommand, 0};
+static const CLI_Command_Definition_t xAthenaCommand = {
+    "athena", "athena:\n\tAthena board temperatures and power monitor, averaged by the sensor poller\n",
+    prvAthenaCommand, 0};
+static const CLI_Command_Definition_t xSdArrayCommand = {
+    "sdarray", "sdarray:\n\tStriped or mirrored SD cards. Can be stats, rebuild or cancel\n", prvSdArrayCommand,
+    1};
 
 /**
  * @brief
@@ -326,36 +573,23 @@ SAT_returnState cli_app(csp_packet_t *packet, csp_conn_t *conn) {
 
 /**
  * @brief
- *      FreeRTOS cli server task
+ *      Handle a connection to the cli service
  * @details
- *      Accepts incoming cli service packets and executes the application
- * @param void* param
+ *      Reads incoming cli service packets and executes the application.
+ *      Run on a service worker, which closes the connection afterwards
+ * @param conn
+ *      Connection accepted by the service dispatcher
  * @return None
  */
-void cli_service(void *param) {
-    csp_socket_t *sock;
-    sock = csp_socket(CSP_SO_HMACREQ); // require RDP connection
-    csp_bind(sock, TC_CLI_SERVICE);
-    csp_listen(sock, SERVICE_BACKLOG_LEN);
-    svc_wdt_counter++;
-    for (;;) {
-        svc_wdt_counter++;
-        csp_conn_t *conn;
-        csp_packet_t *packet;
-        if ((conn = csp_accept(sock, DELAY_WAIT_TIMEOUT)) == NULL) {
-            svc_wdt_counter++;
-            /* timeout */
-            continue;
-        }
-        svc_wdt_counter++;
-        while ((packet = csp_read(conn, 50)) != NULL) {
-            SAT_returnState status = cli_app(packet, conn);
-            if (status != SATR_OK) {
-                csp_buffer_free(packet);
-                ex2_log("CLI error %d", status);
-            }
+static void cli_connection(csp_conn_t *conn) {
+    csp_packet_t *packet;
+
+    while ((packet = csp_read(conn, 50)) != NULL) {
+        SAT_returnState status = cli_app(packet, conn);
+        if (status != SATR_OK) {
+            csp_buffer_free(packet);
+            ex2_log("CLI error %d", status);
         }
-        csp_close(conn);
     }
 }
 
@@ -367,29 +601,33 @@ void register_commands() {
     FreeRTOS_CLIRegisterCommand(&xRebootCommand);
     FreeRTOS_CLIRegisterCommand(&xBootInfoCommand);
     FreeRTOS_CLIRegisterCommand(&xUptimeCommand);
+    FreeRTOS_CLIRegisterCommand(&xTaskStatsCommand);
+    FreeRTOS_CLIRegisterCommand(&xSvcStatsCommand);
+    FreeRTOS_CLIRegisterCommand(&xHealthCommand);
+    FreeRTOS_CLIRegisterCommand(&xImageVerifyCommand);
+    FreeRTOS_CLIRegisterCommand(&xTraceCommand);
+    FreeRTOS_CLIRegisterCommand(&xMemStatsCommand);
+    FreeRTOS_CLIRegisterCommand(&xAthenaCommand);
+    FreeRTOS_CLIRegisterCommand(&xSdArrayCommand);
     register_fs_utils();
 }
 
 /**
  * @brief
- *      Start the cli server task
+ *      Register the cli service
  * @details
- *      Starts the FreeRTOS task responsible for accepting incoming
- *      cli packets and registers cli commands
+ *      Adds the cli connection handler to the service dispatcher and
+ *      registers cli commands
  * @param None
  * @return SAT_returnState
  *      success report
  */
 SAT_returnState start_cli_service(void) {
-    TaskHandle_t svc_tsk;
-    taskFunctions svc_funcs = {0};
-    svc_funcs.getCounterFunction = get_svc_wdt_counter;
-    if (xTaskCreate((TaskFunction_t)cli_service, "cli_svc", CLI_SVC_SIZE, NULL, NORMAL_SERVICE_PRIO, &svc_tsk) !=
-        pdPASS) {
-        ex2_log("FAILED TO CREATE TASK cli_svc\n");
+    service_entry_t entry = {"cli_service", TC_CLI_SERVICE, cli_connection, SERVICE_PRIO_NORMAL, 1, false};
+    if (service_dispatcher_register(&entry) != SATR_OK) {
+        ex2_log("FAILED TO REGISTER cli_service\n");
         return SATR_ERROR;
     }
-    ex2_register(svc_tsk, svc_funcs);
     register_commands();
     return SATR_OK;
 }
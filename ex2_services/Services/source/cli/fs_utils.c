@@ -21,12 +21,19 @@
 
 #include <FreeRTOS.h>
 #include <FreeRTOS-Plus-CLI/FreeRTOS_CLI.h>
+#include <os_task.h>
 #include <redposix.h>
+#include "fs_bulk/fs_bulk.h"
+#include "logger/logger.h"
+#include "service_dispatcher.h"
 #include "printf.h"
 #include <string.h>
 
 #define str(s) #s
 
+/* Bulk operations log their progress this often */
+#define BULK_PROGRESS_PERIOD pdMS_TO_TICKS(10000)
+
 void createErrorOutput(char *pcWriteBuffer, size_t xWriteBufferLen) {
     const char *errorMsg;
     switch (red_errno) {
@@ -224,28 +231,41 @@ static BaseType_t prvMKCommand(char *pcWriteBuffer, size_t xWriteBufferLen, cons
     return pdFALSE;
 }
 
-int _do_recursive_rm(const char *path) {
-    int success = red_chdir(path);
-    if (success == -1) {
-        return red_unlink(path);
-    }
-    REDDIR *dir = red_opendir(".");
-    if (dir == 0) {
-        red_chdir("..");
-        return -1;
+typedef struct {
+    const char *verb;
+    TickType_t start;
+    TickType_t last_report;
+} bulk_run_t;
+
+/* Keeps the worker's watchdog fed through a long operation and logs how far it has got */
+static void bulk_progress(const fs_bulk_totals *totals, void *arg) {
+    bulk_run_t *run = (bulk_run_t *)arg;
+    TickType_t now = xTaskGetTickCount();
+
+    service_dispatcher_feed();
+    if (now - run->last_report >= BULK_PROGRESS_PERIOD) {
+        run->last_report = now;
+        sys_log(INFO, "%s %u files, %u directories, %llu bytes so far", run->verb, totals->files, totals->dirs,
+                totals->bytes);
     }
-    REDDIRENT *entry = red_readdir(dir);
-    while (entry != NULL) {
-        if (_do_recursive_rm(entry->d_name) == -1) {
-            red_closedir(dir);
-            red_chdir("..");
-            return -1;
-        }
-        entry = red_readdir(dir);
+}
+
+static void bulk_start(bulk_run_t *run, const char *verb) {
+    run->verb = verb;
+    run->start = xTaskGetTickCount();
+    run->last_report = run->start;
+}
+
+static void createBulkOutput(char *pcWriteBuffer, size_t xWriteBufferLen, int32_t error, const bulk_run_t *run,
+                             const fs_bulk_totals *totals) {
+    int written = 0;
+    if (error < 0) {
+        createErrorOutput(pcWriteBuffer, xWriteBufferLen);
+        written = strlen(pcWriteBuffer);
     }
-    red_closedir(dir);
-    red_chdir("..");
-    return red_unlink(path);
+    snprintf(pcWriteBuffer + written, xWriteBufferLen - written,
+             "%s %u files, %u directories, %llu bytes in %u ms\n", run->verb, totals->files, totals->dirs,
+             totals->bytes, (xTaskGetTickCount() - run->start) * portTICK_PERIOD_MS);
 }
 
 static BaseType_t prvRMCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
@@ -268,18 +288,18 @@ static BaseType_t prvRMCommand(char *pcWriteBuffer, size_t xWriteBufferLen, cons
                 /* Store the parameter string length. */
                 &parameterLen);
     }
-    int32_t error = red_unlink(parameter);
-    if (error < 0) {
-        if (red_errno == RED_ENOTEMPTY) {
-            int success = _do_recursive_rm(parameter);
-            if (success < 0) {
-                createErrorOutput(pcWriteBuffer, xWriteBufferLen);
-                return pdFALSE;
-            }
-        } else {
+    if (!dorecursive) {
+        int32_t error = red_unlink(parameter);
+        if (error < 0) {
             createErrorOutput(pcWriteBuffer, xWriteBufferLen);
         }
+        return pdFALSE;
     }
+    bulk_run_t run;
+    fs_bulk_totals totals;
+    bulk_start(&run, "Removed");
+    int32_t error = fs_bulk_remove(parameter, &totals, bulk_progress, &run);
+    createBulkOutput(pcWriteBuffer, xWriteBufferLen, error, &run, &totals);
     return pdFALSE;
 }
 
@@ -372,7 +392,8 @@ static BaseType_t prvTRANSACTCommand(char *pcWriteBuffer, size_t xWriteBufferLen
     return pdFALSE;
 }
 
-static BaseType_t prvCPCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
+/* Get the two paths of cp and mv, the first one is terminated in place */
+static const char *getTwoPaths(const char *pcCommandString, const char **copyTo) {
     BaseType_t fromParameterLen;
     char *copyFrom = (char *)FreeRTOS_CLIGetParameter( // I know casting away from const is bad, a null terminator needs to be placed in the array :(
         /* The command string itself. */
@@ -382,7 +403,7 @@ static BaseType_t prvCPCommand(char *pcWriteBuffer, size_t xWriteBufferLen, cons
         /* Store the parameter string length. */
         &fromParameterLen);
     BaseType_t toParameterLen;
-    const char *copyTo = FreeRTOS_CLIGetParameter(
+    *copyTo = FreeRTOS_CLIGetParameter(
         /* The command string itself. */
         pcCommandString,
         /* Return the second parameter. */
@@ -390,46 +411,75 @@ static BaseType_t prvCPCommand(char *pcWriteBuffer, size_t xWriteBufferLen, cons
         /* Store the parameter string length. */
         &toParameterLen);
     copyFrom[fromParameterLen] = 0;
-    int from_fd = red_open(copyFrom, RED_O_RDONLY);
-    if (from_fd < 0) {
-        createErrorOutput(pcWriteBuffer, xWriteBufferLen);
-        return pdFALSE;
-    }
-    int to_fd = red_open(copyTo, RED_O_WRONLY | RED_O_CREAT);
-    if (to_fd < 0) {
+    return copyFrom;
+}
+
+static BaseType_t prvCPCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
+    const char *copyTo;
+    const char *copyFrom = getTwoPaths(pcCommandString, &copyTo);
+    bulk_run_t run;
+    fs_bulk_totals totals;
+
+    bulk_start(&run, "Copied");
+    int32_t error = fs_bulk_copy(copyFrom, copyTo, &totals, bulk_progress, &run);
+    createBulkOutput(pcWriteBuffer, xWriteBufferLen, error, &run, &totals);
+    return pdFALSE;
+}
+
+static BaseType_t prvMVCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
+    const char *moveTo;
+    const char *moveFrom = getTwoPaths(pcCommandString, &moveTo);
+    bulk_run_t run;
+    fs_bulk_totals totals;
+
+    bulk_start(&run, "Moved");
+    int32_t error = fs_bulk_move(moveFrom, moveTo, &totals, bulk_progress, &run);
+    createBulkOutput(pcWriteBuffer, xWriteBufferLen, error, &run, &totals);
+    return pdFALSE;
+}
+
+static BaseType_t prvDUCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
+    // We can guarantee there will be one parameter because FreeRTOS+CLI won't call this function unless it has
+    // exactly one parameter
+    BaseType_t parameterLen;
+    const char *parameter = FreeRTOS_CLIGetParameter(
+        /* The command string itself. */
+        pcCommandString,
+        /* Return the first parameter. */
+        1,
+        /* Store the parameter string length. */
+        &parameterLen);
+    bulk_run_t run;
+    fs_bulk_totals totals;
+
+    bulk_start(&run, "Found");
+    int32_t error = fs_bulk_usage(parameter, &totals);
+    createBulkOutput(pcWriteBuffer, xWriteBufferLen, error, &run, &totals);
+    return pdFALSE;
+}
+
+static BaseType_t prvDFCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
+    // We can guarantee there will be one parameter because FreeRTOS+CLI won't call this function unless it has
+    // exactly one parameter
+    BaseType_t parameterLen;
+    const char *parameter = FreeRTOS_CLIGetParameter(
+        /* The command string itself. */
+        pcCommandString,
+        /* Return the first parameter. */
+        1,
+        /* Store the parameter string length. */
+        &parameterLen);
+    fs_bulk_volume info;
+
+    if (fs_bulk_volume_info(parameter, &info) < 0) {
         createErrorOutput(pcWriteBuffer, xWriteBufferLen);
-        red_close(from_fd);
         return pdFALSE;
     }
-    int8_t *buf = pvPortMalloc(512);
-    if (buf == NULL) {
-        snprintf(pcWriteBuffer, xWriteBufferLen, "%s\n", "failed to allocate buffer");
-        red_close(to_fd);
-        red_close(from_fd);
-        return pdFALSE;
-    }
-    bool done = false;
-    while (!done) {
-        int32_t bytes_read = red_read(from_fd, buf, 512);
-        if (bytes_read == 0) {
-            done = true;
-            continue;
-        } 
-        if (bytes_read < 0) {
-            done = true;
-            createErrorOutput(pcWriteBuffer, xWriteBufferLen);
-            continue;
-        }
-        int32_t bytes_written = red_write(to_fd, buf, 512);
-        if (bytes_written < 0) {
-            done = true;
-            createErrorOutput(pcWriteBuffer, xWriteBufferLen);
-            continue; 
-        }
-    }
-    red_close(to_fd);
-    red_close(from_fd);
-    vPortFree(buf);
+    uint64_t used = info.total_bytes - info.free_bytes;
+    uint32_t percent = info.total_bytes ? (uint32_t)(used * 100 / info.total_bytes) : 0;
+    snprintf(pcWriteBuffer, xWriteBufferLen,
+             "block %u\nsize %llu\nused %llu\nfree %llu\nused %u%%\ninodes %u\ninodes free %u\n", info.block_size,
+             info.total_bytes, used, info.free_bytes, percent, info.total_inodes, info.free_inodes);
     return pdFALSE;
 }
 
@@ -463,7 +513,7 @@ static const CLI_Command_Definition_t xRMDIRCommand = {
     "rmdir", "rmdir:\n\tRemove a directory only if it is empty\n", prvRMDIRCommand, 1};
 static const CLI_Command_Definition_t xMKCommand = {"mk", "mk:\n\tCreate a new empty file\n", prvMKCommand, 1};
 static const CLI_Command_Definition_t xRMCommand = {
-    "rm", "rm:\n\tDelete file\n\tUse -r for recursive", prvRMCommand, -1};
+    "rm", "rm:\n\tDelete file\n\tUse -r to delete a directory and everything in it\n", prvRMCommand, -1};
 static const CLI_Command_Definition_t xSTATCommand = {"stat", "stat:\n\tStat a file\n", prvSTATCommand, 1};
 static const CLI_Command_Definition_t xREADCommand = {"read", "read:\n\tRead contents of a file\n", prvREADCommand,
                                                       1};
@@ -471,7 +521,15 @@ static const CLI_Command_Definition_t xTRANSACTCommand = {
     "transact",
     "transact:\n\tTell Reliance-edge to transact the filesystem.\n\tMust include volume prefix to transact\n",
     prvTRANSACTCommand, 1};
-static const CLI_Command_Definition_t xCPCommand = {"cp", "cp:\n\tCopy first parameter to second parameter\n", prvCPCommand, 2};
+static const CLI_Command_Definition_t xCPCommand = {
+    "cp", "cp:\n\tCopy first parameter to second parameter\n\tDirectories are copied with everything in them\n",
+    prvCPCommand, 2};
+static const CLI_Command_Definition_t xMVCommand = {
+    "mv", "mv:\n\tMove or rename first parameter to second parameter, across volumes too\n", prvMVCommand, 2};
+static const CLI_Command_Definition_t xDUCommand = {
+    "du", "du:\n\tCount the files, directories and bytes under a path\n", prvDUCommand, 1};
+static const CLI_Command_Definition_t xDFCommand = {
+    "df", "df:\n\tSize and free space of a volume\n\tMust include volume prefix\n", prvDFCommand, 1};
 static const CLI_Command_Definition_t xFORMATCommand = {"format", "format:\n\tFormat the specified volume. It may take a long time to format and the response may time out, check again later\n", prvFORMATCommand, 1};
 
 void register_fs_utils() {
@@ -486,5 +544,8 @@ void register_fs_utils() {
     FreeRTOS_CLIRegisterCommand(&xREADCommand);
     FreeRTOS_CLIRegisterCommand(&xTRANSACTCommand);
     FreeRTOS_CLIRegisterCommand(&xCPCommand);
+    FreeRTOS_CLIRegisterCommand(&xMVCommand);
+    FreeRTOS_CLIRegisterCommand(&xDUCommand);
+    FreeRTOS_CLIRegisterCommand(&xDFCommand);
     FreeRTOS_CLIRegisterCommand(&xFORMATCommand);
 }
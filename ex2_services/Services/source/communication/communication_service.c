@@ -25,7 +25,9 @@
 #include <main/system.h>
 
 #include "services.h"
+#include "service_dispatcher.h"
 #include "task_manager/task_manager.h"
+#include "telemetry/telemetry_store.h"
 #include "uhf.h"
 #include "sband.h"
 #include "util/service_utilities.h"
@@ -42,71 +44,47 @@
 
 SAT_returnState communication_service_app(csp_packet_t *packet);
 
-static uint32_t svc_wdt_counter = 0;
-static uint32_t get_svc_wdt_counter() { return svc_wdt_counter; }
-
 /**
  * @brief
- *      FreeRTOS communication server task
+ *      Handle a connection to the communication service
  * @details
- *      Accepts incoming communication service packets and executes the
- * application
- * @param void* param
+ *      Reads incoming communication service packets and executes the application.
+ *      Run on a service worker, which closes the connection afterwards
+ * @param conn
+ *      Connection accepted by the service dispatcher
  * @return None
  */
-void communication_service(void *param) {
-    csp_socket_t *sock;
-    sock = csp_socket(CSP_SO_HMACREQ);
-    csp_bind(sock, TC_COMMUNICATION_SERVICE);
-    csp_listen(sock, SERVICE_BACKLOG_LEN);
-
-    svc_wdt_counter++;
-
-    for (;;) {
-        csp_packet_t *packet;
-        csp_conn_t *conn;
-        if ((conn = csp_accept(sock, DELAY_WAIT_TIMEOUT)) == NULL) {
-            svc_wdt_counter++;
-            /* timeout */
-            continue;
-        }
-        svc_wdt_counter++;
-
-        while ((packet = csp_read(conn, 50)) != NULL) {
-            if (communication_service_app(packet) != SATR_OK) {
-                // something went wrong in the service
+static void communication_connection(csp_conn_t *conn) {
+    csp_packet_t *packet;
+
+    while ((packet = csp_read(conn, 50)) != NULL) {
+        if (communication_service_app(packet) != SATR_OK) {
+            // something went wrong in the service
+            csp_buffer_free(packet);
+        } else {
+            if (!csp_send(conn, packet, 50)) {
                 csp_buffer_free(packet);
-            } else {
-                if (!csp_send(conn, packet, 50)) {
-                    csp_buffer_free(packet);
-                }
             }
         }
-        csp_close(conn);
     }
 }
 
 /**
  * @brief
- *      Start the communication server task
+ *      Register the communication service
  * @details
- *      Starts the FreeRTOS task responsible for accepting incoming
- *      communication service requests
+ *      Adds the communication connection handler to the service dispatcher
  * @param None
  * @return SAT_returnState
  *      success report
  */
 SAT_returnState start_communication_service(void) {
-    TaskHandle_t svc_tsk;
-    taskFunctions svc_funcs = {0};
-    svc_funcs.getCounterFunction = get_svc_wdt_counter;
-
-    if (xTaskCreate((TaskFunction_t)communication_service, "communication_service", 1024, NULL,
-                    NORMAL_SERVICE_PRIO, &svc_tsk) != pdPASS) {
-        ex2_log("FAILED TO CREATE TASK start_communication_service\n");
+    service_entry_t entry = {"communication_service", TC_COMMUNICATION_SERVICE, communication_connection,
+                             SERVICE_PRIO_NORMAL, 1, false};
+    if (service_dispatcher_register(&entry) != SATR_OK) {
+        ex2_log("FAILED TO REGISTER communication_service\n");
         return SATR_ERROR;
     }
-    ex2_register(svc_tsk, svc_funcs);
     ex2_log("Communication service started\n");
     return SATR_OK;
 }
@@ -251,7 +229,11 @@ SAT_returnState communication_service_app(csp_packet_t *packet) {
 
     case S_GET_HK: {
         Sband_Housekeeping HK;
-        status = HAL_S_getHK(&HK);
+        status = S_SUCCESS;
+        if (!telemetry_read_recent(TLM_SBAND, &HK, sizeof(HK), TELEMETRY_FRESH_TICKS)) {
+            status = HAL_S_getHK(&HK);
+            telemetry_write(TLM_SBAND, &HK, sizeof(HK), status == S_SUCCESS);
+        }
         if (sizeof(HK) + 1 > csp_buffer_data_size()) {
             return_state = SATR_ERROR;
         }
@@ -26,7 +26,9 @@
 
 #include "dfgm.h"
 #include "services.h"
+#include "service_dispatcher.h"
 #include "task_manager/task_manager.h"
+#include "telemetry/telemetry_store.h"
 #include "util/service_utilities.h"
 
 #include <limits.h>
@@ -34,75 +36,47 @@
 
 SAT_returnState dfgm_service_app(csp_packet_t *packet);
 
-static uint32_t svc_wdt_counter = 0;
-static uint32_t get_svc_wdt_counter() { return svc_wdt_counter; }
-
 /**
  * @brief
- *      FreeRTOS DFGM server task
+ *      Handle a connection to the DFGM service
  * @details
- *      Accepts incoming DFGM service packets and executes
- *      the application
- * @param void* param
+ *      Reads incoming DFGM service packets and executes the application.
+ *      Run on a service worker, which closes the connection afterwards
+ * @param conn
+ *      Connection accepted by the service dispatcher
  * @return None
  */
-void dfgm_service(void *param) {
-    // socket initialization
-    csp_socket_t *sock;
-    sock = csp_socket(CSP_SO_HMACREQ);
-    csp_bind(sock, TC_DFGM_SERVICE);
-    csp_listen(sock, SERVICE_BACKLOG_LEN);
-
-    svc_wdt_counter++;
-
-    for (;;) {
-        // establish a connection
-        csp_packet_t *packet;
-        csp_conn_t *conn;
-        if ((conn = csp_accept(sock, DELAY_WAIT_TIMEOUT)) == NULL) {
-            svc_wdt_counter++;
-            /* timeout */
-            continue;
-        }
-        svc_wdt_counter++;
-
-        // read and process packets
-        while ((packet = csp_read(conn, 50)) != NULL) {
-            if (dfgm_service_app(packet) != SATR_OK) {
-                // something went wrong in the subservice
+static void dfgm_connection(csp_conn_t *conn) {
+    csp_packet_t *packet;
+
+    while ((packet = csp_read(conn, 50)) != NULL) {
+        if (dfgm_service_app(packet) != SATR_OK) {
+            // something went wrong in the subservice
+            csp_buffer_free(packet);
+        } else {
+            // subservice was successful
+            if (!csp_send(conn, packet, 50)) {
                 csp_buffer_free(packet);
-            } else {
-                // subservice was successful
-                if (!csp_send(conn, packet, 50)) {
-                    csp_buffer_free(packet);
-                }
             }
         }
-        csp_close(conn);
     }
 }
 
 /**
  * @brief
- *      Starts the DFGM server task
+ *      Register the DFGM service
  * @details
- *      Starts the FreeRTOS task responsible for accepting incoming
- *      DFGM service requests
+ *      Adds the DFGM connection handler to the service dispatcher
  * @param None
  * @return SAT_returnState
- *      Success report
+ *      success report
  */
 SAT_returnState start_dfgm_service(void) {
-    TaskHandle_t svc_tsk;
-    taskFunctions svc_funcs = {0};
-    svc_funcs.getCounterFunction = get_svc_wdt_counter;
-
-    if (xTaskCreate((TaskFunction_t)dfgm_service, "dfgm_service", 1024, NULL,
-                    NORMAL_SERVICE_PRIO, &svc_tsk) != pdPASS) {
-        ex2_log("FAILED TO CREATE TASK start_dfgm_service\n");
+    service_entry_t entry = {"dfgm_service", TC_DFGM_SERVICE, dfgm_connection, SERVICE_PRIO_NORMAL, 1, false};
+    if (service_dispatcher_register(&entry) != SATR_OK) {
+        ex2_log("FAILED TO REGISTER dfgm_service\n");
         return SATR_ERROR;
     }
-    ex2_register(svc_tsk, svc_funcs);
     ex2_log("DFGM service started\n");
     return SATR_OK;
 }
@@ -161,7 +135,11 @@ SAT_returnState dfgm_service_app(csp_packet_t *packet) {
     case DFGM_GET_HK: {
         // Get DFGM HK data
         DFGM_Housekeeping HK = {0};
-        status = HAL_DFGM_get_HK(&HK);
+        status = DFGM_SUCCESS;
+        if (!telemetry_read_recent(TLM_DFGM, &HK, sizeof(HK), TELEMETRY_FRESH_TICKS)) {
+            status = HAL_DFGM_get_HK(&HK);
+            telemetry_write(TLM_DFGM, &HK, sizeof(HK), status == DFGM_SUCCESS);
+        }
 
         // Convert floats from host byte order to server byte order
         HK.coreVoltage = csp_hton16(HK.coreVoltage);
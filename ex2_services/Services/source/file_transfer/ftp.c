@@ -24,18 +24,17 @@
 #include <redposix.h>
 
 #include "ftp.h"
+#include "fw_update/fw_delta.h"
+#include "fw_update/fw_update.h"
 #include "services.h"
+#include "service_dispatcher.h"
 #include "task_manager/task_manager.h"
 #include "util/service_utilities.h"
 #include <string.h>
 
-#define FTP_STACK_SIZE 500
 
 typedef enum { GET_REQUEST = 0, POST_REQUEST = 1 } FTP_REQUESTTYPE;
 
-static uint32_t svc_wdt_counter = 0;
-static uint32_t get_svc_wdt_counter() { return svc_wdt_counter; }
-
 typedef struct {
     uint32_t req_id;
     char fname[REDCONF_NAME_MAX];
@@ -47,6 +46,8 @@ typedef struct {
 } FTP_t;
 
 static FTP_t current_upload = {0};
+static FTP_t firmware_upload = {0};
+static uint32_t firmware_size = 0;
 
 csp_conn_t *ftp_make_new_connection(uint8_t dest_addr) {
     return csp_connect(1, dest_addr, TC_FTP_DATA_SERVICE, portMAX_DELAY, CSP_SO_HMACREQ);
@@ -109,6 +110,7 @@ SAT_returnState send_download_burst(csp_conn_t *conn, FTP_t *ftp) {
         if (status == -1) {
             break;
         }
+        service_dispatcher_feed();
         blocknumber++;
     }
     red_close(fd);
@@ -120,74 +122,56 @@ SAT_returnState FTP_app(csp_packet_t *packet, csp_conn_t *conn);
 
 /**
  * @brief
- *      FreeRTOS File Transferring (FT) server task
+ *      Handle a connection to the file transfer service
  * @details
- *      Accepts incoming FTP service packets and executes
- *      the application
- * @param void* param
+ *      Reads incoming file transfer service packets and executes the application.
+ *      Run on a service worker, which closes the connection afterwards
+ * @param conn
+ *      Connection accepted by the service dispatcher
  * @return None
  */
-void FTP_service(void *param) {
-    // socket initialization
-    csp_socket_t *sock;
-    sock = csp_socket(CSP_SO_HMACREQ);
-    csp_bind(sock, TC_FTP_COMMAND_SERVICE);
-    csp_listen(sock, SERVICE_BACKLOG_LEN);
-    svc_wdt_counter++;
+static void FTP_connection(csp_conn_t *conn) {
     csp_packet_t *packet;
-    csp_conn_t *conn;
-
-    for (;;) {
-        // establish a connection
-
-        if ((conn = csp_accept(sock, DELAY_WAIT_TIMEOUT)) == NULL) {
-            svc_wdt_counter++;
-            /* timeout */
-            continue;
-        }
-        svc_wdt_counter++;
 
-        // read and process packets
-        while ((packet = csp_read(conn, 50)) != NULL) {
-            if (FTP_app(packet, conn) != SATR_OK) {
-                // something went wrong in the subservice
+    while ((packet = csp_read(conn, 50)) != NULL) {
+        // A transfer holds the connection for as long as the pass
+        service_dispatcher_feed();
+        if (FTP_app(packet, conn) != SATR_OK) {
+            // something went wrong in the subservice
+            csp_buffer_free(packet);
+        } else {
+            // subservice was successful
+            if (!csp_send(conn, packet, 50)) {
                 csp_buffer_free(packet);
-            } else {
-                // subservice was successful
-                if (!csp_send(conn, packet, 50)) {
-                    csp_buffer_free(packet);
-                }
             }
         }
-        csp_close(conn);
     }
 }
 
 /**
  * @brief
- *      Starts the File Transferring (FT) server task
+ *      Register the file transfer service
  * @details
- *      Starts the FreeRTOS task responsible for accepting incoming
+ *      Adds the file transfer connection handler to the service dispatcher
  * @param None
  * @return SAT_returnState
- *      Success report
+ *      success report
  */
 SAT_returnState start_FTP_service(void) {
-    TaskHandle_t svc_tsk;
-    taskFunctions svc_funcs = {0};
-    svc_funcs.getCounterFunction = get_svc_wdt_counter;
-
-    if (xTaskCreate((TaskFunction_t)FTP_service, "FTP_service", FTP_STACK_SIZE, NULL, NORMAL_SERVICE_PRIO,
-                    &svc_tsk) != pdPASS) {
-        sys_log(CRITICAL, "FAILED TO CREATE TASK FTP_service");
+    service_entry_t entry = {"FTP_service", TC_FTP_COMMAND_SERVICE, FTP_connection, SERVICE_PRIO_LOW, 1, true};
+    if (service_dispatcher_register(&entry) != SATR_OK) {
+        sys_log(CRITICAL, "FAILED TO REGISTER FTP_service");
         return SATR_ERROR;
     }
-
-    ex2_register(svc_tsk, svc_funcs);
     sys_log(INFO, "File Transfer service started\n");
     return SATR_OK;
 }
 
+/* Whether size bytes from offset in the packet's data were received, so a bad size can't read past it */
+static bool packet_holds(const csp_packet_t *packet, uint32_t offset, uint32_t size) {
+    return offset <= packet->length && size <= packet->length - offset;
+}
+
 /**
  * @brief
  *      Takes a CSP packet and switches based on the subservice command
@@ -393,6 +377,156 @@ SAT_returnState FTP_app(csp_packet_t *packet, csp_conn_t *conn) {
         red_close(fd);
         break;
     }
+    case FTP_START_FIRMWARE_UPLOAD: {
+        /**
+         * Packet contains:
+         * uint32_t request_id
+         * uint32_t image size
+         * uint32_t blocksize
+         * uint16_t image CRC-16
+         * char image to replace, 'A'. 'G' is refused, the golden image can't be updated in flight
+         * Reply contains:
+         * uint32_t count of the first block to send, more than 0 when an earlier upload is resumed
+         */
+        uint32_t req_id;
+        uint32_t size;
+        uint32_t blocksize;
+        uint16_t crc;
+        uint32_t resume_at = 0;
+        cnv8_32(&packet->data[IN_DATA_BYTE], &req_id);
+        cnv8_32(&packet->data[IN_DATA_BYTE + 4], &size);
+        cnv8_32(&packet->data[IN_DATA_BYTE + 8], &blocksize);
+        cnv8_16(&packet->data[IN_DATA_BYTE + 12], &crc);
+        image_type target = packet->data[IN_DATA_BYTE + 14] == 'G' ? IMAGE_GOLDEN : IMAGE_APPLICATION;
+        if (blocksize == 0 || fw_update_begin(target, size, crc, &resume_at) != SATR_OK) {
+            status = -1;
+            break;
+        }
+
+        memset(&firmware_upload, 0, sizeof(firmware_upload));
+        firmware_upload.req_id = req_id;
+        firmware_upload.blocksize = blocksize;
+        firmware_upload.count = resume_at / blocksize;
+        firmware_upload.type = POST_REQUEST;
+        firmware_size = size;
+        memcpy(&packet->data[OUT_DATA_BYTE], &firmware_upload.count, sizeof(firmware_upload.count));
+        reply_len = sizeof(firmware_upload.count);
+        break;
+    }
+    case FTP_FIRMWARE_PACKET: {
+        /**
+         * packet contains:
+         * uint32_t req_id
+         * uint32_t count
+         * uint32_t size of this transfer. If less than blocksize, or the image is complete, the transfer is done
+         * uint8_t data[size]
+         * The status of the last packet tells if the image was programmed and matched its CRC
+         */
+        uint32_t req_id;
+        uint32_t count;
+        uint32_t size;
+        cnv8_32(&packet->data[IN_DATA_BYTE], &req_id);
+        cnv8_32(&packet->data[IN_DATA_BYTE + 4], &count);
+        cnv8_32(&packet->data[IN_DATA_BYTE + 8], &size);
+        if (req_id != firmware_upload.req_id || firmware_upload.blocksize == 0) {
+            sys_log(WARN, "Request IDs don't match");
+            status = -1;
+            break;
+        }
+        if (count != firmware_upload.count) {
+            sys_log(WARN, "Data out of order");
+            status = -1;
+            break;
+        }
+        if (size > firmware_upload.blocksize || !packet_holds(packet, IN_DATA_BYTE + 12, size)) {
+            sys_log(WARN, "Firmware packet of %u bytes doesn't match its length", size);
+            status = -1;
+            break;
+        }
+        uint32_t offset = count * firmware_upload.blocksize;
+        if (fw_update_write(offset, &packet->data[IN_DATA_BYTE + 12], size) != SATR_OK) {
+            status = -1;
+            break;
+        }
+        firmware_upload.count++;
+        if (size < firmware_upload.blocksize || offset + size >= firmware_size) {
+            if (fw_update_finish() != SATR_OK) {
+                status = -1;
+            }
+            memset(&firmware_upload, 0, sizeof(firmware_upload));
+        }
+        break;
+    }
+    case FTP_START_DELTA_UPLOAD: {
+        /**
+         * Packet contains:
+         * uint32_t request_id
+         * uint32_t blocksize
+         * char image to replace, 'A'. The patch must be against the golden image, which is running
+         * uint8_t[FW_DELTA_HEADER_SIZE] header of the patch made by tools/fw_delta.py
+         */
+        uint32_t req_id;
+        uint32_t blocksize;
+        cnv8_32(&packet->data[IN_DATA_BYTE], &req_id);
+        cnv8_32(&packet->data[IN_DATA_BYTE + 4], &blocksize);
+        image_type target = packet->data[IN_DATA_BYTE + 8] == 'G' ? IMAGE_GOLDEN : IMAGE_APPLICATION;
+        if (blocksize == 0 || !packet_holds(packet, IN_DATA_BYTE + 9, FW_DELTA_HEADER_SIZE) ||
+            fw_update_begin_delta(target, &packet->data[IN_DATA_BYTE + 9]) != SATR_OK) {
+            status = -1;
+            break;
+        }
+
+        memset(&firmware_upload, 0, sizeof(firmware_upload));
+        firmware_upload.req_id = req_id;
+        firmware_upload.blocksize = blocksize;
+        firmware_upload.type = POST_REQUEST;
+        break;
+    }
+    case FTP_DELTA_PACKET: {
+        /**
+         * packet contains:
+         * uint32_t req_id
+         * uint32_t count
+         * uint32_t size of this transfer. If less than blocksize then transfer is done
+         * uint8_t data[size], the patch after its header
+         * The status of the last packet tells if the new image was programmed and matched its CRC
+         */
+        uint32_t req_id;
+        uint32_t count;
+        uint32_t size;
+        bool done = false;
+        cnv8_32(&packet->data[IN_DATA_BYTE], &req_id);
+        cnv8_32(&packet->data[IN_DATA_BYTE + 4], &count);
+        cnv8_32(&packet->data[IN_DATA_BYTE + 8], &size);
+        if (req_id != firmware_upload.req_id || firmware_upload.blocksize == 0) {
+            sys_log(WARN, "Request IDs don't match");
+            status = -1;
+            break;
+        }
+        if (count != firmware_upload.count) {
+            sys_log(WARN, "Data out of order");
+            status = -1;
+            break;
+        }
+        if (size > firmware_upload.blocksize || !packet_holds(packet, IN_DATA_BYTE + 12, size)) {
+            sys_log(WARN, "Firmware patch packet of %u bytes doesn't match its length", size);
+            status = -1;
+            break;
+        }
+        if (fw_update_write_delta(&packet->data[IN_DATA_BYTE + 12], size, &done) != SATR_OK) {
+            memset(&firmware_upload, 0, sizeof(firmware_upload));
+            status = -1;
+            break;
+        }
+        firmware_upload.count++;
+        if (done || size < firmware_upload.blocksize) {
+            if (!done || fw_update_finish() != SATR_OK) {
+                status = -1;
+            }
+            memset(&firmware_upload, 0, sizeof(firmware_upload));
+        }
+        break;
+    }
     default:
         ex2_log("No such subservice!\n");
         return_state = SATR_PKT_ILLEGAL_SUBSERVICE;
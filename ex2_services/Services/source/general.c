@@ -22,6 +22,7 @@
 #include "HL_reg_system.h"
 #include "privileged_functions.h"
 #include "services.h"
+#include "service_dispatcher.h"
 #include "task_manager/task_manager.h"
 #include "util/service_utilities.h"
 #include <FreeRTOS.h>
@@ -33,77 +34,53 @@
 #include "deployablescontrol.h"
 #include "bl_eeprom.h"
 #include "uhf_pipe_timer.h"
+#include "task_stats/task_stats.h"
 
 SAT_returnState general_app(csp_conn_t *conn, csp_packet_t *packet);
-void general_service(void *param);
+static void general_connection(csp_conn_t *conn);
 
-static uint32_t svc_wdt_counter = 0;
-
-static uint32_t get_svc_wdt_counter() { return svc_wdt_counter; }
 /**
  * @brief
- *      Start the general server task
+ *      Register the general service
  * @details
- *      Starts the FreeRTOS task responsible for accepting incoming
- *      general packets
+ *      Adds the general connection handler to the service dispatcher
  * @param None
  * @return SAT_returnState
  *      success report
  */
 SAT_returnState start_general_service(void) {
-    TaskHandle_t svc_tsk;
-    taskFunctions svc_funcs = {0};
-    svc_funcs.getCounterFunction = get_svc_wdt_counter;
-
-    if (xTaskCreate((TaskFunction_t)general_service, "general_service", 300, NULL, NORMAL_SERVICE_PRIO,
-                    &svc_tsk) != pdPASS) {
-        ex2_log("FAILED TO CREATE TASK general_service\n");
+    service_entry_t entry = {"general_service", TC_GENERAL_SERVICE, general_connection, SERVICE_PRIO_HIGH, 1,
+                             false};
+    if (service_dispatcher_register(&entry) != SATR_OK) {
+        ex2_log("FAILED TO REGISTER general_service\n");
         return SATR_ERROR;
     }
-    ex2_register(svc_tsk, svc_funcs);
     ex2_log("General service started\n");
     return SATR_OK;
 }
 
 /**
  * @brief
- *      FreeRTOS general server task
+ *      Handle a connection to the general service
  * @details
- *      Accepts incoming csp connections to perform tasks not covered by other services
- * @param void* param
+ *      Performs tasks not covered by other services. Run on a service
+ *      worker, which closes the connection afterwards
+ * @param conn
+ *      Connection accepted by the service dispatcher
  * @return None
  */
-void general_service(void *param) {
-    csp_socket_t *sock;
-    sock = csp_socket(CSP_SO_HMACREQ); // require RDP connection
-    csp_bind(sock, TC_GENERAL_SERVICE);
-    csp_listen(sock, SERVICE_BACKLOG_LEN);
-    svc_wdt_counter++;
-
-    for (;;) {
-        svc_wdt_counter++;
-        csp_conn_t *conn;
-        csp_packet_t *packet;
-
-        // wait for connection, timeout
-        if ((conn = csp_accept(sock, DELAY_WAIT_TIMEOUT)) == NULL) {
-            svc_wdt_counter++;
-            /* timeout */
-            continue;
-        }
-        svc_wdt_counter++;
-
-        while ((packet = csp_read(conn, 50)) != NULL) {
-            if (general_app(conn, packet) != SATR_OK) {
+static void general_connection(csp_conn_t *conn) {
+    csp_packet_t *packet;
+
+    while ((packet = csp_read(conn, 50)) != NULL) {
+        if (general_app(conn, packet) != SATR_OK) {
+            csp_buffer_free(packet);
+            ex2_log("Error responding to packet");
+        } else {
+            if (!csp_send(conn, packet, CSP_TIMEOUT)) {
                 csp_buffer_free(packet);
-                ex2_log("Error responding to packet");
-            } else {
-                if (!csp_send(conn, packet, CSP_TIMEOUT)) {
-                    csp_buffer_free(packet);
-                }
             }
         }
-        csp_close(conn); // frees buffers used
     }
 }
 
@@ -284,6 +261,30 @@ SAT_returnState general_app(csp_conn_t *conn, csp_packet_t *packet) {
         break;
     }
 
+    case GET_TASK_STATS: {
+        // Paged: the request holds the index of the first task, the reply holds as many tasks as fit
+        uint8_t first = packet->data[IN_DATA_BYTE];
+        uint8_t total = (uint8_t)task_stats_count();
+        uint32_t max_entries = (csp_buffer_data_size() - OUT_DATA_BYTE - 2) / sizeof(task_stats_entry_t);
+        task_stats_entry_t *entries = (task_stats_entry_t *)&packet->data[OUT_DATA_BYTE + 2];
+        uint8_t count = (uint8_t)task_stats_get(entries, first, max_entries);
+        for (int i = 0; i < count; i++) {
+            entries[i].cpu_short = csp_hton16(entries[i].cpu_short);
+            entries[i].cpu_long = csp_hton16(entries[i].cpu_long);
+            entries[i].stack_hwm = csp_hton16(entries[i].stack_hwm);
+            entries[i].context_switches = csp_hton32(entries[i].context_switches);
+            entries[i].max_latency_us = csp_hton32(entries[i].max_latency_us);
+        }
+        status = 0;
+        memcpy(&packet->data[STATUS_BYTE], &status, sizeof(int8_t));
+        packet->data[OUT_DATA_BYTE] = total;
+        packet->data[OUT_DATA_BYTE + 1] = count;
+        // +2 for the counts, +1 for subservice
+        set_packet_length(packet, sizeof(int8_t) + 2 + count * sizeof(task_stats_entry_t) + 1);
+
+        break;
+    }
+
     default: {
         ex2_log("No such subservice\n");
         return SATR_PKT_ILLEGAL_SUBSERVICE;
@@ -0,0 +1,230 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file hk_limits.c
+ * @date Oct. 19, 2026
+ *
+ * Limit monitoring of collected housekeeping.
+ *
+ * Each limit names one element of a housekeeping field by its section and
+ * field name, with a range and an optional rate of change. Names rather than
+ * hk_schema indices are kept, so a limit still refers to the same field
+ * after the schema changes, and is dropped if its field is removed. The
+ * housekeeping daemon checks every record it collects, and uses the sections
+ * of newly tripped limits to decide what to sample faster. Limits are
+ * uploaded from the ground and kept on the SD card so they survive a reset.
+ */
+
+#include "housekeeping/hk_limits.h"
+
+#include <FreeRTOS.h>
+#include <os_semphr.h>
+#include <os_task.h>
+#include <redposix.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "housekeeping/hk_schema.h"
+#include "logger/logger.h"
+
+static const char limits_file[] = "VOL0:/HKlimits.TMP";
+
+typedef struct {
+    uint16_t field; // index of the limit's field in hk_schema
+    double previous;
+    TickType_t previous_tick;
+    bool has_previous;
+    bool tripped;
+} limit_state_t;
+
+static hk_limit_t limits[HK_LIMIT_COUNT];
+static limit_state_t state[HK_LIMIT_COUNT];
+static bool limits_loaded = false;
+static SemaphoreHandle_t limits_lock = NULL;
+
+static void prv_get_lock(void) {
+    if (limits_lock == NULL) {
+        limits_lock = xSemaphoreCreateMutex();
+    }
+    xSemaphoreTake(limits_lock, portMAX_DELAY);
+}
+
+static void prv_give_lock(void) { xSemaphoreGive(limits_lock); }
+
+/* Index in hk_schema of the recorded field named "section.name", or -1 */
+static int32_t find_field(const char field[HK_LIMIT_FIELD_LEN]) {
+    uint16_t i;
+
+    if (memchr(field, '\0', HK_LIMIT_FIELD_LEN) == NULL) {
+        return -1;
+    }
+    for (i = 0; i < hk_schema_length && hk_schema[i].recorded; i++) {
+        size_t section_len = strlen(hk_schema[i].section);
+        if (strncmp(field, hk_schema[i].section, section_len) == 0 && field[section_len] == '.' &&
+            strcmp(&field[section_len + 1], hk_schema[i].name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* Look up a limit's field, and check the element is in range */
+static int32_t limit_field(const hk_limit_t *limit) {
+    int32_t field = find_field(limit->field);
+    if (field < 0 || limit->element >= hk_schema[field].count) {
+        return -1;
+    }
+    return field;
+}
+
+/* Must hold the lock */
+static void load_limits(void) {
+    limits_loaded = true;
+    int32_t fin = red_open(limits_file, RED_O_RDONLY);
+    if (fin == -1) {
+        return;
+    }
+    if (red_read(fin, limits, sizeof(limits)) != sizeof(limits)) {
+        sys_log(WARN, "Housekeeping limits in '%s' are incomplete, ignoring them\n", limits_file);
+        memset(limits, 0, sizeof(limits));
+    }
+    red_close(fin);
+
+    // The schema may have changed since the limits were written
+    uint8_t i;
+    for (i = 0; i < HK_LIMIT_COUNT; i++) {
+        if (!limits[i].enabled) {
+            continue;
+        }
+        int32_t field = limit_field(&limits[i]);
+        if (field < 0) {
+            sys_log(WARN, "Housekeeping limit %d names an unknown field, disabling it\n", i);
+            limits[i].enabled = 0;
+        } else {
+            state[i].field = (uint16_t)field;
+        }
+    }
+}
+
+/* Must hold the lock */
+static void store_limits(void) {
+    int32_t fout = red_open(limits_file, RED_O_CREAT | RED_O_TRUNC | RED_O_WRONLY);
+    if (fout == -1) {
+        sys_log(ERROR, "Failed to open or create file to write: '%s'\n", limits_file);
+        return;
+    }
+    if (red_write(fout, limits, sizeof(limits)) != sizeof(limits)) {
+        sys_log(ERROR, "Failed to write to file: '%s'\n", limits_file);
+    }
+    red_close(fout);
+}
+
+/**
+ * @brief
+ *      Check a collected housekeeping record against the limits
+ * @details
+ *      Logs a warning when a limit trips, and again when it clears. A limit
+ *      that stays tripped is only reported on the record where it tripped
+ * @param hk
+ *      Housekeeping just collected
+ * @return
+ *      Mask of HK_SECTION_BIT() for the sections with a limit that tripped
+ *      on this record
+ */
+uint32_t hk_limits_check(const All_systems_housekeeping *hk) {
+    const uint8_t *base = (const uint8_t *)hk;
+    TickType_t now = xTaskGetTickCount();
+    uint32_t tripped = 0;
+    uint8_t i;
+
+    prv_get_lock();
+    if (!limits_loaded) {
+        load_limits();
+    }
+    for (i = 0; i < HK_LIMIT_COUNT; i++) {
+        const hk_limit_t *limit = &limits[i];
+        limit_state_t *s = &state[i];
+        if (!limit->enabled) {
+            continue;
+        }
+        const hk_field_t *field = &hk_schema[s->field];
+        double value = hk_schema_get(field, base + field->offset + limit->element * field->width);
+        bool trip = value < limit->low || value > limit->high;
+
+        if (limit->max_rate > 0 && s->has_previous && now != s->previous_tick) {
+            double seconds = (double)(now - s->previous_tick) / configTICK_RATE_HZ;
+            double rate = (value - s->previous) / seconds;
+            if (rate > limit->max_rate || -rate > limit->max_rate) {
+                trip = true;
+            }
+        }
+        s->previous = value;
+        s->previous_tick = now;
+        s->has_previous = true;
+
+        if (trip != s->tripped) {
+            sys_log(WARN, "Housekeeping limit %d %s: %s.%s[%d] = %f", i, trip ? "tripped" : "cleared",
+                    field->section, field->name, limit->element, value);
+            s->tripped = trip;
+            if (trip) {
+                tripped |= 1UL << field->section_id;
+            }
+        }
+    }
+    prv_give_lock();
+    return tripped;
+}
+
+/**
+ * @brief
+ *      Replace one limit and save the limits to the SD card
+ * @param index
+ *      Slot to replace, below HK_LIMIT_COUNT
+ * @param limit
+ *      New limit, or one with enabled set to 0 to clear the slot
+ * @return
+ *      FAILURE if the slot is out of range, or the field is not a recorded
+ *      field or has no such element
+ */
+Result hk_limits_set(uint8_t index, const hk_limit_t *limit) {
+    int32_t field = limit->enabled ? limit_field(limit) : 0;
+    if (index >= HK_LIMIT_COUNT || field < 0) {
+        return FAILURE;
+    }
+    prv_get_lock();
+    if (!limits_loaded) {
+        load_limits();
+    }
+    limits[index] = *limit;
+    memset(&state[index], 0, sizeof(state[index]));
+    state[index].field = (uint16_t)field;
+    store_limits();
+    prv_give_lock();
+    return SUCCESS;
+}
+
+/**
+ * @brief
+ *      Copy out every limit slot
+ * @param out
+ *      Where to copy the limits
+ */
+void hk_limits_get(hk_limit_t out[HK_LIMIT_COUNT]) {
+    prv_get_lock();
+    if (!limits_loaded) {
+        load_limits();
+    }
+    memcpy(out, limits, sizeof(limits));
+    prv_give_lock();
+}
@@ -0,0 +1,331 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file hk_rollup.c
+ * @date Oct. 19, 2026
+ *
+ * Housekeeping rollups at 5 minute, 1 hour and 1 day resolution.
+ *
+ * Every stored housekeeping record is folded into one accumulator per
+ * resolution, which keeps the min, max, mean and last value of every
+ * element in the record. When a record falls in a new period the finished
+ * rollup is written to that resolution's ring file as four ordinary
+ * housekeeping records, one per statistic, so the ground decodes them like
+ * any other record. The hk_timeorder of each holds the start of the period
+ * and the number of samples in it.
+ *
+ * Slots are indexed by time, so a rollup's position in its file follows
+ * from its start time and no index has to be kept.
+ */
+
+#include "housekeeping/hk_rollup.h"
+
+#include <FreeRTOS.h>
+#include <os_semphr.h>
+#include <redposix.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "housekeeping/hk_schema.h"
+#include "logger/logger.h"
+#include "service_dispatcher.h"
+#include "util/service_utilities.h"
+
+typedef struct {
+    const char *file;
+    uint32_t period; // seconds in one rollup
+    uint16_t slots;  // rollups kept before the oldest is overwritten
+} rollup_level_t;
+
+static const rollup_level_t levels[HK_ROLLUP_LEVELS] = {
+    {"VOL0:/HKroll5m.TMP", 5 * 60, 576},       // 2 days
+    {"VOL0:/HKroll1h.TMP", 60 * 60, 336},      // 2 weeks
+    {"VOL0:/HKroll1d.TMP", 24 * 60 * 60, 366}, // 1 year
+};
+
+/* Kept in double, which holds every u32 field and the EPS timestamp exactly */
+typedef struct {
+    double min;
+    double max;
+    double sum;
+    double last;
+} rollup_stat_t;
+
+typedef struct {
+    uint32_t start;   // start of the period being accumulated
+    uint16_t samples; // 0 if nothing has been accumulated
+    rollup_stat_t stat[HK_RECORD_ELEMENTS];
+} rollup_acc_t;
+
+static rollup_acc_t acc[HK_ROLLUP_LEVELS];
+static uint8_t flush_record[HK_RECORD_SIZE];
+static SemaphoreHandle_t rollup_lock = NULL;
+
+static void prv_get_lock(void) {
+    if (rollup_lock == NULL) {
+        rollup_lock = xSemaphoreCreateMutex();
+    }
+    xSemaphoreTake(rollup_lock, portMAX_DELAY);
+}
+
+static void prv_give_lock(void) { xSemaphoreGive(rollup_lock); }
+
+static uint32_t slot_offset(const rollup_level_t *level, uint32_t start) {
+    return ((start / level->period) % level->slots) * HK_ROLLUP_STATS * HK_RECORD_SIZE;
+}
+
+static void accumulate(rollup_acc_t *a, const uint8_t *hk) {
+    uint16_t e = 0;
+    uint16_t i;
+
+    for (i = 0; i < hk_schema_length && hk_schema[i].recorded; i++) {
+        const hk_field_t *field = &hk_schema[i];
+        const uint8_t *element = hk + field->offset;
+        uint8_t n;
+        for (n = 0; n < field->count; n++, e++, element += field->width) {
+            double value = hk_schema_get(field, element);
+            rollup_stat_t *stat = &a->stat[e];
+            if (a->samples == 0) {
+                stat->min = value;
+                stat->max = value;
+                stat->sum = value;
+            } else {
+                stat->min = value < stat->min ? value : stat->min;
+                stat->max = value > stat->max ? value : stat->max;
+                stat->sum += value;
+            }
+            stat->last = value;
+        }
+    }
+    a->samples++;
+}
+
+/* Lay out one statistic of an accumulator as a housekeeping record in host byte order */
+static void build_record(const rollup_acc_t *a, hk_rollup_stat which, uint8_t *out) {
+    uint16_t e = 0;
+    uint16_t i;
+
+    for (i = 0; i < hk_schema_length && hk_schema[i].recorded; i++) {
+        const hk_field_t *field = &hk_schema[i];
+        uint8_t *element = out + field->offset;
+        uint8_t n;
+        for (n = 0; n < field->count; n++, e++, element += field->width) {
+            const rollup_stat_t *stat = &a->stat[e];
+            double value = stat->last;
+            if (which == HK_ROLLUP_MIN) {
+                value = stat->min;
+            } else if (which == HK_ROLLUP_MAX) {
+                value = stat->max;
+            } else if (which == HK_ROLLUP_MEAN) {
+                value = stat->sum / a->samples;
+            }
+            hk_schema_set(field, element, value);
+        }
+    }
+
+    hk_time_and_order timeorder = {0};
+    timeorder.UNIXtimestamp = a->start;
+    timeorder.dataPosition = a->samples;
+    memcpy(out, &timeorder, sizeof(timeorder));
+}
+
+static void flush(hk_rollup_resolution resolution) {
+    const rollup_level_t *level = &levels[resolution];
+    const rollup_acc_t *a = &acc[resolution];
+    int32_t fout = red_open(level->file, RED_O_CREAT | RED_O_RDWR);
+    if (fout == -1) {
+        sys_log(ERROR, "Failed to open or create file to write: '%s'\n", level->file);
+        return;
+    }
+
+    red_errno = 0;
+    red_lseek(fout, slot_offset(level, a->start), RED_SEEK_SET);
+    hk_rollup_stat which;
+    for (which = HK_ROLLUP_MIN; which < HK_ROLLUP_STATS; which++) {
+        build_record(a, which, flush_record);
+        red_write(fout, flush_record, HK_RECORD_SIZE);
+    }
+    if (red_errno != 0) {
+        sys_log(ERROR, "Failed to write to file: '%s'\n", level->file);
+    }
+    red_close(fout);
+}
+
+/**
+ * @brief
+ *      Fold a housekeeping record into the rollups
+ * @details
+ *      Writes out the rollups of any resolution whose period has ended
+ *      Records without a timestamp are skipped, as they can't be placed in a period
+ * @param hk
+ *      Housekeeping that was just stored, timestamped
+ */
+void hk_rollup_add(const All_systems_housekeeping *hk) {
+    uint32_t now = hk->hk_timeorder.UNIXtimestamp;
+    hk_rollup_resolution resolution;
+
+    if (now == 0) {
+        return;
+    }
+
+    prv_get_lock();
+    for (resolution = HK_ROLLUP_5MIN; resolution < HK_ROLLUP_LEVELS; resolution++) {
+        rollup_acc_t *a = &acc[resolution];
+        uint32_t start = now - now % levels[resolution].period;
+        if (a->samples != 0 && a->start != start) {
+            flush(resolution);
+            a->samples = 0;
+        }
+        a->start = start;
+        accumulate(a, (const uint8_t *)hk);
+    }
+    prv_give_lock();
+}
+
+/* Get one statistic of the rollup starting at start, from the accumulator if it is still open */
+static bool load_record(int32_t fin, hk_rollup_resolution resolution, uint32_t start, hk_rollup_stat which,
+                        uint8_t *out) {
+    const rollup_level_t *level = &levels[resolution];
+    hk_time_and_order timeorder;
+
+    prv_get_lock();
+    if (acc[resolution].samples != 0 && acc[resolution].start == start) {
+        build_record(&acc[resolution], which, out);
+        prv_give_lock();
+        return true;
+    }
+    prv_give_lock();
+
+    if (fin == -1) {
+        return false;
+    }
+    red_lseek(fin, slot_offset(level, start) + which * HK_RECORD_SIZE, RED_SEEK_SET);
+    if (red_read(fin, out, HK_RECORD_SIZE) != HK_RECORD_SIZE) {
+        return false;
+    }
+    // The slot may be empty or hold a rollup from an earlier pass around the ring
+    memcpy(&timeorder, out, sizeof(timeorder));
+    return timeorder.UNIXtimestamp == start && timeorder.dataPosition != 0;
+}
+
+static bool send_rollup(csp_conn_t *conn, csp_packet_t *packet, uint8_t final) {
+    uint8_t *record = &packet->data[HK_ROLLUP_RECORD_BYTE];
+    record[offsetof(hk_time_and_order, final)] = final;
+    hk_schema_to_ground(record);
+    if (!csp_send(conn, packet, 50)) {
+        csp_buffer_free(packet);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief
+ *      Send the rollups of one resolution that start within a time range
+ * @details
+ *      Each rollup is sent as four packets, min, max, mean and last, each
+ *      holding a full housekeeping record. hk_timeorder.final is 1 on every
+ *      packet but the last. If there are no rollups in the range, a single
+ *      packet with status -1 is sent
+ * @param conn
+ *      Pointer to the connection on which to send packets
+ * @param resolution
+ *      hk_rollup_resolution to fetch
+ * @param start
+ *      Earliest time of interest
+ * @param end
+ *      Latest time of interest
+ * @return
+ *      enum for success or failure
+ */
+Result hk_rollup_transmit(csp_conn_t *conn, uint8_t resolution, uint32_t start, uint32_t end) {
+    if (resolution >= HK_ROLLUP_LEVELS || end < start) {
+        return FAILURE;
+    }
+    const rollup_level_t *level = &levels[resolution];
+    uint32_t first = start - start % level->period;
+    uint32_t last = end - end % level->period;
+    // Anything further back than the ring holds has been overwritten
+    if ((last - first) / level->period >= level->slots) {
+        first = last - (uint32_t)(level->slots - 1) * level->period;
+    }
+
+    int32_t fin = red_open(level->file, RED_O_RDONLY);
+    csp_packet_t *pending = NULL;
+    Result result = SUCCESS;
+    uint32_t bucket = first;
+
+    for (;;) {
+        hk_rollup_stat which;
+        for (which = HK_ROLLUP_MIN; which < HK_ROLLUP_STATS; which++) {
+            csp_packet_t *packet = csp_buffer_get(HK_ROLLUP_RECORD_BYTE + HK_RECORD_SIZE);
+            if (packet == NULL) {
+                result = FAILURE;
+                break;
+            }
+            if (!load_record(fin, (hk_rollup_resolution)resolution, bucket, which,
+                             &packet->data[HK_ROLLUP_RECORD_BYTE])) {
+                csp_buffer_free(packet);
+                break;
+            }
+            packet->data[SUBSERVICE_BYTE] = GET_ROLLUP;
+            packet->data[STATUS_BYTE] = 0;
+            packet->data[HK_ROLLUP_RESOLUTION_BYTE] = resolution;
+            packet->data[HK_ROLLUP_STAT_BYTE] = which;
+            set_packet_length(packet, HK_ROLLUP_RECORD_BYTE + HK_RECORD_SIZE);
+
+            // Hold each packet back until the next is ready, so the last can be marked final
+            if (pending != NULL && !send_rollup(conn, pending, 1)) {
+                pending = NULL;
+                csp_buffer_free(packet);
+                result = FAILURE;
+                break;
+            }
+            pending = packet;
+        }
+        if (result != SUCCESS || bucket == last) {
+            break;
+        }
+        service_dispatcher_feed();
+        bucket += level->period;
+    }
+
+    if (fin != -1) {
+        red_close(fin);
+    }
+
+    if (pending != NULL) {
+        if (result == SUCCESS) {
+            return send_rollup(conn, pending, 0) ? SUCCESS : FAILURE;
+        }
+        csp_buffer_free(pending);
+        return result;
+    }
+    if (result != SUCCESS) {
+        return result;
+    }
+
+    csp_packet_t *packet = csp_buffer_get(OUT_DATA_BYTE);
+    if (packet == NULL) {
+        return FAILURE;
+    }
+    packet->data[SUBSERVICE_BYTE] = GET_ROLLUP;
+    packet->data[STATUS_BYTE] = (uint8_t)-1;
+    set_packet_length(packet, OUT_DATA_BYTE);
+    if (!csp_send(conn, packet, 50)) {
+        csp_buffer_free(packet);
+        return FAILURE;
+    }
+    return SUCCESS;
+}
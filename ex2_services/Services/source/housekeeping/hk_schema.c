@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file hk_schema.c
+ * @date Oct. 19, 2026
+ *
+ * Field table for All_systems_housekeeping, generated from the lists in
+ * hk_schema.h.
+ *
+ * The table gives the name, type, offset and ground byte order of every
+ * field. Byte swapping for the ground and filling mock data are loops over
+ * it, and since it is plain C with no target dependencies, the ground
+ * software can build it to decode records.
+ */
+
+#include "housekeeping/hk_schema.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "housekeeping/housekeeping_service.h"
+
+#define HK_MEMBER(m, f) (((All_systems_housekeeping *)0)->m.f)
+
+#define HK_FIELD_ENTRY(m, o, f, t, n, rec)                                                                        \
+    {#m, #f, offsetof(All_systems_housekeeping, m.f), sizeof(HK_MEMBER(m, f)) / (n), n, t, o, rec, HK_SECTION_##m},
+#define HK_RECORD_FIELD(m, o, f, t, n) HK_FIELD_ENTRY(m, o, f, t, n, 1)
+#define HK_LOCAL_FIELD(m, o, f, t, n) HK_FIELD_ENTRY(m, o, f, t, n, 0)
+
+#define HK_RECORD_SECTION(member, type, fields, order) fields(HK_RECORD_FIELD, member, order)
+#define HK_LOCAL_SECTION(member, type, fields, order) fields(HK_LOCAL_FIELD, member, order)
+
+const hk_field_t hk_schema[] = {HK_RECORD_SECTIONS(HK_RECORD_SECTION) HK_LOCAL_SECTIONS(HK_LOCAL_SECTION)};
+const uint16_t hk_schema_length = sizeof(hk_schema) / sizeof(hk_schema[0]);
+
+/* A field missing from a list, or a struct changed under it, fails to compile here */
+#define HK_FIELD_SIZE(m, o, f, t, n) +sizeof(HK_MEMBER(m, f))
+#define HK_SECTION_CHECK(member, type, fields, order)                                                             \
+    typedef char hk_schema_covers_##member[(0 fields(HK_FIELD_SIZE, member, order)) == sizeof(type) ? 1 : -1];
+
+HK_RECORD_SECTIONS(HK_SECTION_CHECK)
+HK_LOCAL_SECTIONS(HK_SECTION_CHECK)
+
+static hk_byte_order_t host_order(void) {
+    const uint16_t probe = 1;
+    return *(const uint8_t *)&probe == 0 ? HK_BIG_ENDIAN : HK_LITTLE_ENDIAN;
+}
+
+/**
+ * @brief
+ *      Put every field of the record in the byte order the ground expects
+ * @details
+ *      Swapping is its own inverse, so the same call on the ground turns a
+ *      received record back into host order
+ * @param hk
+ *      All_systems_housekeeping, or a record received from the satellite
+ */
+void hk_schema_to_ground(void *hk) {
+    hk_byte_order_t order = host_order();
+    uint8_t *base = (uint8_t *)hk;
+    uint16_t i;
+
+    for (i = 0; i < hk_schema_length && hk_schema[i].recorded; i++) {
+        const hk_field_t *field = &hk_schema[i];
+        if (field->width == 1 || field->order == order) {
+            continue;
+        }
+        uint8_t *element = base + field->offset;
+        uint8_t n;
+        for (n = 0; n < field->count; n++, element += field->width) {
+            uint8_t lo = 0;
+            uint8_t hi = field->width - 1;
+            for (; lo < hi; lo++, hi--) {
+                uint8_t tmp = element[lo];
+                element[lo] = element[hi];
+                element[hi] = tmp;
+            }
+        }
+    }
+}
+
+/**
+ * @brief
+ *      Read one element of a field in host byte order
+ * @param field
+ *      Field the element belongs to
+ * @param element
+ *      Start of the element, need not be aligned
+ * @return
+ *      The element's value
+ */
+double hk_schema_get(const hk_field_t *field, const void *element) {
+    int8_t i8;
+    uint16_t u16;
+    int16_t i16;
+    uint32_t u32;
+    int32_t i32;
+    float f32;
+    double f64;
+
+    switch (field->type) {
+    case HK_U8:
+        return *(const uint8_t *)element;
+    case HK_I8:
+        memcpy(&i8, element, sizeof(i8));
+        return i8;
+    case HK_U16:
+        memcpy(&u16, element, sizeof(u16));
+        return u16;
+    case HK_I16:
+        memcpy(&i16, element, sizeof(i16));
+        return i16;
+    case HK_U32:
+        memcpy(&u32, element, sizeof(u32));
+        return u32;
+    case HK_I32:
+        memcpy(&i32, element, sizeof(i32));
+        return i32;
+    case HK_F32:
+        memcpy(&f32, element, sizeof(f32));
+        return f32;
+    case HK_F64:
+        memcpy(&f64, element, sizeof(f64));
+        return f64;
+    }
+    return 0;
+}
+
+static double clamp(double value, double low, double high) {
+    if (value < low) {
+        return low;
+    }
+    return value > high ? high : value;
+}
+
+/**
+ * @brief
+ *      Store a value in one element of a field, rounded and clamped to its type
+ * @param field
+ *      Field the element belongs to
+ * @param element
+ *      Start of the element, need not be aligned
+ * @param value
+ *      Value to store
+ */
+void hk_schema_set(const hk_field_t *field, void *element, double value) {
+    double rounded = value < 0 ? value - 0.5 : value + 0.5;
+    uint8_t u8;
+    int8_t i8;
+    uint16_t u16;
+    int16_t i16;
+    uint32_t u32;
+    int32_t i32;
+    float f32 = (float)value;
+
+    switch (field->type) {
+    case HK_U8:
+        u8 = (uint8_t)clamp(rounded, 0, UINT8_MAX);
+        memcpy(element, &u8, sizeof(u8));
+        break;
+    case HK_I8:
+        i8 = (int8_t)clamp(rounded, INT8_MIN, INT8_MAX);
+        memcpy(element, &i8, sizeof(i8));
+        break;
+    case HK_U16:
+        u16 = (uint16_t)clamp(rounded, 0, UINT16_MAX);
+        memcpy(element, &u16, sizeof(u16));
+        break;
+    case HK_I16:
+        i16 = (int16_t)clamp(rounded, INT16_MIN, INT16_MAX);
+        memcpy(element, &i16, sizeof(i16));
+        break;
+    case HK_U32:
+        u32 = (uint32_t)clamp(rounded, 0, UINT32_MAX);
+        memcpy(element, &u32, sizeof(u32));
+        break;
+    case HK_I32:
+        i32 = (int32_t)clamp(rounded, INT32_MIN, INT32_MAX);
+        memcpy(element, &i32, sizeof(i32));
+        break;
+    case HK_F32:
+        memcpy(element, &f32, sizeof(f32));
+        break;
+    case HK_F64:
+        memcpy(element, &value, sizeof(value));
+        break;
+    }
+}
+
+/**
+ * @brief
+ *      Set every element of every field to the same value, for testing
+ * @param hk
+ *      All_systems_housekeeping to fill
+ * @param value
+ *      Value to store, cast to the type of each field
+ */
+void hk_schema_fill(void *hk, int32_t value) {
+    uint8_t *base = (uint8_t *)hk;
+    uint16_t i;
+
+    for (i = 0; i < hk_schema_length; i++) {
+        const hk_field_t *field = &hk_schema[i];
+        uint8_t *element = base + field->offset;
+        uint8_t n;
+        for (n = 0; n < field->count; n++, element += field->width) {
+            uint8_t u8 = (uint8_t)value;
+            uint16_t u16 = (uint16_t)value;
+            uint32_t u32 = (uint32_t)value;
+            float f32 = (float)value;
+            double f64 = (double)value;
+            switch (field->type) {
+            case HK_U8:
+            case HK_I8:
+                memcpy(element, &u8, sizeof(u8));
+                break;
+            case HK_U16:
+            case HK_I16:
+                memcpy(element, &u16, sizeof(u16));
+                break;
+            case HK_U32:
+            case HK_I32:
+                memcpy(element, &u32, sizeof(u32));
+                break;
+            case HK_F32:
+                memcpy(element, &f32, sizeof(f32));
+                break;
+            case HK_F64:
+                memcpy(element, &f64, sizeof(f64));
+                break;
+            }
+        }
+    }
+}
@@ -23,13 +23,17 @@
 #include <redposix.h> //include for file system
 #include "rtcmk.h"    //to get time from RTC
 #include "services.h"
+#include "service_dispatcher.h"
 #include "task_manager/task_manager.h"
 #include "util/service_utilities.h"
 #include "logger/logger.h"
 #include "csp/csp_endian.h"
 #include "ns_payload.h"
+#include "telemetry/telemetry_store.h"
+#include "housekeeping/hk_limits.h"
+#include "housekeeping/hk_rollup.h"
 
-uint16_t MAX_FILES = 20160; // value is 20160 (7 days) based on 30 second period
+uint16_t MAX_FILES = 20160; // 28 days of records stored every HK_STORE_PERIOD_S (120 s), less if limits trip
 char fileName[] = "VOL0:/tempHKdata.TMP";
 uint16_t current_file = 1; // Increments after file write. loops back at MAX_FILES
                            // 1 indexed
@@ -41,9 +45,6 @@ uint16_t hk_timestamp_array_size = 0; // NOT BYTES. stored as number of items. 1
 
 SemaphoreHandle_t f_count_lock = NULL;
 
-static uint32_t svc_wdt_counter = 0;
-static uint32_t get_svc_wdt_counter() { return svc_wdt_counter; }
-
 /**
  * @brief
  *      gets the hk file id that holds a timestamp closest to that given
@@ -55,8 +56,8 @@ static uint32_t get_svc_wdt_counter() { return svc_wdt_counter; }
  *      File ID if found. 0 if no file found
  */
 uint16_t get_file_id_from_timestamp(uint32_t timestamp) {
-    uint32_t threshold =
-        15; // How many seconds timestamps need to be within. Currently assumes 30 second hk intervals
+    // How many seconds timestamps need to be within. Records are at most HK_STORE_PERIOD_S apart
+    uint32_t threshold = HK_STORE_PERIOD_S / 2;
     // perform leftmost binary search
     uint32_t left;
     uint32_t right;
@@ -157,234 +158,9 @@ int32_t temp = 0;
 uint32_t tempTime = 1000;
 
 Result mock_everyone(All_systems_housekeeping *all_hk_data) {
-    // universal temps
-    long tempLong = (long)temp;
-    uint8_t tempu8 = (uint8_t)temp;
-    int8_t temp8 = (int8_t)temp;
-    double tempDouble = (temp * 1.0);
-    uint16_t tempu16 = (uint16_t)temp;
-    uint32_t tempu32 = (uint32_t)temp;
-    float tempFloat = (temp * 1.0);
-
-    // Packet meta
+    hk_schema_fill(all_hk_data, temp);
     all_hk_data->hk_timeorder.UNIXtimestamp = tempTime;
 
-    // ADCS
-    all_hk_data->adcs_hk.Estimated_Angular_Rate_X = tempFloat;
-    all_hk_data->adcs_hk.Estimated_Angular_Rate_Y = tempFloat;
-    all_hk_data->adcs_hk.Estimated_Angular_Rate_Z = tempFloat;
-    all_hk_data->adcs_hk.Estimated_Angular_Angle_X = tempFloat;
-    all_hk_data->adcs_hk.Estimated_Angular_Angle_Y = tempFloat;
-    all_hk_data->adcs_hk.Estimated_Angular_Angle_Z = tempFloat;
-    all_hk_data->adcs_hk.Sat_Position_ECI_X = tempFloat;
-    all_hk_data->adcs_hk.Sat_Position_ECI_Y = tempFloat;
-    all_hk_data->adcs_hk.Sat_Position_ECI_Z = tempFloat;
-    all_hk_data->adcs_hk.Sat_Velocity_ECI_X = tempFloat;
-    all_hk_data->adcs_hk.Sat_Velocity_ECI_Y = tempFloat;
-    all_hk_data->adcs_hk.Sat_Velocity_ECI_Z = tempFloat;
-    all_hk_data->adcs_hk.Sat_Position_LLH_X = tempFloat;
-    all_hk_data->adcs_hk.Sat_Position_LLH_Y = tempFloat;
-    all_hk_data->adcs_hk.Sat_Position_LLH_Z = tempFloat;
-    all_hk_data->adcs_hk.ECEF_Position_X = tempFloat;
-    all_hk_data->adcs_hk.ECEF_Position_Y = tempFloat;
-    all_hk_data->adcs_hk.ECEF_Position_Z = tempFloat;
-    all_hk_data->adcs_hk.Coarse_Sun_Vector_X = tempFloat;
-    all_hk_data->adcs_hk.Coarse_Sun_Vector_Y = tempFloat;
-    all_hk_data->adcs_hk.Coarse_Sun_Vector_Z = tempFloat;
-    all_hk_data->adcs_hk.Fine_Sun_Vector_X = tempFloat;
-    all_hk_data->adcs_hk.Fine_Sun_Vector_Y = tempFloat;
-    all_hk_data->adcs_hk.Fine_Sun_Vector_Z = tempFloat;
-    all_hk_data->adcs_hk.Nadir_Vector_X = tempFloat;
-    all_hk_data->adcs_hk.Nadir_Vector_Y = tempFloat;
-    all_hk_data->adcs_hk.Nadir_Vector_Z = tempFloat;
-    all_hk_data->adcs_hk.Wheel_Speed_X = tempFloat;
-    all_hk_data->adcs_hk.Wheel_Speed_Y = tempFloat;
-    all_hk_data->adcs_hk.Wheel_Speed_Z = tempFloat;
-    all_hk_data->adcs_hk.Mag_Field_Vector_X = tempFloat;
-    all_hk_data->adcs_hk.Mag_Field_Vector_Y = tempFloat;
-    all_hk_data->adcs_hk.Mag_Field_Vector_Z = tempFloat;
-    all_hk_data->adcs_hk.TC_num = tempFloat;
-    all_hk_data->adcs_hk.TM_num = tempFloat;
-    all_hk_data->adcs_hk.CommsStat_flags[0] = tempFloat;
-    all_hk_data->adcs_hk.CommsStat_flags[1] = tempFloat;
-    all_hk_data->adcs_hk.CommsStat_flags[2] = tempFloat;
-    all_hk_data->adcs_hk.CommsStat_flags[3] = tempFloat;
-    all_hk_data->adcs_hk.CommsStat_flags[4] = tempFloat;
-    all_hk_data->adcs_hk.CommsStat_flags[5] = tempFloat;
-    all_hk_data->adcs_hk.Wheel1_Current = tempFloat;
-    all_hk_data->adcs_hk.Wheel2_Current = tempFloat;
-    all_hk_data->adcs_hk.Wheel3_Current = tempFloat;
-    all_hk_data->adcs_hk.CubeSense1_Current = tempFloat;
-    all_hk_data->adcs_hk.CubeSense2_Current = tempFloat;
-    all_hk_data->adcs_hk.CubeControl_Current3v3 = tempFloat;
-    all_hk_data->adcs_hk.CubeControl_Current5v0 = tempFloat;
-    all_hk_data->adcs_hk.CubeStar_Current = tempFloat;
-    all_hk_data->adcs_hk.CubeStar_Temp = tempFloat;
-    all_hk_data->adcs_hk.Magnetorquer_Current = tempFloat;
-    all_hk_data->adcs_hk.MCU_Temp = tempFloat;
-    all_hk_data->adcs_hk.Rate_Sensor_Temp_X = tempFloat;
-    all_hk_data->adcs_hk.Rate_Sensor_Temp_Y = tempFloat;
-    all_hk_data->adcs_hk.Rate_Sensor_Temp_Z = tempFloat;
-
-    // Athena
-    uint8_t i;
-    for (i = 0; i < ATHENA_TEMP_ARRAY_SIZE; i++) {
-        all_hk_data->Athena_hk.temparray[i] = tempLong;
-    }
-    all_hk_data->Athena_hk.boot_cnt = tempu16;
-    all_hk_data->Athena_hk.OBC_mode = tempu8;
-    all_hk_data->Athena_hk.OBC_uptime = tempu16;
-    all_hk_data->Athena_hk.solar_panel_supply_curr = tempu8;
-    all_hk_data->Athena_hk.OBC_software_ver = tempu8;
-    all_hk_data->Athena_hk.cmds_received = tempu16;
-    all_hk_data->Athena_hk.pckts_uncovered_by_FEC = tempu16;
-
-    // EPS
-    all_hk_data->EPS_hk.cmd = tempu8;
-    all_hk_data->EPS_hk.status = temp8;
-    all_hk_data->EPS_hk.timestampInS = tempDouble;
-    all_hk_data->EPS_hk.uptimeInS = tempu32;
-    all_hk_data->EPS_hk.bootCnt = tempu32;
-    all_hk_data->EPS_hk.wdt_gs_time_left = tempu32;
-    all_hk_data->EPS_hk.wdt_gs_counter = tempu32;
-    all_hk_data->EPS_hk.vBatt = tempu16;
-    all_hk_data->EPS_hk.curSolar = tempu16;
-    all_hk_data->EPS_hk.curBattIn = tempu16;
-    all_hk_data->EPS_hk.curBattOut = tempu16;
-    all_hk_data->EPS_hk.outputConverterState = tempu8;
-    all_hk_data->EPS_hk.outputStatus = tempu32;
-    all_hk_data->EPS_hk.outputFaultStatus = tempu32;
-    all_hk_data->EPS_hk.protectedOutputAccessCnt = tempu16;
-    all_hk_data->EPS_hk.battMode = tempu8;
-    all_hk_data->EPS_hk.mpptMode = tempu8;
-    all_hk_data->EPS_hk.batHeaterMode = tempu8;
-    all_hk_data->EPS_hk.batHeaterState = tempu8;
-    all_hk_data->EPS_hk.PingWdt_toggles = tempu16;
-    all_hk_data->EPS_hk.PingWdt_turnOffs = tempu8;
-
-    for (i = 0; i < 2; i++) {
-        all_hk_data->EPS_hk.AOcurOutput[i] = tempu16;
-    }
-    for (i = 0; i < 4; i++) {
-        all_hk_data->EPS_hk.mpptConverterVoltage[i] = tempu16;
-    }
-    for (i = 0; i < 8; i++) {
-        all_hk_data->EPS_hk.curSolarPanels[i] = tempu16;
-        all_hk_data->EPS_hk.OutputConverterVoltage[i] = tempu16;
-    }
-    for (i = 0; i < 18; i++) {
-        all_hk_data->EPS_hk.curOutput[i] = tempu16;
-        all_hk_data->EPS_hk.outputOnDelta[i] = tempu16;
-        all_hk_data->EPS_hk.outputOffDelta[i] = tempu16;
-        all_hk_data->EPS_hk.outputFaultCnt[i] = tempu8;
-    }
-    for (i = 0; i < 14; i++) {
-        all_hk_data->EPS_hk.temp[i] = temp8;
-    }
-
-    // UHF
-    all_hk_data->UHF_hk.freq = tempu32;
-    all_hk_data->UHF_hk.pipe_t = tempu32;
-    all_hk_data->UHF_hk.beacon_t = tempu32;
-    all_hk_data->UHF_hk.audio_t = tempu32;
-    all_hk_data->UHF_hk.uptime = tempu32;
-    all_hk_data->UHF_hk.pckts_out = tempu32;
-    all_hk_data->UHF_hk.pckts_in = tempu32;
-    all_hk_data->UHF_hk.pckts_in_crc16 = tempu32;
-    all_hk_data->UHF_hk.temperature = tempFloat;
-
-    for (i = 0; i < SCW_LEN; i++) {
-        all_hk_data->UHF_hk.scw[i] = tempu8;
-    }
-
-    // Sband
-    all_hk_data->S_band_hk.Output_Power = tempFloat;
-    all_hk_data->S_band_hk.PA_Temp = tempFloat;
-    all_hk_data->S_band_hk.Top_Temp = tempFloat;
-    all_hk_data->S_band_hk.Bottom_Temp = tempFloat;
-    all_hk_data->S_band_hk.Bat_Current = tempFloat;
-    all_hk_data->S_band_hk.Bat_Voltage = tempFloat;
-    all_hk_data->S_band_hk.PA_Current = tempFloat;
-    all_hk_data->S_band_hk.PA_Voltage = tempFloat;
-
-    // Hyperion
-    all_hk_data->hyperion_hk.Nadir_Temp1 = tempFloat;
-    all_hk_data->hyperion_hk.Port_Temp1 = tempFloat;
-    all_hk_data->hyperion_hk.Port_Temp2 = tempFloat;
-    all_hk_data->hyperion_hk.Port_Temp3 = tempFloat;
-    all_hk_data->hyperion_hk.Port_Temp_Adc = tempFloat;
-    all_hk_data->hyperion_hk.Port_Dep_Temp1 = tempFloat;
-    all_hk_data->hyperion_hk.Port_Dep_Temp2 = tempFloat;
-    all_hk_data->hyperion_hk.Port_Dep_Temp3 = tempFloat;
-    all_hk_data->hyperion_hk.Port_Dep_Temp_Adc = tempFloat;
-    all_hk_data->hyperion_hk.Star_Temp1 = tempFloat;
-    all_hk_data->hyperion_hk.Star_Temp2 = tempFloat;
-    all_hk_data->hyperion_hk.Star_Temp3 = tempFloat;
-    all_hk_data->hyperion_hk.Star_Temp_Adc = tempFloat;
-    all_hk_data->hyperion_hk.Star_Dep_Temp1 = tempFloat;
-    all_hk_data->hyperion_hk.Star_Dep_Temp2 = tempFloat;
-    all_hk_data->hyperion_hk.Star_Dep_Temp3 = tempFloat;
-    all_hk_data->hyperion_hk.Star_Dep_Temp_Adc = tempFloat;
-    all_hk_data->hyperion_hk.Zenith_Temp1 = tempFloat;
-    all_hk_data->hyperion_hk.Zenith_Temp2 = tempFloat;
-    all_hk_data->hyperion_hk.Zenith_Temp3 = tempFloat;
-    all_hk_data->hyperion_hk.Zenith_Temp_Adc = tempFloat;
-    all_hk_data->hyperion_hk.Nadir_Pd1 = tempFloat;
-    all_hk_data->hyperion_hk.Port_Pd1 = tempFloat;
-    all_hk_data->hyperion_hk.Port_Pd2 = tempFloat;
-    all_hk_data->hyperion_hk.Port_Pd3 = tempFloat;
-    all_hk_data->hyperion_hk.Port_Dep_Pd1 = tempFloat;
-    all_hk_data->hyperion_hk.Port_Dep_Pd2 = tempFloat;
-    all_hk_data->hyperion_hk.Port_Dep_Pd3 = tempFloat;
-    all_hk_data->hyperion_hk.Star_Pd1 = tempFloat;
-    all_hk_data->hyperion_hk.Star_Pd2 = tempFloat;
-    all_hk_data->hyperion_hk.Star_Pd3 = tempFloat;
-    all_hk_data->hyperion_hk.Star_Dep_Pd1 = tempFloat;
-    all_hk_data->hyperion_hk.Star_Dep_Pd2 = tempFloat;
-    all_hk_data->hyperion_hk.Star_Dep_Pd3 = tempFloat;
-    all_hk_data->hyperion_hk.Zenith_Pd1 = tempFloat;
-    all_hk_data->hyperion_hk.Zenith_Pd2 = tempFloat;
-    all_hk_data->hyperion_hk.Zenith_Pd3 = tempFloat;
-    all_hk_data->hyperion_hk.Port_Voltage = tempFloat;
-    all_hk_data->hyperion_hk.Port_Dep_Voltage = tempFloat;
-    all_hk_data->hyperion_hk.Star_Voltage = tempFloat;
-    all_hk_data->hyperion_hk.Star_Dep_Voltage = tempFloat;
-    all_hk_data->hyperion_hk.Zenith_Voltage = tempFloat;
-    all_hk_data->hyperion_hk.Port_Current = tempFloat;
-    all_hk_data->hyperion_hk.Port_Dep_Current = tempFloat;
-    all_hk_data->hyperion_hk.Star_Current = tempFloat;
-    all_hk_data->hyperion_hk.Star_Dep_Current = tempFloat;
-    all_hk_data->hyperion_hk.Zenith_Current = tempFloat;
-
-    // DFGM
-    all_hk_data->DFGM_hk.coreVoltage = tempFloat;
-    all_hk_data->DFGM_hk.sensorTemp = tempFloat;
-    all_hk_data->DFGM_hk.refTemp = tempFloat;
-    all_hk_data->DFGM_hk.boardTemp = tempFloat;
-    all_hk_data->DFGM_hk.posRailVoltage = tempFloat;
-    all_hk_data->DFGM_hk.inputVoltage = tempFloat;
-    all_hk_data->DFGM_hk.refVoltage = tempFloat;
-    all_hk_data->DFGM_hk.inputCurrent = tempFloat;
-    all_hk_data->DFGM_hk.reserved1 = tempFloat;
-    all_hk_data->DFGM_hk.reserved2 = tempFloat;
-    all_hk_data->DFGM_hk.reserved3 = tempFloat;
-    all_hk_data->DFGM_hk.reserved4 = tempFloat;
-
-    // IRIS
-    all_hk_data->IRIS_hk.vis_temp = tempu16;
-    all_hk_data->IRIS_hk.nir_temp = tempu16;
-    all_hk_data->IRIS_hk.flash_temp = tempu16;
-    all_hk_data->IRIS_hk.gate_temp = tempu16;
-    all_hk_data->IRIS_hk.imagenum = tempu8;
-    all_hk_data->IRIS_hk.software_version = tempu8;
-    all_hk_data->IRIS_hk.errornum = tempu8;
-    all_hk_data->IRIS_hk.MAX_5V_voltage = tempu16;
-    all_hk_data->IRIS_hk.MAX_5V_power = tempu16;
-    all_hk_data->IRIS_hk.MAX_3V_voltage = tempu16;
-    all_hk_data->IRIS_hk.MAX_3V_power = tempu16;
-    all_hk_data->IRIS_hk.MIN_5V_voltage = tempu16;
-    all_hk_data->IRIS_hk.MIN_3V_voltage = tempu16;
-
     temp++;
     tempTime += 30;
     return SUCCESS;
@@ -392,70 +168,112 @@ Result mock_everyone(All_systems_housekeeping *all_hk_data) {
 
 /**
  * @brief
- *      Private. Collect housekeeping information from each device in system
+ *      Collect housekeeping information from devices in the system
  * @attention
  *      Error testing and review recommended to check for possible shallow
  *      copies and resultant data loss and concurrency errors
+ * @details
+ *      The record is timestamped from the RTC, or 0 if the RTC can't be read.
+ *      Sections that are not collected are filled with their latest values
+ *      from the telemetry store
  * @param all_hk_data
  *      pointer to struct of all the housekeeping data collected from components
+ * @param sections
+ *      Mask of HK_SECTION_BIT() for the subsystems to read, HK_ALL_SECTIONS for all
  * @return Result
  *      FAILURE or SUCCESS
  */
+Result collect_hk_from_devices(All_systems_housekeeping *all_hk_data, uint32_t sections) {
+    get_latest_hk(all_hk_data);
+
+    time_t now;
+    if (RTCMK_GetUnix(&now) < 0) {
+        sys_log(WARN, "Could not read the RTC, housekeeping is not timestamped\n");
+        now = 0;
+    }
+    all_hk_data->hk_timeorder.UNIXtimestamp = (uint32_t)now;
 
-Result collect_hk_from_devices(All_systems_housekeeping *all_hk_data) {
 /*populate struct by calling appropriate functions*/
 #if ADCS_IS_STUBBED == 0
-    ADCS_returnState ADCS_return_code = HAL_ADCS_getHK(&all_hk_data->adcs_hk); /* ADCS Housekeeping */
-#endif                                                                         /* ADCS_IS_STUBBED */
+    if (sections & HK_SECTION_BIT(adcs_hk)) {
+        ADCS_returnState ADCS_return_code = HAL_ADCS_getHK(&all_hk_data->adcs_hk); /* ADCS Housekeeping */
+        telemetry_write(TLM_ADCS, &all_hk_data->adcs_hk, sizeof(all_hk_data->adcs_hk),
+                        ADCS_return_code == ADCS_OK);
+    }
+#endif /* ADCS_IS_STUBBED */
 
 #if ATHENA_IS_STUBBED == 0
-    int Athena_return_code = Athena_getHK(&all_hk_data->Athena_hk); /* Athena Housekeeping */
-#endif                                                              /* ATHENA_IS_STUBBED */
+    if (sections & HK_SECTION_BIT(Athena_hk)) {
+        int Athena_return_code = Athena_getHK(&all_hk_data->Athena_hk); /* Athena Housekeeping */
+        telemetry_write(TLM_ATHENA, &all_hk_data->Athena_hk, sizeof(all_hk_data->Athena_hk),
+                        Athena_return_code == 0);
+    }
+#endif /* ATHENA_IS_STUBBED */
 
 #if EPS_IS_STUBBED == 0
-    SAT_returnState EPS_return_code = SATR_OK;
-    if (eps_refresh_instantaneous_telemetry() != SATR_OK)
-        EPS_return_code = SATR_ERROR;
-    if (eps_refresh_startup_telemetry() != SATR_OK)
-        EPS_return_code = SATR_ERROR;
-    EPS_getHK(&all_hk_data->EPS_hk, &all_hk_data->EPS_startup_hk); /* EPS Housekeeping */
-#endif                                                             /* EPS_IS_STUBBED */
+    if (sections & HK_SECTION_BIT(EPS_hk)) {
+        // The EPS daemon keeps this fresh, so this rarely waits on the EPS. The
+        // driver writes the telemetry store itself
+        eps_refresh_if_older(EPS_TELEMETRY_MAX_AGE);
+        EPS_getHK(&all_hk_data->EPS_hk, &all_hk_data->EPS_startup_hk); /* EPS Housekeeping */
+    }
+#endif /* EPS_IS_STUBBED */
 
 #if UHF_IS_STUBBED == 0
     UHF_return UHF_return_code;
-    if (!uhf_is_busy()) {
+    if ((sections & HK_SECTION_BIT(UHF_hk)) && !uhf_is_busy()) {
         UHF_return_code = UHF_getHK(&all_hk_data->UHF_hk); /* UHF Housekeeping */
+        telemetry_write(TLM_UHF, &all_hk_data->UHF_hk, sizeof(all_hk_data->UHF_hk),
+                        UHF_return_code == U_GOOD_CONFIG);
         vTaskDelay(ONE_SECOND);
     }
 #endif /* UHF_IS_STUBBED */
 
 #if SBAND_IS_STUBBED == 0
-    STX_return STX_return_code = HAL_S_getHK(&all_hk_data->S_band_hk); /* SBAND Housekeeping */
-#endif                                                                 /* SBAND_IS_STUBBED */
+    if (sections & HK_SECTION_BIT(S_band_hk)) {
+        STX_return STX_return_code = HAL_S_getHK(&all_hk_data->S_band_hk); /* SBAND Housekeeping */
+        telemetry_write(TLM_SBAND, &all_hk_data->S_band_hk, sizeof(all_hk_data->S_band_hk),
+                        STX_return_code == S_SUCCESS);
+    }
+#endif /* SBAND_IS_STUBBED */
 
 #if HYPERION_IS_STUBBED == 0
+    if (sections & HK_SECTION_BIT(hyperion_hk)) {
 #if HYPERION_PANEL_3U == 1
-    Hyperion_config1_getHK(&all_hk_data->hyperion_hk); /* Hyperion 3U Housekeeping */
-#endif                                                 /* HYPERION_PANEL_3U */
+        Hyperion_config1_getHK(&all_hk_data->hyperion_hk); /* Hyperion 3U Housekeeping */
+#endif                                                     /* HYPERION_PANEL_3U */
 
 #if HYPERION_PANEL_2U == 1
-    Hyperion_config3_getHK(&all_hk_data->hyperion_hk); /* Hyperion 2U Housekeeping */
-#endif                                                 /* HYPERION_PANEL_2U */
-#endif                                                 /* HYPERION_IS_STUBBED */
+        Hyperion_config3_getHK(&all_hk_data->hyperion_hk); /* Hyperion 2U Housekeeping */
+#endif                                                     /* HYPERION_PANEL_2U */
+        telemetry_write(TLM_HYPERION, &all_hk_data->hyperion_hk, sizeof(all_hk_data->hyperion_hk), true);
+    }
+#endif /* HYPERION_IS_STUBBED */
 
 #if CHARON_IS_STUBBED == 0
-    GPS_RETURNSTATE Charon_return_code = Charon_getHK(&all_hk_data->charon_hk); /* Charon Houskeeping */
-#endif                                                                          /* CHARON_IS_STUBBED */
+    if (sections & HK_SECTION_BIT(charon_hk)) {
+        GPS_RETURNSTATE Charon_return_code = Charon_getHK(&all_hk_data->charon_hk); /* Charon Houskeeping */
+        telemetry_write(TLM_CHARON, &all_hk_data->charon_hk, sizeof(all_hk_data->charon_hk),
+                        Charon_return_code == GPS_SUCCESS);
+    }
+#endif /* CHARON_IS_STUBBED */
 
 #if DFGM_IS_STUBBED == 0
-    DFGM_return DFGM_return_code = HAL_DFGM_get_HK(&all_hk_data->DFGM_hk); /* DFGM Housekeeping */
-#endif                                                                     /* DFGM_IS_STUBBED */
+    if (sections & HK_SECTION_BIT(DFGM_hk)) {
+        DFGM_return DFGM_return_code = HAL_DFGM_get_HK(&all_hk_data->DFGM_hk); /* DFGM Housekeeping */
+        telemetry_write(TLM_DFGM, &all_hk_data->DFGM_hk, sizeof(all_hk_data->DFGM_hk),
+                        DFGM_return_code == DFGM_SUCCESS);
+    }
+#endif /* DFGM_IS_STUBBED */
 
 #if PAYLOAD_IS_STUBBED == 0
 #if IS_EXALTA2 == 1
     // Iris housekeeping
 #else
-    NS_return NS_return_code = HAL_NS_get_telemetry(&all_hk_data->NS_hk);
+    if (sections & HK_SECTION_BIT(NS_hk)) {
+        NS_return NS_return_code = HAL_NS_get_telemetry(&all_hk_data->NS_hk);
+        telemetry_write(TLM_NS, &all_hk_data->NS_hk, sizeof(all_hk_data->NS_hk), NS_return_code == NS_OK);
+    }
 #endif /* IS_EXALTA2 */
 #endif /* PAYLOAD_IS_STUBBED */
     /*consider if struct should hold error codes returned from these functions*/
@@ -541,21 +359,14 @@ Result load_config() {
  * @return needed_size
  *    uint16_t of the size of the structure
  */
-uint16_t get_size_of_housekeeping(All_systems_housekeeping *all_hk_data) {
-    uint16_t needed_size = sizeof(all_hk_data->hk_timeorder) + sizeof(all_hk_data->Athena_hk) +
-                           sizeof(all_hk_data->EPS_hk) + sizeof(all_hk_data->UHF_hk) +
-                           sizeof(all_hk_data->S_band_hk) + sizeof(all_hk_data->adcs_hk) +
-                           sizeof(all_hk_data->hyperion_hk) + sizeof(all_hk_data->charon_hk) +
-                           sizeof(all_hk_data->DFGM_hk) + sizeof(all_hk_data->NS_hk);
-    return needed_size;
-}
+uint16_t get_size_of_housekeeping(All_systems_housekeeping *all_hk_data) { return HK_RECORD_SIZE; }
 
 /**
  * @brief
  *      Write housekeeping data to the given file location
  * @details
- *      Writes one struct to file for each subsystem present
- *      Order of writes must match the appropriate read function
+ *      The record sections are contiguous in All_systems_housekeeping, so the
+ *      record is written in one call
  * @param filenumber
  *     uint16_t number to seek to in file
  * @param all_hk_data
@@ -576,17 +387,7 @@ Result write_hk_to_file(uint16_t filenumber, All_systems_housekeeping *all_hk_da
     red_lseek(fout, (filenumber - 1) * needed_size, RED_SEEK_SET);
 
     red_errno = 0;
-    /*The order of writes and subsequent reads must match*/
-    red_write(fout, &all_hk_data->hk_timeorder, sizeof(all_hk_data->hk_timeorder));
-    red_write(fout, &all_hk_data->adcs_hk, sizeof(all_hk_data->adcs_hk));
-    red_write(fout, &all_hk_data->Athena_hk, sizeof(all_hk_data->Athena_hk));
-    red_write(fout, &all_hk_data->EPS_hk, sizeof(all_hk_data->EPS_hk));
-    red_write(fout, &all_hk_data->UHF_hk, sizeof(all_hk_data->UHF_hk));
-    red_write(fout, &all_hk_data->S_band_hk, sizeof(all_hk_data->S_band_hk));
-    red_write(fout, &all_hk_data->hyperion_hk, sizeof(all_hk_data->hyperion_hk));
-    red_write(fout, &all_hk_data->charon_hk, sizeof(all_hk_data->charon_hk));
-    red_write(fout, &all_hk_data->DFGM_hk, sizeof(all_hk_data->DFGM_hk));
-    red_write(fout, &all_hk_data->NS_hk, sizeof(all_hk_data->NS_hk));
+    red_write(fout, all_hk_data, HK_RECORD_SIZE);
 
     if (red_errno != 0) {
         sys_log(ERROR, "Failed to write to file: '%s'\n", fileName);
@@ -601,8 +402,7 @@ Result write_hk_to_file(uint16_t filenumber, All_systems_housekeeping *all_hk_da
  * @brief
  *      Read housekeeping data from given file
  * @details
- *      Reads one struct from file for each subsystem present
- *      Order of reads must match the appropriate write function
+ *      Reads the record sections of All_systems_housekeeping in one call
  * @param filenumber
  *      uint16_t position to seek to in file
  * @param all_hk_data
@@ -626,17 +426,7 @@ Result read_hk_from_file(uint16_t filenumber, All_systems_housekeeping *all_hk_d
     red_lseek(fin, (filenumber - 1) * needed_size, RED_SEEK_SET);
 
     red_errno = 0;
-    /*The order of writes and subsequent reads must match*/
-    red_read(fin, &all_hk_data->hk_timeorder, sizeof(all_hk_data->hk_timeorder));
-    red_read(fin, &all_hk_data->adcs_hk, sizeof(all_hk_data->adcs_hk));
-    red_read(fin, &all_hk_data->Athena_hk, sizeof(all_hk_data->Athena_hk));
-    red_read(fin, &all_hk_data->EPS_hk, sizeof(all_hk_data->EPS_hk));
-    red_read(fin, &all_hk_data->UHF_hk, sizeof(all_hk_data->UHF_hk));
-    red_read(fin, &all_hk_data->S_band_hk, sizeof(all_hk_data->S_band_hk));
-    red_read(fin, &all_hk_data->hyperion_hk, sizeof(all_hk_data->hyperion_hk));
-    red_read(fin, &all_hk_data->charon_hk, sizeof(all_hk_data->charon_hk));
-    red_read(fin, &all_hk_data->DFGM_hk, sizeof(all_hk_data->DFGM_hk));
-    red_read(fin, &all_hk_data->NS_hk, sizeof(all_hk_data->NS_hk));
+    red_read(fin, all_hk_data, HK_RECORD_SIZE);
 
     if (red_errno != 0) {
         sys_log(ERROR, "Failed to read: '%c'\n", fileName);
@@ -669,20 +459,13 @@ static inline void prv_give_lock(SemaphoreHandle_t *lock) { xSemaphoreGive(*lock
 
 /**
  * @brief
- *      Public. Performs all calls and operations to retrieve hk data and store it
+ *      Store a collected housekeeping record to the SD card and the rollups
+ * @param hk
+ *      Housekeeping to store. Its dataPosition is set to the file it is stored in
  * @return
  *      enum for SUCCESS or FAILURE
  */
-Result populate_and_store_hk_data(void) {
-
-    All_systems_housekeeping temp_hk_data;
-
-    if (collect_hk_from_devices(&temp_hk_data) == FAILURE) {
-        sys_log(WARN, "Error collecting hk data from peripherals\n");
-    }
-
-    // RTC_get_unix_time(&temp_hk_data.hk_timeorder.UNIXtimestamp);
-
+Result store_hk_data(All_systems_housekeeping *hk) {
     prv_get_lock(&f_count_lock); // lock
 
     if (config_loaded == 0) {
@@ -692,19 +475,18 @@ Result populate_and_store_hk_data(void) {
     }
     config_loaded = 1;
 
-    // TEMP mock hk
-    // mock_everyone(&temp_hk_data); //not permanent
-
-    temp_hk_data.hk_timeorder.dataPosition = current_file;
+    hk->hk_timeorder.dataPosition = current_file;
 
-    if (write_hk_to_file(current_file, &temp_hk_data) != SUCCESS) {
+    if (write_hk_to_file(current_file, hk) != SUCCESS) {
         sys_log(ERROR, "Housekeeping data lost\n");
         prv_give_lock(&f_count_lock); // unlock
         return FAILURE;
     }
 
+    hk_rollup_add(hk);
+
     if (dynamic_timestamp_array_handler(MAX_FILES) == SUCCESS) {
-        timestamps[current_file] = temp_hk_data.hk_timeorder.UNIXtimestamp;
+        timestamps[current_file] = hk->hk_timeorder.UNIXtimestamp;
     } else {
         sys_log(WARN, "Warning, failed to malloc for secondary data structure\n");
     }
@@ -721,6 +503,26 @@ Result populate_and_store_hk_data(void) {
     return SUCCESS;
 }
 
+/**
+ * @brief
+ *      Public. Performs all calls and operations to retrieve hk data and store it
+ * @return
+ *      enum for SUCCESS or FAILURE
+ */
+Result populate_and_store_hk_data(void) {
+
+    All_systems_housekeeping temp_hk_data = {0};
+
+    if (collect_hk_from_devices(&temp_hk_data, HK_ALL_SECTIONS) == FAILURE) {
+        sys_log(WARN, "Error collecting hk data from peripherals\n");
+    }
+
+    // TEMP mock hk
+    // mock_everyone(&temp_hk_data); //not permanent
+
+    return store_hk_data(&temp_hk_data);
+}
+
 /**
  * @brief
  *      Performs all calls and operations to load hk data from disk
@@ -792,36 +594,33 @@ Result set_max_files(uint16_t new_max) {
  * @brief
  *      Is given a struct of all the housekeeping data and converts the
  *      endianness of each value to be sent over the network
+ * @details
+ *      Each field is put in the byte order listed for its section in hk_schema.h
  * @param hk
  *      A struct of all the housekeeping data
  * @return
  *      enum for SUCCESS or FAILURE
  */
 Result convert_hk_endianness(All_systems_housekeeping *hk) {
-    /*hk_time_and_order*/
-    hk->hk_timeorder.UNIXtimestamp = csp_hton32(hk->hk_timeorder.UNIXtimestamp);
-    hk->hk_timeorder.dataPosition = csp_hton16(hk->hk_timeorder.dataPosition);
-
-    // TODO:
-    // hk->ADCS_hk.
-
-    /*athena_housekeeping*/
-    Athena_hk_convert_endianness(&hk->Athena_hk);
-
-    /*eps_instantaneous_telemetry_t*/
-    prv_instantaneous_telemetry_letoh(&hk->EPS_hk);
-
-    /*UHF_housekeeping*/
-    UHF_convert_endianness(&hk->UHF_hk);
-
-    /*Sband_Housekeeping*/
-    HAL_S_hk_convert_endianness(&hk->S_band_hk);
-
-    /* The endianness converters for ADCS and Hyperion were never created */
-
+    hk_schema_to_ground(hk);
     return SUCCESS;
 }
 
+/**
+ * @brief
+ *      Copy the housekeeping structs that are sent to the ground into a packet
+ * @param out
+ *      Start of the housekeeping data in the packet
+ * @param hk
+ *      Housekeeping data, already converted to network byte order
+ * @return
+ *      Number of bytes written
+ */
+static uint16_t pack_hk(uint8_t *out, All_systems_housekeeping *hk) {
+    memcpy(out, hk, HK_RECORD_SIZE);
+    return HK_RECORD_SIZE;
+}
+
 /**
  * @brief
  *      Paging function to retrieve sets of data so they can be transmitted
@@ -887,29 +686,7 @@ Result fetch_historic_hk_and_transmit(csp_conn_t *conn, uint16_t limit, uint16_t
         memcpy(&packet->data[SUBSERVICE_BYTE], &ser_subtype, sizeof(int8_t));
         memcpy(&packet->data[STATUS_BYTE], &status, sizeof(int8_t));
 
-        uint16_t used_size = 0;
-        memcpy(&packet->data[OUT_DATA_BYTE + used_size], &all_hk_data.hk_timeorder,
-               sizeof(all_hk_data.hk_timeorder));
-        used_size += sizeof(all_hk_data.hk_timeorder);
-        memcpy(&packet->data[OUT_DATA_BYTE + used_size], &all_hk_data.adcs_hk, sizeof(all_hk_data.adcs_hk));
-        used_size += sizeof(all_hk_data.adcs_hk);
-        memcpy(&packet->data[OUT_DATA_BYTE + used_size], &all_hk_data.Athena_hk, sizeof(all_hk_data.Athena_hk));
-        used_size += sizeof(all_hk_data.Athena_hk);
-        memcpy(&packet->data[OUT_DATA_BYTE + used_size], &all_hk_data.EPS_hk, sizeof(all_hk_data.EPS_hk));
-        used_size += sizeof(all_hk_data.EPS_hk);
-        memcpy(&packet->data[OUT_DATA_BYTE + used_size], &all_hk_data.UHF_hk, sizeof(all_hk_data.UHF_hk));
-        used_size += sizeof(all_hk_data.UHF_hk);
-        memcpy(&packet->data[OUT_DATA_BYTE + used_size], &all_hk_data.S_band_hk, sizeof(all_hk_data.S_band_hk));
-        used_size += sizeof(all_hk_data.S_band_hk);
-        memcpy(&packet->data[OUT_DATA_BYTE + used_size], &all_hk_data.hyperion_hk,
-               sizeof(all_hk_data.hyperion_hk));
-        used_size += sizeof(all_hk_data.hyperion_hk);
-        memcpy(&packet->data[OUT_DATA_BYTE + used_size], &all_hk_data.charon_hk, sizeof(all_hk_data.charon_hk));
-        used_size += sizeof(all_hk_data.charon_hk);
-        memcpy(&packet->data[OUT_DATA_BYTE + used_size], &all_hk_data.DFGM_hk, sizeof(all_hk_data.DFGM_hk));
-        used_size += sizeof(all_hk_data.DFGM_hk);
-        memcpy(&packet->data[OUT_DATA_BYTE + used_size], &all_hk_data.NS_hk, sizeof(all_hk_data.NS_hk));
-        used_size += sizeof(all_hk_data.NS_hk);
+        uint16_t used_size = pack_hk(&packet->data[OUT_DATA_BYTE], &all_hk_data);
 
         set_packet_length(packet, used_size + 2);
 
@@ -918,11 +695,110 @@ Result fetch_historic_hk_and_transmit(csp_conn_t *conn, uint16_t limit, uint16_t
             csp_buffer_free(packet);
             return FAILURE;
         }
+        service_dispatcher_feed();
         limit--;
     }
     return SUCCESS;
 }
 
+/**
+ * @brief
+ *      Fill in the latest housekeeping of every subsystem from the telemetry store.
+ * @details
+ *      No bus is accessed, so this never waits on a slow subsystem. Subsystems
+ *      that have not been read since boot are left zeroed.
+ * @param all_hk_data
+ *      Struct to fill
+ */
+void get_latest_hk(All_systems_housekeeping *all_hk_data) {
+    memset(all_hk_data, 0, sizeof(*all_hk_data));
+    telemetry_read(TLM_ADCS, &all_hk_data->adcs_hk, sizeof(all_hk_data->adcs_hk), NULL);
+    telemetry_read(TLM_ATHENA, &all_hk_data->Athena_hk, sizeof(all_hk_data->Athena_hk), NULL);
+    telemetry_read(TLM_EPS, &all_hk_data->EPS_hk, sizeof(all_hk_data->EPS_hk), NULL);
+    telemetry_read(TLM_EPS_STARTUP, &all_hk_data->EPS_startup_hk, sizeof(all_hk_data->EPS_startup_hk), NULL);
+    telemetry_read(TLM_UHF, &all_hk_data->UHF_hk, sizeof(all_hk_data->UHF_hk), NULL);
+    telemetry_read(TLM_SBAND, &all_hk_data->S_band_hk, sizeof(all_hk_data->S_band_hk), NULL);
+    telemetry_read(TLM_HYPERION, &all_hk_data->hyperion_hk, sizeof(all_hk_data->hyperion_hk), NULL);
+    telemetry_read(TLM_CHARON, &all_hk_data->charon_hk, sizeof(all_hk_data->charon_hk), NULL);
+    telemetry_read(TLM_DFGM, &all_hk_data->DFGM_hk, sizeof(all_hk_data->DFGM_hk), NULL);
+    telemetry_read(TLM_NS, &all_hk_data->NS_hk, sizeof(all_hk_data->NS_hk), NULL);
+    telemetry_read(TLM_IRIS, &all_hk_data->IRIS_hk, sizeof(all_hk_data->IRIS_hk), NULL);
+}
+
+/**
+ * @brief
+ *      Reply to a request with the latest housekeeping from the telemetry store
+ * @param conn
+ *      Pointer to the connection on which to send the reply
+ * @param packet
+ *      The request, reused for the reply
+ * @return
+ *      enum for success or failure
+ */
+static Result send_latest_hk(csp_conn_t *conn, csp_packet_t *packet) {
+    All_systems_housekeeping all_hk_data;
+    int8_t status = 0;
+    uint16_t used_size = 0;
+
+    get_latest_hk(&all_hk_data);
+    convert_hk_endianness(&all_hk_data);
+    if (get_size_of_housekeeping(&all_hk_data) + OUT_DATA_BYTE > csp_buffer_data_size()) {
+        status = -1;
+    } else {
+        used_size = pack_hk(&packet->data[OUT_DATA_BYTE], &all_hk_data);
+    }
+    memcpy(&packet->data[STATUS_BYTE], &status, sizeof(int8_t));
+    set_packet_length(packet, used_size + 2);
+
+    if (!csp_send(conn, packet, 50)) {
+        csp_buffer_free(packet);
+        return FAILURE;
+    }
+    return status == 0 ? SUCCESS : FAILURE;
+}
+
+/**
+ * @brief
+ *      Convert a limit between host and network byte order
+ * @param limit
+ *      Limit to convert in place
+ */
+static void limit_convert_endianness(hk_limit_t *limit) {
+    limit->low = csp_htonflt(limit->low);
+    limit->high = csp_htonflt(limit->high);
+    limit->max_rate = csp_htonflt(limit->max_rate);
+}
+
+/**
+ * @brief
+ *      Reply with every limit slot, in slot order
+ * @param conn
+ *      Pointer to the connection on which to send the reply
+ * @param packet
+ *      The request, reused for the reply
+ * @return
+ *      enum for success or failure
+ */
+static Result send_limits(csp_conn_t *conn, csp_packet_t *packet) {
+    hk_limit_t limits[HK_LIMIT_COUNT];
+    int8_t status = 0;
+    uint8_t i;
+
+    hk_limits_get(limits);
+    for (i = 0; i < HK_LIMIT_COUNT; i++) {
+        limit_convert_endianness(&limits[i]);
+    }
+    memcpy(&packet->data[STATUS_BYTE], &status, sizeof(int8_t));
+    memcpy(&packet->data[OUT_DATA_BYTE], limits, sizeof(limits));
+    set_packet_length(packet, sizeof(limits) + 2);
+
+    if (!csp_send(conn, packet, 50)) {
+        csp_buffer_free(packet);
+        return FAILURE;
+    }
+    return SUCCESS;
+}
+
 /**
  * @brief
  *      Processes the incoming requests to decide what response is needed
@@ -941,6 +817,10 @@ SAT_returnState hk_service_app(csp_conn_t *conn, csp_packet_t *packet) {
     uint16_t limit;
     uint16_t before_id;
     uint32_t before_time;
+    uint8_t resolution;
+    uint32_t start;
+    uint32_t end;
+    hk_limit_t new_limit;
 
     switch (ser_subtype) {
     case SET_MAX_FILES:
@@ -988,6 +868,42 @@ SAT_returnState hk_service_app(csp_conn_t *conn, csp_packet_t *packet) {
         }
         break;
 
+    case GET_ROLLUP:
+        resolution = packet->data[IN_DATA_BYTE];
+        memcpy(&start, &packet->data[IN_DATA_BYTE + 1], sizeof(start));
+        memcpy(&end, &packet->data[IN_DATA_BYTE + 5], sizeof(end));
+
+        csp_buffer_free(packet);
+        if (hk_rollup_transmit(conn, resolution, csp_ntoh32(start), csp_ntoh32(end)) != SUCCESS) {
+            return SATR_ERROR;
+        }
+        break;
+
+    case SET_LIMIT:
+        memcpy(&new_limit, &packet->data[IN_DATA_BYTE + 1], sizeof(new_limit));
+        limit_convert_endianness(&new_limit);
+
+        status = hk_limits_set(packet->data[IN_DATA_BYTE], &new_limit) == SUCCESS ? 0 : -1;
+        memcpy(&packet->data[STATUS_BYTE], &status, sizeof(int8_t));
+        set_packet_length(packet, sizeof(int8_t) + 1); // +1 for subservice
+
+        if (!csp_send(conn, packet, 50)) {
+            csp_buffer_free(packet);
+        }
+        break;
+
+    case GET_LIMITS:
+        if (send_limits(conn, packet) != SUCCESS) {
+            return SATR_ERROR;
+        }
+        break;
+
+    case GET_LATEST_HK:
+        if (send_latest_hk(conn, packet) != SUCCESS) {
+            return SATR_ERROR;
+        }
+        break;
+
     default:
         ex2_log("No such subservice\n");
         return SATR_PKT_ILLEGAL_SUBSERVICE;
@@ -1000,57 +916,41 @@ SAT_returnState start_housekeeping_service(void);
 
 /**
  * @brief
- *      FreeRTOS housekeeping server task
+ *      Handle a connection to the housekeeping service
  * @details
- *      Accepts incoming housekeeping service packets and executes the application
- * @param void* param
+ *      Reads incoming housekeeping service packets and executes the application.
+ *      Run on a service worker, which closes the connection afterwards
+ * @param conn
+ *      Connection accepted by the service dispatcher
  * @return None
  */
-void housekeeping_service(void *param) {
-    csp_socket_t *sock;
-    sock = csp_socket(CSP_SO_HMACREQ);
-    csp_bind(sock, TC_HOUSEKEEPING_SERVICE);
-    csp_listen(sock, SERVICE_BACKLOG_LEN);
-    svc_wdt_counter++;
-
-    for (;;) {
-        csp_conn_t *conn;
-        csp_packet_t *packet;
-        if ((conn = csp_accept(sock, CSP_MAX_TIMEOUT)) == NULL) {
-            /* timeout */
-            continue;
-        }
-        svc_wdt_counter++;
+static void housekeeping_connection(csp_conn_t *conn) {
+    csp_packet_t *packet;
 
-        while ((packet = csp_read(conn, 50)) != NULL) {
-            if (hk_service_app(conn, packet) != SATR_OK) {
-                ex2_log("Error responding to packet");
-            }
+    while ((packet = csp_read(conn, 50)) != NULL) {
+        service_dispatcher_feed();
+        if (hk_service_app(conn, packet) != SATR_OK) {
+            ex2_log("Error responding to packet");
         }
-        csp_close(conn); // frees buffers used
     }
 }
 
 /**
  * @brief
- *      Start the housekeeping server task
+ *      Register the housekeeping service
  * @details
- *      Starts the FreeRTOS task responsible for accepting incoming
- *      housekeeping service requests
+ *      Adds the housekeeping connection handler to the service dispatcher
  * @param None
  * @return SAT_returnState
  *      success report
  */
 SAT_returnState start_housekeeping_service(void) {
-    TaskHandle_t svc_tsk;
-    taskFunctions svc_funcs = {0};
-    svc_funcs.getCounterFunction = get_svc_wdt_counter;
-    if (xTaskCreate((TaskFunction_t)housekeeping_service, "start_housekeeping_service", 600, NULL,
-                    NORMAL_SERVICE_PRIO, &svc_tsk) != pdPASS) {
-        ex2_log("FAILED TO CREATE TASK start_housekeeping_service\n");
+    service_entry_t entry = {"housekeeping_service", TC_HOUSEKEEPING_SERVICE, housekeeping_connection,
+                             SERVICE_PRIO_NORMAL, 1, false};
+    if (service_dispatcher_register(&entry) != SATR_OK) {
+        ex2_log("FAILED TO REGISTER housekeeping_service\n");
         return SATR_ERROR;
     }
-    ex2_register(svc_tsk, svc_funcs);
     ex2_log("Service handlers started\n");
     return SATR_OK;
 }
@@ -21,10 +21,38 @@
 #include "logger/logger_service.h"
 #include "logger/logger.h"
 #include "services.h"
+#include "service_dispatcher.h"
 #include "task_manager/task_manager.h"
 #include "util/service_utilities.h" //for setting csp packet length
 #include <csp/csp.h>
+#include <csp/csp_endian.h>
 #include <redposix.h>
+#include <string.h>
+
+#define LOG_SCAN_BLOCK 256
+#define LOG_LINE_MAX STRING_MAX_LEN
+
+/* Every line starts with the uptime, a comma and the level, e.g. "0000001234,I," */
+#define LOG_UPTIME_DIGITS 10
+#define LOG_LEVEL_INDEX 11
+#define LOG_LINE_PREFIX 12
+
+#define LOG_STREAM_DATA_BYTE (STATUS_BYTE + sizeof(log_stream_reply_t))
+
+/* Same order as SysLog_Level, as written by sys_log */
+static const char level_abbreviations[] = {'P', 'A', 'C', 'E', 'W', 'N', 'I', 'D'};
+
+typedef struct {
+    bool valid;
+    uint32_t uptime;
+    uint8_t level;
+} log_line_info;
+
+typedef struct {
+    uint32_t next_line;   // start of the line after the one being checked
+    uint32_t prev_uptime; // uptime of that line
+    uint32_t lines;       // lines counted so far for LOG_STREAM_TAIL
+} log_scan_state;
 
 const char log_file[] = "VOL0:/syslog.log";         // replace with getter in logger.c
 const char old_log_file[] = "VOL0:/syslog_old.log"; // replace with getter
@@ -32,9 +60,6 @@ uint32_t max_file_size = 500;                       // repalce with getter
 
 uint32_t max_string_length = 500;
 
-static uint32_t svc_wdt_counter = 0;
-static uint32_t get_svc_wdt_counter() { return svc_wdt_counter; }
-
 /* @brief
  *      Check if file with given name exists
  * @param filename
@@ -57,7 +82,9 @@ int file_exists(const char *filename) {
 /**
  * @brief
  *      generic file to open and read any file that would contain text data.
- *      primarily designed to handle either of the 2 log files that may be read
+ *      primarily designed to handle either of the 2 log files that may be read.
+ *      Only the first max_string_length bytes fit in the reply, so only those
+ *      are read. Use STREAM_LOG for the rest of the file
  *
  * @param filename
  *      the name of the file to be opened and read
@@ -67,40 +94,283 @@ int file_exists(const char *filename) {
         state to define success of the operation
  */
 SAT_returnState get_file(char *filename, csp_packet_t *packet) {
-    uint32_t max_file_size;
     int8_t status;
     int32_t file;
-    uint32_t data_size;
-    char *log_data;
-    get_logger_file_size(&max_file_size);
-    log_data = (char *)pvPortMalloc(max_file_size);
-    if (log_data == NULL) {
-        status = -2;
-    } else if (file_exists(filename) == 0) {
+    int32_t data_size = 0;
+    char *log_data = (char *)&packet->data[OUT_DATA_BYTE];
+
+    memset(log_data, 0, max_string_length);
+    if (file_exists(filename) == 0) {
         file = red_open(filename, RED_O_RDONLY);
         if (file > -1) {
-            data_size = red_read(file, log_data, max_file_size);
-            if (data_size == 0) {
+            data_size = red_read(file, log_data, max_string_length);
+            red_close(file);
+            if (data_size <= 0) {
                 status = -1;
-                data_size = sprintf(log_data, "Log file %s is empty\n", filename);
+                snprintf(log_data, max_string_length, "Log file %s is empty\n", filename);
             } else {
                 status = 0;
             }
         } else {
             status = -1;
-            data_size = sprintf(log_data, "Can't open log file. red_errno: %d\n", red_errno);
+            snprintf(log_data, max_string_length, "Can't open log file. red_errno: %d\n", red_errno);
         }
     } else {
         status = -1;
-        data_size = sprintf(log_data, "Log file %s does not exist\n", filename);
-    }
-    for (uint32_t i = data_size; i < max_file_size; i++) {
-        log_data[i] = '\0';
+        snprintf(log_data, max_string_length, "Log file %s does not exist\n", filename);
     }
     memcpy(&packet->data[STATUS_BYTE], &status, 1);
-    memcpy(&packet->data[OUT_DATA_BYTE], log_data, max_string_length);
     set_packet_length(packet, max_string_length + 2);
-    vPortFree(log_data);
+    return SATR_OK;
+}
+
+/**
+ * @brief
+ *      Parse the "0000001234,I" uptime and level prefix that the logger puts on every line
+ * @param prefix
+ *      Start of the line
+ * @param avail
+ *      Number of valid bytes at prefix
+ * @return log_line_info
+ *      valid is false if the line does not start with a prefix. Such lines are treated as DEBUG
+ */
+static log_line_info parse_line_prefix(const char *prefix, uint32_t avail) {
+    log_line_info info = {false, 0, DEBUG};
+    int i;
+
+    if (avail < LOG_LINE_PREFIX || prefix[LOG_UPTIME_DIGITS] != ',') {
+        return info;
+    }
+    for (i = 0; i < LOG_UPTIME_DIGITS; i++) {
+        if (prefix[i] < '0' || prefix[i] > '9') {
+            return info;
+        }
+        info.uptime = info.uptime * 10 + (prefix[i] - '0');
+    }
+    for (i = 0; i < sizeof(level_abbreviations); i++) {
+        if (prefix[LOG_LEVEL_INDEX] == level_abbreviations[i]) {
+            info.level = i;
+            info.valid = true;
+        }
+    }
+    return info;
+}
+
+/**
+ * @brief
+ *      Check one line while scanning the log backwards for where a
+ *      LOG_STREAM_TAIL or LOG_STREAM_SINCE request should start
+ * @return
+ *      true once the start has been found and written to start
+ */
+static bool is_stream_start(const log_stream_request_t *req, const char *prefix, uint32_t avail,
+                            uint32_t line_start, log_scan_state *scan, uint32_t *start) {
+    log_line_info info = parse_line_prefix(prefix, avail);
+
+    if (req->mode == LOG_STREAM_TAIL) {
+        if (info.level <= req->max_level && ++scan->lines >= req->arg) {
+            *start = line_start;
+            return true;
+        }
+    } else if (info.valid) {
+        // Going backwards the uptime only grows again where the OBC rebooted
+        if (info.uptime < req->arg || info.uptime > scan->prev_uptime) {
+            *start = scan->next_line;
+            return true;
+        }
+        scan->prev_uptime = info.uptime;
+    }
+    scan->next_line = line_start;
+    return false;
+}
+
+/**
+ * @brief
+ *      Scan the log backwards from the end to find where a LOG_STREAM_TAIL or
+ *      LOG_STREAM_SINCE request starts, without reading more than needed
+ * @return
+ *      0 on success, -1 on a file system error
+ */
+static int32_t find_stream_start(int32_t fd, uint32_t file_size, const log_stream_request_t *req,
+                                 uint32_t *start) {
+    char block[LOG_SCAN_BLOCK];
+    char prefix[LOG_LINE_PREFIX] = {0}; // the bytes following the current position
+    log_scan_state scan = {file_size, UINT32_MAX, 0};
+    uint32_t pos = file_size;
+    int32_t i;
+
+    *start = 0;
+    if (req->mode == LOG_STREAM_TAIL && req->arg == 0) {
+        *start = file_size;
+        return 0;
+    }
+    while (pos > 0) {
+        uint32_t n = pos < LOG_SCAN_BLOCK ? pos : LOG_SCAN_BLOCK;
+        pos -= n;
+        if (red_lseek(fd, pos, RED_SEEK_SET) < 0 || red_read(fd, block, n) != n) {
+            return -1;
+        }
+        for (i = n - 1; i >= 0; i--) {
+            uint32_t line_start = pos + i + 1;
+            if (block[i] == '\n' && line_start < file_size &&
+                is_stream_start(req, prefix, file_size - line_start, line_start, &scan, start)) {
+                return 0;
+            }
+            memmove(prefix + 1, prefix, LOG_LINE_PREFIX - 1);
+            prefix[0] = block[i];
+        }
+    }
+    if (file_size > 0 && !is_stream_start(req, prefix, file_size, 0, &scan, start)) {
+        *start = 0;
+    }
+    return 0;
+}
+
+static csp_packet_t *new_stream_packet(uint32_t chunk_size) {
+    csp_packet_t *packet = csp_buffer_get(LOG_STREAM_DATA_BYTE + chunk_size);
+    if (packet != NULL) {
+        packet->data[SUBSERVICE_BYTE] = STREAM_LOG;
+    }
+    return packet;
+}
+
+static void set_stream_header(csp_packet_t *packet, int8_t status, uint8_t last, uint16_t sequence,
+                              uint32_t next_offset, uint32_t data_len) {
+    log_stream_reply_t reply;
+    reply.status = status;
+    reply.last = last;
+    reply.sequence = csp_hton16(sequence);
+    reply.next_offset = csp_hton32(next_offset);
+    memcpy(&packet->data[STATUS_BYTE], &reply, sizeof(reply));
+    set_packet_length(packet, LOG_STREAM_DATA_BYTE + data_len);
+}
+
+/**
+ * @brief
+ *      Stream part of a log file to the ground as a series of packets, reading
+ *      it a block at a time so the log never has to fit in RAM
+ * @details
+ *      Lines are filtered by level as they are read. All packets but the last
+ *      are sent from here. The request packet is turned into the last one and
+ *      sent by the service task like any other reply.
+ * @param conn
+ *      Connection the request came in on
+ * @param packet
+ *      The request. Filled with the final reply
+ * @return SAT_returnState
+ *      SATR_OK if packet holds the final reply
+ */
+static SAT_returnState stream_log(csp_conn_t *conn, csp_packet_t *packet) {
+    log_stream_request_t req;
+    REDSTAT file_stats;
+    char block[LOG_SCAN_BLOCK];
+    char line[LOG_LINE_MAX];
+    uint32_t line_len = 0;
+    bool line_started = false; // part of the current line has already been filtered
+    bool line_keep = true;
+    uint32_t start, end, pos;
+    uint16_t sequence = 0;
+    int8_t status = 0;
+    csp_packet_t *out = NULL;
+    uint32_t out_len = 0;
+
+    memcpy(&req, &packet->data[IN_DATA_BYTE], sizeof(req));
+    req.chunk_size = csp_ntoh16(req.chunk_size);
+    req.arg = csp_ntoh32(req.arg);
+    req.length = csp_ntoh32(req.length);
+
+    uint32_t chunk_size = csp_buffer_data_size() - LOG_STREAM_DATA_BYTE;
+    if (req.chunk_size != 0 && req.chunk_size < chunk_size) {
+        chunk_size = req.chunk_size;
+    }
+
+    int32_t fd = red_open(req.old_file ? get_logger_old_file() : get_logger_file(), RED_O_RDONLY);
+    if (fd < 0 || red_fstat(fd, &file_stats) != 0) {
+        if (fd >= 0) {
+            red_close(fd);
+        }
+        set_stream_header(packet, -1, 1, sequence, 0, 0);
+        return SATR_OK;
+    }
+    uint32_t file_size = (uint32_t)file_stats.st_size;
+
+    if (req.mode == LOG_STREAM_RANGE) {
+        start = req.arg < file_size ? req.arg : file_size;
+        end = (req.length == 0 || req.length > file_size - start) ? file_size : start + req.length;
+    } else if (find_stream_start(fd, file_size, &req, &start) == 0) {
+        end = file_size;
+    } else {
+        start = end = 0;
+        status = -1;
+    }
+
+    pos = start;
+    if (status == 0 && red_lseek(fd, start, RED_SEEK_SET) < 0) {
+        status = -1;
+    }
+    while (status == 0 && pos < end) {
+        uint32_t n = end - pos < LOG_SCAN_BLOCK ? end - pos : LOG_SCAN_BLOCK;
+        if (red_read(fd, block, n) != n) {
+            status = -1;
+            break;
+        }
+        uint32_t i;
+        for (i = 0; i < n && status == 0; i++) {
+            line[line_len++] = block[i];
+            bool at_end = (pos + i + 1 == end);
+            if (block[i] != '\n' && line_len < LOG_LINE_MAX && !at_end) {
+                continue;
+            }
+            // A whole line, or as much of a long one as fits. Decide on the first part only
+            if (!line_started) {
+                line_keep = parse_line_prefix(line, line_len).level <= req.max_level;
+            }
+            line_started = (block[i] != '\n');
+
+            uint32_t copied = 0;
+            while (line_keep && copied < line_len) {
+                if (out == NULL && (out = new_stream_packet(chunk_size)) == NULL) {
+                    status = -1;
+                    break;
+                }
+                uint32_t space = chunk_size - out_len;
+                uint32_t count = line_len - copied < space ? line_len - copied : space;
+                memcpy(&out->data[LOG_STREAM_DATA_BYTE + out_len], line + copied, count);
+                copied += count;
+                out_len += count;
+                if (out_len == chunk_size) {
+                    // next_offset is only exact once the rest of the line has been taken
+                    set_stream_header(out, 0, 0, sequence++, pos + i + 1 - (line_len - copied), out_len);
+                    if (!csp_send(conn, out, CSP_MAX_TIMEOUT)) {
+                        csp_buffer_free(out);
+                        status = -1;
+                    }
+                    out = NULL;
+                    out_len = 0;
+                    service_dispatcher_feed();
+                    if (status != 0) {
+                        break;
+                    }
+                }
+            }
+            line_len = 0;
+        }
+        pos += n;
+    }
+    red_close(fd);
+
+    if (out != NULL) {
+        if (status == 0) {
+            set_stream_header(out, 0, 0, sequence++, pos, out_len);
+            if (!csp_send(conn, out, CSP_MAX_TIMEOUT)) {
+                csp_buffer_free(out);
+                status = -1;
+            }
+        } else {
+            csp_buffer_free(out);
+        }
+    }
+    set_stream_header(packet, status, 1, sequence, pos, 0);
     return SATR_OK;
 }
 
@@ -110,10 +380,12 @@ SAT_returnState get_file(char *filename, csp_packet_t *packet) {
 
  * @param packet
         the packet that holds the service subtype and will be filled with the log data
+ * @param conn
+        the connection the packet came in on, for subservices that reply with several packets
  * @return SAT_returnState
         state to define success of the operation
  */
-SAT_returnState logger_service_app(csp_packet_t *packet) {
+SAT_returnState logger_service_app(csp_packet_t *packet, csp_conn_t *conn) {
     uint8_t ser_subtype = (uint8_t)packet->data[SUBSERVICE_BYTE];
     int8_t status;
     uint32_t *data32;
@@ -143,6 +415,8 @@ SAT_returnState logger_service_app(csp_packet_t *packet) {
         log_file = get_logger_old_file();
         get_file(log_file, packet);
         break;
+    case STREAM_LOG:
+        return stream_log(conn, packet);
     default:
         ex2_log("No such subservice\n");
         return SATR_PKT_ILLEGAL_SUBSERVICE;
@@ -155,64 +429,44 @@ SAT_returnState start_logger_service(void);
 
 /**
  * @brief
- *      FreeRTOS logger server task
+ *      Handle a connection to the logger service
  * @details
- *      Accepts incoming logger service packets and executes the application
- * @param void* param
+ *      Reads incoming logger service packets and executes the application.
+ *      Run on a service worker, which closes the connection afterwards
+ * @param conn
+ *      Connection accepted by the service dispatcher
  * @return None
  */
-void logger_service(void *param) {
-    csp_socket_t *sock;
-    sock = csp_socket(CSP_SO_HMACREQ);
-    csp_bind(sock, TC_LOGGER_SERVICE);
-    csp_listen(sock, SERVICE_BACKLOG_LEN);
-    svc_wdt_counter++;
-
-    for (;;) {
-        csp_conn_t *conn;
-        csp_packet_t *packet;
-        if ((conn = csp_accept(sock, DELAY_WAIT_TIMEOUT)) == NULL) {
-            svc_wdt_counter++;
-            /* timeout */
-            continue;
-        }
-        svc_wdt_counter++;
+static void logger_connection(csp_conn_t *conn) {
+    csp_packet_t *packet;
 
-        while ((packet = csp_read(conn, 50)) != NULL) {
-            if (logger_service_app(packet) != SATR_OK) {
-                // something went wrong, this shouldn't happen
+    while ((packet = csp_read(conn, 50)) != NULL) {
+        if (logger_service_app(packet, conn) != SATR_OK) {
+            // something went wrong, this shouldn't happen
+            csp_buffer_free(packet);
+        } else {
+            if (!csp_send(conn, packet, 50)) {
                 csp_buffer_free(packet);
-            } else {
-                if (!csp_send(conn, packet, 50)) {
-                    csp_buffer_free(packet);
-                }
             }
         }
-        csp_close(conn); // frees buffers used
     }
 }
 
 /**
  * @brief
- *      Start the logger server task
+ *      Register the logger service
  * @details
- *      Starts the FreeRTOS task responsible for accepting incoming
- *      logger service requests
+ *      Adds the logger connection handler to the service dispatcher
  * @param None
  * @return SAT_returnState
  *      success report
  */
 SAT_returnState start_logger_service(void) {
-    TaskHandle_t svc_tsk;
-    taskFunctions svc_funcs = {0};
-    svc_funcs.getCounterFunction = get_svc_wdt_counter;
-    if (xTaskCreate((TaskFunction_t)logger_service, "start_logger_service", 1200, NULL, NORMAL_SERVICE_PRIO,
-                    &svc_tsk) != pdPASS) {
-        ex2_log("FAILED TO CREATE TASK start_logger_service\n");
+    service_entry_t entry = {"logger_service", TC_LOGGER_SERVICE, logger_connection, SERVICE_PRIO_NORMAL, 1, true};
+    if (service_dispatcher_register(&entry) != SATR_OK) {
+        ex2_log("FAILED TO REGISTER logger_service\n");
         return SATR_ERROR;
     }
-    ex2_register(svc_tsk, svc_funcs);
-
     ex2_log("Logger service started\n");
     return SATR_OK;
 }
@@ -17,77 +17,53 @@
  * @date 2022-06-24
  */
 #include "northern_spirit/ns_service.h"
+#include "service_dispatcher.h"
 #include "task_manager/task_manager.h"
-
-static uint32_t svc_wdt_counter = 0;
-static uint32_t get_svc_wdt_counter() { return svc_wdt_counter; }
+#include "telemetry/telemetry_store.h"
 
 /**
  * @brief
- *      FreeRTOS 2U Payload File Transferring (FT) server task
+ *      Handle a connection to the northern spirit payload service
  * @details
- *      Accepts incoming 2U Payload FT service packets and executes
- *      the application
- * @param void* param
+ *      Reads incoming northern spirit payload service packets and executes the application.
+ *      Run on a service worker, which closes the connection afterwards
+ * @param conn
+ *      Connection accepted by the service dispatcher
  * @return None
  */
-void ns_payload_service(void *param) {
-    // socket initialization
-    csp_socket_t *sock;
-    sock = csp_socket(CSP_SO_HMACREQ);
-    csp_bind(sock, TC_NORTHERN_SPIRIT_SERVICE);
-    csp_listen(sock, SERVICE_BACKLOG_LEN);
-
-    svc_wdt_counter++;
-
-    for (;;) {
-        // establish a connection
-        csp_packet_t *packet;
-        csp_conn_t *conn;
-        if ((conn = csp_accept(sock, DELAY_WAIT_TIMEOUT)) == NULL) {
-            svc_wdt_counter++;
-            /* timeout */
-            continue;
-        }
-        svc_wdt_counter++;
-
-        // read and process packets
-        while ((packet = csp_read(conn, 50)) != NULL) {
-            if (ns_payload_service_app(packet) != SATR_OK) {
-                // something went wrong in the subservice
+static void ns_payload_connection(csp_conn_t *conn) {
+    csp_packet_t *packet;
+
+    while ((packet = csp_read(conn, 50)) != NULL) {
+        service_dispatcher_feed();
+        if (ns_payload_service_app(packet) != SATR_OK) {
+            // something went wrong in the subservice
+            csp_buffer_free(packet);
+        } else {
+            // subservice was successful
+            if (!csp_send(conn, packet, 50)) {
                 csp_buffer_free(packet);
-            } else {
-                // subservice was successful
-                if (!csp_send(conn, packet, 50)) {
-                    csp_buffer_free(packet);
-                }
             }
         }
-        csp_close(conn);
     }
 }
 
 /**
  * @brief
- *      Starts the northern spirit payload server task
+ *      Register the northern spirit payload service
  * @details
- *      Starts the FreeRTOS task responsible for accepting incoming
- *      northern spirit service requests
+ *      Adds the northern spirit payload connection handler to the service dispatcher
  * @param None
  * @return SAT_returnState
- *      Success report
+ *      success report
  */
 SAT_returnState start_ns_payload_service(void) {
-    TaskHandle_t svc_tsk;
-    taskFunctions svc_funcs = {0};
-    svc_funcs.getCounterFunction = get_svc_wdt_counter;
-
-    if (xTaskCreate((TaskFunction_t)ns_payload_service, "ns_payload_service", 1024, NULL, NORMAL_SERVICE_PRIO,
-                    &svc_tsk) != pdPASS) {
-        sys_log(ERROR, "FAILED TO CREATE TASK ns_payload_service\n");
+    service_entry_t entry = {"ns_payload_service", TC_NORTHERN_SPIRIT_SERVICE, ns_payload_connection,
+                             SERVICE_PRIO_LOW, 1, true};
+    if (service_dispatcher_register(&entry) != SATR_OK) {
+        sys_log(ERROR, "FAILED TO REGISTER ns_payload_service\n");
         return SATR_ERROR;
     }
-    ex2_register(svc_tsk, svc_funcs);
     sys_log(INFO, "ns payload service started\n");
     return SATR_OK;
 }
@@ -167,7 +143,11 @@ SAT_returnState ns_payload_service_app(csp_packet_t *packet) {
 
     case NS_GET_TELEMETRY: {
         ns_telemetry tlm;
-        status = HAL_NS_get_telemetry(&tlm);
+        status = NS_OK;
+        if (!telemetry_read_recent(TLM_NS, &tlm, sizeof(tlm), TELEMETRY_FRESH_TICKS)) {
+            status = HAL_NS_get_telemetry(&tlm);
+            telemetry_write(TLM_NS, &tlm, sizeof(tlm), status == NS_OK);
+        }
         memcpy(&packet->data[STATUS_BYTE], &status, sizeof(int8_t));
         memcpy(&packet->data[OUT_DATA_BYTE], &tlm, sizeof(tlm));
         set_packet_length(packet, sizeof(int8_t) + sizeof(tlm) + 1);
@@ -26,6 +26,8 @@
 #include <stdio.h>
 
 #include "iris.h"
+#include "iris_image.h"
+#include "iris_program.h"
 
 #define IRIS_SIZE 1000
 
@@ -113,6 +115,14 @@ SAT_returnState iris_service_app(csp_packet_t *packet) {
     uint8_t ser_subtype = (uint8_t)packet->data[SUBSERVICE_BYTE];
     uint8_t status;
 
+    // The programming task owns Iris until it finishes, so only its progress may be asked for
+    if (iris_program_running() && ser_subtype != IRIS_PROGRAM_STATUS) {
+        status = IRIS_HAL_BUSY;
+        memcpy(&packet->data[STATUS_BYTE], &status, sizeof(uint8_t));
+        set_packet_length(packet, sizeof(uint8_t) + 1);
+        return SATR_OK;
+    }
+
     switch (ser_subtype) {
     case IRIS_POWER_ON:
         status = iris_init();
@@ -147,21 +157,34 @@ SAT_returnState iris_service_app(csp_packet_t *packet) {
     }
     case IRIS_DELIVER_IMAGE: {
         /*
-         * HAL function execution path
-         * 1. Get image length
-         * 2. Transfer image
+         * Stores the image to the file named in the request, or to
+         * IRIS_IMAGE_DEFAULT_PATH if none is given. Replies with the
+         * iris_image_report in network order
          */
-        uint32_t image_length;
+        char path[IRIS_IMAGE_PATH_MAX] = IRIS_IMAGE_DEFAULT_PATH;
+        iris_image_report report;
 
-        status = iris_get_image_length(&image_length);
-
-        if (status == IRIS_HAL_OK && image_length != NULL) {
-            status = iris_transfer_image(image_length);
+        if (packet->length > IN_DATA_BYTE && packet->data[IN_DATA_BYTE] != '\0') {
+            uint16_t path_length = packet->length - IN_DATA_BYTE;
+            if (path_length > IRIS_IMAGE_PATH_MAX - 1) {
+                path_length = IRIS_IMAGE_PATH_MAX - 1;
+            }
+            memcpy(path, &packet->data[IN_DATA_BYTE], path_length);
+            path[path_length] = '\0';
         }
 
-        // Return success/failure report
+        status = iris_image_store(path, &report);
+
+        report.image_length = csp_hton32(report.image_length);
+        report.resumed_at = csp_hton32(report.resumed_at);
+        report.crc = csp_hton32(report.crc);
+        report.elapsed_ms = csp_hton32(report.elapsed_ms);
+        report.bytes_per_s = csp_hton32(report.bytes_per_s);
+
+        // Return success/failure report and the transfer report
         memcpy(&packet->data[STATUS_BYTE], &status, sizeof(uint8_t));
-        set_packet_length(packet, sizeof(uint8_t) + 1);
+        memcpy(&packet->data[OUT_DATA_BYTE], &report, sizeof(report));
+        set_packet_length(packet, sizeof(uint8_t) + sizeof(report) + 1);
         break;
     }
     case IRIS_COUNT_IMAGES: {
@@ -174,8 +197,43 @@ SAT_returnState iris_service_app(csp_packet_t *packet) {
         set_packet_length(packet, sizeof(uint8_t) + 1);
         break;
     }
-    case IRIS_PROGRAM_FLASH:
-        // TODO
+    case IRIS_PROGRAM_FLASH: {
+        /*
+         * Starts reprogramming Iris from the image file named in the request
+         * and replies straight away. Progress is read with IRIS_PROGRAM_STATUS
+         */
+        char path[IRIS_PROGRAM_PATH_MAX] = {0};
+        uint16_t path_length = packet->length > IN_DATA_BYTE ? packet->length - IN_DATA_BYTE : 0;
+
+        if (path_length > IRIS_PROGRAM_PATH_MAX - 1) {
+            path_length = IRIS_PROGRAM_PATH_MAX - 1;
+        }
+        memcpy(path, &packet->data[IN_DATA_BYTE], path_length);
+        status = path[0] != '\0' ? iris_program_start(path) : IRIS_HAL_ERROR;
+
+        // Return success/failure report
+        memcpy(&packet->data[STATUS_BYTE], &status, sizeof(uint8_t));
+        set_packet_length(packet, sizeof(uint8_t) + 1);
+        break;
+    }
+    case IRIS_PROGRAM_STATUS: {
+        iris_program_status progress;
+        iris_program_get_status(&progress);
+        status = progress.state == IRIS_PROGRAM_FAILED ? IRIS_HAL_ERROR : IRIS_HAL_OK;
+
+        progress.state = csp_hton32(progress.state);
+        progress.image_length = csp_hton32(progress.image_length);
+        progress.programmed = csp_hton32(progress.programmed);
+        progress.resumed_at = csp_hton32(progress.resumed_at);
+        progress.crc = csp_hton32(progress.crc);
+        progress.elapsed_ms = csp_hton32(progress.elapsed_ms);
+
+        // Return success/failure report and the programming progress
+        memcpy(&packet->data[STATUS_BYTE], &status, sizeof(uint8_t));
+        memcpy(&packet->data[OUT_DATA_BYTE], &progress, sizeof(progress));
+        set_packet_length(packet, sizeof(uint8_t) + sizeof(progress) + 1);
+        break;
+    }
     case IRIS_GET_HK: {
         // Get Iris housekeeping data
         IRIS_Housekeeping HK = {0};
@@ -6,13 +6,11 @@
  */
 
 #include "scheduler/scheduler.h"
+#include "mem_pool/mem_pool.h"
+#include "service_dispatcher.h"
 
 char *fileName1 = "VOL0:/gs_cmds.TMP";
 
-static uint32_t svc_wdt_counter = 0;
-
-static uint32_t get_svc_wdt_counter() { return svc_wdt_counter; }
-
 int delay_aborted = 0;
 int delete_task = 0;
 static TaskHandle_t SchedulerHandler = 0;
@@ -43,17 +41,17 @@ SAT_returnState scheduler_service_app(csp_packet_t *gs_cmds, SemaphoreHandle_t s
     switch (ser_subtype) {
     case SET_SCHEDULE: {
         // allocating buffer for MAX_NUM_CMDS numbers of incoming commands
-        scheduled_commands_t *cmds = (scheduled_commands_t *)pvPortMalloc(MAX_NUM_CMDS * sizeof(scheduled_commands_t));
-        memset(cmds, 0, MAX_NUM_CMDS * sizeof(scheduled_commands_t));
+        scheduled_commands_t *cmds = (scheduled_commands_t *)pool_malloc(MAX_NUM_CMDS * sizeof(scheduled_commands_t));
         //------------------------------------TODO: test code below, to be deleted-----------------------------------//
         //        scheduled_commands_t *cmds = NULL;
         //------------------------------------TODO: test code above, to be deleted-----------------------------------//
         if (MAX_NUM_CMDS > 0 && cmds == NULL) {
-            sys_log(ERROR, "pvPortMalloc for cmds failed in SET_SCHEDULE, out of memory");
+            sys_log(ERROR, "pool_malloc for cmds failed in SET_SCHEDULE, out of memory");
             status = CALLOC_ERROR;
             memcpy(&gs_cmds->data[STATUS_BYTE], &status, sizeof(int8_t));
             return SATR_ERROR;
         }
+        memset(cmds, 0, MAX_NUM_CMDS * sizeof(scheduled_commands_t));
         // parse the commands
         number_of_cmds = prv_set_scheduler(&(gs_cmds->data[SUBSERVICE_BYTE + 1]), cmds);
         if (number_of_cmds < 0) {
@@ -63,20 +61,20 @@ SAT_returnState scheduler_service_app(csp_packet_t *gs_cmds, SemaphoreHandle_t s
             return SATR_ERROR;
         }
         // calculate frequency of cmds. Non-repetitive commands have a frequency of 0
-        scheduled_commands_unix_t *sorted_cmds = (scheduled_commands_unix_t *)pvPortMalloc(number_of_cmds * sizeof(scheduled_commands_unix_t));
-        memset(sorted_cmds, 0, number_of_cmds * sizeof(scheduled_commands_unix_t));
+        scheduled_commands_unix_t *sorted_cmds = (scheduled_commands_unix_t *)pool_malloc(number_of_cmds * sizeof(scheduled_commands_unix_t));
         if (number_of_cmds > 0 && sorted_cmds == NULL) {
-            sys_log(ERROR, "pvPortMalloc for sorted_cmds failed in SET_SCHEDULE, out of memory");
-            vPortFree(cmds);
+            sys_log(ERROR, "pool_malloc for sorted_cmds failed in SET_SCHEDULE, out of memory");
+            pool_free(cmds);
             status = CALLOC_ERROR;
             memcpy(&gs_cmds->data[STATUS_BYTE], &status, sizeof(int8_t));
             return SATR_ERROR;
         }
+        memset(sorted_cmds, 0, number_of_cmds * sizeof(scheduled_commands_unix_t));
         int calc_cmd_status = calc_cmd_frequency(cmds, number_of_cmds, sorted_cmds);
         if (calc_cmd_status != SATR_OK) {
             sys_log(ERROR, "calc_cmd_ferquency failed in SET_SCHEDULE with error %d", calc_cmd_status);
-            vPortFree(cmds);
-            vPortFree(sorted_cmds);
+            pool_free(cmds);
+            pool_free(sorted_cmds);
             status = calc_cmd_status;
             memcpy(&gs_cmds->data[STATUS_BYTE], &status, sizeof(int8_t));
             return SATR_ERROR;
@@ -100,8 +98,8 @@ SAT_returnState scheduler_service_app(csp_packet_t *gs_cmds, SemaphoreHandle_t s
                     if (sort_status != SATR_OK) {
                         red_close(fout);
                         xSemaphoreGive(scheduleSemaphore);
-                        vPortFree(cmds);
-                        vPortFree(sort_cmds);
+                        pool_free(cmds);
+                        pool_free(sort_cmds);
                         return sort_status;
                     }
                     red_lseek(fout, 0, RED_SEEK_SET);
@@ -111,8 +109,8 @@ SAT_returnState scheduler_service_app(csp_packet_t *gs_cmds, SemaphoreHandle_t s
                         sys_log(ERROR, "error %d from red_write() in SET_SCHEDULE for file: '%s'", (int)red_errno, fileName1);
                         red_close(fout);
                         xSemaphoreGive(scheduleSemaphore);
-                        vPortFree(cmds);
-                        vPortFree(sorted_cmds);
+                        pool_free(cmds);
+                        pool_free(sorted_cmds);
                         status = (int)red_errno;
                         memcpy(&gs_cmds->data[STATUS_BYTE], &status, sizeof(int8_t));
                         return SATR_ERROR;
@@ -145,32 +143,31 @@ SAT_returnState scheduler_service_app(csp_packet_t *gs_cmds, SemaphoreHandle_t s
                     // get number of existing cmds
                     uint32_t num_existing_cmds = scheduler_stat.st_size / sizeof(scheduled_commands_unix_t);
                     int total_cmds = number_of_cmds + num_existing_cmds;
-                    // TODO: use error handling to check pvPortMalloc was successful
-                    scheduled_commands_unix_t *existing_cmds = (scheduled_commands_unix_t *)pvPortMalloc(num_existing_cmds * sizeof(scheduled_commands_unix_t));
-                    memset(existing_cmds, 0, num_existing_cmds * sizeof(scheduled_commands_unix_t));
+                    scheduled_commands_unix_t *existing_cmds = (scheduled_commands_unix_t *)pool_malloc(num_existing_cmds * sizeof(scheduled_commands_unix_t));
                     if (num_existing_cmds > 0 && existing_cmds == NULL) {
-                        sys_log(ERROR, "pvPortMalloc for sorted_cmds failed in SET_SCHEDULE, out of memory");
+                        sys_log(ERROR, "pool_malloc for sorted_cmds failed in SET_SCHEDULE, out of memory");
                         red_close(fout);
                         xSemaphoreGive(scheduleSemaphore);
-                        vPortFree(cmds);
-                        vPortFree(sorted_cmds);
+                        pool_free(cmds);
+                        pool_free(sorted_cmds);
                         status = CALLOC_ERROR;
                         memcpy(&gs_cmds->data[STATUS_BYTE], &status, sizeof(int8_t));
                         return SATR_ERROR;
                     }
-                    scheduled_commands_unix_t *updated_cmds = (scheduled_commands_unix_t *)pvPortMalloc(total_cmds * sizeof(scheduled_commands_unix_t));
-                    memset(updated_cmds, 0, total_cmds * sizeof(scheduled_commands_unix_t));
+                    memset(existing_cmds, 0, num_existing_cmds * sizeof(scheduled_commands_unix_t));
+                    scheduled_commands_unix_t *updated_cmds = (scheduled_commands_unix_t *)pool_malloc(total_cmds * sizeof(scheduled_commands_unix_t));
                     if (total_cmds > 0 && updated_cmds == NULL) {
-                        sys_log(ERROR, "pvPortMalloc for updated_cmds failed in SET_SCHEDULE, out of memory");
+                        sys_log(ERROR, "pool_malloc for updated_cmds failed in SET_SCHEDULE, out of memory");
                         red_close(fout);
                         xSemaphoreGive(scheduleSemaphore);
-                        vPortFree(cmds);
-                        vPortFree(sorted_cmds);
-                        vPortFree(existing_cmds);
+                        pool_free(cmds);
+                        pool_free(sorted_cmds);
+                        pool_free(existing_cmds);
                         status = CALLOC_ERROR;
                         memcpy(&gs_cmds->data[STATUS_BYTE], &status, sizeof(int8_t));
                         return SATR_ERROR;
                     }
+                    memset(updated_cmds, 0, total_cmds * sizeof(scheduled_commands_unix_t));
                     // read file
                     red_lseek(fout, 0, RED_SEEK_SET);
                     int32_t f_read = red_read(fout, existing_cmds, (uint32_t)scheduler_stat.st_size);
@@ -178,10 +175,10 @@ SAT_returnState scheduler_service_app(csp_packet_t *gs_cmds, SemaphoreHandle_t s
                         sys_log(ERROR, "error %d from red_read() in SET_SCHEDULE for file '%s", (int)red_errno, fileName1);
                         red_close(fout);
                         xSemaphoreGive(scheduleSemaphore);
-                        vPortFree(cmds);
-                        vPortFree(sorted_cmds);
-                        vPortFree(existing_cmds);
-                        vPortFree(updated_cmds);
+                        pool_free(cmds);
+                        pool_free(sorted_cmds);
+                        pool_free(existing_cmds);
+                        pool_free(updated_cmds);
                         status = (int)red_errno;
                         memcpy(&gs_cmds->data[STATUS_BYTE], &status, sizeof(int8_t));
                         return SATR_ERROR;
@@ -193,10 +190,10 @@ SAT_returnState scheduler_service_app(csp_packet_t *gs_cmds, SemaphoreHandle_t s
                     if (sort_status != SATR_OK) {
                         red_close(fout);
                         xSemaphoreGive(scheduleSemaphore);
-                        vPortFree(cmds);
-                        vPortFree(sorted_cmds);
-                        vPortFree(existing_cmds);
-                        vPortFree(updated_cmds);
+                        pool_free(cmds);
+                        pool_free(sorted_cmds);
+                        pool_free(existing_cmds);
+                        pool_free(updated_cmds);
                         return sort_status;
                     }
                     // write new cmds to file
@@ -207,10 +204,10 @@ SAT_returnState scheduler_service_app(csp_packet_t *gs_cmds, SemaphoreHandle_t s
                         sys_log(ERROR, "error %d from red_write() in SET_SCHEDULE for file '%s", (int)red_errno, fileName1);
                         red_close(fout);
                         xSemaphoreGive(scheduleSemaphore);
-                        vPortFree(cmds);
-                        vPortFree(sorted_cmds);
-                        vPortFree(existing_cmds);
-                        vPortFree(updated_cmds);
+                        pool_free(cmds);
+                        pool_free(sorted_cmds);
+                        pool_free(existing_cmds);
+                        pool_free(updated_cmds);
                         status = (int)red_errno;
                         memcpy(&gs_cmds->data[STATUS_BYTE], &status, sizeof(int8_t));
                         return SATR_ERROR;
@@ -221,10 +218,10 @@ SAT_returnState scheduler_service_app(csp_packet_t *gs_cmds, SemaphoreHandle_t s
                         sys_log(ERROR, "error %d from red_ftruncate() in SET_SCHEDULE for file '%s", (int)red_errno, fileName1);
                         red_close(fout);
                         xSemaphoreGive(scheduleSemaphore);
-                        vPortFree(cmds);
-                        vPortFree(sorted_cmds);
-                        vPortFree(existing_cmds);
-                        vPortFree(updated_cmds);
+                        pool_free(cmds);
+                        pool_free(sorted_cmds);
+                        pool_free(existing_cmds);
+                        pool_free(updated_cmds);
                         status = (int)red_errno;
                         memcpy(&gs_cmds->data[STATUS_BYTE], &status, sizeof(int8_t));
                         return SATR_ERROR;
@@ -241,23 +238,23 @@ SAT_returnState scheduler_service_app(csp_packet_t *gs_cmds, SemaphoreHandle_t s
                     // set Abort delay flag to 1
                     delay_aborted = 1;
                     xTaskAbortDelay(SchedulerHandler);
-                    // free pvPortMalloc
-                    vPortFree(existing_cmds);
-                    vPortFree(updated_cmds);
+                    // free the buffers
+                    pool_free(existing_cmds);
+                    pool_free(updated_cmds);
                 }
             } 
             else {
                 sys_log(ERROR, "cannot obtain schedulerSemaphore, therefore file system cannot be accessed safely");
-                vPortFree(cmds);
-                vPortFree(sorted_cmds);
+                pool_free(cmds);
+                pool_free(sorted_cmds);
                 status = MUTEX_ERROR;
                 memcpy(&gs_cmds->data[STATUS_BYTE], &status, sizeof(int8_t));
                 return SATR_ERROR;
             }
 
-        // free pvPortMalloc
-        vPortFree(cmds);
-        vPortFree(sorted_cmds);
+        // free the buffers
+        pool_free(cmds);
+        pool_free(sorted_cmds);
 
         status = NO_ERROR;
         memcpy(&gs_cmds->data[STATUS_BYTE], &status, sizeof(int8_t));
@@ -279,46 +276,46 @@ SAT_returnState scheduler_service_app(csp_packet_t *gs_cmds, SemaphoreHandle_t s
                 // if file exists, search for the command to be deleted
                 else if (fout >= 0) {
                     // allocating buffer for MAX_NUM_CMDS numbers of incoming commands
-                    scheduled_commands_t *cmds = (scheduled_commands_t *)pvPortMalloc(MAX_NUM_CMDS * sizeof(scheduled_commands_t));
-                    memset(cmds, 0, MAX_NUM_CMDS * sizeof(scheduled_commands_t));
+                    scheduled_commands_t *cmds = (scheduled_commands_t *)pool_malloc(MAX_NUM_CMDS * sizeof(scheduled_commands_t));
                     if (MAX_NUM_CMDS > 0 && cmds == NULL) {
-                        sys_log(ERROR, "pvPortMalloc for cmds failed in DELETE_SCHEDULE, out of memory");
+                        sys_log(ERROR, "pool_malloc for cmds failed in DELETE_SCHEDULE, out of memory");
                         red_close(fout);
                         xSemaphoreGive(scheduleSemaphore);
                         status = CALLOC_ERROR;
                         memcpy(&gs_cmds->data[STATUS_BYTE], &status, sizeof(int8_t));
                         return SATR_ERROR;
                     }
+                    memset(cmds, 0, MAX_NUM_CMDS * sizeof(scheduled_commands_t));
                     // parse the commands to be deleted
                     number_of_cmds = prv_set_scheduler(&(gs_cmds->data[SUBSERVICE_BYTE + 1]), cmds);
                     if (number_of_cmds < 0) {
                         sys_log(ERROR, "prv_set_scheduler failed for DELETE_SCHEDULE, unable to parse commands");
                         red_close(fout);
                         xSemaphoreGive(scheduleSemaphore);
-                        vPortFree(cmds);
+                        pool_free(cmds);
                         status = number_of_cmds;
                         memcpy(&gs_cmds->data[STATUS_BYTE], &status, sizeof(int8_t));
                         return SATR_ERROR;
                     }
                     // calculate frequency of cmds. Non-repetitive commands have a frequency of 0
-                    scheduled_commands_unix_t *sorted_cmds = (scheduled_commands_unix_t *)pvPortMalloc(number_of_cmds * sizeof(scheduled_commands_unix_t));
-                    memset(sorted_cmds, 0, number_of_cmds * sizeof(scheduled_commands_unix_t));
+                    scheduled_commands_unix_t *sorted_cmds = (scheduled_commands_unix_t *)pool_malloc(number_of_cmds * sizeof(scheduled_commands_unix_t));
                     if (number_of_cmds > 0 && sorted_cmds == NULL) {
-                        sys_log(ERROR, "pvPortMalloc for sorted_cmds failed in DELETE_SCHEDULE, out of memory");
+                        sys_log(ERROR, "pool_malloc for sorted_cmds failed in DELETE_SCHEDULE, out of memory");
                         red_close(fout);
                         xSemaphoreGive(scheduleSemaphore);
-                        vPortFree(cmds);
+                        pool_free(cmds);
                         status = CALLOC_ERROR;
                         memcpy(&gs_cmds->data[STATUS_BYTE], &status, sizeof(int8_t));
                         return SATR_ERROR;
                     }
+                    memset(sorted_cmds, 0, number_of_cmds * sizeof(scheduled_commands_unix_t));
                     int calc_cmd_status = calc_cmd_frequency(cmds, number_of_cmds, sorted_cmds);
                     if (calc_cmd_status != SATR_OK) {
                         sys_log(ERROR, "calc_cmd_ferquency failed in DELETE_SCHEDULE with error %d", calc_cmd_status);
                         red_close(fout);
                         xSemaphoreGive(scheduleSemaphore);
-                        vPortFree(cmds);
-                        vPortFree(sorted_cmds);
+                        pool_free(cmds);
+                        pool_free(sorted_cmds);
                         status = calc_cmd_status;
                         memcpy(&gs_cmds->data[STATUS_BYTE], &status, sizeof(int8_t));
                         return SATR_ERROR;
@@ -328,8 +325,8 @@ SAT_returnState scheduler_service_app(csp_packet_t *gs_cmds, SemaphoreHandle_t s
                     if (sort_status != SATR_OK) {
                         red_close(fout);
                         xSemaphoreGive(scheduleSemaphore);
-                        vPortFree(cmds);
-                        vPortFree(sorted_cmds);
+                        pool_free(cmds);
+                        pool_free(sorted_cmds);
                         status = sort_status;
                         memcpy(&gs_cmds->data[STATUS_BYTE], &status, sizeof(int8_t));
                         return sort_status;
@@ -349,40 +346,39 @@ SAT_returnState scheduler_service_app(csp_packet_t *gs_cmds, SemaphoreHandle_t s
                         }
                         red_close(fout);
                         xSemaphoreGive(scheduleSemaphore);
-                        vPortFree(cmds);
-                        vPortFree(sorted_cmds);
+                        pool_free(cmds);
+                        pool_free(sorted_cmds);
                         memcpy(&gs_cmds->data[STATUS_BYTE], &status, sizeof(int8_t));
                         return SATR_ERROR;
                     }
                     // get number of existing cmds
                     uint32_t num_existing_cmds = scheduler_stat.st_size / sizeof(scheduled_commands_unix_t);
                     uint32_t needed_size = (uint32_t)scheduler_stat.st_size;
-                    // TODO: use error handling to check pvPortMalloc was successful
-                    scheduled_commands_unix_t *existing_cmds = pvPortMalloc(num_existing_cmds * sizeof(scheduled_commands_unix_t));
-                    memset(existing_cmds, 0, num_existing_cmds * sizeof(scheduled_commands_unix_t));
+                    scheduled_commands_unix_t *existing_cmds = pool_malloc(num_existing_cmds * sizeof(scheduled_commands_unix_t));
                     if (num_existing_cmds > 0 && existing_cmds == NULL) {
-                        sys_log(ERROR, "pvPortMalloc for existing_cmds failed in DELETE_SCHEDULE, out of memory");
+                        sys_log(ERROR, "pool_malloc for existing_cmds failed in DELETE_SCHEDULE, out of memory");
                         red_close(fout);
                         xSemaphoreGive(scheduleSemaphore);
-                        vPortFree(cmds);
-                        vPortFree(sorted_cmds);
+                        pool_free(cmds);
+                        pool_free(sorted_cmds);
                         status = CALLOC_ERROR;
                         memcpy(&gs_cmds->data[STATUS_BYTE], &status, sizeof(int8_t));
                         return SATR_ERROR;
                     }
-                    scheduled_commands_unix_t *updated_cmds = (scheduled_commands_unix_t *)pvPortMalloc(num_existing_cmds * sizeof(scheduled_commands_unix_t));
-                    memset(updated_cmds, 0, num_existing_cmds * sizeof(scheduled_commands_unix_t));
+                    memset(existing_cmds, 0, num_existing_cmds * sizeof(scheduled_commands_unix_t));
+                    scheduled_commands_unix_t *updated_cmds = (scheduled_commands_unix_t *)pool_malloc(num_existing_cmds * sizeof(scheduled_commands_unix_t));
                     if (num_existing_cmds > 0 && updated_cmds == NULL) {
-                        sys_log(ERROR, "pvPortMalloc for updated_cmds failed in DELETE_SCHEDULE, out of memory");
+                        sys_log(ERROR, "pool_malloc for updated_cmds failed in DELETE_SCHEDULE, out of memory");
                         red_close(fout);
                         xSemaphoreGive(scheduleSemaphore);
-                        vPortFree(cmds);
-                        vPortFree(sorted_cmds);
-                        vPortFree(existing_cmds);
+                        pool_free(cmds);
+                        pool_free(sorted_cmds);
+                        pool_free(existing_cmds);
                         status = CALLOC_ERROR;
                         memcpy(&gs_cmds->data[STATUS_BYTE], &status, sizeof(int8_t));
                         return SATR_ERROR;
                     }
+                    memset(updated_cmds, 0, num_existing_cmds * sizeof(scheduled_commands_unix_t));
                     // read file
                     red_lseek(fout, 0, RED_SEEK_SET);
                     int32_t f_read = red_read(fout, existing_cmds, (uint32_t)scheduler_stat.st_size);
@@ -390,9 +386,9 @@ SAT_returnState scheduler_service_app(csp_packet_t *gs_cmds, SemaphoreHandle_t s
                         sys_log(ERROR, "error %d from red_read() in DELETE_SCHEDULE for file: '%s'", (int)red_errno, fileName1);
                         red_close(fout);
                         xSemaphoreGive(scheduleSemaphore);
-                        vPortFree(cmds);
-                        vPortFree(sorted_cmds);
-                        vPortFree(existing_cmds);
+                        pool_free(cmds);
+                        pool_free(sorted_cmds);
+                        pool_free(existing_cmds);
                         status = (int)red_errno;
                         memcpy(&gs_cmds->data[STATUS_BYTE], &status, sizeof(int8_t));
                         return SATR_ERROR;
@@ -434,10 +430,10 @@ SAT_returnState scheduler_service_app(csp_packet_t *gs_cmds, SemaphoreHandle_t s
                                     (int)red_errno, fileName1);
                             red_close(fout);
                             xSemaphoreGive(scheduleSemaphore);
-                            vPortFree(cmds);
-                            vPortFree(sorted_cmds);
-                            vPortFree(existing_cmds);
-                            vPortFree(updated_cmds);
+                            pool_free(cmds);
+                            pool_free(sorted_cmds);
+                            pool_free(existing_cmds);
+                            pool_free(updated_cmds);
                             status = (int)red_errno;
                             memcpy(&gs_cmds->data[STATUS_BYTE], &status, sizeof(int8_t));
                             return SATR_ERROR;
@@ -448,10 +444,10 @@ SAT_returnState scheduler_service_app(csp_packet_t *gs_cmds, SemaphoreHandle_t s
                             sys_log(ERROR, "error %d from red_ftruncate() in DELETE_SCHEDULE for file: '%s'", (int)red_errno, fileName1);
                             red_close(fout);
                             xSemaphoreGive(scheduleSemaphore);
-                            vPortFree(cmds);
-                            vPortFree(sorted_cmds);
-                            vPortFree(existing_cmds);
-                            vPortFree(updated_cmds);
+                            pool_free(cmds);
+                            pool_free(sorted_cmds);
+                            pool_free(existing_cmds);
+                            pool_free(updated_cmds);
                             status = (int)red_errno;
                             memcpy(&gs_cmds->data[STATUS_BYTE], &status, sizeof(int8_t));
                             return SATR_ERROR;
@@ -477,11 +473,11 @@ SAT_returnState scheduler_service_app(csp_packet_t *gs_cmds, SemaphoreHandle_t s
                         sys_log(NOTICE, "error %d from red_close() in DELETE_SCHEDULE for file: '%s'", (int)red_errno, fileName1);
                     }
 
-                    // free pvPortMalloc
-                    vPortFree(cmds);
-                    vPortFree(sorted_cmds);
-                    vPortFree(existing_cmds);
-                    vPortFree(updated_cmds);
+                    // free the buffers
+                    pool_free(cmds);
+                    pool_free(sorted_cmds);
+                    pool_free(existing_cmds);
+                    pool_free(updated_cmds);
 
                     xSemaphoreGive(scheduleSemaphore);
                     xTaskAbortDelay(SchedulerHandler);
@@ -525,16 +521,16 @@ SAT_returnState scheduler_service_app(csp_packet_t *gs_cmds, SemaphoreHandle_t s
                     return SATR_ERROR;
                 }
                 // allocating buffer for MAX_NUM_CMDS numbers of incoming commands
-                scheduled_commands_t *cmds = (scheduled_commands_t *)pvPortMalloc(MAX_NUM_CMDS * sizeof(scheduled_commands_t));
-                memset(cmds, 0, MAX_NUM_CMDS * sizeof(scheduled_commands_t));
+                scheduled_commands_t *cmds = (scheduled_commands_t *)pool_malloc(MAX_NUM_CMDS * sizeof(scheduled_commands_t));
                 if (MAX_NUM_CMDS > 0 && cmds == NULL) {
-                    sys_log(ERROR, "pvPortMalloc for cmds failed in REPLACE_SCHEDULE, out of memory");
+                    sys_log(ERROR, "pool_malloc for cmds failed in REPLACE_SCHEDULE, out of memory");
                     red_close(fout);
                     xSemaphoreGive(scheduleSemaphore);
                     status = CALLOC_ERROR;
                     memcpy(&gs_cmds->data[STATUS_BYTE], &status, sizeof(int8_t));
                     return SATR_ERROR;
                 }
+                memset(cmds, 0, MAX_NUM_CMDS * sizeof(scheduled_commands_t));
                 // parse the commands
                 number_of_cmds = prv_set_scheduler(&(gs_cmds->data[SUBSERVICE_BYTE + 1]), cmds);
                 if (number_of_cmds < 0) {
@@ -546,24 +542,24 @@ SAT_returnState scheduler_service_app(csp_packet_t *gs_cmds, SemaphoreHandle_t s
                     return SATR_ERROR;
                 }
                 // calculate frequency of cmds. Non-repetitive commands have a frequency of 0
-                scheduled_commands_unix_t *sorted_cmds = (scheduled_commands_unix_t *)pvPortMalloc(number_of_cmds * sizeof(scheduled_commands_unix_t));
-                memset(sorted_cmds, 0, number_of_cmds * sizeof(scheduled_commands_unix_t));
+                scheduled_commands_unix_t *sorted_cmds = (scheduled_commands_unix_t *)pool_malloc(number_of_cmds * sizeof(scheduled_commands_unix_t));
                 if (number_of_cmds > 0 && sorted_cmds == NULL) {
-                    sys_log(ERROR, "pvPortMalloc for sorted_cmds failed in REPLACE_SCHEDULE, out of memory");
+                    sys_log(ERROR, "pool_malloc for sorted_cmds failed in REPLACE_SCHEDULE, out of memory");
                     red_close(fout);
                     xSemaphoreGive(scheduleSemaphore);
-                    vPortFree(cmds);
+                    pool_free(cmds);
                     status = CALLOC_ERROR;
                     memcpy(&gs_cmds->data[STATUS_BYTE], &status, sizeof(int8_t));
                     return SATR_ERROR;
                 }
+                memset(sorted_cmds, 0, number_of_cmds * sizeof(scheduled_commands_unix_t));
                 int calc_cmd_status = calc_cmd_frequency(cmds, number_of_cmds, sorted_cmds);
                 if (calc_cmd_status != SATR_OK) {
                     sys_log(ERROR, "calc_cmd_ferquency failed in REPLACE_SCHEDULE with error %d", calc_cmd_status);
                     red_close(fout);
                     xSemaphoreGive(scheduleSemaphore);
-                    vPortFree(cmds);
-                    vPortFree(sorted_cmds);
+                    pool_free(cmds);
+                    pool_free(sorted_cmds);
                     status = calc_cmd_status;
                     memcpy(&gs_cmds->data[STATUS_BYTE], &status, sizeof(int8_t));
                     return SATR_ERROR;
@@ -573,8 +569,8 @@ SAT_returnState scheduler_service_app(csp_packet_t *gs_cmds, SemaphoreHandle_t s
                 if (sort_status != SATR_OK) {
                     red_close(fout);
                     xSemaphoreGive(scheduleSemaphore);
-                    vPortFree(cmds);
-                    vPortFree(sorted_cmds);
+                    pool_free(cmds);
+                    pool_free(sorted_cmds);
                     return sort_status;
                 }
                 // write cmds to file
@@ -585,8 +581,8 @@ SAT_returnState scheduler_service_app(csp_packet_t *gs_cmds, SemaphoreHandle_t s
                     sys_log(ERROR, "error %d from red_write() in REPLACE_SCHEDULE for file: '%s'", (int)red_errno, fileName1);
                     red_close(fout);
                     xSemaphoreGive(scheduleSemaphore);
-                    vPortFree(cmds);
-                    vPortFree(sorted_cmds);
+                    pool_free(cmds);
+                    pool_free(sorted_cmds);
                     status = (int)red_errno;
                     memcpy(&gs_cmds->data[STATUS_BYTE], &status, sizeof(int8_t));
                     return SATR_ERROR;
@@ -598,8 +594,8 @@ SAT_returnState scheduler_service_app(csp_packet_t *gs_cmds, SemaphoreHandle_t s
                     sys_log(ERROR, "error %d from red_ftruncate() in REPLACE_SCHEDULE for file: '%s'", (int)red_errno, fileName1);
                     red_close(fout);
                     xSemaphoreGive(scheduleSemaphore);
-                    vPortFree(cmds);
-                    vPortFree(sorted_cmds);
+                    pool_free(cmds);
+                    pool_free(sorted_cmds);
                     status = (int)red_errno;
                     memcpy(&gs_cmds->data[STATUS_BYTE], &status, sizeof(int8_t));
                     return SATR_ERROR;
@@ -611,9 +607,9 @@ SAT_returnState scheduler_service_app(csp_packet_t *gs_cmds, SemaphoreHandle_t s
                 // TODO: review stack size
                 xTaskCreate(vSchedulerHandler, "scheduler", 1000, scheduleSemaphore, NORMAL_SERVICE_PRIO, &SchedulerHandler);
 
-                // free pvPortMalloc
-                vPortFree(cmds);
-                vPortFree(sorted_cmds);
+                // free the buffers
+                pool_free(cmds);
+                pool_free(sorted_cmds);
             } 
             else {
                 sys_log(ERROR, "cannot obtain schedulerSemaphore, therefore file system cannot be accessed safely");
@@ -996,19 +992,19 @@ int prv_set_scheduler(char *cmd_buff, scheduled_commands_t *cmds) {
 int calc_cmd_frequency(scheduled_commands_t *cmds, int number_of_cmds, scheduled_commands_unix_t *sorted_cmds) {
     /*--------------------------------Initialize structures to store sorted commands--------------------------------*/
     // TODO: Confirm that the entire struct has been initialized with zeros
-    scheduled_commands_unix_t *non_reoccurring_cmds = (scheduled_commands_unix_t *)pvPortMalloc(number_of_cmds * sizeof(scheduled_commands_unix_t));
-    memset(non_reoccurring_cmds, 0, number_of_cmds * sizeof(scheduled_commands_unix_t));
+    scheduled_commands_unix_t *non_reoccurring_cmds = (scheduled_commands_unix_t *)pool_malloc(number_of_cmds * sizeof(scheduled_commands_unix_t));
     if (number_of_cmds > 0 && non_reoccurring_cmds == NULL) {
-        sys_log(ERROR, "pvPortMalloc for non_reoccurring_cmds failed, out of memory");
+        sys_log(ERROR, "pool_malloc for non_reoccurring_cmds failed, out of memory");
         return CALLOC_ERROR;
     }
-    scheduled_commands_t *reoccurring_cmds = (scheduled_commands_t *)pvPortMalloc(number_of_cmds * sizeof(scheduled_commands_t));
-    memset(reoccurring_cmds, 0, number_of_cmds * sizeof(scheduled_commands_t));
+    memset(non_reoccurring_cmds, 0, number_of_cmds * sizeof(scheduled_commands_unix_t));
+    scheduled_commands_t *reoccurring_cmds = (scheduled_commands_t *)pool_malloc(number_of_cmds * sizeof(scheduled_commands_t));
     if (number_of_cmds > 0 && reoccurring_cmds == NULL) {
-        sys_log(ERROR, "pvPortMalloc for reoccurring_cmds failed, out of memory");
-        vPortFree(non_reoccurring_cmds);
+        sys_log(ERROR, "pool_malloc for reoccurring_cmds failed, out of memory");
+        pool_free(non_reoccurring_cmds);
         return CALLOC_ERROR;
     }
+    memset(reoccurring_cmds, 0, number_of_cmds * sizeof(scheduled_commands_t));
     num_of_cmds.non_rep_cmds = 0;
     num_of_cmds.rep_cmds = 0;
 
@@ -1052,14 +1048,14 @@ int calc_cmd_frequency(scheduled_commands_t *cmds, int number_of_cmds, scheduled
     /*--------------------------------calculate the frequency of repeated cmds--------------------------------*/
     static tmElements_t time_buff;
     // TODO: check that all callocs have been freed
-    scheduled_commands_unix_t *repeated_cmds_buff = (scheduled_commands_unix_t *)pvPortMalloc(j_rep * sizeof(scheduled_commands_unix_t));
-    memset(repeated_cmds_buff, 0, j_rep * sizeof(scheduled_commands_unix_t));
+    scheduled_commands_unix_t *repeated_cmds_buff = (scheduled_commands_unix_t *)pool_malloc(j_rep * sizeof(scheduled_commands_unix_t));
     if (j_rep > 0 && repeated_cmds_buff == NULL) {
-        sys_log(ERROR, "pvPortMalloc for repeated_cmds_buff failed, out of memory");
-        vPortFree(non_reoccurring_cmds);
-        vPortFree(reoccurring_cmds);
+        sys_log(ERROR, "pool_malloc for repeated_cmds_buff failed, out of memory");
+        pool_free(non_reoccurring_cmds);
+        pool_free(reoccurring_cmds);
         return CALLOC_ERROR;
     }
+    memset(repeated_cmds_buff, 0, j_rep * sizeof(scheduled_commands_unix_t));
     // Obtain the soonest time that the command will be executed, and calculate the frequency it needs to be
     // executed at
     for (int j = 0; j < j_rep; j++) {
@@ -1140,10 +1136,10 @@ int calc_cmd_frequency(scheduled_commands_t *cmds, int number_of_cmds, scheduled
     memcpy(sorted_cmds, repeated_cmds_buff, sizeof(scheduled_commands_unix_t) * j_rep);
     memcpy((sorted_cmds + j_rep), non_reoccurring_cmds, sizeof(scheduled_commands_unix_t) * j_non_rep);
 
-    // free pvPortMalloc
-    vPortFree(non_reoccurring_cmds);
-    vPortFree(reoccurring_cmds);
-    vPortFree(repeated_cmds_buff);
+    // free the buffers
+    pool_free(non_reoccurring_cmds);
+    pool_free(reoccurring_cmds);
+    pool_free(repeated_cmds_buff);
 
     return SATR_OK;
 }
@@ -1190,70 +1186,52 @@ static uint32_t get_svc_wdt_counter() { return svc_wdt_counter; }
 SAT_returnState start_gs_cmds_scheduler_service(void);
 */
 
+static void scheduler_connection(csp_conn_t *conn);
+
 /**
  * @brief
- *      Start scheduler service
+ *      Register the scheduler service
  * @details
- *      Starts the FreeRTOS task responsible for accepting incoming
- *      schedule packets
+ *      Adds the scheduler connection handler to the service dispatcher
  * @param None
  * @return SAT_returnState
  *      success report
  */
 SAT_returnState start_scheduler_service(void) {
-    TaskHandle_t svc_tsk;
-    taskFunctions svc_funcs = {0};
-    svc_funcs.getCounterFunction = get_svc_wdt_counter;
     // create mutex to protect file system
     scheduleSemaphore = xSemaphoreCreateMutex();
 
-    if (xTaskCreate((TaskFunction_t)scheduler_service, "scheduler_service", SCHEDULER_SIZE, scheduleSemaphore,
-                    NORMAL_SERVICE_PRIO, &svc_tsk) != pdPASS) {
-        sys_log(ERROR, "FAILED TO CREATE TASK scheduler_service\n");
+    service_entry_t entry = {"scheduler_service", TC_SCHEDULER_SERVICE, scheduler_connection, SERVICE_PRIO_NORMAL,
+                             1, false};
+    if (service_dispatcher_register(&entry) != SATR_OK) {
+        sys_log(ERROR, "FAILED TO REGISTER scheduler_service\n");
         return SATR_ERROR;
     }
-    ex2_register(svc_tsk, svc_funcs);
     sys_log(NOTICE, "Scheduler service started\n");
     return SATR_OK;
 }
 
 /**
  * @brief
- *      FreeRTOS gs scheduler server task
+ *      Handle a connection to the scheduler service
  * @details
- *      Accepts incoming gs scheduler packets and executes the application
- * @param void* param
- * @return SAT_returnState
+ *      Reads incoming scheduler service packets and executes the application.
+ *      Run on a service worker, which closes the connection afterwards
+ * @param conn
+ *      Connection accepted by the service dispatcher
+ * @return None
  */
-SAT_returnState scheduler_service(SemaphoreHandle_t scheduleSemaphore) {
-    csp_socket_t *sock;
-    sock = csp_socket(CSP_SO_HMACREQ);
-    csp_bind(sock, TC_SCHEDULER_SERVICE);
-    csp_listen(sock, SERVICE_BACKLOG_LEN); // TODO: SERVICE_BACKLOG_LEN constant TBD
-    // svc_wdt_counter++;
-
-    for (;;) {
-        csp_conn_t *conn;
-        csp_packet_t *packet;
-
-        if ((conn = csp_accept(sock, CSP_MAX_TIMEOUT)) == NULL) {
-            /* timeout */
-            // ex2_log("woke up");
-            continue;
+static void scheduler_connection(csp_conn_t *conn) {
+    csp_packet_t *packet;
+
+    while ((packet = csp_read(conn, 50)) != NULL) {
+        if (scheduler_service_app(packet, scheduleSemaphore) != SATR_OK) {
+            int number_of_cmds = -1;
+            memcpy(&packet->data[OUT_DATA_BYTE], &number_of_cmds, sizeof(int8_t));
+            set_packet_length(packet, 2 * sizeof(int8_t) + 1); // plus one for sub-service
         }
-        // TODO: is a watchdog needed?
-        // svc_wdt_counter++;
-
-        while ((packet = csp_read(conn, 50)) != NULL) {
-            if (scheduler_service_app(packet, scheduleSemaphore) != SATR_OK) {
-                int number_of_cmds = -1;
-                memcpy(&packet->data[OUT_DATA_BYTE], &number_of_cmds, sizeof(int8_t));
-                set_packet_length(packet, 2 * sizeof(int8_t) + 1); // plus one for sub-service
-            }
-            if (!csp_send(conn, packet, 50)) {
-                csp_buffer_free(packet);
-            }
+        if (!csp_send(conn, packet, 50)) {
+            csp_buffer_free(packet);
         }
-        csp_close(conn); // frees buffers used
     }
 }
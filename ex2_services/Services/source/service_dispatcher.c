@@ -0,0 +1,324 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file service_dispatcher.c
+ * @date Oct. 19, 2026
+ *
+ * One task accepts the connections of every service and hands them to a
+ * small pool of workers.
+ *
+ * Services register a handler for their port before the dispatcher starts.
+ * The dispatcher binds all the ports to one socket, looks up each accepted
+ * connection by its destination port and queues it. A free worker takes the
+ * waiting connection of the highest priority service that is below its
+ * concurrency limit, oldest first. Bulk services, which can hold a worker for
+ * a long time, may only use SERVICE_BULK_WORKERS workers at once so quick
+ * requests always have one left. A service's priority only decides which
+ * waiting connection is taken next, the workers themselves all run at
+ * NORMAL_SERVICE_PRIO whatever service they are handling.
+ *
+ * CSP's own ports, such as ping, are answered by the dispatcher itself.
+ * Queue wait and handler time are measured here for every service.
+ *
+ * Each worker and the dispatcher has its own watchdog counter, so one hung
+ * handler stops the watchdog being fed however busy the other tasks are.
+ * A worker's counter moves between connections, so handlers that keep a
+ * connection for a long time call service_dispatcher_feed for each packet.
+ */
+
+#include "service_dispatcher.h"
+
+#include <FreeRTOS.h>
+#include <os_semphr.h>
+#include <os_task.h>
+
+#include "logger/logger.h"
+#include "task_manager/task_manager.h"
+
+typedef struct {
+    csp_conn_t *conn;
+    uint8_t service; // index into handlers
+    TickType_t accepted;
+} pending_conn_t;
+
+static service_entry_t handlers[SERVICE_HANDLERS_MAX];
+static service_stats_t stats[SERVICE_HANDLERS_MAX];
+static uint8_t running[SERVICE_HANDLERS_MAX];
+static uint8_t service_count = 0;
+static uint8_t bulk_running = 0;
+
+static pending_conn_t pending[SERVICE_PENDING_LEN];
+static uint8_t pending_count = 0;
+
+static SemaphoreHandle_t dispatch_lock = NULL;
+static SemaphoreHandle_t work = NULL; // given for each queued connection and each finished one
+
+/* Watchdog counter of each worker, and last of the dispatcher */
+#define DISPATCHER_WDT SERVICE_WORKER_COUNT
+static uint32_t wdt_counter[SERVICE_WORKER_COUNT + 1];
+static TaskHandle_t wdt_task[SERVICE_WORKER_COUNT + 1];
+
+/* The task manager takes a counter function without arguments, so each task needs its own */
+#if SERVICE_WORKER_COUNT != 3
+#error "Add a counter function for each service worker"
+#endif
+static uint32_t get_worker0_wdt_counter(void) { return wdt_counter[0]; }
+static uint32_t get_worker1_wdt_counter(void) { return wdt_counter[1]; }
+static uint32_t get_worker2_wdt_counter(void) { return wdt_counter[2]; }
+static uint32_t get_dispatcher_wdt_counter(void) { return wdt_counter[DISPATCHER_WDT]; }
+
+static uint32_t (*const get_wdt_counter[SERVICE_WORKER_COUNT + 1])(void) = {
+    get_worker0_wdt_counter,
+    get_worker1_wdt_counter,
+    get_worker2_wdt_counter,
+    get_dispatcher_wdt_counter,
+};
+
+static uint32_t ticks_to_ms(TickType_t ticks) { return ticks * portTICK_PERIOD_MS; }
+
+static int8_t find_service(uint8_t port) {
+    uint8_t i;
+    for (i = 0; i < service_count; i++) {
+        if (handlers[i].port == port) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* Must hold the lock. Returns the index into pending of the connection to handle next, or -1 */
+static int8_t next_pending(void) {
+    int8_t best = -1;
+    uint8_t i;
+
+    for (i = 0; i < pending_count; i++) {
+        const service_entry_t *service = &handlers[pending[i].service];
+        if (running[pending[i].service] >= service->max_concurrent) {
+            continue;
+        }
+        if (service->bulk && bulk_running >= SERVICE_BULK_WORKERS) {
+            continue;
+        }
+        if (best == -1 || service->priority < handlers[pending[best].service].priority) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief
+ *      Worker task, runs the handlers of queued connections
+ * @param void* param
+ *      Index of the worker's watchdog counter
+ * @return None
+ */
+static void service_worker(void *param) {
+    uint32_t *counter = &wdt_counter[(uintptr_t)param];
+
+    for (;;) {
+        (*counter)++;
+        if (xSemaphoreTake(work, pdMS_TO_TICKS(DELAY_WAIT_TIMEOUT)) != pdTRUE) {
+            continue;
+        }
+
+        xSemaphoreTake(dispatch_lock, portMAX_DELAY);
+        int8_t next = next_pending();
+        if (next == -1) {
+            // Everything waiting is held back by a limit, a finishing worker will look again
+            xSemaphoreGive(dispatch_lock);
+            continue;
+        }
+        pending_conn_t job = pending[next];
+        pending_count--;
+        memmove(&pending[next], &pending[next + 1], (pending_count - next) * sizeof(pending[0]));
+        const service_entry_t *service = &handlers[job.service];
+        running[job.service]++;
+        if (service->bulk) {
+            bulk_running++;
+        }
+        xSemaphoreGive(dispatch_lock);
+
+        TickType_t start = xTaskGetTickCount();
+        service->handler(job.conn);
+        csp_close(job.conn);
+        TickType_t end = xTaskGetTickCount();
+
+        xSemaphoreTake(dispatch_lock, portMAX_DELAY);
+        service_stats_t *s = &stats[job.service];
+        uint32_t wait_ms = ticks_to_ms(start - job.accepted);
+        uint32_t run_ms = ticks_to_ms(end - start);
+        s->connections++;
+        s->max_wait_ms = wait_ms > s->max_wait_ms ? wait_ms : s->max_wait_ms;
+        s->max_run_ms = run_ms > s->max_run_ms ? run_ms : s->max_run_ms;
+        s->total_run_ms += run_ms;
+        running[job.service]--;
+        if (service->bulk) {
+            bulk_running--;
+        }
+        xSemaphoreGive(dispatch_lock);
+        xSemaphoreGive(work);
+    }
+}
+
+/**
+ * @brief
+ *      Dispatcher task, accepts connections for every service and queues them
+ * @param void* param
+ * @return None
+ */
+static void service_dispatcher(void *param) {
+    csp_socket_t *sock = csp_socket(CSP_SO_HMACREQ);
+    uint8_t i;
+
+    csp_bind(sock, CSP_PING);
+    for (i = 0; i < service_count; i++) {
+        csp_bind(sock, handlers[i].port);
+    }
+    csp_listen(sock, SERVICE_BACKLOG_LEN);
+
+    for (;;) {
+        csp_conn_t *conn;
+        csp_packet_t *packet;
+        wdt_counter[DISPATCHER_WDT]++;
+        if ((conn = csp_accept(sock, DELAY_WAIT_TIMEOUT)) == NULL) {
+            /* timeout */
+            continue;
+        }
+
+        int8_t service = find_service(csp_conn_dport(conn));
+        if (service == -1) {
+            while ((packet = csp_read(conn, 50)) != NULL) {
+                csp_service_handler(conn, packet);
+            }
+            csp_close(conn);
+            continue;
+        }
+
+        xSemaphoreTake(dispatch_lock, portMAX_DELAY);
+        if (pending_count == SERVICE_PENDING_LEN) {
+            stats[service].rejected++;
+            xSemaphoreGive(dispatch_lock);
+            sys_log(WARN, "Too many requests waiting, dropped %s connection", handlers[service].name);
+            csp_close(conn);
+            continue;
+        }
+        pending[pending_count].conn = conn;
+        pending[pending_count].service = service;
+        pending[pending_count].accepted = xTaskGetTickCount();
+        pending_count++;
+        xSemaphoreGive(dispatch_lock);
+        xSemaphoreGive(work);
+    }
+}
+
+/**
+ * @brief
+ *      Add a service to the dispatcher's handler table
+ * @details
+ *      Must be called before start_service_dispatcher
+ * @param entry
+ *      Service to add, copied into the table
+ * @return SAT_returnState
+ *      SATR_ERROR if the table is full or the port is taken
+ */
+SAT_returnState service_dispatcher_register(const service_entry_t *entry) {
+    if (service_count == SERVICE_HANDLERS_MAX || find_service(entry->port) != -1 || entry->max_concurrent == 0) {
+        return SATR_ERROR;
+    }
+    handlers[service_count++] = *entry;
+    return SATR_OK;
+}
+
+/**
+ * @brief
+ *      Start the dispatcher and worker tasks
+ * @return SAT_returnState
+ *      success report
+ */
+SAT_returnState start_service_dispatcher(void) {
+    taskFunctions svc_funcs = {0};
+    uint8_t i;
+
+    dispatch_lock = xSemaphoreCreateMutex();
+    work = xSemaphoreCreateCounting(SERVICE_PENDING_LEN + SERVICE_WORKER_COUNT, 0);
+    if (dispatch_lock == NULL || work == NULL) {
+        return SATR_ERROR;
+    }
+
+    for (i = 0; i < SERVICE_WORKER_COUNT; i++) {
+        if (xTaskCreate((TaskFunction_t)service_worker, "service_worker", SERVICE_WORKER_SIZE,
+                        (void *)(uintptr_t)i, NORMAL_SERVICE_PRIO, &wdt_task[i]) != pdPASS) {
+            ex2_log("FAILED TO CREATE TASK service_worker\n");
+            return SATR_ERROR;
+        }
+        svc_funcs.getCounterFunction = get_wdt_counter[i];
+        ex2_register(wdt_task[i], svc_funcs);
+    }
+    if (xTaskCreate((TaskFunction_t)service_dispatcher, "service_dispatcher", SERVICE_DISPATCHER_SIZE, NULL,
+                    NORMAL_SERVICE_PRIO, &wdt_task[DISPATCHER_WDT]) != pdPASS) {
+        ex2_log("FAILED TO CREATE TASK service_dispatcher\n");
+        return SATR_ERROR;
+    }
+    svc_funcs.getCounterFunction = get_wdt_counter[DISPATCHER_WDT];
+    ex2_register(wdt_task[DISPATCHER_WDT], svc_funcs);
+    return SATR_OK;
+}
+
+/**
+ * @brief
+ *      Copy out the statistics of one service
+ * @param index
+ *      Service to get, in the order they were registered
+ * @param name
+ *      Set to the name of the service
+ * @param out
+ *      Where to copy the statistics
+ * @return
+ *      false once index is past the last service
+ */
+bool service_dispatcher_get_stats(uint8_t index, const char **name, service_stats_t *out) {
+    if (index >= service_count) {
+        return false;
+    }
+    *name = handlers[index].name;
+    if (dispatch_lock != NULL) {
+        xSemaphoreTake(dispatch_lock, portMAX_DELAY);
+    }
+    *out = stats[index];
+    if (dispatch_lock != NULL) {
+        xSemaphoreGive(dispatch_lock);
+    }
+    return true;
+}
+
+/**
+ * @brief
+ *      Show the watchdog a handler is still making progress
+ * @details
+ *      For handlers that stay in a loop for a long time, such as streams.
+ *      Only feeds the counter of the worker it is called from, and does
+ *      nothing on any other task
+ */
+void service_dispatcher_feed(void) {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    uint8_t i;
+
+    for (i = 0; i < SERVICE_WORKER_COUNT; i++) {
+        if (wdt_task[i] == self) {
+            wdt_counter[i]++;
+            return;
+        }
+    }
+}
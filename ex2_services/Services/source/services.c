@@ -36,26 +36,23 @@
 #include "adcs/adcs_service.h"
 #include "northern_spirit/ns_service.h"
 #include "payload/iris/iris_service.h"
+#include "service_dispatcher.h"
 
 #include "printf.h"
 
-void csp_server(void *parameters);
 SAT_returnState start_service_server(void);
 
 /**
  * @brief
- *      Start the services server, and response task
+ *      Start the services server
  * @details
- *      intitializes the FreeRTOS queue and task
+ *      registers each service with the service dispatcher, then starts the
+ *      dispatcher and its workers
  * @param void
  * @return SAT_returnState
  *      success or failure
  */
 SAT_returnState start_service_server(void) {
-    if (xTaskCreate((TaskFunction_t)csp_server, "csp_server THREAD", 256, NULL, NORMAL_SERVICE_PRIO, NULL) !=
-        pdPASS) {
-        return SATR_ERROR;
-    }
     services start_service_function[] = {
         &start_cli_service,       &start_communication_service, &start_time_management_service,
         &start_scheduler_service, &start_housekeeping_service,  &start_general_service,
@@ -89,47 +86,12 @@ SAT_returnState start_service_server(void) {
         }
     }
     vPortFree(start_service_flag);
-    return SATR_OK;
-}
-
-/**
- * @brief
- * 		CSP server loop to services pings, and such
- * @details
- * 		send incoming CSP packets to the appropriate service queues,
- * otherwise pass it to the CSP service handler
- * @param void *parameters
- * 		not used
- */
-void csp_server(void *parameters) {
-    csp_socket_t *sock;
-
-    /* Create socket and listen for incoming connections */
-    sock = csp_socket(CSP_SO_HMACREQ);
-    //  csp_bind(sock, CSP_CMP);
-    csp_bind(sock, CSP_PING);
-    //  csp_bind(sock, CSP_PS);
-    //  csp_bind(sock, CSP_MEMFREE);
-    //  csp_bind(sock, CSP_REBOOT);
-    //  csp_bind(sock, CSP_BUF_FREE);
-    //  csp_bind(sock, CSP_UPTIME);
-
-    csp_listen(sock, SERVICE_BACKLOG_LEN);
-
-    for (;;) {
-        /* Process incoming packet */
-        csp_conn_t *conn;
-        csp_packet_t *packet;
-        if ((conn = csp_accept(sock, CSP_MAX_TIMEOUT)) == NULL) {
-            /* timeout */
-            continue;
-        }
 
-        while ((packet = csp_read(conn, 50)) != NULL) {
-            csp_service_handler(conn, packet);
-        }
-        csp_close(conn);
+    if (start_service_dispatcher() != SATR_OK) {
+        sys_log(ERROR, "start service dispatcher failed");
+        return SATR_ERROR;
     }
+    return SATR_OK;
 }
 
 // for testing only. do hex dump
@@ -22,6 +22,7 @@
 
 #include "rtcmk.h"
 #include "services.h"
+#include "service_dispatcher.h"
 #include "task_manager/task_manager.h"
 #include "time_management/time_management_service.h"
 #include "util/service_utilities.h"
@@ -30,73 +31,49 @@
 #include <main/system.h>
 #include <stdio.h>
 
-#define TIME_MANAGEMENT_SIZE 300
-
 SAT_returnState time_management_app(csp_packet_t *packet);
 
-static uint32_t svc_wdt_counter = 0;
-
-static uint32_t get_svc_wdt_counter() { return svc_wdt_counter; }
-
 /**
  * @brief
- *      FreeRTOS time management server task
+ *      Handle a connection to the time management service
  * @details
- *      Accepts incoming time management service packets and executes the application
- * @param void* param
+ *      Reads incoming time management service packets and executes the application.
+ *      Run on a service worker, which closes the connection afterwards
+ * @param conn
+ *      Connection accepted by the service dispatcher
  * @return None
  */
-void time_management_service(void *param) {
-    csp_socket_t *sock;
-    sock = csp_socket(CSP_SO_HMACREQ);
-    csp_bind(sock, TC_TIME_MANAGEMENT_SERVICE);
-    csp_listen(sock, SERVICE_BACKLOG_LEN);
-    svc_wdt_counter++;
-    for (;;) {
-        svc_wdt_counter++;
-        csp_conn_t *conn;
-        csp_packet_t *packet;
-        if ((conn = csp_accept(sock, DELAY_WAIT_TIMEOUT)) == NULL) {
-            svc_wdt_counter++;
-            /* timeout */
-            continue;
-        }
-        svc_wdt_counter++;
-        while ((packet = csp_read(conn, 50)) != NULL) {
-            if (time_management_app(packet) != SATR_OK) {
-                // something went wrong, this shouldn't happen
+static void time_management_connection(csp_conn_t *conn) {
+    csp_packet_t *packet;
+
+    while ((packet = csp_read(conn, 50)) != NULL) {
+        if (time_management_app(packet) != SATR_OK) {
+            // something went wrong, this shouldn't happen
+            csp_buffer_free(packet);
+        } else {
+            if (!csp_send(conn, packet, 50)) {
                 csp_buffer_free(packet);
-            } else {
-                if (!csp_send(conn, packet, 50)) {
-                    csp_buffer_free(packet);
-                }
             }
         }
-        csp_close(conn);
     }
 }
 
 /**
  * @brief
- *      Start the time management server task
+ *      Register the time management service
  * @details
- *      Starts the FreeRTOS task responsible for accepting incoming
- *      time management packets
+ *      Adds the time management connection handler to the service dispatcher
  * @param None
  * @return SAT_returnState
  *      success report
  */
 SAT_returnState start_time_management_service(void) {
-    TaskHandle_t svc_tsk;
-    taskFunctions svc_funcs = {0};
-    svc_funcs.getCounterFunction = get_svc_wdt_counter;
-    if (xTaskCreate((TaskFunction_t)time_management_service, "time_management_service", TIME_MANAGEMENT_SIZE, NULL,
-                    NORMAL_SERVICE_PRIO, &svc_tsk) != pdPASS) {
-        ex2_log("FAILED TO CREATE TASK time_management_service\n");
+    service_entry_t entry = {"time_management_service", TC_TIME_MANAGEMENT_SERVICE, time_management_connection,
+                             SERVICE_PRIO_HIGH, 1, false};
+    if (service_dispatcher_register(&entry) != SATR_OK) {
+        ex2_log("FAILED TO REGISTER time_management_service\n");
         return SATR_ERROR;
     }
-    ex2_register(svc_tsk, svc_funcs);
-
     return SATR_OK;
 }
 
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file calibration.h
+ * @date Oct. 19, 2026
+ */
+
+#ifndef EX2_SYSTEM_INCLUDE_CALIBRATION_CALIBRATION_H_
+#define EX2_SYSTEM_INCLUDE_CALIBRATION_CALIBRATION_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Linear scales and offsets are fixed point with this many fraction bits */
+#define CALIBRATION_Q 16
+#define CALIBRATION_FIXED(x) ((int32_t)((x) * (1L << CALIBRATION_Q) + ((x) < 0 ? -0.5 : 0.5)))
+
+typedef enum {
+    CALIBRATION_LINEAR, // output = raw * scale + offset
+    CALIBRATION_TABLE,  // output interpolated from a table indexed by raw
+} calibration_kind_t;
+
+typedef struct {
+    calibration_kind_t kind;
+    uint8_t raw_shift;  // status bits below the value, dropped first
+    uint8_t raw_bits;   // width of a two's complement value, 0 if the value is unsigned
+    int32_t scale;      // linear: output units per raw count, CALIBRATION_FIXED
+    int32_t offset;     // linear: added to the scaled value, CALIBRATION_FIXED
+    uint8_t step_shift; // table: entries are 1 << step_shift raw counts apart, starting at 0
+    uint16_t entries;   // table: number of entries, at least 2
+    const int32_t *table;
+} calibration_t;
+
+/* Hyperion AD7291 channels, 2.5 V reference */
+extern const calibration_t cal_ad7291_mv;             // input voltage in mV
+extern const calibration_t cal_lmt70_centi_c;         // LMT70 temperature in hundredths of a degree C
+extern const calibration_t cal_hyperion_mv;           // panel voltage in mV
+extern const calibration_t cal_hyperion_ma;           // panel current in mA
+extern const calibration_t cal_hyperion_pd;           // photodiode in percent of full scale
+extern const calibration_t cal_ad7291_tsense_centi_c; // AD7291 internal sensor in hundredths of a degree C
+
+/* 12 bit two's complement temperature above 4 status bits, 0.0625 C per count (TMP421, S-band) */
+extern const calibration_t cal_temp12_ten_thousandth_c;
+
+/* INA226 registers */
+extern const calibration_t cal_ina226_bus_mv;   // bus voltage in mV
+extern const calibration_t cal_ina226_shunt_uv; // shunt voltage in uV
+
+/* DFGM housekeeping words, in the units listed in dfgm_handler.h */
+#define CALIBRATION_DFGM_HK_COUNT 12
+extern const calibration_t cal_dfgm_hk[CALIBRATION_DFGM_HK_COUNT];
+
+int32_t calibration_convert(const calibration_t *cal, uint16_t raw);
+
+void calibration_convert_n(const calibration_t *cal, const uint16_t *raw, int32_t *out, size_t n);
+
+#endif /* EX2_SYSTEM_INCLUDE_CALIBRATION_CALIBRATION_H_ */
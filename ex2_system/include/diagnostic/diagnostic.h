@@ -21,11 +21,31 @@
 #define EX2_SYSTEM_INCLUDE_DIAGNOSTIC_DIAGNOSTIC_H_
 
 #include "main/system.h"
+#include <stdbool.h>
 
 #define STUBBED_WATCHDOG_DELAY 42
 #define WATCHDOG_MINIMUM_DELAY_MS 30000
 
+typedef enum {
+    HEALTH_UHF,
+    HEALTH_SBAND,
+    HEALTH_CHARON,
+    HEALTH_ADCS,
+    HEALTH_NS,
+    HEALTH_SUBSYSTEM_COUNT
+} health_subsystem_id;
+
+typedef struct {
+    uint32_t probes;        // checks of a powered subsystem, including retries
+    uint32_t failed_probes; // checks it did not answer
+    uint32_t power_cycles;  // power cycles started
+    uint32_t failed_cycles; // power cycles that stopped because the subsystem did not switch
+} health_stats_t;
+
 SAT_returnState start_diagnostic_daemon(void);
+TickType_t get_watchdog_delay(health_subsystem_id id);
+SAT_returnState set_watchdog_delay(health_subsystem_id id, const unsigned int ms_delay);
+bool diagnostic_get_stats(uint8_t index, const char **name, health_stats_t *stats);
 TickType_t get_uhf_watchdog_delay(void);
 TickType_t get_sband_watchdog_delay(void);
 TickType_t get_charon_watchdog_delay(void);
@@ -23,9 +23,12 @@
 
 #define UPDATE_INFO_BLOCKNUMBER 3
 
-#define LEOP_INFO_BLOCKNUMBER 4
+#define LEOP_INFO_BLOCKNUMBER 4 // only read to move the status into nv_store
 
 Fapi_StatusType eeprom_write(void *dat, uint8_t block, uint32_t size);
 Fapi_StatusType eeprom_read(void *dat, uint8_t block, uint32_t size);
 
+void flash_lock(void);
+void flash_unlock(void);
+
 #endif /* EX2_SYSTEM_INCLUDE_EEPROM_H_ */
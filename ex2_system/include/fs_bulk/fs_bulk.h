@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file fs_bulk.h
+ * @date Oct. 19, 2026
+ */
+
+#ifndef EX2_SYSTEM_INCLUDE_FS_BULK_FS_BULK_H_
+#define EX2_SYSTEM_INCLUDE_FS_BULK_FS_BULK_H_
+
+#include <redposix.h>
+#include <stdint.h>
+
+/* Bytes moved by each read and write of a copy, a whole number of file system blocks */
+#define FS_BULK_BUFFER_SIZE (16 * REDCONF_BLOCK_SIZE)
+
+#define FS_BULK_PATH_MAX 256
+
+/* Directory entries are listed into this many bytes of names shared by every level of a walk */
+#define FS_BULK_NAMES_SIZE 2048
+
+/* Deepest directory a walk goes into below the one it was given */
+#define FS_BULK_DEPTH_MAX 8
+
+typedef struct {
+    uint32_t files; // files copied, moved, removed or counted
+    uint32_t dirs;  // directories copied, moved, removed or counted
+    uint64_t bytes; // bytes of file data in those files
+} fs_bulk_totals;
+
+typedef struct {
+    uint32_t block_size;
+    uint64_t total_bytes;
+    uint64_t free_bytes;
+    uint32_t total_inodes;
+    uint32_t free_inodes;
+} fs_bulk_volume;
+
+/* Called after each file and each buffer copied, long operations can use it to report and feed a watchdog */
+typedef void (*fs_bulk_progress)(const fs_bulk_totals *totals, void *arg);
+
+int32_t fs_bulk_copy(const char *from, const char *to, fs_bulk_totals *totals, fs_bulk_progress progress,
+                     void *arg);
+
+int32_t fs_bulk_move(const char *from, const char *to, fs_bulk_totals *totals, fs_bulk_progress progress,
+                     void *arg);
+
+int32_t fs_bulk_remove(const char *path, fs_bulk_totals *totals, fs_bulk_progress progress, void *arg);
+
+int32_t fs_bulk_usage(const char *path, fs_bulk_totals *totals);
+
+int32_t fs_bulk_volume_info(const char *volume, fs_bulk_volume *info);
+
+#endif /* EX2_SYSTEM_INCLUDE_FS_BULK_FS_BULK_H_ */
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file fw_delta.h
+ * @date Oct. 19, 2026
+ */
+
+#ifndef EX2_SYSTEM_INCLUDE_FW_UPDATE_FW_DELTA_H_
+#define EX2_SYSTEM_INCLUDE_FW_UPDATE_FW_DELTA_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define FW_DELTA_MAGIC 0x45584431 // "EXD1"
+#define FW_DELTA_HEADER_SIZE 18
+
+/* Operations of a patch, each followed by its arguments as LEB128 varints */
+typedef enum {
+    FW_DELTA_END = 0,    // no arguments, the new image is complete
+    FW_DELTA_COPY = 1,   // length, then the zigzag encoded move of the source position before copying
+    FW_DELTA_INSERT = 2, // length, then that many bytes of the new image
+    FW_DELTA_ADD = 3,    // length, move as for COPY, count of changed bytes, then each as a skip and a difference
+} fw_delta_op;
+
+typedef enum { FW_DELTA_MORE = 0, FW_DELTA_DONE, FW_DELTA_ERROR } fw_delta_result;
+
+typedef struct {
+    uint32_t source_size; // image the patch applies to
+    uint16_t source_crc;
+    uint32_t target_size; // image the patch produces
+    uint16_t target_crc;
+} fw_delta_header;
+
+/* Receives the new image in order. Returns false to stop */
+typedef bool (*fw_delta_output)(uint32_t offset, const uint8_t *data, uint32_t length);
+
+/* Where a patch being applied is up to, kept between pieces of the patch */
+typedef struct {
+    fw_delta_header header;
+    const uint8_t *source;
+    fw_delta_output output;
+    uint32_t source_pos;
+    uint32_t produced; // bytes of the new image output so far
+    uint8_t state;
+    uint8_t op;
+    uint8_t shift;    // bits of the varint being read so far
+    uint32_t value;   // varint being read
+    uint32_t length;  // of the current operation
+    uint32_t pending; // bytes of the current insert or add still to come
+    uint32_t changes; // changed bytes of the current add still to come
+} fw_delta_ctx;
+
+bool fw_delta_parse_header(const uint8_t *data, fw_delta_header *header);
+
+void fw_delta_init(fw_delta_ctx *ctx, const fw_delta_header *header, const uint8_t *source,
+                   fw_delta_output output);
+
+fw_delta_result fw_delta_feed(fw_delta_ctx *ctx, const uint8_t *data, uint32_t length);
+
+#endif /* EX2_SYSTEM_INCLUDE_FW_UPDATE_FW_DELTA_H_ */
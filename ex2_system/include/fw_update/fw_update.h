@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file fw_update.h
+ * @date Oct. 19, 2026
+ */
+
+#ifndef EX2_SYSTEM_INCLUDE_FW_UPDATE_FW_UPDATE_H_
+#define EX2_SYSTEM_INCLUDE_FW_UPDATE_FW_UPDATE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "image_verify/image_verify.h"
+#include "system.h"
+
+/* Bytes per programming command, the width of the main flash banks */
+#define FW_UPDATE_BURST 32
+
+/* Uplinked data is gathered into two buffers of this many bytes, one fills while the other is programmed */
+#define FW_UPDATE_BUFFER_SIZE 2048
+
+/* The next sector is erased while the writer is idle once the write pointer is this close to the erased end */
+#define FW_UPDATE_ERASE_AHEAD 0x8000
+
+/* Longest a write waits for the writer to free a buffer */
+#define FW_UPDATE_WAIT pdMS_TO_TICKS(10000)
+
+#define FW_UPDATE_STACK_SIZE 256
+
+typedef struct {
+    bool active;         // an update is being received
+    image_type target;   // image being replaced
+    uint32_t size;       // bytes in the new image
+    uint32_t received;   // bytes accepted from the uplink
+    uint32_t programmed; // bytes programmed and read back
+    uint32_t resumed_at; // bytes kept from an interrupted update, 0 if started afresh
+} fw_update_status;
+
+SAT_returnState fw_update_begin(image_type target, uint32_t size, uint16_t crc, uint32_t *resume_at);
+
+SAT_returnState fw_update_write(uint32_t offset, const uint8_t *data, uint32_t length);
+
+SAT_returnState fw_update_begin_delta(image_type target, const uint8_t *header);
+
+SAT_returnState fw_update_write_delta(const uint8_t *data, uint32_t length, bool *done);
+
+SAT_returnState fw_update_finish(void);
+
+void fw_update_get_status(fw_update_status *status);
+
+SAT_returnState start_fw_update_daemon(void);
+
+#endif /* EX2_SYSTEM_INCLUDE_FW_UPDATE_FW_UPDATE_H_ */
@@ -20,6 +20,21 @@
 #define EX2_SYSTEM_HOUSEKEEPING_TASK_H_
 
 #define HK_DAEMON_STACK_SIZE 1200
+
+/* Seconds between collections when no limit is tripped. Every collection is checked against the limits */
+#define HK_SAMPLE_PERIOD_S 30
+
+/* Seconds between collections of the subsystems with a tripped limit */
+#define HK_BURST_PERIOD_S 2
+
+/* Seconds to keep storing every collection after the limit trip that started a burst */
+#define HK_POST_TRIGGER_S 60
+
+/* Seconds after a burst ends before a limit trip can start another */
+#define HK_BURST_HOLDOFF_S 600
+
+/* Collections kept in RAM between stores, and stored when a limit trips */
+#define HK_PRE_TRIGGER_RECORDS (HK_STORE_PERIOD_S / HK_SAMPLE_PERIOD_S)
 #include "system.h"
 
 SAT_returnState start_housekeeping_daemon(void);
@@ -0,0 +1,28 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file image_crc.h
+ * @date Oct. 19, 2026
+ */
+
+#ifndef EX2_SYSTEM_INCLUDE_IMAGE_VERIFY_IMAGE_CRC_H_
+#define EX2_SYSTEM_INCLUDE_IMAGE_VERIFY_IMAGE_CRC_H_
+
+#include <stdint.h>
+
+uint16_t image_crc16(uint16_t crc, const uint8_t *data, uint32_t length);
+
+uint64_t image_crc64(uint64_t crc, const uint8_t *data, uint32_t length);
+
+#endif /* EX2_SYSTEM_INCLUDE_IMAGE_VERIFY_IMAGE_CRC_H_ */
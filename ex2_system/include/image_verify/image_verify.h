@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file image_verify.h
+ * @date Oct. 19, 2026
+ */
+
+#ifndef EX2_SYSTEM_INCLUDE_IMAGE_VERIFY_IMAGE_VERIFY_H_
+#define EX2_SYSTEM_INCLUDE_IMAGE_VERIFY_IMAGE_VERIFY_H_
+
+#include <FreeRTOS.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "bl_eeprom.h"
+#include "system.h"
+
+/* 1 to checksum with the CRC module, 0 to use the software CRC-64 */
+#define IMAGE_VERIFY_HW_CRC 1
+
+/* Bytes the background check covers before giving up the CPU, a multiple of 8 */
+#define IMAGE_VERIFY_CHUNK 0x4000
+#define IMAGE_VERIFY_CHUNK_DELAY pdMS_TO_TICKS(10)
+
+/* The inactive image is first checked this long after boot, then once a day */
+#define IMAGE_VERIFY_START_DELAY ONE_MINUTE
+#define IMAGE_VERIFY_PERIOD (24 * 60 * ONE_MINUTE)
+
+#define IMAGE_VERIFY_STACK_SIZE 256
+
+typedef enum { IMAGE_APPLICATION = 0, IMAGE_GOLDEN = 1, IMAGE_COUNT } image_type;
+
+typedef enum { IMAGE_UNCHECKED = 0, IMAGE_VALID, IMAGE_INVALID, IMAGE_MISSING } image_state;
+
+typedef struct {
+    image_state state;
+    bool signature;      // checked against the saved CRC-64, not the full CRC-16
+    uint32_t elapsed_ms; // time the check took
+    uint32_t checked_at; // uptime in seconds when the check finished
+} image_verify_status;
+
+/* A check in progress, advanced a chunk at a time */
+typedef struct {
+    image_type type;
+    image_info info;
+    uint32_t channel; // CRC module channel the check owns
+    const uint8_t *next;
+    uint32_t remaining;
+    uint16_t crc16;
+    uint64_t crc64;     // running CRC-64 when the software CRC is used
+    bool full;          // no signature saved for this image yet, so the CRC-16 is computed too
+    uint64_t signature; // expected CRC-64 when not full
+    TickType_t start;
+} image_verify_ctx;
+
+image_state image_verify_begin(image_verify_ctx *ctx, image_type type, uint32_t channel);
+
+bool image_verify_step(image_verify_ctx *ctx, uint32_t max_bytes);
+
+image_state image_verify_end(image_verify_ctx *ctx);
+
+image_state image_verify(image_type type);
+
+void image_verify_get_status(image_type type, image_verify_status *status);
+
+SAT_returnState start_image_verify_daemon(void);
+
+#endif /* EX2_SYSTEM_INCLUDE_IMAGE_VERIFY_IMAGE_VERIFY_H_ */
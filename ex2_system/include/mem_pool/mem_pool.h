@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file mem_pool.h
+ * @date Oct. 19, 2026
+ */
+
+#ifndef EX2_SYSTEM_INCLUDE_MEM_POOL_MEM_POOL_H_
+#define EX2_SYSTEM_INCLUDE_MEM_POOL_MEM_POOL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Guard words around every block, checked when the block is freed */
+#ifndef MEM_POOL_CANARIES
+#define MEM_POOL_CANARIES 1
+#endif
+
+/*
+ * Size classes as X(block size in bytes, number of blocks), smallest first.
+ * Block sizes must be multiples of 8.
+ */
+#define MEM_POOL_CLASSES(X)                                                                                       \
+    X(32, 16)  /* NS replies, ADCS telecommand frames */                                                          \
+    X(128, 12) /* task manager nodes, scheduler command lists */                                                  \
+    X(256, 8)                                                                                                     \
+    X(512, 4) /* ADCS telemetry replies */
+
+typedef struct {
+    uint16_t block_size;
+    uint16_t blocks;
+    uint16_t used;
+    uint16_t high_water;
+    uint32_t allocs;
+    uint32_t failures;    // requests that found this class full
+    uint32_t corruptions; // bad pointers, double frees and overwritten canaries seen on free
+} mem_pool_stats_t;
+
+typedef struct {
+    uint32_t heap_free;
+    uint32_t heap_min_free;
+    uint32_t heap_fallbacks;  // pool_malloc requests served by the FreeRTOS heap
+    uint32_t malloc_failures; // pvPortMalloc failures since boot
+} mem_heap_stats_t;
+
+void *pool_malloc(size_t size);
+
+void pool_free(void *ptr);
+
+uint32_t mem_pool_count(void);
+
+bool mem_pool_get_stats(uint32_t index, mem_pool_stats_t *stats);
+
+void mem_heap_get_stats(mem_heap_stats_t *stats);
+
+void mem_pool_malloc_failed(void);
+
+#endif /* EX2_SYSTEM_INCLUDE_MEM_POOL_MEM_POOL_H_ */
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file nv_store.h
+ * @date Oct. 19, 2026
+ */
+
+#ifndef EX2_SYSTEM_INCLUDE_NV_STORE_NV_STORE_H_
+#define EX2_SYSTEM_INCLUDE_NV_STORE_NV_STORE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* The store uses two areas of bank 7 sectors starting at this one. Sectors below it hold the fixed blocks */
+#define NV_STORE_FIRST_SECTOR 8
+#define NV_STORE_AREA_SECTORS 4
+#define NV_STORE_SECTOR_SIZE 0x1000
+#define NV_STORE_AREA_SIZE (NV_STORE_AREA_SECTORS * NV_STORE_SECTOR_SIZE)
+#define NV_STORE_AREAS 2
+
+/* Flash is programmed in words of this many bytes, each only once between erases */
+#define NV_STORE_WORD 8
+
+#define NV_STORE_MAX_KEYS 16
+#define NV_STORE_MAX_VALUE 248
+
+/* Keys of the records kept in the store, below NV_STORE_MAX_KEYS. Never reuse a retired key */
+typedef enum {
+    NV_KEY_NONE = 0,
+    NV_KEY_LEOP_STATUS = 1,
+    NV_KEY_APP_SIGNATURE = 2,
+    NV_KEY_GOLDEN_SIGNATURE = 3,
+    NV_KEY_FW_UPDATE = 4,
+} nv_key;
+
+typedef struct {
+    uint32_t generation;  // times the store has been compacted, plus one
+    uint32_t used;        // bytes of the active area holding records
+    uint32_t writes;      // records written since boot
+    uint32_t compactions; // compactions since boot
+} nv_store_stats;
+
+bool nv_store_mount(void);
+
+bool nv_store_read(nv_key key, void *value, uint16_t size, uint16_t *length);
+
+bool nv_store_write(nv_key key, const void *value, uint16_t length);
+
+void nv_store_get_stats(nv_store_stats *stats);
+
+/*
+ * Flash backend. nv_flash.c drives bank 7 of the OBC, host tests supply a
+ * model of the bank with the same program and erase rules.
+ */
+
+const uint8_t *nv_flash_area(uint8_t area);
+
+bool nv_flash_erase(uint8_t area);
+
+bool nv_flash_program(uint8_t area, uint32_t offset, const void *data, uint32_t length);
+
+void nv_flash_lock(void);
+
+void nv_flash_unlock(void);
+
+#endif /* EX2_SYSTEM_INCLUDE_NV_STORE_NV_STORE_H_ */
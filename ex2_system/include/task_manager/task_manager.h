@@ -35,9 +35,13 @@ typedef struct taskFunctions {
     uint32_t (*getCounterFunction)(void);
 } taskFunctions;
 
+/* A task whose counter hasn't moved for this long is hung. Longer than any registered task's slowest loop */
+#define TASK_HUNG_TIMEOUT pdMS_TO_TICKS(3 * 60 * 1000)
+
 typedef struct {
     TaskHandle_t task;
     uint32_t prev_counter;
+    TickType_t last_progress; // tick the counter last changed
     taskFunctions funcs;
 } task_info;
 
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file task_stats.h
+ * @date Oct. 19, 2026
+ */
+
+#ifndef EX2_SYSTEM_INCLUDE_TASK_STATS_TASK_STATS_H_
+#define EX2_SYSTEM_INCLUDE_TASK_STATS_TASK_STATS_H_
+
+#include <FreeRTOS.h>
+#include <stdint.h>
+#include "system.h"
+
+/* Maximum number of tasks tracked. Must be at least the number of tasks alive at once */
+#define TASK_STATS_MAX_TASKS 40
+
+/* The daemon samples all tasks this often */
+#define TASK_STATS_SAMPLE_PERIOD_MS 5000
+
+/* Windows are expressed in samples. With a 5 second period these are 10 and 60 seconds */
+#define TASK_STATS_SHORT_WINDOW 2
+#define TASK_STATS_LONG_WINDOW 12
+
+#define TASK_STATS_STACK_SIZE 400
+
+/* CPU usage is reported in hundredths of a percent */
+#define TASK_STATS_CPU_SCALE 10000
+
+typedef struct __attribute__((packed)) {
+    char name[configMAX_TASK_NAME_LEN];
+    uint8_t priority;
+    uint16_t cpu_short;        // CPU usage over the short window, 0.01% units
+    uint16_t cpu_long;         // CPU usage over the long window, 0.01% units
+    uint16_t stack_hwm;        // Minimum free stack since creation, in words
+    uint32_t context_switches; // Times switched in over the long window
+    uint32_t max_latency_us;   // Worst ready-to-running delay over the long window
+} task_stats_entry_t;
+
+SAT_returnState start_task_stats_daemon(void);
+
+uint32_t task_stats_get(task_stats_entry_t *entries, uint32_t first, uint32_t max_entries);
+
+uint32_t task_stats_count(void);
+
+/*
+ * Kernel hooks. These are called from the FreeRTOS trace macros defined in FreeRTOSConfig.h
+ * with the scheduler locked and must not call any FreeRTOS API.
+ */
+UBaseType_t task_stats_on_create(void *task, UBaseType_t tcb_number);
+void task_stats_on_delete(void *task);
+void task_stats_on_ready(UBaseType_t slot);
+void task_stats_on_switched_in(UBaseType_t slot);
+void task_stats_on_switched_out(UBaseType_t slot);
+
+#endif /* EX2_SYSTEM_INCLUDE_TASK_STATS_TASK_STATS_H_ */
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file telemetry_store.h
+ * @date Oct. 19, 2026
+ */
+
+#ifndef EX2_SYSTEM_INCLUDE_TELEMETRY_TELEMETRY_STORE_H_
+#define EX2_SYSTEM_INCLUDE_TELEMETRY_TELEMETRY_STORE_H_
+
+#include <FreeRTOS.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "system.h"
+
+#include "adcs.h"
+#include "dfgm.h"
+#include "eps.h"
+#include "housekeeping_athena.h"
+#include "housekeeping_charon.h"
+#include "hyperion.h"
+#include "iris.h"
+#include "ns_payload.h"
+#include "sband.h"
+#include "uhf.h"
+
+/*
+ * One entry per subsystem housekeeping struct, as X(id, type). The store keeps
+ * the latest value of each, as written by the housekeeping collector.
+ */
+#define TELEMETRY_ENTRIES(X)                                                                                      \
+    X(TLM_ADCS, ADCS_HouseKeeping)                                                                                \
+    X(TLM_ATHENA, athena_housekeeping)                                                                            \
+    X(TLM_EPS, eps_instantaneous_telemetry_t)                                                                     \
+    X(TLM_EPS_STARTUP, eps_startup_telemetry_t)                                                                   \
+    X(TLM_UHF, UHF_housekeeping)                                                                                  \
+    X(TLM_SBAND, Sband_Housekeeping)                                                                              \
+    X(TLM_HYPERION, Hyperion_HouseKeeping)                                                                        \
+    X(TLM_CHARON, charon_housekeeping)                                                                            \
+    X(TLM_DFGM, DFGM_Housekeeping)                                                                                \
+    X(TLM_NS, ns_telemetry)                                                                                       \
+    X(TLM_IRIS, IRIS_Housekeeping)
+
+#define X(id, type) id,
+typedef enum { TELEMETRY_ENTRIES(X) TLM_COUNT } telemetry_id_t;
+#undef X
+
+/* Ground requests are answered from the store if the entry is younger than this */
+#define TELEMETRY_FRESH_TICKS pdMS_TO_TICKS(30 * 1000)
+
+typedef struct {
+    TickType_t updated; // tick count of the last write
+    uint32_t updates;   // writes since boot. 0 means the entry has never been written
+    bool valid;         // false if the last poll of the subsystem failed
+} telemetry_meta_t;
+
+void telemetry_store_init(void);
+
+void telemetry_write(telemetry_id_t id, const void *data, size_t size, bool valid);
+
+bool telemetry_read(telemetry_id_t id, void *data, size_t size, telemetry_meta_t *meta);
+
+bool telemetry_read_recent(telemetry_id_t id, void *data, size_t size, TickType_t max_age);
+
+TickType_t telemetry_age(const telemetry_meta_t *meta);
+
+#endif /* EX2_SYSTEM_INCLUDE_TELEMETRY_TELEMETRY_STORE_H_ */
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file trace_recorder.h
+ * @date Oct. 19, 2026
+ */
+
+#ifndef EX2_SYSTEM_INCLUDE_TRACE_TRACE_RECORDER_H_
+#define EX2_SYSTEM_INCLUDE_TRACE_TRACE_RECORDER_H_
+
+#include <FreeRTOS.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Size of the RAM ring in events. Must be a power of two */
+#define TRACE_BUFFER_EVENTS 2048
+
+#define TRACE_FILE "VOL0:/trace.bin"
+#define TRACE_OLD_FILE "VOL0:/trace.bin.old"
+
+/* trace.bin is moved to trace.bin.old before a flush would grow it past this size */
+#define TRACE_FILE_MAX_SIZE (128 * 1024)
+
+/* Number of queues that can be given a name in the trace file */
+#define TRACE_MAX_QUEUE_NAMES 16
+
+#define TRACE_MAGIC 0x45583254 // "EX2T"
+#define TRACE_FROZEN_MAGIC 0x46525A4E // "FRZN"
+#define TRACE_VERSION 1
+
+typedef enum {
+    TRACE_EVT_TASK_SWITCH = 1, // task switched in
+    TRACE_EVT_QUEUE_SEND,
+    TRACE_EVT_QUEUE_RECEIVE,
+    TRACE_EVT_QUEUE_BLOCK_SEND,    // task blocks because the queue is full
+    TRACE_EVT_QUEUE_BLOCK_RECEIVE, // task blocks because the queue is empty
+    TRACE_EVT_SEM_GIVE,
+    TRACE_EVT_SEM_TAKE,
+    TRACE_EVT_SEM_BLOCK, // task blocks on a semaphore or mutex
+    TRACE_EVT_QUEUE_SEND_ISR,
+    TRACE_EVT_QUEUE_RECEIVE_ISR,
+    TRACE_EVT_PRIORITY_INHERIT, // task is the mutex holder whose priority was raised
+    TRACE_EVT_PRIORITY_DISINHERIT,
+    TRACE_EVT_ISR, // object is the interrupt source, see TRACE_ISR_SOURCE
+    TRACE_EVT_MARK // user marker, object is caller defined
+} trace_event_type_t;
+
+/*
+ * Interrupt source ids, combined with the peripheral instance by TRACE_ISR_SOURCE.
+ * The instance is bits 8-15 of the peripheral base address, the GIO bit or the DMA channel
+ */
+typedef enum {
+    TRACE_ISR_SCI = 1,
+    TRACE_ISR_GIO,
+    TRACE_ISR_I2C,
+    TRACE_ISR_CAN,
+    TRACE_ISR_DMA,
+    TRACE_ISR_SPI,
+} trace_isr_t;
+
+#define TRACE_ISR_SOURCE(isr, instance) ((uint16_t)(((isr) << 8) | ((instance)&0xFF)))
+
+/*
+ * Everything in the trace file is big endian, as written by the OBC.
+ *
+ * A flush appends one chunk: a trace_chunk_header_t, task_names task name
+ * records, queue_names queue name records and then event_count events.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t timestamp; // PMU cycle counter, wraps every 2^32 / cpu_hz seconds
+    uint8_t type;       // trace_event_type_t
+    uint8_t task;       // task number (see task_stats) of the running task, 0 for unknown
+    uint16_t object;    // queue number or interrupt source
+} trace_event_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t task_names;
+    uint8_t queue_names;
+    uint32_t cpu_hz;
+    uint32_t uptime;      // seconds at the time of the flush
+    uint32_t event_count; // events in this chunk
+    uint32_t dropped;     // events overwritten before they could be flushed
+} trace_chunk_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t task;
+    char name[configMAX_TASK_NAME_LEN];
+} trace_task_name_t;
+
+typedef struct __attribute__((packed)) {
+    uint16_t object;
+    char name[configMAX_TASK_NAME_LEN];
+} trace_queue_name_t;
+
+void trace_init(void);
+
+void trace_enable(bool enable);
+
+bool trace_is_enabled(void);
+
+int32_t trace_flush(void);
+
+void trace_freeze(void);
+
+int32_t trace_flush_frozen(void);
+
+uint32_t trace_pending(void);
+
+uint32_t trace_dropped(void);
+
+void trace_mark(uint16_t id);
+
+void trace_isr(uint16_t source);
+
+/*
+ * Kernel hooks. These are called from the FreeRTOS trace macros defined in FreeRTOSConfig.h
+ * with interrupts masked and must not call any FreeRTOS API.
+ */
+void trace_record(uint8_t type, UBaseType_t object);
+void trace_on_task_create(UBaseType_t task_number, const char *name);
+void trace_on_switched_in(UBaseType_t task_number);
+UBaseType_t trace_on_queue_create(void);
+void trace_on_queue_registry_add(UBaseType_t object, const char *name);
+
+#endif /* EX2_SYSTEM_INCLUDE_TRACE_TRACE_RECORDER_H_ */
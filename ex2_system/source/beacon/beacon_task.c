@@ -25,7 +25,7 @@
 #define BEACON_FREQ_DELAY pdMS_TO_TICKS(30 * 1000) // pdMS_TO_TICKS(1000) converts 1000 ms to number of ticks
 #define BEACON_UPDATE_DELAY pdMS_TO_TICKS(3 * 1000)
 
-static void *beacon_daemon(All_systems_housekeeping *all_hk_data);
+static void *beacon_daemon(void *pvParameters);
 SAT_returnState start_beacon_daemon();
 
 /**
@@ -34,7 +34,9 @@ SAT_returnState start_beacon_daemon();
  * @param pvParameters
  *    task parameters (not used)
  */
-static void *beacon_daemon(All_systems_housekeeping *all_hk_data) {
+static void *beacon_daemon(void *pvParameters) {
+    // Static to keep the copy of every subsystem's housekeeping off the task stack
+    static All_systems_housekeeping all_hk_data;
 
     for (;;) {
         int8_t uhf_status = -1;
@@ -47,6 +49,8 @@ static void *beacon_daemon(All_systems_housekeeping *all_hk_data) {
                                                1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
                                                1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1};
 
+        // Read the latest values from the telemetry store, so the beacon never waits on a subsystem
+        get_latest_hk(&all_hk_data);
         update_beacon(&all_hk_data, &beacon_packet_one, &beacon_packet_two);
 
         // Send first beacon packet
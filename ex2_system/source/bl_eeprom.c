@@ -11,8 +11,7 @@
 #include "flash_defines.h"
 #include "F021.h"
 #include "eeprom.h"
-
-unsigned short crc16();
+#include "image_verify/image_verify.h"
 
 // @param reboot_type: if 0, preserve boot type
 void sw_reset(char reboot_type, SW_RESET_REASON reason) {
@@ -75,45 +74,9 @@ Fapi_StatusType eeprom_get_update_info(update_info *u) {
 }
 
 bool verify_application() {
-    image_info app_info = {0};
-    eeprom_get_app_info(&app_info);
-    if (app_info.exists == EXISTS_FLAG) {
-        if (crc16((char *)app_info.addr, app_info.size) == app_info.crc) {
-            return true;
-        } else return false;
-    } else return false;
+    return image_verify(IMAGE_APPLICATION) == IMAGE_VALID;
 }
 
 bool verify_golden() {
-    image_info app_info = {0};
-    eeprom_get_golden_info(&app_info);
-    if (app_info.exists == EXISTS_FLAG) {
-        if (crc16((char *)app_info.addr, app_info.size) == app_info.crc) {
-            return true;
-        } else return false;
-    } else return false;
-}
-
-unsigned short crc16( char *ptr, int count)
-{
-   uint16_t crc;
-   char i;
-   crc = 0;
-   while (--count >= 0)
-   {
-      crc = crc ^  ( ((int)*ptr)  << 8  ) ;
-      ptr=ptr+1;
-      i = 8;
-      do
-      {
-         if (crc & 0x8000)
-            crc = (crc << 1) ^ 0x1021;
-         else
-            crc = crc << 1;
-      } while(--i);
-   }
-   return (crc);
+    return image_verify(IMAGE_GOLDEN) == IMAGE_VALID;
 }
-
-
-
@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file calibration.c
+ * @date Oct. 19, 2026
+ *
+ * Raw to engineering unit conversion for the housekeeping sensors.
+ *
+ * Linear sensors are a fixed point multiply and add, with the constants
+ * folded at compile time from each driver's scale and offset macros.
+ * Nonlinear sensors use a table sampled at evenly spaced raw values, so a
+ * conversion is one shift to find the segment and one interpolation instead
+ * of a search through the datasheet breakpoints.
+ */
+
+#include "calibration/calibration.h"
+
+#include "common_defines.h"
+#include "dfgm_handler.h"
+
+#define LINEAR(shift, bits, scale, offset)                                                                        \
+    { CALIBRATION_LINEAR, shift, bits, CALIBRATION_FIXED(scale), CALIBRATION_FIXED(offset), 0, 0, NULL }
+
+#define TABLE(step_shift, table)                                                                                  \
+    { CALIBRATION_TABLE, 0, 0, 0, 0, step_shift, sizeof(table) / sizeof((table)[0]), table }
+
+#define AD7291_MV_PER_COUNT (ADC_VREF * 1000.0 / 4096.0)
+
+/*
+ * LMT70 temperature in hundredths of a degree at every 64th AD7291 count,
+ * 2.5 V reference. Generated from the breakpoints previously in
+ * adc_calculate_sensor_temp(), 100 mV at -40 C to 2017.5 mV at 150 C, and
+ * 10 mV per degree past either end. Interpolating between entries is within
+ * 0.1 C of the breakpoint curve.
+ */
+static const int32_t lmt70_table[] = {
+    -5000, -4609, -4219, -3828, -3438, -3047, -2656, -2266, -1875, -1484, -1094, -703,  -312,
+    78,    469,   859,   1250,  1641,  2031,  2422,  2812,  3203,  3594,  3984,  4375,  4766,
+    5156,  5547,  5938,  6328,  6719,  7109,  7500,  7891,  8281,  8672,  9062,  9453,  9844,
+    10232, 10619, 11006, 11392, 11779, 12166, 12550, 12919, 13287, 13656, 14024, 14393, 14761,
+    15138, 15528, 15919, 16309, 16700, 17091, 17481, 17872, 18262, 18653, 19044, 19434, 19825};
+
+const calibration_t cal_ad7291_mv = LINEAR(0, 0, AD7291_MV_PER_COUNT, 0);
+const calibration_t cal_lmt70_centi_c = TABLE(6, lmt70_table);
+const calibration_t cal_hyperion_mv =
+    LINEAR(0, 0, AD7291_MV_PER_COUNT * (VOLT_MAX - VOLT_MIN) / (ADC_VOLT_MAX - ADC_VOLT_MIN), 0);
+const calibration_t cal_hyperion_ma =
+    LINEAR(0, 0, AD7291_MV_PER_COUNT * (CURR_MAX - CURR_MIN) / (ADC_VOLT_MAX - ADC_VOLT_MIN), 0);
+const calibration_t cal_hyperion_pd = LINEAR(0, 0, AD7291_MV_PER_COUNT / PD_MAX_VOLTAGE / 1000 * 100, 0);
+const calibration_t cal_ad7291_tsense_centi_c = LINEAR(0, 12, 25, 0);
+
+const calibration_t cal_temp12_ten_thousandth_c = LINEAR(4, 12, 625, 0);
+
+const calibration_t cal_ina226_bus_mv = LINEAR(0, 0, 1.25, 0);
+const calibration_t cal_ina226_shunt_uv = LINEAR(0, 16, 2.5, 0);
+
+const calibration_t cal_dfgm_hk[CALIBRATION_DFGM_HK_COUNT] = {
+    LINEAR(0, 0, HK_SCALE_0, HK_OFFSET_0),   LINEAR(0, 0, HK_SCALE_1, HK_OFFSET_1),
+    LINEAR(0, 0, HK_SCALE_2, HK_OFFSET_2),   LINEAR(0, 0, HK_SCALE_3, HK_OFFSET_3),
+    LINEAR(0, 0, HK_SCALE_4, HK_OFFSET_4),   LINEAR(0, 0, HK_SCALE_5, HK_OFFSET_5),
+    LINEAR(0, 0, HK_SCALE_6, HK_OFFSET_6),   LINEAR(0, 0, HK_SCALE_7, HK_OFFSET_7),
+    LINEAR(0, 0, HK_SCALE_8, HK_OFFSET_8),   LINEAR(0, 0, HK_SCALE_9, HK_OFFSET_9),
+    LINEAR(0, 0, HK_SCALE_10, HK_OFFSET_10), LINEAR(0, 0, HK_SCALE_11, HK_OFFSET_11)};
+
+static int32_t raw_value(const calibration_t *cal, uint16_t raw) {
+    int32_t value = raw >> cal->raw_shift;
+    if (cal->raw_bits != 0) {
+        int32_t sign = 1L << (cal->raw_bits - 1);
+        value &= (sign << 1) - 1;
+        value = (value ^ sign) - sign;
+    }
+    return value;
+}
+
+static int32_t convert_value(const calibration_t *cal, int32_t value) {
+    if (cal->kind == CALIBRATION_LINEAR) {
+        int64_t scaled = (int64_t)value * cal->scale + cal->offset;
+        return (int32_t)(scaled >> CALIBRATION_Q);
+    }
+
+    // Values past either end extrapolate along the first or last segment
+    int32_t index = value >> cal->step_shift;
+    if (index < 0) {
+        index = 0;
+    } else if (index > cal->entries - 2) {
+        index = cal->entries - 2;
+    }
+    int32_t offset = value - (index << cal->step_shift);
+    int32_t low = cal->table[index];
+    int32_t high = cal->table[index + 1];
+    return low + (int32_t)(((int64_t)(high - low) * offset) / (1L << cal->step_shift));
+}
+
+/**
+ * @brief
+ *      Convert one raw sensor reading to engineering units
+ * @param cal
+ *      Calibration of the sensor, which also gives the output unit
+ * @param raw
+ *      Register or ADC value as read from the sensor
+ * @return
+ *      The converted value
+ */
+int32_t calibration_convert(const calibration_t *cal, uint16_t raw) {
+    return convert_value(cal, raw_value(cal, raw));
+}
+
+/**
+ * @brief
+ *      Convert n readings of the same sensor type
+ * @param raw
+ *      Raw readings
+ * @param out
+ *      Converted values, may not overlap raw
+ * @param n
+ *      Number of readings
+ */
+void calibration_convert_n(const calibration_t *cal, const uint16_t *raw, int32_t *out, size_t n) {
+    size_t i;
+    for (i = 0; i < n; i++) {
+        out[i] = convert_value(cal, raw_value(cal, raw[i]));
+    }
+}
@@ -15,12 +15,22 @@
  * @file diagnosic.c
  * @author Andrew R. Rooney
  * @date Mar. 6, 2021
+ *
+ * Health monitor for the subsystems that can be power cycled.
+ *
+ * Each subsystem is described by an entry in a table: how to probe it, how
+ * to tell it is powered, and the steps that power cycle it. A one-shot
+ * software timer per subsystem wakes a single monitor task, which takes one
+ * step of that subsystem's check and arms the timer for the next one. No
+ * step waits in the task, so power cycles of different subsystems overlap.
  */
 #include "diagnostic/diagnostic.h"
 
 #include <FreeRTOS.h>
-#include <os_task.h>
+#include <os_queue.h>
 #include <os_semphr.h>
+#include <os_task.h>
+#include <os_timer.h>
 #include "HL_gio.h"
 #include "uhf.h"
 #include "sband.h"
@@ -33,501 +43,406 @@
 #include "adcs.h"
 #include "logger/logger.h"
 #include "ns_payload.h"
+#include "task_manager/task_manager.h"
+#include <string.h>
 
-static void uhf_watchdog_daemon(void *pvParameters);
-static void sband_watchdog_daemon(void *pvParameters);
-static void charon_watchdog_daemon(void *pvParameters);
-static void adcs_watchdog_daemon(void *pvParameters);
-static void ns_watchdog_daemon(void *pvParameters);
 SAT_returnState start_diagnostic_daemon(void);
 
 const unsigned int mutex_timeout = pdMS_TO_TICKS(100);
-const unsigned int reset_wait_period = 5 * ONE_SECOND; // 5 seconds
+#define RESET_WAIT_PERIOD (5 * ONE_SECOND)
 const unsigned int watchdog_retries = 3;
 
-static TickType_t uhf_prv_watchdog_delay = ONE_MINUTE;
-static TickType_t sband_prv_watchdog_delay = ONE_MINUTE;
-static TickType_t charon_prv_watchdog_delay = ONE_MINUTE;
-static TickType_t adcs_prv_watchdog_delay = ONE_MINUTE;
-static TickType_t ns_prv_watchdog_delay = ONE_MINUTE;
-
-static SemaphoreHandle_t uhf_watchdog_mtx = NULL;
-static SemaphoreHandle_t sband_watchdog_mtx = NULL;
-static SemaphoreHandle_t charon_watchdog_mtx = NULL;
-static SemaphoreHandle_t adcs_watchdog_mtx = NULL;
-static SemaphoreHandle_t ns_watchdog_mtx = NULL;
-
-#if UHF_IS_STUBBED == 0
-/**
- * @brief Check that the UHF is responsive. If not, toggle power.
- *
- * @param pvParameters Task parameters (not used)
- */
-static void uhf_watchdog_daemon(void *pvParameters) {
-    for (;;) {
-        TickType_t delay = get_uhf_watchdog_delay();
-        if (eps_get_pwr_chnl(UHF_5V0_PWR_CHNL) == 0) {
-            ex2_log("UHF not on - power not toggled");
-            vTaskDelay(delay);
-            continue;
-        }
-        UHF_return err;
-        for (int i = 0; i < watchdog_retries; i++) {
-            err = UHF_refresh_state();
-            if (err == U_GOOD_CONFIG) {
-                break;
-            } else if (err == U_IN_PIPE) {
-                break;
-            }
-            vTaskDelay(2 * ONE_SECOND);
-        }
-
-        if (err == U_IN_PIPE) {
-            ex2_log("UHF in PIPE Mode - power not toggled.");
-        } else if (err != U_GOOD_CONFIG) {
-            ex2_log("UHF was not responsive - attempting to toggle power.");
-
-            // Turn off the UHF.
-            eps_set_pwr_chnl(UHF_5V0_PWR_CHNL, OFF);
-
-            // Allow the system to fully power off
-            vTaskDelay(reset_wait_period);
-
-            // Check that the UHF has been turned off.
-            if (eps_get_pwr_chnl(UHF_5V0_PWR_CHNL) != OFF) {
-                ex2_log("UHF failed to power off.");
-                vTaskDelay(delay);
-                continue;
-            }
-
-            // Turn the UHF back on.
-            eps_set_pwr_chnl(UHF_5V0_PWR_CHNL, ON);
-
-            // Allow the system to fully power on
-            vTaskDelay(reset_wait_period);
-
-            // Check that the UHF has been turned on
-            if (eps_get_pwr_chnl(UHF_5V0_PWR_CHNL) != ON) {
-                ex2_log("UHF failed to power on.");
-            } else {
-                ex2_log("UHF powered back on.");
-            }
+typedef struct health_subsystem health_subsystem_t;
+
+typedef enum { HEALTH_RESPONSIVE, HEALTH_UNRESPONSIVE, HEALTH_LEAVE } health_probe_result;
+
+/* One step of a power cycle. The check, if any, is made once the wait is over */
+typedef struct {
+    void (*action)(const health_subsystem_t *subsystem);
+    bool (*check)(const health_subsystem_t *subsystem);
+    const char *what; // logged as "<name> failed to <what>." when the check fails
+    TickType_t wait;
+} health_step_t;
+
+struct health_subsystem {
+    health_subsystem_id id;
+    const char *name;
+    health_probe_result (*probe)(void);
+    bool (*powered)(const health_subsystem_t *subsystem);
+    uint8_t channels[2]; // EPS power channels switched by the generic power steps
+    uint8_t channel_count;
+    TickType_t retry_delay; // between probes of an unresponsive subsystem
+    const health_step_t *cycle;
+    uint8_t cycle_length;
+};
+
+typedef enum { HEALTH_WAITING, HEALTH_PROBING, HEALTH_CYCLING } health_phase;
+
+typedef struct {
+    TimerHandle_t timer;
+    TickType_t period;
+    health_phase phase;
+    uint8_t attempt; // failed probes in a row
+    uint8_t step;    // step of the power cycle being waited on
+    health_stats_t stats;
+} health_state_t;
+
+/* Generic steps for subsystems powered from EPS channels */
+
+static bool channels_are(const health_subsystem_t *subsystem, uint8_t state) {
+    uint8_t i;
+    for (i = 0; i < subsystem->channel_count; i++) {
+        if (eps_get_pwr_chnl(subsystem->channels[i]) != state) {
+            return false;
         }
+    }
+    return true;
+}
 
-        if (xSemaphoreTake(uhf_watchdog_mtx, mutex_timeout) == pdPASS) {
-            delay = uhf_prv_watchdog_delay;
-            xSemaphoreGive(uhf_watchdog_mtx);
+static bool any_channel_on(const health_subsystem_t *subsystem) {
+    uint8_t i;
+    for (i = 0; i < subsystem->channel_count; i++) {
+        if (eps_get_pwr_chnl(subsystem->channels[i]) != 0) {
+            return true;
         }
-        vTaskDelay(delay);
     }
+    return false;
 }
-#endif
 
-#if SBAND_IS_STUBBED == 0
-/**
- * @brief Check that the SBAND is responsive. If not, toggle power.
- *
- * @param pvParameters Task parameters (not used)
- */
-static void sband_watchdog_daemon(void *pvParameters) {
-    for (;;) {
-        TickType_t delay = get_sband_watchdog_delay();
-        if (gioGetBit(hetPORT2, 23) == 0) {
-            ex2_log("SBAND not enabled - power not toggled");
-            vTaskDelay(delay);
-            continue;
-        }
-        // Get SBAND control values
-        uint16_t SBAND_version = 0;
-        STX_return err;
-        for (int i = 0; i < watchdog_retries; i++) {
-            STX_getFirmwareV(&SBAND_version);
-            if (SBAND_version != 0)
-                break;
-            vTaskDelay(2 * ONE_SECOND);
-        }
-        if (SBAND_version == 0) {
-            // TODO: Currently no way for power toggling to return fail
-            ex2_log("SBAND was not responsive - attempting to toggle power.");
+static void channels_off(const health_subsystem_t *subsystem) {
+    uint8_t i;
+    for (i = 0; i < subsystem->channel_count; i++) {
+        eps_set_pwr_chnl(subsystem->channels[i], OFF);
+    }
+}
 
-            // Reset the SBAND by toggling the reset pin
-            gioSetBit(hetPORT2, 21, 0); // Het2 21 is the S-band nRESET pin
-            vTaskDelay(2 * ONE_SECOND);
-            gioSetBit(hetPORT2, 21, 1); // Het2 21 is the S-band nRESET pin
-            vTaskDelay(2 * ONE_SECOND);
+static void channels_on(const health_subsystem_t *subsystem) {
+    uint8_t i;
+    for (i = 0; i < subsystem->channel_count; i++) {
+        eps_set_pwr_chnl(subsystem->channels[i], ON);
+    }
+}
 
-            // Disable the SBAND
-            STX_Disable();
-            vTaskDelay(10 * ONE_SECOND);
+static bool channels_are_off(const health_subsystem_t *subsystem) { return channels_are(subsystem, OFF); }
 
-            // Enable the S-band
-            STX_Enable();
-            vTaskDelay(ONE_SECOND);
+static bool channels_are_on(const health_subsystem_t *subsystem) { return channels_are(subsystem, ON); }
 
-            ex2_log("SBAND power toggled");
-        }
+static const health_step_t power_cycle[] = {
+    {channels_off, channels_are_off, "power off", RESET_WAIT_PERIOD}, // Allow the system to fully power off
+    {channels_on, channels_are_on, "power on", RESET_WAIT_PERIOD},    // Allow the system to fully power on
+};
 
-        if (xSemaphoreTake(sband_watchdog_mtx, mutex_timeout) == pdPASS) {
-            delay = sband_prv_watchdog_delay;
-            xSemaphoreGive(sband_watchdog_mtx);
-        }
-        vTaskDelay(delay);
+#if UHF_IS_STUBBED == 0
+static health_probe_result uhf_probe(void) {
+    UHF_return err = UHF_refresh_state();
+    if (err == U_IN_PIPE) {
+        ex2_log("UHF in PIPE Mode - power not toggled.");
+        return HEALTH_LEAVE;
     }
+    return err == U_GOOD_CONFIG ? HEALTH_RESPONSIVE : HEALTH_UNRESPONSIVE;
 }
 #endif
 
-#if CHARON_IS_STUBBED == 0 && IS_EXALTA2 == 1
-/**
- * @brief Check that Charon is responsive. If not, toggle power.
- *
- * @param pvParameters Task parameters (not used)
- */
-
-static void charon_watchdog_daemon(void *pvParameters) {
-    for (;;) {
-        TickType_t delay = get_charon_watchdog_delay();
-        if (eps_get_pwr_chnl(CHARON_3V3_PWR_CHNL) == 0) {
-            ex2_log("Charon not on - power not toggled");
-            vTaskDelay(delay);
-            continue;
-        }
-
-        // Get Charon gps firmware version
-        uint32_t version = NULL;
-        GPS_RETURNSTATE err;
-        for (int i = 0; i < watchdog_retries; i++) {
-            err = gps_skytraq_get_software_version(&version);
-            if (err == GPS_SUCCESS)
-                break;
-            vTaskDelay(2 * ONE_SECOND);
-        }
-
-        if ((err != GPS_SUCCESS) || (version == NULL)) {
-            ex2_log("Charon was not responsive - attempting to toggle power.");
+#if SBAND_IS_STUBBED == 0
+static health_probe_result sband_probe(void) {
+    uint16_t SBAND_version = 0;
+    STX_getFirmwareV(&SBAND_version);
+    return SBAND_version != 0 ? HEALTH_RESPONSIVE : HEALTH_UNRESPONSIVE;
+}
 
-            // Turn Charon off
-            eps_set_pwr_chnl(CHARON_3V3_PWR_CHNL, OFF);
+static bool sband_enabled(const health_subsystem_t *subsystem) { return gioGetBit(hetPORT2, 23) != 0; }
 
-            // Allow the system to fully power off
-            vTaskDelay(reset_wait_period);
+// Het2 21 is the S-band nRESET pin
+static void sband_reset_low(const health_subsystem_t *subsystem) { gioSetBit(hetPORT2, 21, 0); }
 
-            // Check that Charon has been turned off.
-            if (eps_get_pwr_chnl(CHARON_3V3_PWR_CHNL) != OFF) {
-                ex2_log("Charon failed to power off.");
-                vTaskDelay(delay);
-                continue;
-            }
+static void sband_reset_high(const health_subsystem_t *subsystem) { gioSetBit(hetPORT2, 21, 1); }
 
-            // Turn Charon back on.
-            eps_set_pwr_chnl(CHARON_3V3_PWR_CHNL, ON);
+static void sband_disable(const health_subsystem_t *subsystem) { STX_Disable(); }
 
-            // Allow the system to fully power on
-            vTaskDelay(reset_wait_period);
+static void sband_enable(const health_subsystem_t *subsystem) { STX_Enable(); }
 
-            // Check that Charon has been turned on
-            if (eps_get_pwr_chnl(CHARON_3V3_PWR_CHNL) != ON) {
-                ex2_log("Charon failed to power on.");
-            } else {
-                ex2_log("Charon powered back on.");
-            }
-        }
+// TODO: Currently no way for power toggling to return fail
+static const health_step_t sband_cycle[] = {
+    {sband_reset_low, NULL, "reset", 2 * ONE_SECOND},
+    {sband_reset_high, NULL, "reset", 2 * ONE_SECOND},
+    {sband_disable, NULL, "disable", 10 * ONE_SECOND},
+    {sband_enable, NULL, "enable", ONE_SECOND},
+};
+#endif
 
-        if (xSemaphoreTake(charon_watchdog_mtx, mutex_timeout) == pdPASS) {
-            delay = charon_prv_watchdog_delay;
-            xSemaphoreGive(charon_watchdog_mtx);
-        }
-        vTaskDelay(delay);
-    }
+#if CHARON_IS_STUBBED == 0 && IS_EXALTA2 == 1
+static health_probe_result charon_probe(void) {
+    uint32_t version = 0;
+    GPS_RETURNSTATE err = gps_skytraq_get_software_version(&version);
+    return (err == GPS_SUCCESS && version != 0) ? HEALTH_RESPONSIVE : HEALTH_UNRESPONSIVE;
 }
 #endif
 
 #if ADCS_IS_STUBBED == 0
-/**
- * @brief Check that the ADCS is responsive. If not, toggle power.
- *
- * @param pvParameters Task parameters (not used)
- */
-
-static void adcs_watchdog_daemon(void *pvParameters) {
-    for (;;) {
-        TickType_t delay = get_adcs_watchdog_delay();
-
-        if (eps_get_pwr_chnl(ADCS_3V3_PWR_CHNL) == 0) {
-            ex2_log("ADCS not on - power not toggled");
-            vTaskDelay(delay);
-            continue;
-        }
-
-        ADCS_boot_program_stat test_stat;
-
-        ADCS_returnState err;
-        for (int i = 0; i < watchdog_retries; i++) {
-            err =
-                HAL_ADCS_get_boot_program_stat(&test_stat); // Chosen bc the ADCS will respond in boot and app mode
-            if (err == ADCS_OK)
-                break;
-            vTaskDelay(2 * ONE_SECOND);
-        }
-
-        if ((err != ADCS_OK) && (err != ADCS_UART_BUSY)) {
-            ex2_log("ADCS was not responsive - attempting to toggle power.");
-
-            // Turn the ADCS off
-            eps_set_pwr_chnl(ADCS_3V3_PWR_CHNL, OFF);
-            eps_set_pwr_chnl(ADCS_5V0_PWR_CHNL, OFF);
-
-            // Allow the system to fully power off
-            vTaskDelay(reset_wait_period);
-
-            // Check that the ADCS has been turned off.
-            if ((eps_get_pwr_chnl(ADCS_3V3_PWR_CHNL) != OFF) || (eps_get_pwr_chnl(ADCS_5V0_PWR_CHNL) != OFF)) {
-                ex2_log("ADCS failed to power off.");
-                vTaskDelay(delay);
-                continue;
-            }
-
-            // Turn the ADCS back on.
-            eps_set_pwr_chnl(ADCS_3V3_PWR_CHNL, ON);
-            eps_set_pwr_chnl(ADCS_5V0_PWR_CHNL, ON);
-
-            // Allow the system to fully power on
-            vTaskDelay(reset_wait_period);
-
-            // Check that the ADCS has been turned on
-            if ((eps_get_pwr_chnl(ADCS_3V3_PWR_CHNL) != ON) && (eps_get_pwr_chnl(ADCS_5V0_PWR_CHNL) != ON)) {
-                ex2_log("ADCS failed to power on.");
-            } else {
-                ex2_log("ADCS powered back on.");
-            }
-        }
-
-        if (xSemaphoreTake(adcs_watchdog_mtx, mutex_timeout) == pdPASS) {
-            delay = adcs_prv_watchdog_delay;
-            xSemaphoreGive(adcs_watchdog_mtx);
-        }
-        vTaskDelay(delay);
+static health_probe_result adcs_probe(void) {
+    ADCS_boot_program_stat test_stat;
+    // Chosen bc the ADCS will respond in boot and app mode
+    ADCS_returnState err = HAL_ADCS_get_boot_program_stat(&test_stat);
+    if (err == ADCS_UART_BUSY) {
+        return HEALTH_LEAVE;
     }
+    return err == ADCS_OK ? HEALTH_RESPONSIVE : HEALTH_UNRESPONSIVE;
 }
 #endif
 
-#if PAYLOAD_IS_STUBBED == 0
-#if IS_EXALTA2 == 1
-// Iris watchdog
+#if PAYLOAD_IS_STUBBED == 0 && IS_EXALTA2 == 0
+static health_probe_result ns_probe(void) {
+    uint8_t heartbeat;
+    return HAL_NS_get_heartbeat(&heartbeat) == NS_OK ? HEALTH_RESPONSIVE : HEALTH_UNRESPONSIVE;
+}
 #endif
-/**
- * @brief Check that the northern spirit payload is responsive. If not, toggle power.
- *
- * @param pvParameters Task parameters (not used)
- */
 
-static void ns_watchdog_daemon(void *pvParameters) {
-    for (;;) {
-        TickType_t delay = get_ns_watchdog_delay();
+#define POWER_CYCLE power_cycle, sizeof(power_cycle) / sizeof(power_cycle[0])
 
-        if ((eps_get_pwr_chnl(PYLD_5V0_PWR_CHNL) == 0) && (eps_get_pwr_chnl(PYLD_3V3_PWR_CHNL) == 0)) {
-            ex2_log("NS not on - power not toggled");
-            vTaskDelay(delay);
-            continue;
-        }
+/* Subsystems to watch, ending with an entry without a name */
+static const health_subsystem_t subsystems[] = {
+#if UHF_IS_STUBBED == 0
+    {HEALTH_UHF, "UHF", uhf_probe, any_channel_on, {UHF_5V0_PWR_CHNL}, 1, 2 * ONE_SECOND, POWER_CYCLE},
+#endif
+#if SBAND_IS_STUBBED == 0
+    {HEALTH_SBAND, "SBAND", sband_probe, sband_enabled, {0}, 0, 2 * ONE_SECOND, sband_cycle,
+     sizeof(sband_cycle) / sizeof(sband_cycle[0])},
+#endif
+#if CHARON_IS_STUBBED == 0 && IS_EXALTA2 == 1
+    {HEALTH_CHARON, "Charon", charon_probe, any_channel_on, {CHARON_3V3_PWR_CHNL}, 1, 2 * ONE_SECOND, POWER_CYCLE},
+#endif
+#if ADCS_IS_STUBBED == 0
+    {HEALTH_ADCS, "ADCS", adcs_probe, any_channel_on, {ADCS_3V3_PWR_CHNL, ADCS_5V0_PWR_CHNL}, 2, 2 * ONE_SECOND,
+     POWER_CYCLE},
+#endif
+#if PAYLOAD_IS_STUBBED == 0 && IS_EXALTA2 == 0
+    {HEALTH_NS, "NS payload", ns_probe, any_channel_on, {PYLD_3V3_PWR_CHNL, PYLD_5V0_PWR_CHNL}, 2, 10 * ONE_SECOND,
+     POWER_CYCLE},
+#endif
+    {HEALTH_SUBSYSTEM_COUNT, NULL},
+};
 
-        NS_return err;
-        uint8_t heartbeat;
-        for (int i = 0; i < watchdog_retries; i++) {
-            err = HAL_NS_get_heartbeat(&heartbeat);
-            if (err == NS_OK)
-                break;
-            vTaskDelay(10 * ONE_SECOND);
-        }
+#define SUBSYSTEM_COUNT (sizeof(subsystems) / sizeof(subsystems[0]) - 1)
 
-        if (err != NS_OK) {
-            ex2_log("NS payload was not responsive - attempting to toggle power.");
+static health_state_t state[sizeof(subsystems) / sizeof(subsystems[0])];
+static SemaphoreHandle_t health_lock = NULL; // guards period and stats
+static QueueHandle_t health_queue = NULL;   // index of each subsystem whose timer expired
 
-            // Turn the NS payload off
-            eps_set_pwr_chnl(PYLD_3V3_PWR_CHNL, OFF);
-            eps_set_pwr_chnl(PYLD_5V0_PWR_CHNL, OFF);
+static uint32_t health_wdt_counter = 0;
 
-            // Allow the system to fully power off
-            vTaskDelay(reset_wait_period);
+static uint32_t get_health_wdt_counter() { return health_wdt_counter; }
 
-            // Check that the NS payload has been turned off.
-            if ((eps_get_pwr_chnl(PYLD_3V3_PWR_CHNL) != OFF) || (eps_get_pwr_chnl(PYLD_5V0_PWR_CHNL) != OFF)) {
-                ex2_log("NS payload failed to power off.");
-                vTaskDelay(delay);
-                continue;
-            }
+static int8_t find_subsystem(health_subsystem_id id) {
+    uint8_t i;
+    for (i = 0; i < SUBSYSTEM_COUNT; i++) {
+        if (subsystems[i].id == id) {
+            return i;
+        }
+    }
+    return -1;
+}
 
-            // Turn the NS payload back on.
-            eps_set_pwr_chnl(PYLD_3V3_PWR_CHNL, ON);
-            eps_set_pwr_chnl(PYLD_5V0_PWR_CHNL, ON);
+static void health_timer_expired(TimerHandle_t timer) {
+    uint8_t index = (uint8_t)(uint32_t)pvTimerGetTimerID(timer);
+    xQueueSend(health_queue, &index, 0);
+}
 
-            // Allow the system to fully power on
-            vTaskDelay(reset_wait_period);
+static void arm(uint8_t index, TickType_t delay) {
+    if (xTimerChangePeriod(state[index].timer, delay, ONE_SECOND) != pdPASS) {
+        ex2_log("Failed to arm %s health timer", subsystems[index].name);
+    }
+}
 
-            // Check that the NS payload has been turned on
-            if ((eps_get_pwr_chnl(PYLD_3V3_PWR_CHNL) != ON) && (eps_get_pwr_chnl(PYLD_5V0_PWR_CHNL) != ON)) {
-                ex2_log("NS payload failed to power on.");
-            } else {
-                ex2_log("NS payload powered back on.");
-            }
-        }
+static void wait_period(uint8_t index) {
+    health_state_t *s = &state[index];
+    TickType_t period = ONE_MINUTE;
 
-        if (xSemaphoreTake(ns_watchdog_mtx, mutex_timeout) == pdPASS) {
-            delay = ns_prv_watchdog_delay;
-            xSemaphoreGive(ns_watchdog_mtx);
-        }
-        vTaskDelay(delay);
+    if (xSemaphoreTake(health_lock, mutex_timeout) == pdPASS) {
+        period = s->period;
+        xSemaphoreGive(health_lock);
     }
+    s->phase = HEALTH_WAITING;
+    s->attempt = 0;
+    arm(index, period);
 }
-#endif
 
-TickType_t get_uhf_watchdog_delay(void) {
-#if UHF_IS_STUBBED == 1
-    return STUBBED_WATCHDOG_DELAY;
-#else
-    if (xSemaphoreTake(uhf_watchdog_mtx, mutex_timeout) == pdPASS) {
-        TickType_t delay = uhf_prv_watchdog_delay;
-        xSemaphoreGive(uhf_watchdog_mtx);
-        return delay;
-    } else {
-        return 0;
+static void count(uint32_t *counter) {
+    if (xSemaphoreTake(health_lock, mutex_timeout) == pdPASS) {
+        (*counter)++;
+        xSemaphoreGive(health_lock);
     }
-#endif
 }
 
-TickType_t get_sband_watchdog_delay(void) {
-#if SBAND_IS_STUBBED == 1
-    return STUBBED_WATCHDOG_DELAY;
-#else
-    if (xSemaphoreTake(sband_watchdog_mtx, mutex_timeout) == pdPASS) {
-        TickType_t delay = sband_prv_watchdog_delay;
-        xSemaphoreGive(sband_watchdog_mtx);
-        return delay;
-    } else {
-        return 0;
-    }
-#endif
+static void start_step(uint8_t index) {
+    const health_step_t *step = &subsystems[index].cycle[state[index].step];
+    step->action(&subsystems[index]);
+    arm(index, step->wait);
 }
 
-TickType_t get_charon_watchdog_delay(void) {
-#if CHARON_IS_STUBBED == 1
-    return STUBBED_WATCHDOG_DELAY;
-#else
-    if (xSemaphoreTake(charon_watchdog_mtx, mutex_timeout) == pdPASS) {
-        TickType_t delay = charon_prv_watchdog_delay;
-        xSemaphoreGive(charon_watchdog_mtx);
-        return delay;
-    } else {
-        return 0;
+/* Take the next step for a subsystem whose timer expired. Never blocks on a delay */
+static void health_step(uint8_t index) {
+    const health_subsystem_t *subsystem = &subsystems[index];
+    health_state_t *s = &state[index];
+
+    if (s->phase == HEALTH_CYCLING) {
+        const health_step_t *step = &subsystem->cycle[s->step];
+        if (step->check != NULL && !step->check(subsystem)) {
+            ex2_log("%s failed to %s.", subsystem->name, step->what);
+            count(&s->stats.failed_cycles);
+            wait_period(index);
+            return;
+        }
+        if (++s->step < subsystem->cycle_length) {
+            start_step(index);
+            return;
+        }
+        ex2_log("%s power toggled.", subsystem->name);
+        wait_period(index);
+        return;
     }
-#endif
+
+    if (!subsystem->powered(subsystem)) {
+        ex2_log("%s not on - power not toggled", subsystem->name);
+        wait_period(index);
+        return;
+    }
+    count(&s->stats.probes);
+    health_probe_result result = subsystem->probe();
+    if (result != HEALTH_UNRESPONSIVE) {
+        wait_period(index);
+        return;
+    }
+    count(&s->stats.failed_probes);
+    if (++s->attempt < watchdog_retries) {
+        s->phase = HEALTH_PROBING;
+        arm(index, subsystem->retry_delay);
+        return;
+    }
+
+    ex2_log("%s was not responsive - attempting to toggle power.", subsystem->name);
+    count(&s->stats.power_cycles);
+    s->phase = HEALTH_CYCLING;
+    s->step = 0;
+    start_step(index);
 }
 
-TickType_t get_adcs_watchdog_delay(void) {
-#if ADCS_IS_STUBBED == 1
-    return STUBBED_WATCHDOG_DELAY;
-#else
-    if (xSemaphoreTake(adcs_watchdog_mtx, mutex_timeout) == pdPASS) {
-        TickType_t delay = adcs_prv_watchdog_delay;
-        xSemaphoreGive(adcs_watchdog_mtx);
-        return delay;
-    } else {
-        return 0;
+/**
+ * @brief
+ *      Health monitor task, steps each subsystem whose timer expired
+ * @param pvParameters
+ *      Task parameters (not used)
+ */
+static void health_monitor_daemon(void *pvParameters) {
+    uint8_t index;
+    for (;;) {
+        health_wdt_counter++;
+        if (xQueueReceive(health_queue, &index, ONE_MINUTE) == pdPASS) {
+            health_step(index);
+        }
     }
-#endif
 }
 
-TickType_t get_ns_watchdog_delay(void) {
-#if PAYLOAD_IS_STUBBED == 1
-    return STUBBED_WATCHDOG_DELAY;
-#else
-    if (xSemaphoreTake(ns_watchdog_mtx, mutex_timeout) == pdPASS) {
-        TickType_t delay = ns_prv_watchdog_delay;
-        xSemaphoreGive(ns_watchdog_mtx);
-        return delay;
-    } else {
+/**
+ * @brief
+ *      Get how often a subsystem is checked
+ * @param id
+ *      Subsystem to get
+ * @return
+ *      Delay between checks in ticks, 0 if it could not be read
+ */
+TickType_t get_watchdog_delay(health_subsystem_id id) {
+    int8_t index = find_subsystem(id);
+    if (index == -1) {
+        return STUBBED_WATCHDOG_DELAY;
+    }
+    if (health_lock == NULL || xSemaphoreTake(health_lock, mutex_timeout) != pdPASS) {
         return 0;
     }
-#endif
+    TickType_t delay = state[index].period;
+    xSemaphoreGive(health_lock);
+    return delay;
 }
 
-SAT_returnState set_uhf_watchdog_delay(const unsigned int ms_delay) {
-#if UHF_IS_STUBBED == 1
-    return SATR_OK;
-#else
+/**
+ * @brief
+ *      Set how often a subsystem is checked, from its next check on
+ * @param id
+ *      Subsystem to set
+ * @param ms_delay
+ *      Delay between checks, at least WATCHDOG_MINIMUM_DELAY_MS
+ * @return SAT_returnState
+ *      SATR_ERROR if the delay is too short or could not be set
+ */
+SAT_returnState set_watchdog_delay(health_subsystem_id id, const unsigned int ms_delay) {
+    int8_t index = find_subsystem(id);
+    if (index == -1) {
+        return SATR_OK;
+    }
     if (ms_delay < WATCHDOG_MINIMUM_DELAY_MS) {
         return SATR_ERROR;
     }
-    if (xSemaphoreTake(uhf_watchdog_mtx, mutex_timeout) == pdPASS) {
-        uhf_prv_watchdog_delay = pdMS_TO_TICKS(ms_delay);
-        xSemaphoreGive(uhf_watchdog_mtx);
+    if (health_lock != NULL && xSemaphoreTake(health_lock, mutex_timeout) == pdPASS) {
+        state[index].period = pdMS_TO_TICKS(ms_delay);
+        xSemaphoreGive(health_lock);
         return SATR_OK;
     }
     return SATR_ERROR;
-#endif
+}
+
+TickType_t get_uhf_watchdog_delay(void) { return get_watchdog_delay(HEALTH_UHF); }
+
+TickType_t get_sband_watchdog_delay(void) { return get_watchdog_delay(HEALTH_SBAND); }
+
+TickType_t get_charon_watchdog_delay(void) { return get_watchdog_delay(HEALTH_CHARON); }
+
+TickType_t get_adcs_watchdog_delay(void) { return get_watchdog_delay(HEALTH_ADCS); }
+
+TickType_t get_ns_watchdog_delay(void) { return get_watchdog_delay(HEALTH_NS); }
+
+SAT_returnState set_uhf_watchdog_delay(const unsigned int ms_delay) {
+    return set_watchdog_delay(HEALTH_UHF, ms_delay);
 }
 
 SAT_returnState set_sband_watchdog_delay(const unsigned int ms_delay) {
-#if SBAND_IS_STUBBED == 1
-    return SATR_OK;
-#else
-    if (ms_delay < WATCHDOG_MINIMUM_DELAY_MS) {
-        return SATR_ERROR;
-    }
-    if (xSemaphoreTake(sband_watchdog_mtx, mutex_timeout) == pdPASS) {
-        sband_prv_watchdog_delay = pdMS_TO_TICKS(ms_delay);
-        xSemaphoreGive(sband_watchdog_mtx);
-        return SATR_OK;
-    }
-    return SATR_ERROR;
-#endif
+    return set_watchdog_delay(HEALTH_SBAND, ms_delay);
 }
 
 SAT_returnState set_charon_watchdog_delay(const unsigned int ms_delay) {
-#if CHARON_IS_STUBBED == 1
-    return SATR_OK;
-#else
-    if (ms_delay < WATCHDOG_MINIMUM_DELAY_MS) {
-        return SATR_ERROR;
-    }
-    if (xSemaphoreTake(charon_watchdog_mtx, mutex_timeout) == pdPASS) {
-        charon_prv_watchdog_delay = pdMS_TO_TICKS(ms_delay);
-        xSemaphoreGive(charon_watchdog_mtx);
-        return SATR_OK;
-    }
-    return SATR_ERROR;
-#endif
+    return set_watchdog_delay(HEALTH_CHARON, ms_delay);
 }
 
 SAT_returnState set_adcs_watchdog_delay(const unsigned int ms_delay) {
-#if ADCS_IS_STUBBED == 1
-    return SATR_OK;
-#else
-    if (ms_delay < WATCHDOG_MINIMUM_DELAY_MS) {
-        return SATR_ERROR;
-    }
-    if (xSemaphoreTake(adcs_watchdog_mtx, mutex_timeout) == pdPASS) {
-        adcs_prv_watchdog_delay = pdMS_TO_TICKS(ms_delay);
-        xSemaphoreGive(adcs_watchdog_mtx);
-        return SATR_OK;
-    }
-    return SATR_ERROR;
-#endif
+    return set_watchdog_delay(HEALTH_ADCS, ms_delay);
 }
 
 SAT_returnState set_ns_watchdog_delay(const unsigned int ms_delay) {
-#if PAYLOAD_IS_STUBBED == 1
-    return SATR_OK;
-#else
-    if (ms_delay < WATCHDOG_MINIMUM_DELAY_MS) {
-        return SATR_ERROR;
+    return set_watchdog_delay(HEALTH_NS, ms_delay);
+}
+
+/**
+ * @brief
+ *      Copy out the health statistics of one watched subsystem
+ * @param index
+ *      Subsystem to get, counting only those not stubbed
+ * @param name
+ *      Set to the name of the subsystem
+ * @param out
+ *      Where to copy the statistics
+ * @return
+ *      false once index is past the last subsystem
+ */
+bool diagnostic_get_stats(uint8_t index, const char **name, health_stats_t *out) {
+    if (index >= SUBSYSTEM_COUNT || health_lock == NULL) {
+        return false;
     }
-    if (xSemaphoreTake(ns_watchdog_mtx, mutex_timeout) == pdPASS) {
-        ns_prv_watchdog_delay = pdMS_TO_TICKS(ms_delay);
-        xSemaphoreGive(ns_watchdog_mtx);
-        return SATR_OK;
+    *name = subsystems[index].name;
+    if (xSemaphoreTake(health_lock, mutex_timeout) != pdPASS) {
+        memset(out, 0, sizeof(*out));
+        return true;
     }
-    return SATR_ERROR;
-#endif
+    *out = state[index].stats;
+    xSemaphoreGive(health_lock);
+    return true;
 }
 
 /**
@@ -537,76 +452,45 @@ SAT_returnState set_ns_watchdog_delay(const unsigned int ms_delay) {
  *   error report of task creation
  */
 SAT_returnState start_diagnostic_daemon(void) {
-#if UHF_IS_STUBBED == 0
-    if (xTaskCreate((TaskFunction_t)uhf_watchdog_daemon, "uhf_watchdog_daemon", 1000, NULL, DIAGNOSTIC_TASK_PRIO,
-                    NULL) != pdPASS) {
-        ex2_log("FAILED TO CREATE TASK uhf_watchdog_daemon.\n");
-        return SATR_ERROR;
-    }
-    ex2_log("UHF watchdog task started.\n");
-    uhf_watchdog_mtx = xSemaphoreCreateMutex();
-    if (uhf_watchdog_mtx == NULL) {
-        ex2_log("FAILED TO CREATE MUTEX uhf_watchdog_mtx.\n");
-        return SATR_ERROR;
-    }
-#endif
+    TaskHandle_t health_tsk;
+    taskFunctions health_funcs = {0};
+    health_funcs.getCounterFunction = get_health_wdt_counter;
+    uint8_t i;
 
-#if SBAND_IS_STUBBED == 0
-    if (xTaskCreate((TaskFunction_t)sband_watchdog_daemon, "sband_watchdog_daemon", 1000, NULL,
-                    DIAGNOSTIC_TASK_PRIO, NULL) != pdPASS) {
-        ex2_log("FAILED TO CREATE TASK sband_watchdog_daemon.\n");
-        return SATR_ERROR;
+    if (SUBSYSTEM_COUNT == 0) {
+        return SATR_OK;
     }
-    ex2_log("SBAND watchdog task started.\n");
-    sband_watchdog_mtx = xSemaphoreCreateMutex();
-    if (sband_watchdog_mtx == NULL) {
-        ex2_log("FAILED TO CREATE MUTEX sband_watchdog_mtx.\n");
+    health_lock = xSemaphoreCreateMutex();
+    if (health_lock == NULL) {
+        ex2_log("FAILED TO CREATE MUTEX health_lock.\n");
         return SATR_ERROR;
     }
-#endif
-
-#if CHARON_IS_STUBBED == 0 && IS_EXALTA2 == 1
-    if (xTaskCreate(charon_watchdog_daemon, "charon_watchdog_daemon", 1000, NULL, DIAGNOSTIC_TASK_PRIO, NULL) !=
-        pdPASS) {
-        ex2_log("FAILED TO CREATE TASK charon_watchdog_daemon.\n");
+    health_queue = xQueueCreate(SUBSYSTEM_COUNT + 1, sizeof(uint8_t));
+    if (health_queue == NULL) {
+        ex2_log("FAILED TO CREATE QUEUE health_queue.\n");
         return SATR_ERROR;
     }
-    ex2_log("Charon watchdog task started.\n");
-    charon_watchdog_mtx = xSemaphoreCreateMutex();
-    if (charon_watchdog_mtx == NULL) {
-        ex2_log("FAILED TO CREATE MUTEX charon_watchdog_mtx.\n");
-        return SATR_ERROR;
+    for (i = 0; i < SUBSYSTEM_COUNT; i++) {
+        state[i].period = ONE_MINUTE;
+        state[i].timer = xTimerCreate(subsystems[i].name, ONE_MINUTE, pdFALSE, (void *)(uint32_t)i,
+                                      health_timer_expired);
+        if (state[i].timer == NULL) {
+            ex2_log("FAILED TO CREATE TIMER for %s watchdog.\n", subsystems[i].name);
+            return SATR_ERROR;
+        }
     }
-#endif
 
-#if ADCS_IS_STUBBED == 0
-    if (xTaskCreate(adcs_watchdog_daemon, "adcs_watchdog_daemon", 1000, NULL, DIAGNOSTIC_TASK_PRIO, NULL) !=
-        pdPASS) {
-        ex2_log("FAILED TO CREATE TASK adcs_watchdog_daemon.\n");
-        return SATR_ERROR;
-    }
-    ex2_log("ADCS watchdog task started.\n");
-    adcs_watchdog_mtx = xSemaphoreCreateMutex();
-    if (adcs_watchdog_mtx == NULL) {
-        ex2_log("FAILED TO CREATE MUTEX adcs_watchdog_mtx.\n");
+    if (xTaskCreate(health_monitor_daemon, "health_monitor_daemon", 1000, NULL, DIAGNOSTIC_TASK_PRIO,
+                    &health_tsk) != pdPASS) {
+        ex2_log("FAILED TO CREATE TASK health_monitor_daemon.\n");
         return SATR_ERROR;
     }
-#endif
+    ex2_register(health_tsk, health_funcs);
 
-#if PAYLOAD_IS_STUBBED == 0
-#if IS_EXALTA2 == 1
-#else
-    if (xTaskCreate(ns_watchdog_daemon, "ns_watchdog_daemon", 1000, NULL, DIAGNOSTIC_TASK_PRIO, NULL) != pdPASS) {
-        ex2_log("FAILED TO CREATE TASK ns_watchdog_daemon.\n");
-        return SATR_ERROR;
-    }
-    ex2_log("NS watchdog task started.\n");
-    ns_watchdog_mtx = xSemaphoreCreateMutex();
-    if (ns_watchdog_mtx == NULL) {
-        ex2_log("FAILED TO CREATE MUTEX ns_watchdog_mtx.\n");
-        return SATR_ERROR;
+    // First checks are right away, a second apart so they don't all talk at once
+    for (i = 0; i < SUBSYSTEM_COUNT; i++) {
+        arm(i, (i + 1) * ONE_SECOND);
+        ex2_log("%s watchdog started.\n", subsystems[i].name);
     }
-#endif
-#endif
     return SATR_OK;
 }
@@ -5,11 +5,33 @@
  *      Author: Robert Taylor
  */
 
-#include "FreeRTOSConfig.h"
+#include <FreeRTOS.h>
+#include <os_semphr.h>
+#include "eeprom.h"
 #include "privileged_functions.h"
 #include "flash_defines.h"
 #include "F021.h"
 #include "bl_flash.h"
+#include <string.h>
+
+static SemaphoreHandle_t flash_mutex = NULL;
+
+/**
+ * @brief
+ *      Take the lock shared by everything that erases or programs the flash
+ * @details
+ *      There is one flash state machine for every bank, used by the EEPROM
+ *      blocks, nv_store and firmware updates. Recursive, so a holder may
+ *      call eeprom_write
+ */
+void flash_lock(void) {
+    if (flash_mutex == NULL) {
+        flash_mutex = xSemaphoreCreateRecursiveMutex();
+    }
+    xSemaphoreTakeRecursive(flash_mutex, portMAX_DELAY);
+}
+
+void flash_unlock(void) { xSemaphoreGiveRecursive(flash_mutex); }
 
 static const SECTORS *eeprom_get_sector_by_block(uint8_t block) {
     const SECTORS *sector = 0;
@@ -38,10 +60,16 @@ Fapi_StatusType eeprom_write(void *dat, uint8_t block, uint32_t size) {
     if (size > sector_size) {
         return Fapi_Error_AsyncIncorrectDataBufferLength;
     }
+    // Don't wear the sector out rewriting what it already holds
+    if (memcmp(addr, dat, size) == 0) {
+        return Fapi_Status_Success;
+    }
+    flash_lock();
     raise_privilege();
     uint32_t status = Fapi_BlockErase((uint32_t)addr, size);
     status = Fapi_BlockProgram(7, (uint32_t)addr, (uint32_t)dat, size);
     reset_privilege();
+    flash_unlock();
     return (Fapi_StatusType)status;
 }
 
@@ -0,0 +1,575 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file fs_bulk.c
+ * @date Oct. 19, 2026
+ *
+ * Copies, moves, removes and measures whole directory trees on the SD card.
+ *
+ * A walk never changes the working directory and keeps no directory open
+ * while it works on the entries. It lists as many entries of a directory as
+ * fit in a shared buffer of names, closes the directory, then handles them.
+ * Deeper levels list into the rest of the same buffer, so the number of open
+ * handles stays the same however deep the tree is.
+ *
+ * Automatic transactions are turned off on the volumes being written for
+ * the length of an operation, apart from when the volume fills, and one
+ * transaction is made at the end. File data is copied through one block
+ * aligned buffer of FS_BULK_BUFFER_SIZE bytes. Operations take a lock, so
+ * only one runs at a time.
+ *
+ * Failures return -1 with red_errno set, like the Reliance Edge calls.
+ */
+
+#include "fs_bulk/fs_bulk.h"
+
+#include <FreeRTOS.h>
+#include <os_semphr.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* Longest volume prefix, such as "VOL0:", with its terminator */
+#define VOLUME_NAME_MAX 8
+
+typedef enum {
+    WALK_COPY,
+    WALK_REMOVE,
+    WALK_USAGE,
+} walk_op;
+
+typedef struct {
+    walk_op op;
+    fs_bulk_totals *totals;
+    fs_bulk_progress progress;
+    void *arg;
+} walk_t;
+
+typedef struct {
+    char name[VOLUME_NAME_MAX];
+    uint32_t saved_mask; // transaction mask to put back
+    bool held;
+} volume_hold_t;
+
+/* Reliance Edge moves whole blocks in an aligned buffer straight to the disk, without its block buffers */
+static union {
+    uint32_t align;
+    uint8_t data[FS_BULK_BUFFER_SIZE];
+} transfer;
+
+static char src_path[FS_BULK_PATH_MAX];
+static char dst_path[FS_BULK_PATH_MAX];
+static char names[FS_BULK_NAMES_SIZE]; // each entry is 'd' or 'f', the name and a terminator
+static volume_hold_t holds[2];
+static SemaphoreHandle_t bulk_lock = NULL;
+
+static int32_t walk_dir(walk_t *walk, uint32_t used, uint8_t depth);
+
+static void prv_get_lock(void) {
+    if (bulk_lock == NULL) {
+        bulk_lock = xSemaphoreCreateMutex();
+    }
+    xSemaphoreTake(bulk_lock, portMAX_DELAY);
+}
+
+static void prv_give_lock(void) { xSemaphoreGive(bulk_lock); }
+
+static int32_t fail(int32_t error) {
+    red_errno = error;
+    return -1;
+}
+
+static void report(walk_t *walk) {
+    if (walk->progress != NULL) {
+        walk->progress(walk->totals, walk->arg);
+    }
+}
+
+static int32_t set_path(char *buffer, const char *path) {
+    size_t len = strlen(path);
+    if (len >= FS_BULK_PATH_MAX) {
+        return fail(RED_ENAMETOOLONG);
+    }
+    memcpy(buffer, path, len + 1);
+    // Names are appended after a separator, but the root of a volume keeps its own
+    while (len > 1 && buffer[len - 1] == '/' && buffer[len - 2] != ':') {
+        buffer[--len] = '\0';
+    }
+    return 0;
+}
+
+/* Append a name to a path, returns the length to cut the path back to afterwards */
+static int32_t push_name(char *buffer, const char *name) {
+    size_t len = strlen(buffer);
+    size_t name_len = strlen(name);
+    size_t separator = len > 0 && buffer[len - 1] != '/' ? 1 : 0;
+
+    if (len + separator + name_len >= FS_BULK_PATH_MAX) {
+        return fail(RED_ENAMETOOLONG);
+    }
+    if (separator) {
+        buffer[len] = '/';
+    }
+    memcpy(&buffer[len + separator], name, name_len + 1);
+    return len;
+}
+
+static bool is_dir(const char *path) {
+    REDDIR *dir = red_opendir(path);
+    if (dir == NULL) {
+        return false;
+    }
+    red_closedir(dir);
+    return true;
+}
+
+/* Start holding back automatic transactions on the volume of path, a relative path is on the cwd's volume */
+static void hold_volume(const char *path) {
+    char name[VOLUME_NAME_MAX];
+    const char *colon = strchr(path, ':');
+    uint8_t i;
+
+    if (colon == NULL) {
+        path = red_getcwd(names, sizeof(names));
+        colon = path != NULL ? strchr(path, ':') : NULL;
+    }
+    if (colon == NULL || colon - path + 1 >= VOLUME_NAME_MAX) {
+        return;
+    }
+    memcpy(name, path, colon - path + 1);
+    name[colon - path + 1] = '\0';
+
+    for (i = 0; i < 2; i++) {
+        if (holds[i].held && strcmp(holds[i].name, name) == 0) {
+            return;
+        }
+    }
+    for (i = 0; i < 2; i++) {
+        if (!holds[i].held) {
+            break;
+        }
+    }
+    if (i == 2 || red_gettransmask(name, &holds[i].saved_mask) != 0) {
+        return;
+    }
+    // Still transact when the volume fills, so the space of removed files can be reused
+    if (red_settransmask(name, holds[i].saved_mask & RED_TRANSACT_VOLFULL) == 0) {
+        strcpy(holds[i].name, name);
+        holds[i].held = true;
+    }
+}
+
+/* Put back the transaction masks and commit everything done while they were held */
+static void release_volumes(void) {
+    uint8_t i;
+    for (i = 0; i < 2; i++) {
+        if (holds[i].held) {
+            red_settransmask(holds[i].name, holds[i].saved_mask);
+            red_transact(holds[i].name);
+            holds[i].held = false;
+        }
+    }
+}
+
+/*
+ * List the entries of the directory in src_path after the first skip into
+ * names, starting at *used, until the buffer fills. Files are only counted
+ * when measuring. Returns the entries taken, and sets *end after the last.
+ */
+static int32_t list_dir(walk_t *walk, uint32_t skip, uint32_t *used, bool *end) {
+    REDDIR *dir = red_opendir(src_path);
+    REDDIRENT *entry;
+    uint32_t index = 0;
+    int32_t taken = 0;
+
+    if (dir == NULL) {
+        return -1;
+    }
+    *end = false;
+    red_errno = 0;
+    while ((entry = red_readdir(dir)) != NULL) {
+        if (index++ < skip) {
+            continue;
+        }
+        bool entry_is_dir = RED_S_ISDIR(entry->d_stat.st_mode);
+        if (entry_is_dir || walk->op != WALK_USAGE) {
+            size_t size = strlen(entry->d_name) + 2;
+            if (*used + size > FS_BULK_NAMES_SIZE) {
+                break;
+            }
+            names[*used] = entry_is_dir ? 'd' : 'f';
+            memcpy(&names[*used + 1], entry->d_name, size - 1);
+            *used += size;
+        }
+        if (!entry_is_dir && walk->op != WALK_COPY) {
+            walk->totals->bytes += entry->d_stat.st_size;
+            if (walk->op == WALK_USAGE) {
+                walk->totals->files++;
+            }
+        }
+        taken++;
+    }
+    if (entry == NULL) {
+        if (red_errno != 0) {
+            red_closedir(dir);
+            return -1;
+        }
+        *end = true;
+    }
+    red_closedir(dir);
+    return taken;
+}
+
+static int32_t copy_file(walk_t *walk) {
+    int32_t from = red_open(src_path, RED_O_RDONLY);
+    if (from < 0) {
+        return -1;
+    }
+    int32_t to = red_open(dst_path, RED_O_WRONLY | RED_O_CREAT | RED_O_TRUNC);
+    if (to < 0) {
+        red_close(from);
+        return -1;
+    }
+
+    int32_t ret = 0;
+    for (;;) {
+        int32_t bytes_read = red_read(from, transfer.data, FS_BULK_BUFFER_SIZE);
+        if (bytes_read <= 0) {
+            ret = bytes_read;
+            break;
+        }
+        int32_t bytes_written = red_write(to, transfer.data, bytes_read);
+        if (bytes_written != bytes_read) {
+            ret = bytes_written < 0 ? -1 : fail(RED_ENOSPC);
+            break;
+        }
+        walk->totals->bytes += bytes_read;
+        report(walk);
+    }
+    if (red_close(to) != 0) {
+        ret = -1;
+    }
+    red_close(from);
+    if (ret == 0) {
+        walk->totals->files++;
+    }
+    return ret;
+}
+
+static int32_t copy_dir(walk_t *walk, uint32_t used, uint8_t depth) {
+    if (red_mkdir(dst_path) != 0 && !(red_errno == RED_EEXIST && is_dir(dst_path))) {
+        return -1;
+    }
+    walk->totals->dirs++;
+    return walk_dir(walk, used, depth);
+}
+
+/* Handle one listed entry, whose name is pushed onto the paths */
+static int32_t visit(walk_t *walk, bool entry_is_dir, const char *name, uint32_t used, uint8_t depth) {
+    int32_t src_len = push_name(src_path, name);
+    int32_t dst_len = 0;
+    int32_t ret = -1;
+
+    if (src_len < 0) {
+        return -1;
+    }
+    if (walk->op == WALK_COPY && (dst_len = push_name(dst_path, name)) < 0) {
+        src_path[src_len] = '\0';
+        return -1;
+    }
+
+    switch (walk->op) {
+    case WALK_COPY:
+        ret = entry_is_dir ? copy_dir(walk, used, depth + 1) : copy_file(walk);
+        break;
+    case WALK_REMOVE:
+        ret = entry_is_dir ? walk_dir(walk, used, depth + 1) : 0;
+        if (ret == 0) {
+            ret = red_unlink(src_path);
+        }
+        if (ret == 0 && entry_is_dir) {
+            walk->totals->dirs++;
+        } else if (ret == 0) {
+            walk->totals->files++;
+        }
+        break;
+    case WALK_USAGE:
+        walk->totals->dirs++;
+        ret = walk_dir(walk, used, depth + 1);
+        break;
+    }
+
+    src_path[src_len] = '\0';
+    if (walk->op == WALK_COPY) {
+        dst_path[dst_len] = '\0';
+    }
+    if (ret == 0) {
+        report(walk);
+    }
+    return ret;
+}
+
+/* Visit every entry of the directory in src_path, listing them into names from used */
+static int32_t walk_dir(walk_t *walk, uint32_t used, uint8_t depth) {
+    uint32_t skip = 0;
+    bool end = false;
+
+    if (depth > FS_BULK_DEPTH_MAX) {
+        return fail(RED_ENAMETOOLONG);
+    }
+    while (!end) {
+        uint32_t top = used;
+        int32_t taken = list_dir(walk, skip, &top, &end);
+        if (taken < 0) {
+            return -1;
+        }
+        if (taken == 0 && !end) {
+            return fail(RED_ERANGE); // not even one name fits
+        }
+        // Removed entries drop out of the directory, the others are skipped when it is listed again
+        if (walk->op != WALK_REMOVE) {
+            skip += taken;
+        }
+
+        const char *entry = &names[used];
+        while (entry < &names[top]) {
+            if (visit(walk, entry[0] == 'd', entry + 1, top, depth) != 0) {
+                return -1;
+            }
+            entry += strlen(entry) + 1;
+        }
+    }
+    return 0;
+}
+
+/* Copy the file or directory in src_path to dst_path. Must hold the lock */
+static int32_t copy_entry(walk_t *walk) {
+    if (!is_dir(src_path)) {
+        return copy_file(walk);
+    }
+    size_t len = strlen(src_path);
+    if (strncmp(dst_path, src_path, len) == 0 && (dst_path[len] == '/' || dst_path[len] == '\0')) {
+        return fail(RED_EINVAL); // a directory can't be copied into itself
+    }
+    return copy_dir(walk, 0, 0);
+}
+
+/* Remove the file or directory in src_path. Must hold the lock */
+static int32_t remove_entry(walk_t *walk) {
+    if (!is_dir(src_path)) {
+        REDSTAT stat;
+        int32_t fd = red_open(src_path, RED_O_RDONLY);
+        if (fd < 0) {
+            return -1;
+        }
+        int32_t ret = red_fstat(fd, &stat);
+        red_close(fd);
+        if (ret != 0 || red_unlink(src_path) != 0) {
+            return -1;
+        }
+        walk->totals->files++;
+        walk->totals->bytes += stat.st_size;
+        return 0;
+    }
+    if (walk_dir(walk, 0, 0) != 0 || red_unlink(src_path) != 0) {
+        return -1;
+    }
+    walk->totals->dirs++;
+    return 0;
+}
+
+/**
+ * @brief
+ *      Copy a file, or a directory and everything in it
+ * @param from
+ *      File or directory to copy
+ * @param to
+ *      Path of the copy. Files are replaced, directories are merged into
+ * @param totals
+ *      Set to what was copied, also on failure
+ * @param progress
+ *      Called as the copy goes, may be NULL
+ * @param arg
+ *      Passed to progress
+ * @return
+ *      0, or -1 with red_errno set
+ */
+int32_t fs_bulk_copy(const char *from, const char *to, fs_bulk_totals *totals, fs_bulk_progress progress,
+                     void *arg) {
+    walk_t walk = {WALK_COPY, totals, progress, arg};
+    int32_t ret;
+
+    memset(totals, 0, sizeof(*totals));
+    prv_get_lock();
+    ret = set_path(src_path, from);
+    if (ret == 0) {
+        ret = set_path(dst_path, to);
+    }
+    if (ret == 0) {
+        hold_volume(to);
+        ret = copy_entry(&walk);
+        release_volumes();
+    }
+    prv_give_lock();
+    return ret;
+}
+
+/**
+ * @brief
+ *      Move a file or a directory
+ * @details
+ *      Renamed in place on the same volume. Moving to the other volume
+ *      copies everything and then removes the original
+ * @param from
+ *      File or directory to move
+ * @param to
+ *      New path
+ * @param totals
+ *      Set to what was moved, also on failure
+ * @param progress
+ *      Called as the move goes, may be NULL
+ * @param arg
+ *      Passed to progress
+ * @return
+ *      0, or -1 with red_errno set
+ */
+int32_t fs_bulk_move(const char *from, const char *to, fs_bulk_totals *totals, fs_bulk_progress progress,
+                     void *arg) {
+    walk_t walk = {WALK_COPY, totals, progress, arg};
+    int32_t ret;
+
+    memset(totals, 0, sizeof(*totals));
+    prv_get_lock();
+    ret = set_path(src_path, from);
+    if (ret == 0) {
+        ret = set_path(dst_path, to);
+    }
+    if (ret != 0) {
+        prv_give_lock();
+        return ret;
+    }
+
+    bool entry_is_dir = is_dir(src_path);
+    ret = red_rename(src_path, dst_path);
+    if (ret == 0) {
+        if (entry_is_dir) {
+            totals->dirs++;
+        } else {
+            totals->files++;
+        }
+    } else if (red_errno == RED_EXDEV) {
+        fs_bulk_totals removed = {0};
+        hold_volume(from);
+        hold_volume(to);
+        ret = copy_entry(&walk);
+        if (ret == 0) {
+            walk.op = WALK_REMOVE;
+            walk.totals = &removed;
+            ret = remove_entry(&walk);
+        }
+        release_volumes();
+    }
+    prv_give_lock();
+    return ret;
+}
+
+/**
+ * @brief
+ *      Remove a file, or a directory and everything in it
+ * @param path
+ *      File or directory to remove
+ * @param totals
+ *      Set to what was removed, also on failure
+ * @param progress
+ *      Called after each file or directory removed, may be NULL
+ * @param arg
+ *      Passed to progress
+ * @return
+ *      0, or -1 with red_errno set
+ */
+int32_t fs_bulk_remove(const char *path, fs_bulk_totals *totals, fs_bulk_progress progress, void *arg) {
+    walk_t walk = {WALK_REMOVE, totals, progress, arg};
+    int32_t ret;
+
+    memset(totals, 0, sizeof(*totals));
+    prv_get_lock();
+    ret = set_path(src_path, path);
+    if (ret == 0) {
+        hold_volume(path);
+        ret = remove_entry(&walk);
+        release_volumes();
+    }
+    prv_give_lock();
+    return ret;
+}
+
+/**
+ * @brief
+ *      Count the files, directories and bytes under a path
+ * @details
+ *      Sizes come from the directory entries, no file is opened
+ * @param path
+ *      File or directory to measure
+ * @param totals
+ *      Set to the files and directories found and their size
+ * @return
+ *      0, or -1 with red_errno set
+ */
+int32_t fs_bulk_usage(const char *path, fs_bulk_totals *totals) {
+    walk_t walk = {WALK_USAGE, totals, NULL, NULL};
+    int32_t ret;
+
+    memset(totals, 0, sizeof(*totals));
+    prv_get_lock();
+    ret = set_path(src_path, path);
+    if (ret == 0 && is_dir(src_path)) {
+        ret = walk_dir(&walk, 0, 0);
+    } else if (ret == 0) {
+        REDSTAT stat;
+        int32_t fd = red_open(src_path, RED_O_RDONLY);
+        ret = fd < 0 ? -1 : red_fstat(fd, &stat);
+        if (fd >= 0) {
+            red_close(fd);
+        }
+        if (ret == 0) {
+            totals->files = 1;
+            totals->bytes = stat.st_size;
+        }
+    }
+    prv_give_lock();
+    return ret;
+}
+
+/**
+ * @brief
+ *      Get the size and free space of a volume
+ * @param volume
+ *      Volume prefix, such as "VOL0:"
+ * @param info
+ *      Set to the size and free space
+ * @return
+ *      0, or -1 with red_errno set
+ */
+int32_t fs_bulk_volume_info(const char *volume, fs_bulk_volume *info) {
+    REDSTATFS stat;
+
+    if (red_statvfs(volume, &stat) != 0) {
+        return -1;
+    }
+    info->block_size = stat.f_frsize;
+    info->total_bytes = (uint64_t)stat.f_blocks * stat.f_frsize;
+    info->free_bytes = (uint64_t)stat.f_bfree * stat.f_frsize;
+    info->total_inodes = stat.f_files;
+    info->free_inodes = stat.f_ffree;
+    return 0;
+}
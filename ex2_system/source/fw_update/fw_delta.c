@@ -0,0 +1,274 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file fw_delta.c
+ * @date Oct. 19, 2026
+ *
+ * Applies a patch made by tools/fw_delta.py to an image in flash.
+ *
+ * A patch is a header naming the image it applies to and the image it
+ * produces, then a list of operations. COPY takes bytes from the old image,
+ * after moving the position in it by a signed amount. INSERT carries bytes
+ * that are new. ADD is a COPY in which some bytes change, as in bsdiff: code
+ * that moved keeps most of its bytes but the addresses and branch offsets in
+ * it differ. Only the changed bytes are carried, each as the count of
+ * unchanged bytes before it and the difference to add to the old byte. The
+ * patch can arrive in pieces of any size, and the new image is output in
+ * order as it is produced, with old bytes read straight from flash, so
+ * applying a patch takes no buffer of its own.
+ */
+
+#include "fw_update/fw_delta.h"
+
+#include <string.h>
+
+typedef enum {
+    STATE_OP = 0,
+    STATE_LENGTH,
+    STATE_MOVE,
+    STATE_INSERT,
+    STATE_CHANGES,
+    STATE_SKIP,
+    STATE_DIFFERENCE,
+    STATE_DONE,
+    STATE_ERROR,
+} delta_state;
+
+static uint32_t get_be32(const uint8_t *data) {
+    return (uint32_t)data[0] << 24 | (uint32_t)data[1] << 16 | (uint32_t)data[2] << 8 | data[3];
+}
+
+static uint16_t get_be16(const uint8_t *data) { return (uint16_t)(data[0] << 8 | data[1]); }
+
+/**
+ * @brief
+ *      Read the header at the start of a patch
+ * @param data
+ *      First FW_DELTA_HEADER_SIZE bytes of the patch
+ * @param header
+ *      Filled in from the patch
+ * @return
+ *      false if data isn't the start of a patch
+ */
+bool fw_delta_parse_header(const uint8_t *data, fw_delta_header *header) {
+    if (get_be32(data) != FW_DELTA_MAGIC) {
+        return false;
+    }
+    header->source_size = get_be32(data + 4);
+    header->source_crc = get_be16(data + 8);
+    header->target_size = get_be32(data + 10);
+    header->target_crc = get_be16(data + 14);
+    // The last two bytes are reserved
+    return true;
+}
+
+/**
+ * @brief
+ *      Start applying a patch
+ * @param ctx
+ *      Patch to start
+ * @param header
+ *      Header of the patch
+ * @param source
+ *      Image the patch applies to, header->source_size bytes
+ * @param output
+ *      Called with each piece of the new image
+ */
+void fw_delta_init(fw_delta_ctx *ctx, const fw_delta_header *header, const uint8_t *source,
+                   fw_delta_output output) {
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->header = *header;
+    ctx->source = source;
+    ctx->output = output;
+    ctx->state = STATE_OP;
+}
+
+/* Add a byte to the varint being read. Returns true once it is complete */
+static bool read_varint(fw_delta_ctx *ctx, uint8_t byte) {
+    if (ctx->shift >= 32) {
+        ctx->state = STATE_ERROR;
+        return false;
+    }
+    ctx->value |= (uint32_t)(byte & 0x7F) << ctx->shift;
+    ctx->shift += 7;
+    return (byte & 0x80) == 0;
+}
+
+static void next_varint(fw_delta_ctx *ctx, delta_state state) {
+    ctx->value = 0;
+    ctx->shift = 0;
+    ctx->state = state;
+}
+
+/* Move the position in the old image, checking the current operation fits both images */
+static bool seek(fw_delta_ctx *ctx, uint32_t move) {
+    // move is zigzag encoded, 0, -1, 1, -2... are 0, 1, 2, 3...
+    int32_t delta = (int32_t)(move >> 1) ^ -(int32_t)(move & 1);
+    uint32_t pos = ctx->source_pos + (uint32_t)delta;
+
+    if (pos > ctx->header.source_size || ctx->length > ctx->header.source_size - pos ||
+        ctx->length > ctx->header.target_size - ctx->produced) {
+        return false;
+    }
+    ctx->source_pos = pos;
+    return true;
+}
+
+/* Output bytes of the old image unchanged */
+static bool copy(fw_delta_ctx *ctx, uint32_t length) {
+    if (length > 0 && !ctx->output(ctx->produced, ctx->source + ctx->source_pos, length)) {
+        return false;
+    }
+    ctx->source_pos += length;
+    ctx->produced += length;
+    return true;
+}
+
+/* Output the rest of an add once its last changed byte is out */
+static void finish_add(fw_delta_ctx *ctx) {
+    ctx->state = copy(ctx, ctx->pending) ? STATE_OP : STATE_ERROR;
+    ctx->pending = 0;
+}
+
+/**
+ * @brief
+ *      Apply the next piece of a patch
+ * @param ctx
+ *      Patch being applied
+ * @param data
+ *      Next bytes of the patch, after the header
+ * @param length
+ *      Bytes in data
+ * @return
+ *      FW_DELTA_DONE once the new image is complete, FW_DELTA_ERROR if the
+ *      patch is malformed or output failed
+ */
+fw_delta_result fw_delta_feed(fw_delta_ctx *ctx, const uint8_t *data, uint32_t length) {
+    while (length > 0 && ctx->state != STATE_ERROR) {
+        switch (ctx->state) {
+        case STATE_OP:
+            ctx->op = *data++;
+            length--;
+            if (ctx->op == FW_DELTA_END) {
+                ctx->state = ctx->produced == ctx->header.target_size ? STATE_DONE : STATE_ERROR;
+            } else if (ctx->op == FW_DELTA_COPY || ctx->op == FW_DELTA_INSERT || ctx->op == FW_DELTA_ADD) {
+                next_varint(ctx, STATE_LENGTH);
+            } else {
+                ctx->state = STATE_ERROR;
+            }
+            break;
+
+        case STATE_LENGTH:
+            length--;
+            if (!read_varint(ctx, *data++)) {
+                break;
+            }
+            ctx->length = ctx->value;
+            if (ctx->op == FW_DELTA_COPY || ctx->op == FW_DELTA_ADD) {
+                next_varint(ctx, STATE_MOVE);
+            } else if (ctx->length > ctx->header.target_size - ctx->produced) {
+                ctx->state = STATE_ERROR;
+            } else {
+                ctx->pending = ctx->length;
+                ctx->state = ctx->pending ? STATE_INSERT : STATE_OP;
+            }
+            break;
+
+        case STATE_MOVE:
+            length--;
+            if (!read_varint(ctx, *data++)) {
+                break;
+            }
+            if (!seek(ctx, ctx->value)) {
+                ctx->state = STATE_ERROR;
+            } else if (ctx->op == FW_DELTA_COPY) {
+                ctx->state = copy(ctx, ctx->length) ? STATE_OP : STATE_ERROR;
+            } else {
+                ctx->pending = ctx->length;
+                next_varint(ctx, STATE_CHANGES);
+            }
+            break;
+
+        case STATE_CHANGES:
+            length--;
+            if (!read_varint(ctx, *data++)) {
+                break;
+            }
+            ctx->changes = ctx->value;
+            if (ctx->changes == 0) {
+                finish_add(ctx);
+            } else {
+                next_varint(ctx, STATE_SKIP);
+            }
+            break;
+
+        case STATE_SKIP:
+            length--;
+            if (!read_varint(ctx, *data++)) {
+                break;
+            }
+            // The changed byte after the skip must be within the add too
+            if (ctx->value >= ctx->pending || !copy(ctx, ctx->value)) {
+                ctx->state = STATE_ERROR;
+                break;
+            }
+            ctx->pending -= ctx->value;
+            ctx->state = STATE_DIFFERENCE;
+            break;
+
+        case STATE_DIFFERENCE: {
+            uint8_t byte = ctx->source[ctx->source_pos] + *data++;
+            length--;
+            if (!ctx->output(ctx->produced, &byte, 1)) {
+                ctx->state = STATE_ERROR;
+                break;
+            }
+            ctx->source_pos++;
+            ctx->produced++;
+            ctx->pending--;
+            if (--ctx->changes == 0) {
+                finish_add(ctx);
+            } else {
+                next_varint(ctx, STATE_SKIP);
+            }
+            break;
+        }
+
+        case STATE_INSERT: {
+            uint32_t part = length < ctx->pending ? length : ctx->pending;
+            if (!ctx->output(ctx->produced, data, part)) {
+                ctx->state = STATE_ERROR;
+                break;
+            }
+            ctx->produced += part;
+            ctx->pending -= part;
+            data += part;
+            length -= part;
+            if (ctx->pending == 0) {
+                ctx->state = STATE_OP;
+            }
+            break;
+        }
+
+        case STATE_DONE:
+            // Nothing may follow the end
+            ctx->state = STATE_ERROR;
+            break;
+        }
+    }
+    if (ctx->state == STATE_ERROR) {
+        return FW_DELTA_ERROR;
+    }
+    return ctx->state == STATE_DONE ? FW_DELTA_DONE : FW_DELTA_MORE;
+}
@@ -0,0 +1,548 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file fw_update.c
+ * @date Oct. 19, 2026
+ *
+ * Programs a new application or golden image into flash as it is uplinked.
+ *
+ * Uplinked data is gathered into one of two buffers. When a buffer is full
+ * it is handed to the writer task and the other one is filled, so a buffer
+ * is programmed while the next blocks are received. The writer erases each
+ * sector just before the write pointer reaches it, or earlier when it is
+ * idle, programs whole bank width bursts, and reads every burst back. A
+ * CRC-16 of what was read back is kept as it goes.
+ *
+ * Only the application image can be replaced, and only while the golden
+ * image is running, so the flash bank being programmed is never the one the
+ * code runs from. The golden image shares bank 0 with the vectors and the
+ * bootloader, which can't be erased while the code runs from flash with
+ * interrupts and the scheduler going, so it is never updated. Its image_info is
+ * cleared when the update starts and written again once the whole image
+ * matches the CRC from the ground, so the bootloader never sees a partly
+ * written image as valid. Progress is saved in nv_store at the end of every
+ * sector, and an update of the same image started again resumes there.
+ *
+ * The new image can also be uplinked as a patch against the running image,
+ * see fw_delta.c.
+ */
+
+#include "fw_update/fw_update.h"
+
+#include <FreeRTOS.h>
+#include <os_queue.h>
+#include <os_semphr.h>
+#include <os_task.h>
+#include <string.h>
+
+#include "F021.h"
+#include "eeprom.h"
+#include "flash_defines.h"
+#include "fw_update/fw_delta.h"
+#include "image_verify/image_crc.h"
+#include "logger/logger.h"
+#include "nv_store/nv_store.h"
+#include "privileged_functions.h"
+#include "task_manager/task_manager.h"
+
+#define FLASH_END 0x00400000 // end of bank 1
+
+typedef struct __attribute__((packed)) {
+    uint32_t target;
+    uint32_t size;
+    uint16_t crc;        // CRC-16 of the whole new image
+    uint32_t stored;     // bytes programmed, always up to the end of a sector
+    uint16_t stored_crc; // CRC-16 of those bytes
+} fw_checkpoint;
+
+typedef struct {
+    uint8_t buffer;
+    uint32_t length;
+} fw_job;
+
+static fw_update_status status;
+static uint32_t image_start;
+static uint16_t image_crc;
+static uint16_t programmed_crc; // CRC-16 of the bytes programmed, as read back
+static uint32_t erased_to;      // the sectors below this address are erased and ready
+static volatile bool failed;
+static TickType_t started;
+
+static fw_delta_ctx delta;
+
+static uint8_t stage[2][FW_UPDATE_BUFFER_SIZE];
+static uint8_t fill_buffer;
+static uint32_t fill;
+static volatile uint32_t jobs_queued = 0;
+static volatile uint32_t jobs_done = 0;
+
+static QueueHandle_t jobs = NULL;
+static SemaphoreHandle_t job_done = NULL;
+static SemaphoreHandle_t status_lock = NULL; // only held to copy status in or out
+
+static uint32_t svc_wdt_counter = 0;
+
+static uint32_t get_svc_wdt_counter() { return svc_wdt_counter; }
+
+static const SECTORS *find_sector(uint32_t addr) {
+    int i;
+    for (i = 0; i < NUMBEROFSECTORS; i++) {
+        uint32_t start = (uint32_t)flash_sector[i].start;
+        if (addr >= start && addr < start + flash_sector[i].length) {
+            return &flash_sector[i];
+        }
+    }
+    return NULL;
+}
+
+static bool erase_sector(const SECTORS *sector) {
+    Fapi_StatusType result;
+
+    raise_privilege();
+    Fapi_setActiveFlashBank((Fapi_FlashBankType)sector->bankNumber);
+    Fapi_enableMainBankSectors(0xFFFF);
+    while (FAPI_CHECK_FSM_READY_BUSY != Fapi_Status_FsmReady) {
+    }
+    Fapi_issueAsyncCommandWithAddress(Fapi_EraseSector, (uint32_t *)sector->start);
+    while (FAPI_CHECK_FSM_READY_BUSY == Fapi_Status_FsmBusy) {
+        // Erasing a sector takes hundreds of milliseconds, let the other tasks run meanwhile
+        vTaskDelay(1);
+    }
+    result = FAPI_GET_FSM_STATUS;
+    reset_privilege();
+    return result == Fapi_Status_Success;
+}
+
+/* Program length bytes, a multiple of FW_UPDATE_BURST, in one sector of one bank */
+static bool program(const SECTORS *sector, uint32_t addr, const uint8_t *data, uint32_t length) {
+    bool ok = true;
+
+    raise_privilege();
+    Fapi_setActiveFlashBank((Fapi_FlashBankType)sector->bankNumber);
+    Fapi_enableMainBankSectors(0xFFFF);
+    while (FAPI_CHECK_FSM_READY_BUSY != Fapi_Status_FsmReady) {
+    }
+    while (length > 0 && ok) {
+        Fapi_issueProgrammingCommand((uint32_t *)addr, (uint8_t *)data, FW_UPDATE_BURST, 0, 0,
+                                     Fapi_AutoEccGeneration);
+        while (FAPI_CHECK_FSM_READY_BUSY == Fapi_Status_FsmBusy) {
+        }
+        ok = FAPI_GET_FSM_STATUS == Fapi_Status_Success;
+        addr += FW_UPDATE_BURST;
+        data += FW_UPDATE_BURST;
+        length -= FW_UPDATE_BURST;
+    }
+    reset_privilege();
+    return ok;
+}
+
+static void save_checkpoint(void) {
+    fw_checkpoint checkpoint = {status.target, status.size, image_crc, status.programmed, programmed_crc};
+    if (!nv_store_write(NV_KEY_FW_UPDATE, &checkpoint, sizeof(checkpoint))) {
+        sys_log(WARN, "Failed to save firmware update progress");
+    }
+}
+
+/* Writer task side. Program one buffer, a sector at a time */
+static bool program_job(const fw_job *job) {
+    const uint8_t *data = stage[job->buffer];
+    uint32_t done = 0;
+
+    while (done < job->length) {
+        uint32_t addr = image_start + status.programmed;
+        const SECTORS *sector = find_sector(addr);
+        if (sector == NULL) {
+            return false;
+        }
+        uint32_t sector_end = (uint32_t)sector->start + sector->length;
+        uint32_t piece = job->length - done;
+        if (piece > sector_end - addr) {
+            piece = sector_end - addr;
+        }
+
+        if (erased_to <= addr) {
+            if (!erase_sector(sector)) {
+                sys_log(ERROR, "Failed to erase flash sector at 0x%08X", (uint32_t)sector->start);
+                return false;
+            }
+            erased_to = sector_end;
+        }
+        // The last piece of the image is padded to a whole burst, the buffer holds 0xFF past the data
+        uint32_t padded = (piece + FW_UPDATE_BURST - 1) & ~(uint32_t)(FW_UPDATE_BURST - 1);
+        if (!program(sector, addr, data + done, padded) || memcmp((const void *)addr, data + done, piece) != 0) {
+            sys_log(ERROR, "Failed to program flash at 0x%08X", addr);
+            return false;
+        }
+        programmed_crc = image_crc16(programmed_crc, (const uint8_t *)addr, piece);
+
+        xSemaphoreTake(status_lock, portMAX_DELAY);
+        status.programmed += piece;
+        xSemaphoreGive(status_lock);
+        done += piece;
+        if (addr + piece == sector_end) {
+            save_checkpoint();
+        }
+    }
+    return true;
+}
+
+/* Writer task side. Erase the next sector while waiting for data, if the write pointer is close to it */
+static void erase_ahead(void) {
+    uint32_t end = image_start + status.size;
+    uint32_t addr = image_start + status.programmed;
+
+    if (!status.active || failed || erased_to >= end || erased_to - addr > FW_UPDATE_ERASE_AHEAD) {
+        return;
+    }
+    const SECTORS *sector = find_sector(erased_to);
+    if (sector == NULL || !erase_sector(sector)) {
+        failed = true;
+        return;
+    }
+    erased_to = (uint32_t)sector->start + sector->length;
+}
+
+static void fw_update_daemon(void *pvParameters) {
+    fw_job job;
+
+    for (;;) {
+        svc_wdt_counter++;
+        if (xQueueReceive(jobs, &job, ONE_SECOND) != pdTRUE) {
+            continue;
+        }
+        flash_lock();
+        if (!failed && !program_job(&job)) {
+            failed = true;
+        }
+        jobs_done++;
+        xSemaphoreGive(job_done);
+        if (uxQueueMessagesWaiting(jobs) == 0) {
+            erase_ahead();
+        }
+        flash_unlock();
+    }
+}
+
+/* Wait until at most pending buffers are waiting for the writer */
+static bool wait_for_writer(uint32_t pending) {
+    while (jobs_queued - jobs_done > pending) {
+        if (xSemaphoreTake(job_done, FW_UPDATE_WAIT) != pdTRUE) {
+            sys_log(ERROR, "Firmware update writer stopped responding");
+            return false;
+        }
+    }
+    return !failed;
+}
+
+/* Hand the buffer being filled to the writer and start filling the other one */
+static bool queue_fill(void) {
+    fw_job job = {fill_buffer, fill};
+
+    memset(&stage[fill_buffer][fill], 0xFF, FW_UPDATE_BUFFER_SIZE - fill);
+    jobs_queued++;
+    xQueueSend(jobs, &job, portMAX_DELAY);
+    fill_buffer ^= 1;
+    fill = 0;
+    return wait_for_writer(1);
+}
+
+static void set_info(image_type target, image_info *info) {
+    if (target == IMAGE_APPLICATION) {
+        eeprom_set_app_info(info);
+    } else {
+        eeprom_set_golden_info(info);
+    }
+}
+
+/* Pick up an interrupted update of the same image, if the part already stored still matches its CRC */
+static uint32_t resume_point(image_type target, uint32_t size, uint16_t crc, uint16_t *stored_crc) {
+    fw_checkpoint checkpoint;
+
+    if (!nv_store_read(NV_KEY_FW_UPDATE, &checkpoint, sizeof(checkpoint), NULL) || checkpoint.target != target ||
+        checkpoint.size != size || checkpoint.crc != crc || checkpoint.stored >= size) {
+        return 0;
+    }
+    if (image_crc16(0, (const uint8_t *)image_start, checkpoint.stored) != checkpoint.stored_crc) {
+        return 0;
+    }
+    *stored_crc = checkpoint.stored_crc;
+    return checkpoint.stored;
+}
+
+/**
+ * @brief
+ *      Start receiving a new image
+ * @details
+ *      Clears the image's image_info, so it won't be booted until the update
+ *      finishes. Resumes an earlier update of the same image if it was cut short
+ * @param target
+ *      Image to replace, only IMAGE_APPLICATION and it must not be running
+ * @param size
+ *      Bytes in the new image
+ * @param crc
+ *      CRC-16 of the new image, as stored in image_info
+ * @param resume_at
+ *      Set to the offset the uplink should start from
+ * @return SAT_returnState
+ *      SATR_ERROR if the image is the golden one, is running or doesn't fit
+ */
+SAT_returnState fw_update_begin(image_type target, uint32_t size, uint16_t crc, uint32_t *resume_at) {
+    boot_info boot = {0};
+    image_info info = {0};
+
+    if (jobs == NULL || target >= IMAGE_COUNT || size == 0) {
+        return SATR_ERROR;
+    }
+    if (target != IMAGE_APPLICATION) {
+        sys_log(WARN, "The golden image shares bank 0 with the bootloader and can't be updated");
+        return SATR_ERROR;
+    }
+    eeprom_get_boot_info(&boot);
+    if (boot.type == APPLICATION) {
+        sys_log(WARN, "Can't update the image that is running");
+        return SATR_ERROR;
+    }
+    uint32_t start = APP_DEFAULT_ADDR;
+    uint32_t limit = FLASH_END;
+    if (size > limit - start) {
+        sys_log(WARN, "Image of %u bytes doesn't fit", size);
+        return SATR_ERROR;
+    }
+    // An update already underway is replaced, let the writer finish what it has first
+    status.active = false;
+    wait_for_writer(0);
+    flash_lock();
+
+    set_info(target, &info);
+    image_start = start;
+    image_crc = crc;
+    failed = false;
+    fill_buffer = 0;
+    fill = 0;
+
+    raise_privilege();
+    Fapi_initializeFlashBanks((uint32_t)SYS_CLK_FREQ);
+    Fapi_enableAutoEccCalculation();
+    reset_privilege();
+
+    programmed_crc = 0;
+    uint32_t resumed = resume_point(target, size, crc, &programmed_crc);
+    // The sector after the resume point may be partly programmed, it is erased again
+    erased_to = start + resumed;
+
+    xSemaphoreTake(status_lock, portMAX_DELAY);
+    status.active = true;
+    status.target = target;
+    status.size = size;
+    status.received = resumed;
+    status.programmed = resumed;
+    status.resumed_at = resumed;
+    xSemaphoreGive(status_lock);
+    flash_unlock();
+    started = xTaskGetTickCount();
+
+    *resume_at = resumed;
+    sys_log(INFO, "Firmware update of %u bytes started at byte %u", size, resumed);
+    return SATR_OK;
+}
+
+/**
+ * @brief
+ *      Add uplinked data to the new image
+ * @details
+ *      Returns once the data is buffered, it is programmed in the background.
+ *      Data below what was already received, as when an update resumes, is skipped
+ * @param offset
+ *      Where in the image the data goes
+ * @param data
+ *      Data to add
+ * @param length
+ *      Bytes in data
+ * @return SAT_returnState
+ *      SATR_ERROR if data is missing before offset, or programming failed
+ */
+SAT_returnState fw_update_write(uint32_t offset, const uint8_t *data, uint32_t length) {
+    if (!status.active || failed || offset > status.received || offset + length > status.size) {
+        return SATR_ERROR;
+    }
+    uint32_t skip = status.received - offset;
+    if (skip >= length) {
+        return SATR_OK;
+    }
+    data += skip;
+    length -= skip;
+
+    while (length > 0) {
+        uint32_t part = FW_UPDATE_BUFFER_SIZE - fill;
+        if (part > length) {
+            part = length;
+        }
+        memcpy(&stage[fill_buffer][fill], data, part);
+        fill += part;
+        data += part;
+        length -= part;
+        xSemaphoreTake(status_lock, portMAX_DELAY);
+        status.received += part;
+        xSemaphoreGive(status_lock);
+        if (fill == FW_UPDATE_BUFFER_SIZE && !queue_fill()) {
+            return SATR_ERROR;
+        }
+    }
+    return SATR_OK;
+}
+
+/**
+ * @brief
+ *      Finish an update
+ * @details
+ *      Waits for the rest of the image to be programmed, then writes its
+ *      image_info if the whole image arrived and matches its CRC
+ * @return SAT_returnState
+ *      SATR_ERROR if the image is incomplete or doesn't match
+ */
+SAT_returnState fw_update_finish(void) {
+    image_info info;
+    bool ok;
+
+    if (!status.active) {
+        return SATR_ERROR;
+    }
+    ok = (fill == 0 || queue_fill()) && wait_for_writer(0);
+    ok = ok && status.programmed == status.size && programmed_crc == image_crc;
+
+    uint32_t elapsed_ms = (xTaskGetTickCount() - started) * portTICK_PERIOD_MS;
+    xSemaphoreTake(status_lock, portMAX_DELAY);
+    status.active = false;
+    xSemaphoreGive(status_lock);
+
+    if (!ok) {
+        sys_log(ERROR, "Firmware update failed at byte %u of %u, CRC 0x%04X", status.programmed, status.size,
+                programmed_crc);
+        return SATR_ERROR;
+    }
+    info.exists = EXISTS_FLAG;
+    info.size = status.size;
+    info.addr = image_start;
+    info.crc = image_crc;
+    set_info(status.target, &info);
+    nv_store_write(NV_KEY_FW_UPDATE, NULL, 0);
+    sys_log(INFO, "Firmware update of %u bytes done in %u ms", status.size, elapsed_ms);
+    return SATR_OK;
+}
+
+static bool delta_output(uint32_t offset, const uint8_t *data, uint32_t length) {
+    return fw_update_write(offset, data, length) == SATR_OK;
+}
+
+/**
+ * @brief
+ *      Start receiving a patch that turns the running image into a new one
+ * @details
+ *      The new image replaces the other image, as with fw_update_begin. A
+ *      patch always starts from its first byte, but the part of the new
+ *      image already programmed by an interrupted update is not programmed again
+ * @param target
+ *      Image to replace, only IMAGE_APPLICATION and it must not be running
+ * @param header
+ *      First FW_DELTA_HEADER_SIZE bytes of the patch
+ * @return SAT_returnState
+ *      SATR_ERROR if the patch is not for the running image
+ */
+SAT_returnState fw_update_begin_delta(image_type target, const uint8_t *header) {
+    fw_delta_header patch;
+    image_info source = {0};
+    uint32_t resume_at;
+
+    if (!fw_delta_parse_header(header, &patch)) {
+        return SATR_ERROR;
+    }
+    if (target == IMAGE_APPLICATION) {
+        eeprom_get_golden_info(&source);
+    } else {
+        eeprom_get_app_info(&source);
+    }
+    if (source.exists != EXISTS_FLAG || source.size != patch.source_size || source.crc != patch.source_crc) {
+        sys_log(WARN, "Firmware patch is for a different image");
+        return SATR_ERROR;
+    }
+    if (fw_update_begin(target, patch.target_size, patch.target_crc, &resume_at) != SATR_OK) {
+        return SATR_ERROR;
+    }
+    fw_delta_init(&delta, &patch, (const uint8_t *)source.addr, delta_output);
+    return SATR_OK;
+}
+
+/**
+ * @brief
+ *      Apply the next piece of a patch
+ * @param data
+ *      Next bytes of the patch, after the header
+ * @param length
+ *      Bytes in data
+ * @param done
+ *      Set once the patch has produced the whole new image, fw_update_finish is next
+ * @return SAT_returnState
+ *      SATR_ERROR if the patch is malformed or programming failed
+ */
+SAT_returnState fw_update_write_delta(const uint8_t *data, uint32_t length, bool *done) {
+    if (!status.active) {
+        return SATR_ERROR;
+    }
+    fw_delta_result result = fw_delta_feed(&delta, data, length);
+    *done = result == FW_DELTA_DONE;
+    return result == FW_DELTA_ERROR ? SATR_ERROR : SATR_OK;
+}
+
+/**
+ * @brief
+ *      Get the progress of the current or last update
+ * @param out
+ *      Where to copy the progress
+ */
+void fw_update_get_status(fw_update_status *out) {
+    if (status_lock == NULL) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    xSemaphoreTake(status_lock, portMAX_DELAY);
+    *out = status;
+    xSemaphoreGive(status_lock);
+}
+
+/**
+ * Start the task that programs uplinked images
+ *
+ * @returns status
+ *   error report of task creation
+ */
+SAT_returnState start_fw_update_daemon(void) {
+    TaskHandle_t update_tsk;
+    taskFunctions update_funcs = {0};
+    update_funcs.getCounterFunction = get_svc_wdt_counter;
+
+    jobs = xQueueCreate(2, sizeof(fw_job));
+    job_done = xSemaphoreCreateBinary();
+    status_lock = xSemaphoreCreateMutex();
+    if (jobs == NULL || job_done == NULL || status_lock == NULL) {
+        return SATR_ERROR;
+    }
+    if (xTaskCreate(fw_update_daemon, "fw_update", FW_UPDATE_STACK_SIZE, NULL, FW_UPDATE_TASK_PRIO, &update_tsk) !=
+        pdPASS) {
+        ex2_log("FAILED TO CREATE TASK fw_update\n");
+        return SATR_ERROR;
+    }
+    ex2_register(update_tsk, update_funcs);
+    ex2_log("Firmware update started\n");
+    return SATR_OK;
+}
@@ -15,6 +15,16 @@
  * @file housekeeping_task.c
  * @author Andrew R. Rooney, Grace Yi
  * @date 2020-07-23
+ *
+ * Housekeeping is collected every HK_SAMPLE_PERIOD_S and checked against the
+ * limits in hk_limits.c, but only stored every HK_STORE_PERIOD_S. Samples
+ * that were not stored are kept in a small RAM ring. When a limit trips,
+ * the ring is stored as the pre-trigger window, and the tripped subsystems
+ * are then sampled and stored every HK_BURST_PERIOD_S for
+ * HK_POST_TRIGGER_S. Only a limit going from in range to tripped starts a
+ * burst, and a burst is never extended, so a limit that keeps tripping
+ * can't flood the housekeeping files. Trips in the HK_BURST_HOLDOFF_S after
+ * a burst are logged but start nothing.
  */
 
 #include <FreeRTOS.h>
@@ -22,12 +32,36 @@
 #include <os_semphr.h>
 #include <os_task.h>
 
+#include "housekeeping/hk_limits.h"
 #include "housekeeping_service.h"
 #include "housekeeping_task.h"
 
 static void *housekeeping_daemon(void *pvParameters);
 SAT_returnState start_housekeeping_daemon(void);
 
+static All_systems_housekeeping history[HK_PRE_TRIGGER_RECORDS];
+static uint8_t history_next = 0;
+static uint8_t history_count = 0;
+static All_systems_housekeeping sample;
+
+static void history_push(const All_systems_housekeeping *hk) {
+    history[history_next] = *hk;
+    history_next = (history_next + 1) % HK_PRE_TRIGGER_RECORDS;
+    if (history_count < HK_PRE_TRIGGER_RECORDS) {
+        history_count++;
+    }
+}
+
+/* Store the samples in the ring, oldest first */
+static void history_store(void) {
+    uint8_t index = (history_next + HK_PRE_TRIGGER_RECORDS - history_count) % HK_PRE_TRIGGER_RECORDS;
+    while (history_count > 0) {
+        store_hk_data(&history[index]);
+        index = (index + 1) % HK_PRE_TRIGGER_RECORDS;
+        history_count--;
+    }
+}
+
 /**
  * Housekeeping task. Query subsystem housekeeping and stores to file.
  *
@@ -35,12 +69,55 @@ SAT_returnState start_housekeeping_daemon(void);
  *    task parameters (not used)
  */
 static void *housekeeping_daemon(void *pvParameters) {
-    uint32_t seconds_delay = 30;
-    TickType_t hk_delay = pdMS_TO_TICKS(1000 * seconds_delay);
+    uint32_t burst_sections = 0; // sections sampled at the burst rate, 0 outside a burst
+    TickType_t burst_end = 0;
+    TickType_t holdoff_end = 0;
+    bool holdoff = false;
+    TickType_t last_full = 0;
+    TickType_t last_store = 0;
+    bool first = true;
+
     for (;;) {
-        // Call housekeeping and have them collect and store data to SD card
-        populate_and_store_hk_data();
-        vTaskDelay(hk_delay);
+        TickType_t now = xTaskGetTickCount();
+        bool full = first || now - last_full >= pdMS_TO_TICKS(1000 * HK_SAMPLE_PERIOD_S);
+        if (full) {
+            last_full = now;
+        }
+        collect_hk_from_devices(&sample, full ? HK_ALL_SECTIONS : burst_sections);
+
+        if (holdoff && (int32_t)(now - holdoff_end) >= 0) {
+            holdoff = false;
+        }
+
+        uint32_t tripped = hk_limits_check(&sample);
+        if (burst_sections != 0) {
+            // Limits that trip during a burst are sampled faster too, but don't lengthen it
+            burst_sections |= tripped;
+        } else if (tripped != 0 && !holdoff) {
+            history_store();
+            burst_sections = tripped;
+            burst_end = now + pdMS_TO_TICKS(1000 * HK_POST_TRIGGER_S);
+        }
+
+        if (burst_sections != 0) {
+            store_hk_data(&sample);
+            last_store = now;
+            if ((int32_t)(now - burst_end) >= 0) {
+                burst_sections = 0;
+                holdoff = true;
+                holdoff_end = now + pdMS_TO_TICKS(1000 * HK_BURST_HOLDOFF_S);
+            }
+        } else if (first || now - last_store >= pdMS_TO_TICKS(1000 * HK_STORE_PERIOD_S)) {
+            // Everything in the ring is older than this, so it no longer belongs to a pre-trigger window
+            store_hk_data(&sample);
+            last_store = now;
+            history_count = 0;
+        } else {
+            history_push(&sample);
+        }
+
+        first = false;
+        vTaskDelay(pdMS_TO_TICKS(1000 * (burst_sections != 0 ? HK_BURST_PERIOD_S : HK_SAMPLE_PERIOD_S)));
     }
 }
 
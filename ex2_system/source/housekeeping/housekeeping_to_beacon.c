@@ -18,6 +18,133 @@
  */
 #include "housekeeping_to_beacon.h"
 
+#include <stddef.h>
+
+/* A beacon field filled straight from a housekeeping field, truncated or zero extended to fit */
+typedef struct {
+    uint8_t packet;    // 1 or 2
+    uint8_t dst;       // offset in the beacon packet
+    uint8_t dst_width; // bytes per element
+    uint16_t src;      // offset in All_systems_housekeeping
+    uint8_t src_width; // bytes per element
+    uint8_t count;
+} beacon_field_t;
+
+#define HK_FIELD(src) (((All_systems_housekeeping *)0)->src)
+#define BEACON_PACKET(n) beacon_packet_##n##_t
+
+#define BEACON_FIELD(n, dst, src)                                                                                 \
+    {n, offsetof(BEACON_PACKET(n), dst), sizeof(((BEACON_PACKET(n) *)0)->dst),                                    \
+     offsetof(All_systems_housekeeping, src), sizeof(HK_FIELD(src)), 1}
+#define BEACON_ARRAY(n, dst, src, count)                                                                          \
+    {n, offsetof(BEACON_PACKET(n), dst), sizeof(((BEACON_PACKET(n) *)0)->dst[0]),                                 \
+     offsetof(All_systems_housekeeping, src), sizeof(HK_FIELD(src)[0]), count}
+
+static const beacon_field_t beacon_map[] = {
+    BEACON_FIELD(1, time, hk_timeorder.UNIXtimestamp),
+    /*-------EPS-------*/
+    BEACON_FIELD(1, eps_mode, EPS_hk.battMode),
+    BEACON_FIELD(1, battery_voltage, EPS_hk.vBatt),
+    BEACON_FIELD(1, battery_input_current, EPS_hk.curBattIn),
+    BEACON_ARRAY(1, current_channels, EPS_hk.curOutput, 10),
+    BEACON_FIELD(1, output_states, EPS_hk.outputStatus),
+    BEACON_ARRAY(1, output_faults, EPS_hk.outputFaultCnt, 10),
+    BEACON_FIELD(1, EPS_boot_count, EPS_hk.bootCnt),
+    /*-------Watchdog-------*/
+    // TODO: More work to be done on watchdogs, using temporary placeholders from hk data
+    BEACON_FIELD(1, gs_wdt, EPS_hk.vBatt),
+    BEACON_FIELD(1, obc_wdt, EPS_hk.outputConverterState),
+    BEACON_FIELD(1, gs_wdt_expr, EPS_hk.vBatt),
+    BEACON_FIELD(1, obc_wdt_expr, EPS_hk.outputConverterState),
+    /*-------Temperatures-------*/
+    // Onboard battery pack temp location defined in ICD
+    BEACON_FIELD(1, temps[0], EPS_hk.temp[8]),
+    BEACON_FIELD(1, temps[4], hyperion_hk.Nadir_Temp1),
+    BEACON_FIELD(1, temps[5], hyperion_hk.Zenith_Temp1),
+    BEACON_FIELD(1, temps[6], hyperion_hk.Port_Temp1),
+    BEACON_FIELD(1, temps[7], hyperion_hk.Star_Temp1),
+    /*-------UHF-------*/
+    // Convert uint32_t to uint16_t, seconds = UHF_uptime*10. Max = 655350 seconds (7.6 days)
+    BEACON_FIELD(1, uhf_uptime, UHF_hk.uptime),
+
+    BEACON_FIELD(2, time, hk_timeorder.UNIXtimestamp),
+    /*-------OBC-------*/
+    // TODO: write missing drivers and functions for OBC/athena housekeeping
+    BEACON_FIELD(2, obc_boot_count, Athena_hk.boot_cnt),
+    BEACON_FIELD(2, obc_last_reset_reason, Athena_hk.last_reset_reason),
+    BEACON_FIELD(2, obc_mode, Athena_hk.OBC_mode),
+    // Unit will be deca-seconds due to size restraint, seconds = OBC_uptime*10
+    BEACON_FIELD(2, obc_uptime, Athena_hk.OBC_uptime),
+    BEACON_FIELD(2, solar_panel_current, Athena_hk.solar_panel_supply_curr),
+    BEACON_FIELD(2, obc_software_version, Athena_hk.OBC_software_ver),
+    BEACON_FIELD(2, commands_received, Athena_hk.cmds_received),
+    BEACON_FIELD(2, fec_recovered_packets, Athena_hk.pckts_uncovered_by_FEC),
+    /*-------Logged Items-------*/
+    // TODO: write the function for logged items in beacon_task
+    BEACON_FIELD(2, log1_timestamp, EPS_hk.outputConverterState),
+    BEACON_FIELD(2, log1_code, EPS_hk.outputConverterState),
+    BEACON_FIELD(2, log2_timestamp, EPS_hk.outputConverterState),
+    BEACON_FIELD(2, log2_code, EPS_hk.outputConverterState),
+    BEACON_FIELD(2, log3_timestamp, EPS_hk.outputConverterState),
+    BEACON_FIELD(2, log3_code, EPS_hk.outputConverterState),
+    BEACON_FIELD(2, log4_timestamp, EPS_hk.outputConverterState),
+    BEACON_FIELD(2, log4_code, EPS_hk.outputConverterState),
+    BEACON_FIELD(2, log5_timestamp, EPS_hk.outputConverterState),
+    BEACON_FIELD(2, log5_code, EPS_hk.outputConverterState),
+    BEACON_FIELD(2, log6_timestamp, EPS_hk.outputConverterState),
+    BEACON_FIELD(2, log6_code, EPS_hk.outputConverterState),
+};
+
+static uint32_t read_value(const uint8_t *p, uint8_t width) {
+    uint8_t u8;
+    uint16_t u16;
+    uint32_t u32;
+    switch (width) {
+    case 1:
+        memcpy(&u8, p, sizeof(u8));
+        return u8;
+    case 2:
+        memcpy(&u16, p, sizeof(u16));
+        return u16;
+    default:
+        memcpy(&u32, p, sizeof(u32));
+        return u32;
+    }
+}
+
+static void write_value(uint8_t *p, uint8_t width, uint32_t value) {
+    uint8_t u8 = (uint8_t)value;
+    uint16_t u16 = (uint16_t)value;
+    switch (width) {
+    case 1:
+        memcpy(p, &u8, sizeof(u8));
+        break;
+    case 2:
+        memcpy(p, &u16, sizeof(u16));
+        break;
+    default:
+        memcpy(p, &value, sizeof(value));
+        break;
+    }
+}
+
+/* Fill every field in beacon_map. Fields that need more than a copy are done in update_beacon() */
+static void copy_beacon_map(All_systems_housekeeping *all_hk_data, beacon_packet_1_t *beacon_packet_one,
+                            beacon_packet_2_t *beacon_packet_two) {
+    const uint8_t *hk = (const uint8_t *)all_hk_data;
+    size_t i;
+    for (i = 0; i < sizeof(beacon_map) / sizeof(beacon_map[0]); i++) {
+        const beacon_field_t *field = &beacon_map[i];
+        uint8_t *dst = field->packet == 1 ? (uint8_t *)beacon_packet_one : (uint8_t *)beacon_packet_two;
+        const uint8_t *src = hk + field->src;
+        uint8_t n;
+        dst += field->dst;
+        for (n = 0; n < field->count; n++, dst += field->dst_width, src += field->src_width) {
+            write_value(dst, field->dst_width, read_value(src, field->src_width));
+        }
+    }
+}
+
 /**
  * @brief
  *      Updates the beacon packet with the latest housekeeping data
@@ -37,27 +164,11 @@ void update_beacon(All_systems_housekeeping *all_hk_data, beacon_packet_1_t *bea
     // get the unix time from RTC, and convert it to a struct using RTCMK_GetUnix
     // RTCMK_GetUnix(&(beacon_packet.time));
 
-    beacon_packet_one->time = all_hk_data->hk_timeorder.UNIXtimestamp;
-    beacon_packet_two->time = all_hk_data->hk_timeorder.UNIXtimestamp;
+    copy_beacon_map(all_hk_data, beacon_packet_one, beacon_packet_two);
     beacon_packet_one->packet_number = 1;
     beacon_packet_two->packet_number = 2;
 
     /*-------EPS-------*/
-    beacon_packet_one->eps_mode = all_hk_data->EPS_hk.battMode;
-    beacon_packet_one->battery_voltage = all_hk_data->EPS_hk.vBatt;
-    beacon_packet_one->battery_input_current = all_hk_data->EPS_hk.curBattIn;
-    uint16_t current_channels_array_length[10];
-    memcpy(&(beacon_packet_one->current_channels), &(all_hk_data->EPS_hk.curOutput),
-           sizeof(current_channels_array_length));
-
-    beacon_packet_one->output_states = all_hk_data->EPS_hk.outputStatus;
-
-    uint16_t output_faults_array_length[10];
-    memcpy(&(beacon_packet_one->output_faults), &(all_hk_data->EPS_hk.outputFaultCnt),
-           sizeof(output_faults_array_length));
-
-    beacon_packet_one->EPS_boot_count = all_hk_data->EPS_hk.bootCnt;
-
     // Last EPS reset reason
     typedef enum {
         Power_on = 0, // After power supply removal or hard reset
@@ -84,18 +195,8 @@ void update_beacon(All_systems_housekeeping *all_hk_data, beacon_packet_1_t *bea
     // TEST: eps_last_reset_reason added, define the function based on EPS ICD manual
     beacon_packet_one->eps_last_reset_reason = EPS_last_reset_reason;
 
-    /*-------Watchdog-------*/
-    // TODO: More work to be done on watchdogs, using temporary placeholders from hk data
-    beacon_packet_one->gs_wdt = all_hk_data->EPS_hk.vBatt;
-    beacon_packet_one->obc_wdt = all_hk_data->EPS_hk.outputConverterState;
-    beacon_packet_one->gs_wdt_expr = all_hk_data->EPS_hk.vBatt;
-    beacon_packet_one->obc_wdt_expr = all_hk_data->EPS_hk.outputConverterState;
-
     /*-------Temperatures-------*/
     // TODO: more temp data was added to beacon from hk, review temp fields before finalizing beacon struct
-    // Onboard battery pack temp location defined in ICD
-    beacon_packet_one->temps[0] = all_hk_data->EPS_hk.temp[8];
-
     // TODO: Athena MCU temperature should not be stored as long data type since data size can change depending on
     // the computer
     //      should stick with int64_t format. Change the temp driver to fix this.
@@ -126,11 +227,6 @@ void update_beacon(All_systems_housekeeping *all_hk_data, beacon_packet_1_t *bea
     // TODO: write a function/preprocesor to determine 2U or 3U, and then fetch payload temp with CAN protocol
     // memcpy(&(beacon_packet.temps[3]), &(all_hk_data->payload_hk.payload_temp), sizeof(int8_t));
 
-    beacon_packet_one->temps[4] = all_hk_data->hyperion_hk.Nadir_Temp1;
-    beacon_packet_one->temps[5] = all_hk_data->hyperion_hk.Zenith_Temp1;
-    beacon_packet_one->temps[6] = all_hk_data->hyperion_hk.Port_Temp1;
-    beacon_packet_one->temps[7] = all_hk_data->hyperion_hk.Star_Temp1;
-
     /*-------ADCS-------*/
 #ifndef ADCS_IS_STUBBED
     // Of the x, y, and z angular rates, use the maximum angular rate
@@ -145,41 +241,8 @@ void update_beacon(All_systems_housekeeping *all_hk_data, beacon_packet_1_t *bea
     beacon_packet_one->adcs_control_mode = adcs_current_hk.att_ctrl_mode;
 #endif /*ADCS_IS_STUBBED*/
 
-    /*-------UHF-------*/
-    // Convert uint32_t to uint16_t, seconds = UHF_uptime*10. Max = 655350 seconds (7.6 days)
-    uint16_t UHF_uptime = all_hk_data->UHF_hk.uptime;
-    beacon_packet_one->uhf_uptime = UHF_uptime;
-
     /*-------Payload-------*/
     // TODO: Write payload driver to get payload software version and temp
     // memcpy(&(beacon_packet.payload_software_ver), &(all_hk_data->payload_hk.payload_software_ver),
     // sizeof(uint8_t));
-
-    /*-------OBC-------*/
-    // TODO: write missing drivers and functions for OBC/athena housekeeping
-    beacon_packet_two->obc_boot_count = all_hk_data->Athena_hk.boot_cnt;
-    beacon_packet_two->obc_last_reset_reason = all_hk_data->Athena_hk.last_reset_reason;
-    beacon_packet_two->obc_mode = all_hk_data->Athena_hk.OBC_mode;
-
-    // Unit will be deca-seconds due to size restraint, seconds = OBC_uptime*10
-    beacon_packet_two->obc_uptime = all_hk_data->Athena_hk.OBC_uptime;
-    beacon_packet_two->solar_panel_current = all_hk_data->Athena_hk.solar_panel_supply_curr;
-    beacon_packet_two->obc_software_version = all_hk_data->Athena_hk.OBC_software_ver;
-    beacon_packet_two->commands_received = all_hk_data->Athena_hk.cmds_received;
-    beacon_packet_two->fec_recovered_packets = all_hk_data->Athena_hk.pckts_uncovered_by_FEC;
-
-    /*-------Logged Items-------*/
-    // TODO: write the function for logged items in beacon_task
-    beacon_packet_two->log1_timestamp = all_hk_data->EPS_hk.outputConverterState;
-    beacon_packet_two->log1_code = all_hk_data->EPS_hk.outputConverterState;
-    beacon_packet_two->log2_timestamp = all_hk_data->EPS_hk.outputConverterState;
-    beacon_packet_two->log2_code = all_hk_data->EPS_hk.outputConverterState;
-    beacon_packet_two->log3_timestamp = all_hk_data->EPS_hk.outputConverterState;
-    beacon_packet_two->log3_code = all_hk_data->EPS_hk.outputConverterState;
-    beacon_packet_two->log4_timestamp = all_hk_data->EPS_hk.outputConverterState;
-    beacon_packet_two->log4_code = all_hk_data->EPS_hk.outputConverterState;
-    beacon_packet_two->log5_timestamp = all_hk_data->EPS_hk.outputConverterState;
-    beacon_packet_two->log5_code = all_hk_data->EPS_hk.outputConverterState;
-    beacon_packet_two->log6_timestamp = all_hk_data->EPS_hk.outputConverterState;
-    beacon_packet_two->log6_code = all_hk_data->EPS_hk.outputConverterState;
 }
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file image_crc.c
+ * @date Oct. 19, 2026
+ *
+ * Table driven software CRCs used to check flash images.
+ *
+ * image_crc16 is the CRC-16 (polynomial 0x1021, seed 0) stored with each
+ * image in its image_info. image_crc64 is the CRC-64 (polynomial 0x1B, seed
+ * 0, most significant bit first) that the TMS570 CRC module computes, so it
+ * can finish a signature the hardware started or stand in for it on a host.
+ * Both take the CRC so far, so data can be added in pieces.
+ */
+
+#include "image_verify/image_crc.h"
+
+static const uint16_t crc16_table[256] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+    0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+    0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+    0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+    0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+    0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+    0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+    0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+    0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+    0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+    0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+    0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+    0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+    0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+    0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+    0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+    0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+    0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+    0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+    0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+    0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+    0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+    0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+    0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+    0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+    0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+    0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+    0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+    0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+    0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0,
+};
+
+static const uint64_t crc64_table[256] = {
+    0x0000000000000000ULL, 0x000000000000001BULL, 0x0000000000000036ULL, 0x000000000000002DULL,
+    0x000000000000006CULL, 0x0000000000000077ULL, 0x000000000000005AULL, 0x0000000000000041ULL,
+    0x00000000000000D8ULL, 0x00000000000000C3ULL, 0x00000000000000EEULL, 0x00000000000000F5ULL,
+    0x00000000000000B4ULL, 0x00000000000000AFULL, 0x0000000000000082ULL, 0x0000000000000099ULL,
+    0x00000000000001B0ULL, 0x00000000000001ABULL, 0x0000000000000186ULL, 0x000000000000019DULL,
+    0x00000000000001DCULL, 0x00000000000001C7ULL, 0x00000000000001EAULL, 0x00000000000001F1ULL,
+    0x0000000000000168ULL, 0x0000000000000173ULL, 0x000000000000015EULL, 0x0000000000000145ULL,
+    0x0000000000000104ULL, 0x000000000000011FULL, 0x0000000000000132ULL, 0x0000000000000129ULL,
+    0x0000000000000360ULL, 0x000000000000037BULL, 0x0000000000000356ULL, 0x000000000000034DULL,
+    0x000000000000030CULL, 0x0000000000000317ULL, 0x000000000000033AULL, 0x0000000000000321ULL,
+    0x00000000000003B8ULL, 0x00000000000003A3ULL, 0x000000000000038EULL, 0x0000000000000395ULL,
+    0x00000000000003D4ULL, 0x00000000000003CFULL, 0x00000000000003E2ULL, 0x00000000000003F9ULL,
+    0x00000000000002D0ULL, 0x00000000000002CBULL, 0x00000000000002E6ULL, 0x00000000000002FDULL,
+    0x00000000000002BCULL, 0x00000000000002A7ULL, 0x000000000000028AULL, 0x0000000000000291ULL,
+    0x0000000000000208ULL, 0x0000000000000213ULL, 0x000000000000023EULL, 0x0000000000000225ULL,
+    0x0000000000000264ULL, 0x000000000000027FULL, 0x0000000000000252ULL, 0x0000000000000249ULL,
+    0x00000000000006C0ULL, 0x00000000000006DBULL, 0x00000000000006F6ULL, 0x00000000000006EDULL,
+    0x00000000000006ACULL, 0x00000000000006B7ULL, 0x000000000000069AULL, 0x0000000000000681ULL,
+    0x0000000000000618ULL, 0x0000000000000603ULL, 0x000000000000062EULL, 0x0000000000000635ULL,
+    0x0000000000000674ULL, 0x000000000000066FULL, 0x0000000000000642ULL, 0x0000000000000659ULL,
+    0x0000000000000770ULL, 0x000000000000076BULL, 0x0000000000000746ULL, 0x000000000000075DULL,
+    0x000000000000071CULL, 0x0000000000000707ULL, 0x000000000000072AULL, 0x0000000000000731ULL,
+    0x00000000000007A8ULL, 0x00000000000007B3ULL, 0x000000000000079EULL, 0x0000000000000785ULL,
+    0x00000000000007C4ULL, 0x00000000000007DFULL, 0x00000000000007F2ULL, 0x00000000000007E9ULL,
+    0x00000000000005A0ULL, 0x00000000000005BBULL, 0x0000000000000596ULL, 0x000000000000058DULL,
+    0x00000000000005CCULL, 0x00000000000005D7ULL, 0x00000000000005FAULL, 0x00000000000005E1ULL,
+    0x0000000000000578ULL, 0x0000000000000563ULL, 0x000000000000054EULL, 0x0000000000000555ULL,
+    0x0000000000000514ULL, 0x000000000000050FULL, 0x0000000000000522ULL, 0x0000000000000539ULL,
+    0x0000000000000410ULL, 0x000000000000040BULL, 0x0000000000000426ULL, 0x000000000000043DULL,
+    0x000000000000047CULL, 0x0000000000000467ULL, 0x000000000000044AULL, 0x0000000000000451ULL,
+    0x00000000000004C8ULL, 0x00000000000004D3ULL, 0x00000000000004FEULL, 0x00000000000004E5ULL,
+    0x00000000000004A4ULL, 0x00000000000004BFULL, 0x0000000000000492ULL, 0x0000000000000489ULL,
+    0x0000000000000D80ULL, 0x0000000000000D9BULL, 0x0000000000000DB6ULL, 0x0000000000000DADULL,
+    0x0000000000000DECULL, 0x0000000000000DF7ULL, 0x0000000000000DDAULL, 0x0000000000000DC1ULL,
+    0x0000000000000D58ULL, 0x0000000000000D43ULL, 0x0000000000000D6EULL, 0x0000000000000D75ULL,
+    0x0000000000000D34ULL, 0x0000000000000D2FULL, 0x0000000000000D02ULL, 0x0000000000000D19ULL,
+    0x0000000000000C30ULL, 0x0000000000000C2BULL, 0x0000000000000C06ULL, 0x0000000000000C1DULL,
+    0x0000000000000C5CULL, 0x0000000000000C47ULL, 0x0000000000000C6AULL, 0x0000000000000C71ULL,
+    0x0000000000000CE8ULL, 0x0000000000000CF3ULL, 0x0000000000000CDEULL, 0x0000000000000CC5ULL,
+    0x0000000000000C84ULL, 0x0000000000000C9FULL, 0x0000000000000CB2ULL, 0x0000000000000CA9ULL,
+    0x0000000000000EE0ULL, 0x0000000000000EFBULL, 0x0000000000000ED6ULL, 0x0000000000000ECDULL,
+    0x0000000000000E8CULL, 0x0000000000000E97ULL, 0x0000000000000EBAULL, 0x0000000000000EA1ULL,
+    0x0000000000000E38ULL, 0x0000000000000E23ULL, 0x0000000000000E0EULL, 0x0000000000000E15ULL,
+    0x0000000000000E54ULL, 0x0000000000000E4FULL, 0x0000000000000E62ULL, 0x0000000000000E79ULL,
+    0x0000000000000F50ULL, 0x0000000000000F4BULL, 0x0000000000000F66ULL, 0x0000000000000F7DULL,
+    0x0000000000000F3CULL, 0x0000000000000F27ULL, 0x0000000000000F0AULL, 0x0000000000000F11ULL,
+    0x0000000000000F88ULL, 0x0000000000000F93ULL, 0x0000000000000FBEULL, 0x0000000000000FA5ULL,
+    0x0000000000000FE4ULL, 0x0000000000000FFFULL, 0x0000000000000FD2ULL, 0x0000000000000FC9ULL,
+    0x0000000000000B40ULL, 0x0000000000000B5BULL, 0x0000000000000B76ULL, 0x0000000000000B6DULL,
+    0x0000000000000B2CULL, 0x0000000000000B37ULL, 0x0000000000000B1AULL, 0x0000000000000B01ULL,
+    0x0000000000000B98ULL, 0x0000000000000B83ULL, 0x0000000000000BAEULL, 0x0000000000000BB5ULL,
+    0x0000000000000BF4ULL, 0x0000000000000BEFULL, 0x0000000000000BC2ULL, 0x0000000000000BD9ULL,
+    0x0000000000000AF0ULL, 0x0000000000000AEBULL, 0x0000000000000AC6ULL, 0x0000000000000ADDULL,
+    0x0000000000000A9CULL, 0x0000000000000A87ULL, 0x0000000000000AAAULL, 0x0000000000000AB1ULL,
+    0x0000000000000A28ULL, 0x0000000000000A33ULL, 0x0000000000000A1EULL, 0x0000000000000A05ULL,
+    0x0000000000000A44ULL, 0x0000000000000A5FULL, 0x0000000000000A72ULL, 0x0000000000000A69ULL,
+    0x0000000000000820ULL, 0x000000000000083BULL, 0x0000000000000816ULL, 0x000000000000080DULL,
+    0x000000000000084CULL, 0x0000000000000857ULL, 0x000000000000087AULL, 0x0000000000000861ULL,
+    0x00000000000008F8ULL, 0x00000000000008E3ULL, 0x00000000000008CEULL, 0x00000000000008D5ULL,
+    0x0000000000000894ULL, 0x000000000000088FULL, 0x00000000000008A2ULL, 0x00000000000008B9ULL,
+    0x0000000000000990ULL, 0x000000000000098BULL, 0x00000000000009A6ULL, 0x00000000000009BDULL,
+    0x00000000000009FCULL, 0x00000000000009E7ULL, 0x00000000000009CAULL, 0x00000000000009D1ULL,
+    0x0000000000000948ULL, 0x0000000000000953ULL, 0x000000000000097EULL, 0x0000000000000965ULL,
+    0x0000000000000924ULL, 0x000000000000093FULL, 0x0000000000000912ULL, 0x0000000000000909ULL,
+};
+
+/**
+ * @brief
+ *      Continue a CRC-16 over more data
+ * @param crc
+ *      CRC of the data so far, 0 to start
+ * @param data
+ *      Data to add
+ * @param length
+ *      Number of bytes in data
+ * @return
+ *      CRC of all the data
+ */
+uint16_t image_crc16(uint16_t crc, const uint8_t *data, uint32_t length) {
+    while (length--) {
+        crc = (uint16_t)(crc << 8) ^ crc16_table[(uint8_t)(crc >> 8) ^ *data++];
+    }
+    return crc;
+}
+
+/**
+ * @brief
+ *      Continue a CRC-64 over more data
+ * @details
+ *      Matches the PSA signature of the CRC module fed the same bytes as
+ *      big-endian 64 bit words
+ * @param crc
+ *      CRC of the data so far, 0 to start
+ * @param data
+ *      Data to add
+ * @param length
+ *      Number of bytes in data
+ * @return
+ *      CRC of all the data
+ */
+uint64_t image_crc64(uint64_t crc, const uint8_t *data, uint32_t length) {
+    while (length--) {
+        crc = (crc << 8) ^ crc64_table[(uint8_t)(crc >> 56) ^ *data++];
+    }
+    return crc;
+}
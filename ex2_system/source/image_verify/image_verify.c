@@ -0,0 +1,303 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file image_verify.c
+ * @date Oct. 19, 2026
+ *
+ * Verification of the application and golden images in flash.
+ *
+ * The CRC stored with an image is a CRC-16, which can only be computed in
+ * software. The first time an image passes that check, the CRC-64 signature
+ * the CRC module computes for it is saved in nv_store with a copy of the
+ * image_info it belongs to. Later checks of the same image only need the
+ * hardware signature, with the CPU writing 64 bit words straight into the
+ * PSA register. An image whose image_info changed gets the full check again.
+ *
+ * Checks run a chunk at a time. image_verify uses CRC channel 1 and runs a
+ * check to the end. The daemon uses channel 2 to check the image that is not
+ * running, a chunk at a time with a pause between chunks.
+ */
+
+#include "image_verify/image_verify.h"
+
+#include <FreeRTOS.h>
+#include <os_semphr.h>
+#include <os_task.h>
+#include <string.h>
+
+#include "HL_crc.h"
+#include "eeprom.h"
+#include "image_verify/image_crc.h"
+#include "logger/logger.h"
+#include "nv_store/nv_store.h"
+#include "task_manager/task_manager.h"
+
+typedef struct __attribute__((packed)) {
+    uint32_t exists; // EXISTS_FLAG once a signature was taken
+    image_info info; // image the signature was taken for
+    uint64_t crc64;
+} image_signature;
+
+static const char *const image_names[IMAGE_COUNT] = {"application", "golden"};
+static const nv_key signature_keys[IMAGE_COUNT] = {NV_KEY_APP_SIGNATURE, NV_KEY_GOLDEN_SIGNATURE};
+
+static image_verify_status status[IMAGE_COUNT];
+static SemaphoreHandle_t verify_lock = NULL;     // guards status and the saved signatures
+static SemaphoreHandle_t foreground_lock = NULL; // held by image_verify while it owns CRC channel 1
+
+static uint32_t svc_wdt_counter = 0;
+
+static uint32_t get_svc_wdt_counter() { return svc_wdt_counter; }
+
+static void prv_init(void) {
+    if (verify_lock == NULL) {
+        verify_lock = xSemaphoreCreateMutex();
+        foreground_lock = xSemaphoreCreateMutex();
+#if IMAGE_VERIFY_HW_CRC == 1
+        crcInit();
+#endif
+    }
+}
+
+static void get_info(image_type type, image_info *info) {
+    if (type == IMAGE_APPLICATION) {
+        eeprom_get_app_info(info);
+    } else {
+        eeprom_get_golden_info(info);
+    }
+}
+
+static void record(image_type type, image_state state, bool signature, uint32_t elapsed_ms) {
+    xSemaphoreTake(verify_lock, portMAX_DELAY);
+    status[type].state = state;
+    status[type].signature = signature;
+    status[type].elapsed_ms = elapsed_ms;
+    status[type].checked_at = xTaskGetTickCount() / configTICK_RATE_HZ;
+    xSemaphoreGive(verify_lock);
+}
+
+/* Must hold verify_lock */
+static void save_signature(image_type type, const image_info *info, uint64_t crc64) {
+    image_signature signature;
+    signature.exists = EXISTS_FLAG;
+    signature.info = *info;
+    signature.crc64 = crc64;
+    if (!nv_store_write(signature_keys[type], &signature, sizeof(signature))) {
+        sys_log(ERROR, "Failed to save %s image signature", image_names[type]);
+    }
+}
+
+/**
+ * @brief
+ *      Start checking an image
+ * @param ctx
+ *      Check to start
+ * @param type
+ *      Image to check
+ * @param channel
+ *      CRC module channel to use, CRC_CH1 or CRC_CH2. Only one check may use a channel at once
+ * @return
+ *      IMAGE_MISSING if there is no image to check, otherwise IMAGE_UNCHECKED
+ */
+image_state image_verify_begin(image_verify_ctx *ctx, image_type type, uint32_t channel) {
+    image_signature signature = {0};
+
+    prv_init();
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->type = type;
+    ctx->channel = channel;
+    ctx->start = xTaskGetTickCount();
+    get_info(type, &ctx->info);
+    if (ctx->info.exists != EXISTS_FLAG) {
+        record(type, IMAGE_MISSING, false, 0);
+        return IMAGE_MISSING;
+    }
+
+    xSemaphoreTake(verify_lock, portMAX_DELAY);
+    nv_store_read(signature_keys[type], &signature, sizeof(signature), NULL);
+    xSemaphoreGive(verify_lock);
+    if (signature.exists == EXISTS_FLAG && memcmp(&signature.info, &ctx->info, sizeof(image_info)) == 0) {
+        ctx->signature = signature.crc64;
+    } else {
+        ctx->full = true;
+    }
+
+    ctx->next = (const uint8_t *)ctx->info.addr;
+    ctx->remaining = ctx->info.size;
+#if IMAGE_VERIFY_HW_CRC == 1
+    crcChannelReset(crcREG1, channel);
+#endif
+    return IMAGE_UNCHECKED;
+}
+
+/**
+ * @brief
+ *      Check the next part of an image
+ * @param ctx
+ *      Check started by image_verify_begin
+ * @param max_bytes
+ *      Most bytes to check, a multiple of 8
+ * @return
+ *      true once image_verify_end can be called
+ */
+bool image_verify_step(image_verify_ctx *ctx, uint32_t max_bytes) {
+    uint32_t words = (ctx->remaining < max_bytes ? ctx->remaining : max_bytes) / sizeof(uint64_t);
+    uint32_t length = words * sizeof(uint64_t);
+
+    if (words != 0) {
+#if IMAGE_VERIFY_HW_CRC == 1
+        crcModConfig_t config = {CRC_FULL_CPU, ctx->channel, (uint64 *)ctx->next, words};
+        crcSignGen(crcREG1, &config);
+#else
+        ctx->crc64 = image_crc64(ctx->crc64, ctx->next, length);
+#endif
+        if (ctx->full) {
+            ctx->crc16 = image_crc16(ctx->crc16, ctx->next, length);
+        }
+        ctx->next += length;
+        ctx->remaining -= length;
+    }
+    return ctx->remaining < sizeof(uint64_t);
+}
+
+/**
+ * @brief
+ *      Finish checking an image and record the result
+ * @details
+ *      Saves the image's signature if it passed a full check
+ * @param ctx
+ *      Check for which image_verify_step returned true
+ * @return
+ *      IMAGE_VALID or IMAGE_INVALID
+ */
+image_state image_verify_end(image_verify_ctx *ctx) {
+#if IMAGE_VERIFY_HW_CRC == 1
+    uint64_t crc64 = crcGetPSASig(crcREG1, ctx->channel);
+#else
+    uint64_t crc64 = ctx->crc64;
+#endif
+    // The CRC module only takes whole words, the last few bytes are added in software
+    crc64 = image_crc64(crc64, ctx->next, ctx->remaining);
+
+    bool valid;
+    if (ctx->full) {
+        ctx->crc16 = image_crc16(ctx->crc16, ctx->next, ctx->remaining);
+        valid = ctx->crc16 == ctx->info.crc;
+        if (valid) {
+            xSemaphoreTake(verify_lock, portMAX_DELAY);
+            save_signature(ctx->type, &ctx->info, crc64);
+            xSemaphoreGive(verify_lock);
+        }
+    } else {
+        valid = crc64 == ctx->signature;
+    }
+
+    uint32_t elapsed_ms = (xTaskGetTickCount() - ctx->start) * portTICK_PERIOD_MS;
+    image_state state = valid ? IMAGE_VALID : IMAGE_INVALID;
+    record(ctx->type, state, !ctx->full, elapsed_ms);
+    sys_log(valid ? INFO : ERROR, "%s image %s, %s check of %u bytes took %u ms", image_names[ctx->type],
+            valid ? "valid" : "INVALID", ctx->full ? "full" : "signature", ctx->info.size, elapsed_ms);
+    return state;
+}
+
+/**
+ * @brief
+ *      Check an image from start to end
+ * @param type
+ *      Image to check
+ * @return
+ *      IMAGE_VALID, IMAGE_INVALID or IMAGE_MISSING
+ */
+image_state image_verify(image_type type) {
+    image_verify_ctx ctx;
+    image_state state;
+
+    prv_init();
+    xSemaphoreTake(foreground_lock, portMAX_DELAY);
+    state = image_verify_begin(&ctx, type, CRC_CH1);
+    if (state != IMAGE_MISSING) {
+        while (!image_verify_step(&ctx, IMAGE_VERIFY_CHUNK)) {
+        }
+        state = image_verify_end(&ctx);
+    }
+    xSemaphoreGive(foreground_lock);
+    return state;
+}
+
+/**
+ * @brief
+ *      Get the result of the last check of an image
+ * @param type
+ *      Image to get
+ * @param out
+ *      Where to copy the result
+ */
+void image_verify_get_status(image_type type, image_verify_status *out) {
+    prv_init();
+    xSemaphoreTake(verify_lock, portMAX_DELAY);
+    *out = status[type];
+    xSemaphoreGive(verify_lock);
+}
+
+static void image_verify_daemon(void *pvParameters) {
+    image_verify_ctx ctx;
+    boot_info info = {0};
+    TickType_t waited;
+
+    eeprom_get_boot_info(&info);
+    image_type inactive = info.type == GOLDEN ? IMAGE_APPLICATION : IMAGE_GOLDEN;
+    TickType_t delay = IMAGE_VERIFY_START_DELAY;
+
+    for (;;) {
+        for (waited = 0; waited < delay; waited += ONE_MINUTE) {
+            svc_wdt_counter++;
+            vTaskDelay(ONE_MINUTE);
+        }
+        delay = IMAGE_VERIFY_PERIOD;
+
+        if (image_verify_begin(&ctx, inactive, CRC_CH2) == IMAGE_MISSING) {
+            continue;
+        }
+        while (!image_verify_step(&ctx, IMAGE_VERIFY_CHUNK)) {
+            svc_wdt_counter++;
+            vTaskDelay(IMAGE_VERIFY_CHUNK_DELAY);
+        }
+        image_verify_end(&ctx);
+    }
+}
+
+/**
+ * Start the daemon that checks the image not running
+ *
+ * @returns status
+ *   error report of task creation
+ */
+SAT_returnState start_image_verify_daemon(void) {
+    TaskHandle_t verify_tsk;
+    taskFunctions verify_funcs = {0};
+    verify_funcs.getCounterFunction = get_svc_wdt_counter;
+
+    prv_init();
+    if (verify_lock == NULL || foreground_lock == NULL) {
+        return SATR_ERROR;
+    }
+    if (xTaskCreate(image_verify_daemon, "image_verify", IMAGE_VERIFY_STACK_SIZE, NULL, IMAGE_VERIFY_TASK_PRIO,
+                    &verify_tsk) != pdPASS) {
+        ex2_log("FAILED TO CREATE TASK image_verify\n");
+        return SATR_ERROR;
+    }
+    ex2_register(verify_tsk, verify_funcs);
+    ex2_log("Image verify started\n");
+    return SATR_OK;
+}
@@ -7,6 +7,7 @@
 #include "eeprom.h"
 #include "leop_eeprom.h"
 #include "F021.h"
+#include "nv_store/nv_store.h"
 
 typedef struct __attribute__((packed)){
     uint32_t exists_flag;
@@ -15,25 +16,24 @@ typedef struct __attribute__((packed)){
 
 bool eeprom_get_leop_status() {
     leop_status_t state = {0};
-    if (eeprom_read(&state, LEOP_INFO_BLOCKNUMBER, sizeof(state)) == Fapi_Status_Success) {
-        if (state.exists_flag == EXISTS_FLAG) {
-            return state.status;
-        } else {
-            memset(&state, 0, sizeof(state));
-            state.exists_flag = EXISTS_FLAG;
-            eeprom_write(&state, LEOP_INFO_BLOCKNUMBER, sizeof(state));
-            return state.status;
-        }
+    if (nv_store_read(NV_KEY_LEOP_STATUS, &state, sizeof(state), NULL) && state.exists_flag == EXISTS_FLAG) {
+        return state.status;
     }
-    else {
+    // Status saved before the store was used, copy it over
+    if (eeprom_read(&state, LEOP_INFO_BLOCKNUMBER, sizeof(state)) != Fapi_Status_Success) {
         return false;
     }
+    if (state.exists_flag != EXISTS_FLAG) {
+        memset(&state, 0, sizeof(state));
+        state.exists_flag = EXISTS_FLAG;
+    }
+    nv_store_write(NV_KEY_LEOP_STATUS, &state, sizeof(state));
+    return state.status;
 }
 
 bool eeprom_set_leop_status() {
     leop_status_t state = {0};
     state.exists_flag = EXISTS_FLAG;
     state.status = true;
-    eeprom_write(&state, LEOP_INFO_BLOCKNUMBER, sizeof(state));
-    return true;
+    return nv_store_write(NV_KEY_LEOP_STATUS, &state, sizeof(state));
 }
@@ -377,5 +377,6 @@ void kill_logger_daemon() {
 void init_logger_queue() {
     if (input_queue == NULL) {
         input_queue = xQueueCreate(DEFAULT_INPUT_QUEUE_LEN, INPUT_QUEUE_ITEM_SIZE);
+        vQueueAddToRegistry(input_queue, "logger_in");
     }
 }
@@ -0,0 +1,260 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file mem_pool.c
+ * @date Oct. 19, 2026
+ *
+ * Fixed size block pools for allocations on hot paths.
+ *
+ * Each size class is a static array of equal sized blocks. Free blocks are
+ * kept on a singly linked list threaded through the blocks themselves, and
+ * blocks that were never used are handed out from the end of the array, so
+ * both pool_malloc() and pool_free() are O(1) and the pools never fragment.
+ *
+ * Requests larger than the biggest class, or that find every large enough
+ * class full, fall back to the FreeRTOS heap. pool_free() tells the two
+ * apart by address, so callers only ever use pool_malloc() and pool_free().
+ */
+
+#include "mem_pool/mem_pool.h"
+
+#include <FreeRTOS.h>
+#include <os_portable.h>
+#include <string.h>
+#include "logger/logger.h"
+
+#if MEM_POOL_CANARIES == 1
+#define MEM_POOL_HEAD 8 // canary, requested size
+#define MEM_POOL_TAIL 8 // tail canary right after the requested size
+#define CANARY_ALLOCATED 0xA110CA7EU
+#define CANARY_FREE 0xF4EEB10CU
+#define CANARY_TAIL 0xC0FFEE11U
+#else
+#define MEM_POOL_HEAD 0
+#define MEM_POOL_TAIL 0
+#endif
+
+#define MEM_POOL_STRIDE(size) ((size) + MEM_POOL_HEAD + MEM_POOL_TAIL)
+
+typedef struct pool_block {
+    struct pool_block *next;
+} pool_block;
+
+typedef struct {
+    uint8_t *start;
+    uint8_t *end;
+    uint32_t stride;
+    uint32_t untouched; // blocks from here to the end have never been allocated
+    pool_block *free_list;
+    mem_pool_stats_t stats;
+} mem_pool;
+
+#define X(size, count)                                                                                            \
+    static uint64_t pool_storage_##size[(MEM_POOL_STRIDE(size) * (count)) / sizeof(uint64_t)];
+MEM_POOL_CLASSES(X)
+#undef X
+
+#define X(size, count)                                                                                            \
+    {(uint8_t *)pool_storage_##size,                                                                              \
+     (uint8_t *)pool_storage_##size + sizeof(pool_storage_##size),                                                \
+     MEM_POOL_STRIDE(size),                                                                                       \
+     0,                                                                                                           \
+     NULL,                                                                                                        \
+     {size, count}},
+static mem_pool pools[] = {MEM_POOL_CLASSES(X)};
+#undef X
+
+#define MEM_POOL_NUM_CLASSES (sizeof(pools) / sizeof(pools[0]))
+
+static uint32_t heap_fallbacks = 0;
+static uint32_t malloc_failures = 0;
+
+/**
+ * @brief
+ *      Take a block from a pool. Must be called with interrupts masked
+ * @return
+ *      Start of the block including its header, or NULL if the pool is full
+ */
+static uint8_t *take_block(mem_pool *pool) {
+    uint8_t *block;
+    if (pool->free_list != NULL) {
+        block = (uint8_t *)pool->free_list - MEM_POOL_HEAD;
+        pool->free_list = pool->free_list->next;
+    } else if (pool->untouched < pool->stats.blocks) {
+        block = pool->start + pool->untouched * pool->stride;
+        pool->untouched++;
+    } else {
+        pool->stats.failures++;
+        return NULL;
+    }
+    pool->stats.used++;
+    pool->stats.allocs++;
+    if (pool->stats.used > pool->stats.high_water) {
+        pool->stats.high_water = pool->stats.used;
+    }
+    return block;
+}
+
+/**
+ * @brief
+ *      Allocate memory from the smallest pool with a free block that fits
+ * @param size
+ *      Number of bytes needed
+ * @return
+ *      Pointer to the memory, or NULL if neither the pools nor the heap could serve the request
+ */
+void *pool_malloc(size_t size) {
+    uint8_t *block = NULL;
+    uint32_t i;
+
+    {
+        RAISE_PRIVILEGE;
+        portENTER_CRITICAL();
+        for (i = 0; i < MEM_POOL_NUM_CLASSES && block == NULL; i++) {
+            if (size <= pools[i].stats.block_size) {
+                block = take_block(&pools[i]);
+            }
+        }
+        if (block == NULL) {
+            heap_fallbacks++;
+        }
+        portEXIT_CRITICAL();
+        RESET_PRIVILEGE;
+    }
+
+    if (block == NULL) {
+        return pvPortMalloc(size);
+    }
+
+#if MEM_POOL_CANARIES == 1
+    uint32_t header[2] = {CANARY_ALLOCATED, size};
+    uint32_t tail = CANARY_TAIL;
+    memcpy(block, header, sizeof(header));
+    memcpy(block + MEM_POOL_HEAD + size, &tail, sizeof(tail));
+#endif
+    return block + MEM_POOL_HEAD;
+}
+
+static mem_pool *find_pool(uint8_t *ptr) {
+    uint32_t i;
+    for (i = 0; i < MEM_POOL_NUM_CLASSES; i++) {
+        if (ptr >= pools[i].start && ptr < pools[i].end) {
+            return &pools[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief
+ *      Free memory returned by pool_malloc
+ * @param ptr
+ *      Pointer from pool_malloc. NULL is ignored
+ */
+void pool_free(void *ptr) {
+    uint8_t *payload = (uint8_t *)ptr;
+    if (payload == NULL) {
+        return;
+    }
+    mem_pool *pool = find_pool(payload);
+    if (pool == NULL) {
+        vPortFree(ptr);
+        return;
+    }
+
+    uint8_t *block = payload - MEM_POOL_HEAD;
+    const char *error = NULL;
+    if ((block - pool->start) % pool->stride != 0) {
+        error = "not the start of a block";
+    }
+#if MEM_POOL_CANARIES == 1
+    uint32_t header[2];
+    uint32_t tail;
+    if (error == NULL) {
+        memcpy(header, block, sizeof(header));
+        if (header[0] == CANARY_FREE) {
+            error = "double free";
+        } else if (header[0] != CANARY_ALLOCATED || header[1] > pool->stats.block_size) {
+            error = "header overwritten";
+        } else {
+            memcpy(&tail, payload + header[1], sizeof(tail));
+            if (tail != CANARY_TAIL) {
+                // The block is still valid, so report it and carry on freeing it
+                sys_log(ERROR, "Pool %d: block %p overflowed", pool->stats.block_size, ptr);
+                pool->stats.corruptions++;
+            }
+            header[0] = CANARY_FREE;
+            memcpy(block, header, sizeof(uint32_t));
+        }
+    }
+#endif
+    if (error != NULL) {
+        pool->stats.corruptions++;
+        sys_log(ERROR, "Pool %d: bad free of %p, %s", pool->stats.block_size, ptr, error);
+        return;
+    }
+
+    RAISE_PRIVILEGE;
+    portENTER_CRITICAL();
+    ((pool_block *)payload)->next = pool->free_list;
+    pool->free_list = (pool_block *)payload;
+    pool->stats.used--;
+    portEXIT_CRITICAL();
+    RESET_PRIVILEGE;
+}
+
+/**
+ * @brief
+ *      Number of size classes
+ */
+uint32_t mem_pool_count(void) { return MEM_POOL_NUM_CLASSES; }
+
+/**
+ * @brief
+ *      Copy out the counters of one size class
+ * @param index
+ *      Size class, smallest first
+ * @return
+ *      false if there is no such class
+ */
+bool mem_pool_get_stats(uint32_t index, mem_pool_stats_t *stats) {
+    if (index >= MEM_POOL_NUM_CLASSES) {
+        return false;
+    }
+    RAISE_PRIVILEGE;
+    portENTER_CRITICAL();
+    *stats = pools[index].stats;
+    portEXIT_CRITICAL();
+    RESET_PRIVILEGE;
+    return true;
+}
+
+/**
+ * @brief
+ *      Get the FreeRTOS heap usage and the failure counters
+ */
+void mem_heap_get_stats(mem_heap_stats_t *stats) {
+    RAISE_PRIVILEGE;
+    stats->heap_free = xPortGetFreeHeapSize();
+    stats->heap_min_free = xPortGetMinimumEverFreeHeapSize();
+    RESET_PRIVILEGE;
+    stats->heap_fallbacks = heap_fallbacks;
+    stats->malloc_failures = malloc_failures;
+}
+
+/**
+ * @brief
+ *      Count a failed pvPortMalloc. Called from vApplicationMallocFailedHook
+ */
+void mem_pool_malloc_failed(void) { malloc_failures++; }
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file nv_flash.c
+ * @date Oct. 19, 2026
+ *
+ * Flash backend of the store, on the sectors of bank 7 after the fixed
+ * EEPROM blocks.
+ *
+ * The flash state machine is checked after every operation, and what was
+ * erased or programmed is read back, so a failed write is reported instead
+ * of leaving the store to find it on the next scan.
+ */
+
+#include "nv_store/nv_store.h"
+
+#include <string.h>
+
+#include "F021.h"
+#include "eeprom.h"
+#include "flash_defines.h"
+#include "privileged_functions.h"
+
+#define NV_FLASH_BANK 7
+
+/* Bank 7 sectors are programmed this many bytes at a time */
+#define NV_FLASH_BANK_WIDTH 8
+
+static const SECTORS *area_sector(uint8_t area) {
+    uint32_t sector = NV_STORE_FIRST_SECTOR + area * NV_STORE_AREA_SECTORS;
+    int i;
+
+    if (area >= NV_STORE_AREAS) {
+        return NULL;
+    }
+    for (i = 0; i < NUMBEROFSECTORS; i++) {
+        if (flash_sector[i].bankNumber == NV_FLASH_BANK && flash_sector[i].sectorNumber == sector) {
+            return &flash_sector[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief
+ *      Get where an area is mapped for reading
+ */
+const uint8_t *nv_flash_area(uint8_t area) {
+    const SECTORS *sector = area_sector(area);
+    return sector == NULL ? NULL : (const uint8_t *)sector->start;
+}
+
+/* Must be privileged. Make bank 7 the one the state machine works on */
+static void select_bank(void) {
+    Fapi_initializeFlashBanks((uint32_t)SYS_CLK_FREQ);
+    Fapi_enableAutoEccCalculation();
+    Fapi_setActiveFlashBank((Fapi_FlashBankType)NV_FLASH_BANK);
+    Fapi_enableEepromBankSectors(0xFFFF, 0);
+    while (FAPI_CHECK_FSM_READY_BUSY != Fapi_Status_FsmReady) {
+    }
+}
+
+/* Must be privileged. Wait for the state machine, true if the last operation succeeded */
+static bool fsm_done(void) {
+    while (FAPI_CHECK_FSM_READY_BUSY == Fapi_Status_FsmBusy) {
+    }
+    return FAPI_GET_FSM_STATUS == Fapi_Status_Success;
+}
+
+/**
+ * @brief
+ *      Erase every sector of an area
+ * @return
+ *      false if the state machine reported an error or the area isn't blank after
+ */
+bool nv_flash_erase(uint8_t area) {
+    const SECTORS *sector = area_sector(area);
+    const uint8_t *start;
+    bool ok = true;
+    uint32_t i;
+
+    if (sector == NULL) {
+        return false;
+    }
+    raise_privilege();
+    select_bank();
+    for (i = 0; i < NV_STORE_AREA_SECTORS && ok; i++) {
+        ok = Fapi_issueAsyncCommandWithAddress(Fapi_EraseSector, (uint32_t *)sector[i].start) ==
+                 Fapi_Status_Success &&
+             fsm_done();
+    }
+    reset_privilege();
+
+    start = (const uint8_t *)sector->start;
+    for (i = 0; i < NV_STORE_AREA_SIZE && ok; i++) {
+        ok = start[i] == 0xFF;
+    }
+    return ok;
+}
+
+/**
+ * @brief
+ *      Program erased words of an area
+ * @param offset
+ *      Where in the area to start, a multiple of NV_STORE_WORD
+ * @return
+ *      false if the state machine reported an error or the flash doesn't read back as data
+ */
+bool nv_flash_program(uint8_t area, uint32_t offset, const void *data, uint32_t length) {
+    const SECTORS *sector = area_sector(area);
+    const uint8_t *src = (const uint8_t *)data;
+    uint8_t *dst;
+    bool ok = true;
+    uint32_t done;
+
+    if (sector == NULL || offset % NV_STORE_WORD != 0 || offset + length > NV_STORE_AREA_SIZE) {
+        return false;
+    }
+    dst = (uint8_t *)sector->start + offset;
+    raise_privilege();
+    select_bank();
+    for (done = 0; done < length && ok; done += NV_FLASH_BANK_WIDTH) {
+        uint32_t bytes = length - done < NV_FLASH_BANK_WIDTH ? length - done : NV_FLASH_BANK_WIDTH;
+        ok = Fapi_issueProgrammingCommand((uint32_t *)(dst + done), (uint8_t *)(src + done), (uint8_t)bytes, 0, 0,
+                                          Fapi_AutoEccGeneration) == Fapi_Status_Success &&
+             fsm_done();
+    }
+    reset_privilege();
+    return ok && memcmp(dst, data, length) == 0;
+}
+
+/**
+ * @brief
+ *      Take the flash lock shared with the EEPROM blocks and firmware updates
+ */
+void nv_flash_lock(void) { flash_lock(); }
+
+void nv_flash_unlock(void) { flash_unlock(); }
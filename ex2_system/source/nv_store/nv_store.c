@@ -0,0 +1,339 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file nv_store.c
+ * @date Oct. 19, 2026
+ *
+ * Log structured store of small keyed records in the EEPROM emulation bank.
+ *
+ * Records are appended to the active area, never rewritten, so an update
+ * costs one program of a few words instead of a sector erase. Each record
+ * carries its key, length, a sequence number and a CRC-16. The newest copy
+ * of a key with a good CRC is the current value, so a write cut short by a
+ * reset leaves the previous value in place.
+ *
+ * When the active area is full the current records are copied to the other
+ * area, and its header is written last with the next generation number. The
+ * area with a valid header and the highest generation is the active one, so
+ * a compaction cut short leaves the old area in charge. The two areas take
+ * turns, spreading the erases over both.
+ */
+
+#include "nv_store/nv_store.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "image_verify/image_crc.h"
+
+#define NV_AREA_MAGIC 0x4E565331 // "NVS1"
+#define NV_NO_RECORD 0xFFFFFFFF
+
+typedef struct {
+    uint32_t magic;
+    uint32_t generation;
+} nv_area_header;
+
+typedef struct {
+    uint16_t key;
+    uint16_t length;   // bytes of value after the header, 0 for a deleted key
+    uint16_t sequence; // counts up with every record written
+    uint16_t crc;      // CRC-16 of the fields above and the value
+} nv_record_header;
+
+static bool mounted = false;
+static uint8_t active;
+static uint32_t generation;
+static uint32_t free_offset;                 // where the next record goes in the active area
+static uint32_t records[NV_STORE_MAX_KEYS]; // offset of the current record of each key
+static uint16_t sequence;
+static uint32_t writes;
+static uint32_t compactions;
+
+/* A record is built here before it is programmed, flash can't be read while bank 7 is programmed */
+static uint8_t record_buffer[sizeof(nv_record_header) + NV_STORE_MAX_VALUE];
+
+static uint32_t padded(uint32_t length) { return (length + NV_STORE_WORD - 1) & ~(uint32_t)(NV_STORE_WORD - 1); }
+
+static bool erased(const uint8_t *data, uint32_t length) {
+    while (length--) {
+        if (*data++ != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint16_t record_crc(const nv_record_header *header, const uint8_t *value) {
+    uint16_t crc = image_crc16(0, (const uint8_t *)header, offsetof(nv_record_header, crc));
+    return image_crc16(crc, value, header->length);
+}
+
+/* Walk the records of the active area, indexing the newest good copy of each key */
+static void scan(void) {
+    const uint8_t *area = nv_flash_area(active);
+    uint32_t offset = sizeof(nv_area_header);
+    uint8_t key;
+
+    for (key = 0; key < NV_STORE_MAX_KEYS; key++) {
+        records[key] = NV_NO_RECORD;
+    }
+    sequence = 0;
+
+    while (offset + sizeof(nv_record_header) <= NV_STORE_AREA_SIZE) {
+        nv_record_header header;
+        memcpy(&header, area + offset, sizeof(header));
+        if (erased(area + offset, sizeof(header))) {
+            break;
+        }
+        uint32_t size = sizeof(header) + padded(header.length);
+        if (header.length > NV_STORE_MAX_VALUE || offset + size > NV_STORE_AREA_SIZE) {
+            // Nothing after a damaged header can be trusted to line up, fill the area so it is compacted
+            offset = NV_STORE_AREA_SIZE;
+            break;
+        }
+        if (header.key < NV_STORE_MAX_KEYS && header.crc == record_crc(&header, area + offset + sizeof(header))) {
+            records[header.key] = offset;
+            sequence = header.sequence;
+        }
+        offset += size;
+    }
+    free_offset = offset;
+}
+
+static bool start_area(uint8_t area, uint32_t new_generation) {
+    nv_area_header header = {NV_AREA_MAGIC, new_generation};
+    return nv_flash_program(area, 0, &header, sizeof(header));
+}
+
+/* Must hold the lock */
+static bool mount(void) {
+    nv_area_header header;
+    bool found = false;
+    uint8_t area;
+
+    for (area = 0; area < NV_STORE_AREAS; area++) {
+        memcpy(&header, nv_flash_area(area), sizeof(header));
+        if (header.magic == NV_AREA_MAGIC && (!found || header.generation > generation)) {
+            active = area;
+            generation = header.generation;
+            found = true;
+        }
+    }
+    if (!found) {
+        active = 0;
+        generation = 1;
+        if (!nv_flash_erase(active) || !start_area(active, generation)) {
+            return false;
+        }
+    }
+    scan();
+    mounted = true;
+    return true;
+}
+
+/* Must hold the lock. Copy the current records to the other area and make it the active one */
+static bool compact(void) {
+    uint8_t spare = (active + 1) % NV_STORE_AREAS;
+    const uint8_t *area = nv_flash_area(active);
+    uint32_t offset = sizeof(nv_area_header);
+    uint32_t moved[NV_STORE_MAX_KEYS];
+    uint8_t key;
+
+    if (!nv_flash_erase(spare)) {
+        return false;
+    }
+    for (key = 0; key < NV_STORE_MAX_KEYS; key++) {
+        moved[key] = NV_NO_RECORD;
+        if (records[key] == NV_NO_RECORD) {
+            continue;
+        }
+        nv_record_header header;
+        memcpy(&header, area + records[key], sizeof(header));
+        if (header.length == 0) {
+            continue; // deleted, nothing to keep
+        }
+        uint32_t size = sizeof(header) + padded(header.length);
+        memcpy(record_buffer, area + records[key], size);
+        if (!nv_flash_program(spare, offset, record_buffer, size)) {
+            return false;
+        }
+        moved[key] = offset;
+        offset += size;
+    }
+    // Every copy must read back whole before the new area can take over
+    const uint8_t *copy = nv_flash_area(spare);
+    for (key = 0; key < NV_STORE_MAX_KEYS; key++) {
+        nv_record_header header;
+        if (moved[key] == NV_NO_RECORD) {
+            continue;
+        }
+        memcpy(&header, copy + moved[key], sizeof(header));
+        if (header.key != key || header.length > NV_STORE_MAX_VALUE ||
+            header.crc != record_crc(&header, copy + moved[key] + sizeof(header))) {
+            return false;
+        }
+    }
+    // The header goes last, until it is written the old area stays active
+    if (!start_area(spare, generation + 1)) {
+        return false;
+    }
+    active = spare;
+    generation++;
+    free_offset = offset;
+    memcpy(records, moved, sizeof(records));
+    compactions++;
+    return true;
+}
+
+static bool append(nv_key key, const void *value, uint16_t length) {
+    nv_record_header *header = (nv_record_header *)record_buffer;
+    uint32_t size = sizeof(*header) + padded(length);
+
+    if (free_offset + size > NV_STORE_AREA_SIZE && (!compact() || free_offset + size > NV_STORE_AREA_SIZE)) {
+        return false;
+    }
+
+    memset(record_buffer, 0xFF, size);
+    header->key = key;
+    header->length = length;
+    header->sequence = ++sequence;
+    memcpy(record_buffer + sizeof(*header), value, length);
+    header->crc = record_crc(header, record_buffer + sizeof(*header));
+
+    uint32_t offset = free_offset;
+    // Whatever happens, this space has been programmed and can't be used again
+    free_offset += size;
+    if (!nv_flash_program(active, offset, record_buffer, size) ||
+        memcmp(nv_flash_area(active) + offset, record_buffer, size) != 0) {
+        return false;
+    }
+    records[key] = offset;
+    writes++;
+    return true;
+}
+
+/**
+ * @brief
+ *      Find the active area and index its records
+ * @details
+ *      Formats the store if no area is valid. Called by the other functions
+ *      when needed, and again to pick up changes made to the flash directly
+ * @return
+ *      false if the store could not be formatted
+ */
+bool nv_store_mount(void) {
+    nv_flash_lock();
+    bool ok = mount();
+    nv_flash_unlock();
+    return ok;
+}
+
+/**
+ * @brief
+ *      Read the current value of a record
+ * @param key
+ *      Record to read
+ * @param value
+ *      Where to copy the value
+ * @param size
+ *      Size of value, a longer record is cut short
+ * @param length
+ *      Set to the length of the record, may be NULL
+ * @return
+ *      false if the record was never written or was deleted
+ */
+bool nv_store_read(nv_key key, void *value, uint16_t size, uint16_t *length) {
+    bool found = false;
+
+    if (key == NV_KEY_NONE || key >= NV_STORE_MAX_KEYS) {
+        return false;
+    }
+    nv_flash_lock();
+    if ((mounted || mount()) && records[key] != NV_NO_RECORD) {
+        const uint8_t *record = nv_flash_area(active) + records[key];
+        nv_record_header header;
+        memcpy(&header, record, sizeof(header));
+        if (header.length != 0) {
+            memcpy(value, record + sizeof(header), header.length < size ? header.length : size);
+            if (length != NULL) {
+                *length = header.length;
+            }
+            found = true;
+        }
+    }
+    nv_flash_unlock();
+    return found;
+}
+
+/**
+ * @brief
+ *      Replace the value of a record
+ * @details
+ *      Nothing is written if the value is unchanged. If the active area is
+ *      full, it is compacted first, which erases the other area
+ * @param key
+ *      Record to write
+ * @param value
+ *      New value
+ * @param length
+ *      Bytes in value, at most NV_STORE_MAX_VALUE. 0 deletes the record
+ * @return
+ *      false if the record could not be written, the previous value is kept
+ */
+bool nv_store_write(nv_key key, const void *value, uint16_t length) {
+    bool ok = true;
+
+    if (key == NV_KEY_NONE || key >= NV_STORE_MAX_KEYS || length > NV_STORE_MAX_VALUE) {
+        return false;
+    }
+    nv_flash_lock();
+    if (!mounted && !mount()) {
+        nv_flash_unlock();
+        return false;
+    }
+    if (records[key] != NV_NO_RECORD) {
+        const uint8_t *record = nv_flash_area(active) + records[key];
+        nv_record_header header;
+        memcpy(&header, record, sizeof(header));
+        if (header.length == length && memcmp(record + sizeof(header), value, length) == 0) {
+            nv_flash_unlock();
+            return true;
+        }
+    } else if (length == 0) {
+        nv_flash_unlock();
+        return true;
+    }
+    ok = append(key, value, length);
+    nv_flash_unlock();
+    return ok;
+}
+
+/**
+ * @brief
+ *      Get how full the store is and how often it was written
+ * @param stats
+ *      Where to copy the statistics
+ */
+void nv_store_get_stats(nv_store_stats *stats) {
+    nv_flash_lock();
+    if (!mounted) {
+        mount();
+    }
+    stats->generation = generation;
+    stats->used = free_offset;
+    stats->writes = writes;
+    stats->compactions = compactions;
+    nv_flash_unlock();
+}
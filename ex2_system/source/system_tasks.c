@@ -20,13 +20,18 @@
 #include <beacon_task.h>
 #include "system_tasks.h"
 
+#include "athena_sensors.h"
 #include "coordinate_management/coordinate_management.h"
 #include "diagnostic/diagnostic.h"
+#include "eps.h"
+#include "fw_update/fw_update.h"
 #include "housekeeping/housekeeping_task.h"
+#include "image_verify/image_verify.h"
 #include "logger/logger.h"
 #include "nmea_daemon.h"
 #include "time_management/rtc_daemon.h"
 #include "task_manager/task_manager.h"
+#include "task_stats/task_stats.h"
 
 /**
  * Start all system daemon tasks
@@ -36,15 +41,20 @@
  */
 SAT_returnState start_system_tasks(void) {
 
-    const const static char *system_task_names[] = {"beacon_daemon\0",   "coordinate_management_daemon\0",
+    const const static char *system_task_names[] = {"task_manager\0",     "beacon_daemon\0",
+                                                    "coordinate_management_daemon\0",
                                                     "diagnostic_daemon", "housekeeping_daemon\0",
                                                     "NMEA_daemon\0",     "RTC_daemon\0",
-                                                    "logger_daemon\0"};
+                                                    "logger_daemon\0",   "task_stats_daemon\0",
+                                                    "eps_daemon\0",      "athena_sensor_daemon\0",
+                                                    "image_verify_daemon\0", "fw_update_daemon\0"};
 
     const system_tasks start_task[] = {
         &start_task_manager,      &start_beacon_daemon,       &start_coordinate_management_daemon,
         &start_diagnostic_daemon, &start_housekeeping_daemon, &start_NMEA_daemon,
-        &start_RTC_daemon,        &start_logger_daemon,       NULL};
+        &start_RTC_daemon,        &start_logger_daemon,       &start_task_stats_daemon,
+        &start_eps_daemon,        &start_athena_sensor_daemon, &start_image_verify_daemon,
+        &start_fw_update_daemon,  NULL};
 
     int number_of_system_tasks = (sizeof(start_task) - 1) / sizeof(system_tasks);
     uint8_t *start_task_flag = pvPortMalloc(number_of_system_tasks * sizeof(uint8_t));
@@ -5,6 +5,7 @@
  *      Author: Robert Taylor
  */
 #include "task_manager/task_manager.h"
+#include "mem_pool/mem_pool.h"
 #include "HL_reg_rti.h"
 #include "os_task.h"
 #include "privileged_functions.h"
@@ -56,8 +57,10 @@ uint32_t get_task_count() {
 }
 
 task_info_node *get_new_task_node() {
-    task_info_node *new_node = pvPortMalloc(sizeof(task_info_node));
-    memset(new_node, 0, sizeof(new_node));
+    task_info_node *new_node = pool_malloc(sizeof(task_info_node));
+    if (new_node != NULL) {
+        memset(new_node, 0, sizeof(task_info_node));
+    }
     return new_node;
 }
 
@@ -70,9 +73,7 @@ bool is_task_in_list(TaskHandle_t task) {
 
 void compress_list() {}
 
-// returns false if task already in list or if task list doesn't exist
-// behavior on malloc() fail is undefined
-// TODO: make this handle malloc failure
+// returns false if task already in list, if task list doesn't exist or if a new node can't be allocated
 bool add_task_to_list(task_info *new_tsk) {
     if (is_task_in_list(new_tsk->task)) {
         return false;
@@ -81,17 +82,20 @@ bool add_task_to_list(task_info *new_tsk) {
     task_info *tsk = get_task_info(0);
     if (!tsk) { // no free space found. Make a new node
         task_info_node *curr = tasks_start;
+        task_info_node *new_node = get_new_task_node();
+        if (new_node == NULL) {
+            xSemaphoreGiveRecursive(task_mutex);
+            return false;
+        }
         if (curr == NULL) {
-            curr = get_new_task_node();
-            tasks_start = curr;
-            tsk = &(curr->info_list[0]);
+            tasks_start = new_node;
         } else {
             while (curr->next) {
                 curr = curr->next;
             }
-            curr->next = get_new_task_node();
-            tsk = &(curr->next->info_list[0]);
+            curr->next = new_node;
         }
+        tsk = &(new_node->info_list[0]);
     }
     memcpy(tsk, new_tsk, sizeof(task_info)); // copy from stack to heap
     xSemaphoreGiveRecursive(task_mutex);
@@ -146,6 +150,7 @@ void ex2_deregister(TaskHandle_t task) { remove_task_from_list(task); }
 void ex2_register(TaskHandle_t task, taskFunctions funcs) {
     task_info new_task = {0};
     new_task.task = task;
+    new_task.last_progress = xTaskGetTickCount();
     new_task.funcs = funcs;
     add_task_to_list(&new_task);
 }
@@ -184,6 +189,7 @@ void ex2_task_init_mutex() {
 }
 
 bool check_tasks_health() {
+    TickType_t now = xTaskGetTickCount();
     xSemaphoreTakeRecursive(task_mutex, portMAX_DELAY);
     task_info_node *curr = tasks_start;
     while (1) {
@@ -192,18 +198,21 @@ bool check_tasks_health() {
         }
         int i;
         for (i = 0; i < 10; i++) {
-            task_info tsk = curr->info_list[i];
-            if (tsk.task == 0) {
+            task_info *tsk = &curr->info_list[i];
+            if (tsk->task == 0) {
                 continue;
             }
-            if (tsk.funcs.getCounterFunction == 0) {
+            if (tsk->funcs.getCounterFunction == 0) {
                 continue;
             }
-            uint32_t tsk_counter = tsk.funcs.getCounterFunction();
-            if (tsk_counter == tsk.prev_counter) {
+            uint32_t tsk_counter = tsk->funcs.getCounterFunction();
+            if (tsk_counter != tsk->prev_counter) {
+                tsk->prev_counter = tsk_counter;
+                tsk->last_progress = now;
+            } else if (now - tsk->last_progress > TASK_HUNG_TIMEOUT) {
+                xSemaphoreGiveRecursive(task_mutex);
                 return false;
             }
-            tsk.prev_counter = tsk_counter;
         }
         curr = curr->next;
     }
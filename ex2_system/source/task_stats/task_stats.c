@@ -0,0 +1,356 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file task_stats.c
+ * @date Oct. 19, 2026
+ *
+ * Per task CPU load, stack and scheduling latency statistics.
+ *
+ * Run time comes from the FreeRTOS run time stats, which are driven by the PMU
+ * cycle counter (see initializeProfiler() in main.c). Context switches and
+ * latency are counted by the kernel hooks at the bottom of this file.
+ */
+
+#include "task_stats/task_stats.h"
+
+#include <FreeRTOS.h>
+#include <os_semphr.h>
+#include <os_task.h>
+#include <stdbool.h>
+#include <string.h>
+#include "HL_sys_pmu.h"
+#include "HL_system.h"
+#include "logger/logger.h"
+#include "privileged_functions.h"
+#include "task_manager/task_manager.h"
+
+/* One more snapshot than the long window so the window start is still available */
+#define TASK_STATS_HISTORY (TASK_STATS_LONG_WINDOW + 1)
+
+#if TASK_STATS_SHORT_WINDOW > TASK_STATS_LONG_WINDOW
+#error "TASK_STATS_SHORT_WINDOW must not be longer than TASK_STATS_LONG_WINDOW"
+#endif
+
+/* Written by the kernel hooks only */
+typedef struct {
+    void *task;
+    UBaseType_t tcb_number;
+    uint32_t switches;
+    uint32_t ready_stamp;
+    uint32_t max_latency; // PMU cycles since the daemon last sampled
+    bool ready_pending;
+} task_hook_slot;
+
+/* Written by the daemon only */
+typedef struct {
+    TaskHandle_t task;
+    UBaseType_t tcb_number;
+    char name[configMAX_TASK_NAME_LEN];
+    uint8_t priority;
+    uint16_t stack_hwm;
+    uint32_t first_sample;
+    uint32_t run_time[TASK_STATS_HISTORY];       // cumulative snapshots
+    uint32_t switches[TASK_STATS_HISTORY];       // cumulative snapshots
+    uint32_t max_latency_us[TASK_STATS_HISTORY]; // worst latency within each sample period
+} task_history;
+
+static task_hook_slot hook_slots[TASK_STATS_MAX_TASKS];
+static task_history history[TASK_STATS_MAX_TASKS];
+static uint32_t total_run_time[TASK_STATS_HISTORY]; // run time of all tasks within each sample period
+static uint32_t sample_count = 0;
+static TaskStatus_t status_array[TASK_STATS_MAX_TASKS];
+
+static SemaphoreHandle_t stats_mutex = NULL;
+
+static uint32_t svc_wdt_counter = 0;
+static uint32_t get_svc_wdt_counter() { return svc_wdt_counter; }
+
+static inline uint32_t ring(uint32_t sample) { return sample % TASK_STATS_HISTORY; }
+
+/**
+ * @brief
+ *      Find the hook slot assigned to a task when it was created
+ * @return
+ *      Slot index, or -1 if the task was created while all slots were in use
+ */
+static int find_slot(TaskStatus_t *status) {
+    for (int i = 0; i < TASK_STATS_MAX_TASKS; i++) {
+        if (hook_slots[i].task == status->xHandle && hook_slots[i].tcb_number == status->xTaskNumber) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief
+ *      Snapshot the counters of every task into the sliding window history
+ */
+static void task_stats_sample(void) {
+    uint32_t switches[TASK_STATS_MAX_TASKS];
+    uint32_t latency[TASK_STATS_MAX_TASKS];
+    int i;
+
+    UBaseType_t num_tasks = uxTaskGetSystemState(status_array, TASK_STATS_MAX_TASKS, NULL);
+    if (num_tasks == 0) {
+        sys_log(WARN, "Task stats: more than %d tasks running", TASK_STATS_MAX_TASKS);
+        return;
+    }
+
+    RAISE_PRIVILEGE;
+    portENTER_CRITICAL();
+    for (i = 0; i < TASK_STATS_MAX_TASKS; i++) {
+        switches[i] = hook_slots[i].switches;
+        latency[i] = hook_slots[i].max_latency;
+        hook_slots[i].max_latency = 0;
+    }
+    portEXIT_CRITICAL();
+    RESET_PRIVILEGE;
+
+    xSemaphoreTake(stats_mutex, portMAX_DELAY);
+    uint32_t prev = sample_count;
+    uint32_t now = sample_count + 1;
+    uint32_t total = 0;
+    bool seen[TASK_STATS_MAX_TASKS] = {0};
+
+    for (UBaseType_t t = 0; t < num_tasks; t++) {
+        TaskStatus_t *status = &status_array[t];
+        int slot = find_slot(status);
+        if (slot < 0) {
+            continue;
+        }
+        task_history *hist = &history[slot];
+        seen[slot] = true;
+
+        if (hist->task != status->xHandle || hist->tcb_number != status->xTaskNumber) {
+            // New task in this slot. Its window starts now
+            memset(hist, 0, sizeof(task_history));
+            hist->task = status->xHandle;
+            hist->tcb_number = status->xTaskNumber;
+            hist->first_sample = now;
+        } else {
+            total += status->ulRunTimeCounter - hist->run_time[ring(prev)];
+        }
+        strncpy(hist->name, status->pcTaskName, configMAX_TASK_NAME_LEN - 1);
+        hist->priority = status->uxCurrentPriority;
+        hist->stack_hwm = status->usStackHighWaterMark;
+        hist->run_time[ring(now)] = status->ulRunTimeCounter;
+        hist->switches[ring(now)] = switches[slot];
+        // The PMU only starts counting with the scheduler, so the first period has no valid latency
+        hist->max_latency_us[ring(now)] = prev == 0 ? 0 : (uint32_t)(latency[slot] / GCLK_FREQ);
+    }
+
+    for (i = 0; i < TASK_STATS_MAX_TASKS; i++) {
+        if (!seen[i] && history[i].task != NULL) {
+            memset(&history[i], 0, sizeof(task_history));
+        }
+    }
+
+    total_run_time[ring(now)] = total;
+    sample_count = now;
+    xSemaphoreGive(stats_mutex);
+}
+
+static uint16_t window_cpu(task_history *hist, uint32_t window) {
+    uint32_t start = sample_count > window ? sample_count - window : 0;
+    uint32_t total = 0;
+    for (uint32_t s = start + 1; s <= sample_count; s++) {
+        total += total_run_time[ring(s)];
+    }
+    if (start < hist->first_sample) {
+        start = hist->first_sample;
+    }
+    if (total == 0) {
+        return 0;
+    }
+    uint32_t used = hist->run_time[ring(sample_count)] - hist->run_time[ring(start)];
+    uint64_t cpu = ((uint64_t)used * TASK_STATS_CPU_SCALE) / total;
+    return cpu > TASK_STATS_CPU_SCALE ? TASK_STATS_CPU_SCALE : (uint16_t)cpu;
+}
+
+static void fill_entry(task_history *hist, task_stats_entry_t *entry) {
+    uint32_t start = sample_count > TASK_STATS_LONG_WINDOW ? sample_count - TASK_STATS_LONG_WINDOW : 0;
+    if (start < hist->first_sample) {
+        start = hist->first_sample;
+    }
+    uint32_t max_latency = 0;
+    for (uint32_t s = start + 1; s <= sample_count; s++) {
+        if (hist->max_latency_us[ring(s)] > max_latency) {
+            max_latency = hist->max_latency_us[ring(s)];
+        }
+    }
+
+    memcpy(entry->name, hist->name, configMAX_TASK_NAME_LEN);
+    entry->priority = hist->priority;
+    entry->cpu_short = window_cpu(hist, TASK_STATS_SHORT_WINDOW);
+    entry->cpu_long = window_cpu(hist, TASK_STATS_LONG_WINDOW);
+    entry->stack_hwm = hist->stack_hwm;
+    entry->context_switches = hist->switches[ring(sample_count)] - hist->switches[ring(start)];
+    entry->max_latency_us = max_latency;
+}
+
+/**
+ * @brief
+ *      Copy out the statistics of the tasks currently tracked
+ * @param entries
+ *      Array to fill
+ * @param first
+ *      Index of the first tracked task to return, for paging through the list
+ * @param max_entries
+ *      Capacity of entries
+ * @return
+ *      Number of entries filled
+ */
+uint32_t task_stats_get(task_stats_entry_t *entries, uint32_t first, uint32_t max_entries) {
+    uint32_t index = 0;
+    uint32_t filled = 0;
+    if (stats_mutex == NULL) {
+        return 0;
+    }
+    xSemaphoreTake(stats_mutex, portMAX_DELAY);
+    for (int i = 0; i < TASK_STATS_MAX_TASKS && filled < max_entries; i++) {
+        if (history[i].task == NULL) {
+            continue;
+        }
+        if (index++ < first) {
+            continue;
+        }
+        fill_entry(&history[i], &entries[filled++]);
+    }
+    xSemaphoreGive(stats_mutex);
+    return filled;
+}
+
+/**
+ * @brief
+ *      Number of tasks with statistics available
+ */
+uint32_t task_stats_count(void) {
+    uint32_t count = 0;
+    if (stats_mutex == NULL) {
+        return 0;
+    }
+    xSemaphoreTake(stats_mutex, portMAX_DELAY);
+    for (int i = 0; i < TASK_STATS_MAX_TASKS; i++) {
+        if (history[i].task != NULL) {
+            count++;
+        }
+    }
+    xSemaphoreGive(stats_mutex);
+    return count;
+}
+
+/**
+ * Task statistics daemon. Samples all tasks every TASK_STATS_SAMPLE_PERIOD_MS
+ *
+ * @param pvParameters
+ *    task parameters (not used)
+ */
+static void task_stats_daemon(void *pvParameters) {
+    TickType_t last_wake_time = xTaskGetTickCount();
+    for (;;) {
+        svc_wdt_counter++;
+        task_stats_sample();
+        vTaskDelayUntil(&last_wake_time, pdMS_TO_TICKS(TASK_STATS_SAMPLE_PERIOD_MS));
+    }
+}
+
+/**
+ * Start the task statistics daemon
+ *
+ * @returns status
+ *   error report of task creation
+ */
+SAT_returnState start_task_stats_daemon(void) {
+    TaskHandle_t stats_tsk;
+    taskFunctions stats_funcs = {0};
+    stats_funcs.getCounterFunction = get_svc_wdt_counter;
+
+    if (stats_mutex == NULL) {
+        stats_mutex = xSemaphoreCreateMutex();
+        if (stats_mutex == NULL) {
+            return SATR_ERROR;
+        }
+    }
+    if (xTaskCreate(task_stats_daemon, "task_stats", TASK_STATS_STACK_SIZE, NULL, SYSTEM_STATS_TASK_PRIO,
+                    &stats_tsk) != pdPASS) {
+        ex2_log("FAILED TO CREATE TASK task_stats\n");
+        return SATR_ERROR;
+    }
+    ex2_register(stats_tsk, stats_funcs);
+    ex2_log("Task stats started\n");
+    return SATR_OK;
+}
+
+/*
+ * Kernel hooks
+ *
+ * These run inside the kernel with interrupts masked, so they only touch
+ * hook_slots and read the PMU directly. The slot number is stored in the TCB
+ * (uxTaskNumber) offset by one so that 0 means untracked.
+ */
+
+UBaseType_t task_stats_on_create(void *task, UBaseType_t tcb_number) {
+    for (int i = 0; i < TASK_STATS_MAX_TASKS; i++) {
+        if (hook_slots[i].task == NULL) {
+            hook_slots[i].task = task;
+            hook_slots[i].tcb_number = tcb_number;
+            hook_slots[i].switches = 0;
+            hook_slots[i].max_latency = 0;
+            hook_slots[i].ready_pending = false;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+void task_stats_on_delete(void *task) {
+    for (int i = 0; i < TASK_STATS_MAX_TASKS; i++) {
+        if (hook_slots[i].task == task) {
+            hook_slots[i].task = NULL;
+            return;
+        }
+    }
+}
+
+void task_stats_on_ready(UBaseType_t slot) {
+    if (slot == 0) {
+        return;
+    }
+    hook_slots[slot - 1].ready_stamp = _pmuGetCycleCount_();
+    hook_slots[slot - 1].ready_pending = true;
+}
+
+void task_stats_on_switched_in(UBaseType_t slot) {
+    if (slot == 0) {
+        return;
+    }
+    task_hook_slot *hook = &hook_slots[slot - 1];
+    hook->switches++;
+    if (hook->ready_pending) {
+        uint32_t latency = _pmuGetCycleCount_() - hook->ready_stamp;
+        if (latency > hook->max_latency) {
+            hook->max_latency = latency;
+        }
+        hook->ready_pending = false;
+    }
+}
+
+void task_stats_on_switched_out(UBaseType_t slot) {
+    if (slot == 0) {
+        return;
+    }
+    // A task made ready while it was running has no wake up latency to measure
+    hook_slots[slot - 1].ready_pending = false;
+}
@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file telemetry_store.c
+ * @date Oct. 19, 2026
+ *
+ * Latest value store for subsystem housekeeping.
+ *
+ * Every entry has two buffers and a sequence number. The sequence is odd while
+ * a write is in progress, and sequence / 2 counts completed writes, so bit 1
+ * selects the buffer readers should copy. A writer always fills the other
+ * buffer and then flips the sequence, so readers never take a lock or wait
+ * for a bus. A reader only has to retry if two writes complete while it is
+ * copying, at which point the buffer it was reading is being reused.
+ *
+ * Writers are serialized by a mutex. They are expected to be rare compared to
+ * readers: the housekeeping collector, and services refreshing a stale entry.
+ */
+
+#include "telemetry/telemetry_store.h"
+
+#include <os_semphr.h>
+#include <os_task.h>
+#include <string.h>
+
+/* Reads that keep colliding with writes take the writer lock after this many attempts */
+#define TELEMETRY_READ_RETRIES 3
+
+typedef struct {
+    uint8_t *buffers; // two buffers of size bytes, back to back
+    size_t size;
+    volatile uint32_t sequence;
+    telemetry_meta_t meta[2];
+} telemetry_entry;
+
+#define X(id, type) static type buffers_##id[2];
+TELEMETRY_ENTRIES(X)
+#undef X
+
+#define X(id, type) {(uint8_t *)buffers_##id, sizeof(type), 0, {{0}, {0}}},
+static telemetry_entry entries[TLM_COUNT] = {TELEMETRY_ENTRIES(X)};
+#undef X
+
+static SemaphoreHandle_t write_lock = NULL;
+
+/**
+ * @brief
+ *      Create the writer lock. Must be called before any task writes to the store
+ */
+void telemetry_store_init(void) {
+    if (write_lock == NULL) {
+        write_lock = xSemaphoreCreateMutex();
+    }
+}
+
+/**
+ * @brief
+ *      Replace the latest value of an entry
+ * @param id
+ *      Entry to update
+ * @param data
+ *      New value
+ * @param size
+ *      sizeof the entry's type. Writes of the wrong size are ignored
+ * @param valid
+ *      false if the value could not be read from the subsystem. Readers still
+ *      get the data, but telemetry_read() returns false
+ */
+void telemetry_write(telemetry_id_t id, const void *data, size_t size, bool valid) {
+    if (id >= TLM_COUNT || entries[id].size != size || write_lock == NULL) {
+        return;
+    }
+    telemetry_entry *entry = &entries[id];
+
+    xSemaphoreTake(write_lock, portMAX_DELAY);
+    uint32_t sequence = entry->sequence;
+    uint32_t current = (sequence >> 1) & 1;
+    uint32_t next = current ^ 1;
+
+    entry->sequence = sequence + 1;
+    memcpy(entry->buffers + next * size, data, size);
+    entry->meta[next].updated = xTaskGetTickCount();
+    entry->meta[next].updates = entry->meta[current].updates + 1;
+    entry->meta[next].valid = valid;
+    entry->sequence = sequence + 2;
+    xSemaphoreGive(write_lock);
+}
+
+/**
+ * @brief
+ *      Copy out the latest value of an entry without touching the subsystem
+ * @param id
+ *      Entry to read
+ * @param data
+ *      Where to copy the value
+ * @param size
+ *      sizeof the entry's type
+ * @param meta
+ *      If not NULL, set to when the value was written and whether it is valid
+ * @return
+ *      true if the entry has been written and the last write was valid
+ */
+bool telemetry_read(telemetry_id_t id, void *data, size_t size, telemetry_meta_t *meta) {
+    if (id >= TLM_COUNT || entries[id].size != size) {
+        return false;
+    }
+    telemetry_entry *entry = &entries[id];
+    telemetry_meta_t copy;
+    bool consistent = false;
+    int attempt;
+
+    for (attempt = 0; attempt < TELEMETRY_READ_RETRIES && !consistent; attempt++) {
+        uint32_t start = entry->sequence;
+        uint32_t active = (start >> 1) & 1;
+        memcpy(data, entry->buffers + active * size, size);
+        copy = entry->meta[active];
+        // The buffer is only reused by the second write that starts after start was read
+        consistent = (entry->sequence - (start & ~1U)) < 3;
+    }
+
+    if (!consistent) {
+        xSemaphoreTake(write_lock, portMAX_DELAY);
+        uint32_t active = (entry->sequence >> 1) & 1;
+        memcpy(data, entry->buffers + active * size, size);
+        copy = entry->meta[active];
+        xSemaphoreGive(write_lock);
+    }
+
+    if (meta != NULL) {
+        *meta = copy;
+    }
+    return copy.updates != 0 && copy.valid;
+}
+
+/**
+ * @brief
+ *      Read an entry only if it is valid and was written less than max_age ticks ago
+ * @return
+ *      true if data was filled in. On false, the caller should poll the subsystem itself
+ */
+bool telemetry_read_recent(telemetry_id_t id, void *data, size_t size, TickType_t max_age) {
+    telemetry_meta_t meta;
+    if (!telemetry_read(id, data, size, &meta)) {
+        return false;
+    }
+    return telemetry_age(&meta) < max_age;
+}
+
+/**
+ * @brief
+ *      Ticks since the value described by meta was written
+ */
+TickType_t telemetry_age(const telemetry_meta_t *meta) { return xTaskGetTickCount() - meta->updated; }
@@ -0,0 +1,415 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file trace_recorder.c
+ * @date Oct. 19, 2026
+ *
+ * Kernel event trace recorder.
+ *
+ * The FreeRTOS trace macros in FreeRTOSConfig.h append 8 byte events to a RAM
+ * ring, overwriting the oldest events when it is full. trace_flush() appends
+ * everything recorded since the previous flush to TRACE_FILE. Use
+ * tools/trace_to_chrome.py to convert the file for chrome://tracing or Perfetto.
+ *
+ * A fault can't use the file system, so trace_freeze() stops recording and
+ * marks the ring as saved instead. The ring lives in a section that is not
+ * initialized at start up, and neither a watchdog nor a software reset
+ * clears RAM, so the next boot finds it and trace_flush_frozen() writes it.
+ */
+
+#include "trace/trace_recorder.h"
+
+#include <FreeRTOS.h>
+#include <os_task.h>
+#include <redposix.h>
+#include <string.h>
+#include "HL_sys_pmu.h"
+#include "HL_system.h"
+#include "task_stats/task_stats.h"
+
+#if (TRACE_BUFFER_EVENTS & (TRACE_BUFFER_EVENTS - 1)) != 0
+#error "TRACE_BUFFER_EVENTS must be a power of two"
+#endif
+
+/* Events copied out of the ring per critical section while flushing */
+#define TRACE_FLUSH_BATCH 32
+
+/* Left as it was by a reset so a frozen trace survives it, see trace_init() */
+#pragma DATA_SECTION(trace_buffer, ".traceNOINIT")
+#pragma DATA_SECTION(frozen, ".traceNOINIT")
+static trace_event_t trace_buffer[TRACE_BUFFER_EVENTS];
+static struct {
+    uint32_t magic; // TRACE_FROZEN_MAGIC while the rest describes a frozen trace
+    uint32_t write_index;
+    uint32_t flush_index;
+    uint32_t dropped_total;
+    char task_names[TASK_STATS_MAX_TASKS + 1][configMAX_TASK_NAME_LEN];
+} frozen;
+static bool frozen_pending = false; // the ring holds the trace of the previous boot
+
+static uint32_t write_index = 0; // events recorded since boot
+static uint32_t flush_index = 0; // first event not yet in the trace file
+static uint32_t dropped_total = 0;
+static bool recording = true;
+static bool flushing = false;
+
+static UBaseType_t current_task = 0;
+static UBaseType_t next_queue_number = 0;
+
+/* Indexed by task number, which is the task_stats slot + 1 */
+static char task_names[TASK_STATS_MAX_TASKS + 1][configMAX_TASK_NAME_LEN];
+
+static struct {
+    uint16_t object;
+    const char *name;
+} queue_names[TRACE_MAX_QUEUE_NAMES];
+static uint32_t queue_name_count = 0;
+
+static inline void put_event(uint8_t type, UBaseType_t task, UBaseType_t object) {
+    if (!recording) {
+        return;
+    }
+    trace_event_t *evt = &trace_buffer[write_index & (TRACE_BUFFER_EVENTS - 1)];
+    evt->timestamp = _pmuGetCycleCount_();
+    evt->type = type;
+    evt->task = (uint8_t)task;
+    evt->object = (uint16_t)object;
+    write_index++;
+}
+
+/**
+ * @brief
+ *      Start or stop recording. Events already in the ring are kept
+ */
+void trace_enable(bool enable) { recording = enable; }
+
+bool trace_is_enabled(void) { return recording; }
+
+/**
+ * @brief
+ *      Number of events waiting to be flushed
+ */
+uint32_t trace_pending(void) {
+    uint32_t pending = write_index - flush_index;
+    return pending > TRACE_BUFFER_EVENTS ? TRACE_BUFFER_EVENTS : pending;
+}
+
+/**
+ * @brief
+ *      Number of events overwritten before they were flushed, since boot
+ */
+uint32_t trace_dropped(void) {
+    uint32_t pending = write_index - flush_index;
+    return dropped_total + (pending > TRACE_BUFFER_EVENTS ? pending - TRACE_BUFFER_EVENTS : 0);
+}
+
+/**
+ * @brief
+ *      Record a marker event from task context, e.g. around a section of code being profiled
+ * @param id
+ *      Caller defined value shown in the trace
+ */
+void trace_mark(uint16_t id) {
+    RAISE_PRIVILEGE;
+    portENTER_CRITICAL();
+    put_event(TRACE_EVT_MARK, current_task, id);
+    portEXIT_CRITICAL();
+    RESET_PRIVILEGE;
+}
+
+/**
+ * @brief
+ *      Record an interrupt. Call at the start of an interrupt handler
+ * @param source
+ *      Interrupt source from TRACE_ISR_SOURCE
+ */
+void trace_isr(uint16_t source) { put_event(TRACE_EVT_ISR, current_task, source); }
+
+/**
+ * @brief
+ *      Move the read position past events that were overwritten before being flushed
+ * @return
+ *      Number of events skipped
+ */
+static uint32_t skip_overwritten(void) {
+    uint32_t pending = write_index - flush_index;
+    if (pending <= TRACE_BUFFER_EVENTS) {
+        return 0;
+    }
+    flush_index = write_index - TRACE_BUFFER_EVENTS;
+    return pending - TRACE_BUFFER_EVENTS;
+}
+
+/**
+ * @brief
+ *      Open the trace file for appending, moving it to TRACE_OLD_FILE first if
+ *      the new chunk would make it too large
+ * @return
+ *      File descriptor, or -1 on failure
+ */
+static int32_t open_trace_file(uint32_t chunk_size) {
+    REDSTAT file_stats;
+    int32_t fd = red_open(TRACE_FILE, RED_O_CREAT | RED_O_RDWR);
+    if (fd < 0) {
+        return -1;
+    }
+    if (red_fstat(fd, &file_stats) == 0 && file_stats.st_size + chunk_size > TRACE_FILE_MAX_SIZE) {
+        red_close(fd);
+        red_rename(TRACE_FILE, TRACE_OLD_FILE);
+        fd = red_open(TRACE_FILE, RED_O_CREAT | RED_O_RDWR);
+        if (fd < 0) {
+            return -1;
+        }
+    }
+    if (red_lseek(fd, 0, RED_SEEK_END) < 0) {
+        red_close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int32_t write_names(int32_t fd, trace_chunk_header_t *header,
+                           const char names[][configMAX_TASK_NAME_LEN]) {
+    trace_task_name_t task_record;
+    trace_queue_name_t queue_record;
+    int i;
+
+    for (i = 1; i <= TASK_STATS_MAX_TASKS; i++) {
+        if (names[i][0] == '\0') {
+            continue;
+        }
+        task_record.task = i;
+        memcpy(task_record.name, names[i], configMAX_TASK_NAME_LEN);
+        if (red_write(fd, &task_record, sizeof(task_record)) != sizeof(task_record)) {
+            return -1;
+        }
+        header->task_names++;
+    }
+
+    for (i = 0; i < (int)queue_name_count; i++) {
+        queue_record.object = queue_names[i].object;
+        memset(queue_record.name, 0, configMAX_TASK_NAME_LEN);
+        strncpy(queue_record.name, queue_names[i].name, configMAX_TASK_NAME_LEN - 1);
+        if (red_write(fd, &queue_record, sizeof(queue_record)) != sizeof(queue_record)) {
+            return -1;
+        }
+        header->queue_names++;
+    }
+    return 0;
+}
+
+static int32_t flush(const char names[][configMAX_TASK_NAME_LEN]) {
+    trace_chunk_header_t header = {0};
+    trace_event_t batch[TRACE_FLUSH_BATCH];
+    uint32_t end;
+    uint32_t written = 0;
+    int32_t ret = -1;
+
+    {
+        RAISE_PRIVILEGE;
+        portENTER_CRITICAL();
+        if (flushing) {
+            portEXIT_CRITICAL();
+            RESET_PRIVILEGE;
+            return -1;
+        }
+        flushing = true;
+        header.dropped = skip_overwritten();
+        end = write_index;
+        portEXIT_CRITICAL();
+        RESET_PRIVILEGE;
+    }
+
+    uint32_t chunk_size = sizeof(header) + (TASK_STATS_MAX_TASKS * sizeof(trace_task_name_t)) +
+                          (queue_name_count * sizeof(trace_queue_name_t)) +
+                          ((end - flush_index) * sizeof(trace_event_t));
+    int32_t fd = open_trace_file(chunk_size);
+    if (fd < 0) {
+        flushing = false;
+        return -1;
+    }
+    int64_t header_offset = red_lseek(fd, 0, RED_SEEK_CUR);
+
+    header.magic = TRACE_MAGIC;
+    header.version = TRACE_VERSION;
+    header.cpu_hz = (uint32_t)(GCLK_FREQ * 1000000.0F);
+    header.uptime = (uint32_t)(xTaskGetTickCount() / configTICK_RATE_HZ);
+    header.event_count = end - flush_index;
+
+    // The header is rewritten at the end once the name and event counts are known
+    if (red_write(fd, &header, sizeof(header)) != sizeof(header) || write_names(fd, &header, names) != 0) {
+        goto out;
+    }
+
+    while (flush_index != end) {
+        uint32_t count = 0;
+        {
+            RAISE_PRIVILEGE;
+            portENTER_CRITICAL();
+            uint32_t skipped = skip_overwritten();
+            header.dropped += skipped;
+            if ((int32_t)(end - flush_index) < 0) {
+                // Everything left before end has been overwritten
+                end = flush_index;
+            }
+            while (count < TRACE_FLUSH_BATCH && flush_index != end) {
+                batch[count++] = trace_buffer[flush_index & (TRACE_BUFFER_EVENTS - 1)];
+                flush_index++;
+            }
+            portEXIT_CRITICAL();
+            RESET_PRIVILEGE;
+        }
+        if (count == 0) {
+            break;
+        }
+        if (red_write(fd, batch, count * sizeof(trace_event_t)) != count * sizeof(trace_event_t)) {
+            goto out;
+        }
+        written += count;
+    }
+
+    header.event_count = written;
+    if (red_lseek(fd, header_offset, RED_SEEK_SET) != header_offset ||
+        red_write(fd, &header, sizeof(header)) != sizeof(header)) {
+        goto out;
+    }
+    ret = written;
+
+out:
+    dropped_total += header.dropped;
+    red_close(fd);
+    red_transact("VOL0:");
+    flushing = false;
+    return ret;
+}
+
+/**
+ * @brief
+ *      Append all events recorded since the last flush to the trace file.
+ *
+ * @details
+ *      Recording carries on while the file is written. Events that get
+ *      overwritten before they are copied out are counted as dropped in the
+ *      chunk header. Must be called from task context with the file system
+ *      initialized.
+ * @return
+ *      Number of events written, or -1 on failure
+ */
+int32_t trace_flush(void) {
+    if (frozen_pending) {
+        // The ring still holds the previous boot, it has to be written with that boot's task names
+        return -1;
+    }
+    return flush((const char(*)[configMAX_TASK_NAME_LEN])task_names);
+}
+
+/**
+ * @brief
+ *      Look for a trace frozen before the last reset. Call first thing at start up
+ * @details
+ *      A frozen trace is kept, and recording stays off, until
+ *      trace_flush_frozen() has written it
+ */
+void trace_init(void) {
+    if (frozen.magic != TRACE_FROZEN_MAGIC || frozen.write_index - frozen.flush_index > (uint32_t)INT32_MAX) {
+        frozen.magic = 0;
+        write_index = 0;
+        flush_index = 0;
+        return;
+    }
+    write_index = frozen.write_index;
+    flush_index = frozen.flush_index;
+    dropped_total = frozen.dropped_total;
+    recording = false;
+    frozen_pending = true;
+}
+
+/**
+ * @brief
+ *      Stop recording and keep the ring through a reset
+ * @details
+ *      For fault handlers. Uses no FreeRTOS API or file system, so it is safe
+ *      from an interrupt, a critical section or the context switch
+ */
+void trace_freeze(void) {
+    recording = false;
+    if (frozen_pending) {
+        // Still holding an earlier frozen trace, which is the one to keep
+        return;
+    }
+    frozen.write_index = write_index;
+    frozen.flush_index = flush_index;
+    frozen.dropped_total = dropped_total;
+    memcpy(frozen.task_names, task_names, sizeof(frozen.task_names));
+    frozen.magic = TRACE_FROZEN_MAGIC;
+}
+
+/**
+ * @brief
+ *      Write a trace frozen before the last reset to the trace file, then
+ *      start recording again
+ * @details
+ *      Call once the file system is mounted. Does nothing if there is no
+ *      frozen trace
+ * @return
+ *      Number of events written, 0 if there was no frozen trace, or -1 on failure
+ */
+int32_t trace_flush_frozen(void) {
+    int32_t written;
+    if (!frozen_pending) {
+        return 0;
+    }
+    written = flush((const char(*)[configMAX_TASK_NAME_LEN])frozen.task_names);
+    frozen.magic = 0;
+    frozen_pending = false;
+    recording = true;
+    return written;
+}
+
+/*
+ * Kernel hooks
+ *
+ * These run inside the kernel or an interrupt handler with interrupts masked.
+ */
+
+void trace_record(uint8_t type, UBaseType_t object) { put_event(type, current_task, object); }
+
+void trace_on_task_create(UBaseType_t task_number, const char *name) {
+    if (task_number == 0 || task_number > TASK_STATS_MAX_TASKS) {
+        return;
+    }
+    strncpy(task_names[task_number], name, configMAX_TASK_NAME_LEN - 1);
+    task_names[task_number][configMAX_TASK_NAME_LEN - 1] = '\0';
+}
+
+void trace_on_switched_in(UBaseType_t task_number) {
+    current_task = task_number;
+    put_event(TRACE_EVT_TASK_SWITCH, task_number, 0);
+}
+
+UBaseType_t trace_on_queue_create(void) {
+    next_queue_number++;
+    if ((uint16_t)next_queue_number == 0) {
+        next_queue_number++;
+    }
+    return next_queue_number;
+}
+
+void trace_on_queue_registry_add(UBaseType_t object, const char *name) {
+    if (queue_name_count < TRACE_MAX_QUEUE_NAMES) {
+        queue_names[queue_name_count].object = (uint16_t)object;
+        queue_names[queue_name_count].name = name;
+        queue_name_count++;
+    }
+}
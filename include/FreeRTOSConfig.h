@@ -181,6 +181,52 @@ extern BaseType_t prvRaisePrivilege( void );
 #define portGET_RUN_TIME_COUNTER_VALUE() getProfilerTimerCount()
 #define configINCLUDE_APPLICATION_DEFINED_PRIVILEGED_FUNCTIONS 1
 
+/* Per task statistics, implemented in ex2_system/source/task_stats/task_stats.c */
+UBaseType_t task_stats_on_create(void *task, UBaseType_t tcb_number);
+void task_stats_on_delete(void *task);
+void task_stats_on_ready(UBaseType_t slot);
+void task_stats_on_switched_in(UBaseType_t slot);
+void task_stats_on_switched_out(UBaseType_t slot);
+
+/* Event trace recorder, implemented in ex2_system/source/trace/trace_recorder.c */
+#include "trace/trace_recorder.h"
+
+#define configQUEUE_REGISTRY_SIZE 16
+
+#define traceTASK_CREATE( pxNewTCB ) do { \
+    ( pxNewTCB )->uxTaskNumber = task_stats_on_create( ( pxNewTCB ), ( pxNewTCB )->uxTCBNumber ); \
+    trace_on_task_create( ( pxNewTCB )->uxTaskNumber, ( pxNewTCB )->pcTaskName ); \
+} while( 0 )
+#define traceTASK_DELETE( pxTCB ) task_stats_on_delete( pxTCB )
+#define traceMOVED_TASK_TO_READY_STATE( pxTCB ) task_stats_on_ready( ( pxTCB )->uxTaskNumber )
+#define traceTASK_SWITCHED_IN() do { \
+    task_stats_on_switched_in( pxCurrentTCB->uxTaskNumber ); \
+    trace_on_switched_in( pxCurrentTCB->uxTaskNumber ); \
+} while( 0 )
+#define traceTASK_SWITCHED_OUT() task_stats_on_switched_out( pxCurrentTCB->uxTaskNumber )
+#define traceTASK_PRIORITY_INHERIT( pxTCBOfMutexHolder, uxInheritedPriority ) \
+    trace_record( TRACE_EVT_PRIORITY_INHERIT, ( pxTCBOfMutexHolder )->uxTaskNumber )
+#define traceTASK_PRIORITY_DISINHERIT( pxTCBOfMutexHolder, uxOriginalPriority ) \
+    trace_record( TRACE_EVT_PRIORITY_DISINHERIT, ( pxTCBOfMutexHolder )->uxTaskNumber )
+
+/* Queues, semaphores and mutexes share one implementation. Split the events by queue type */
+#define TRACE_QUEUE_EVENT( pxQueue, queue_event, semaphore_event ) \
+    trace_record( ( ( pxQueue )->ucQueueType == queueQUEUE_TYPE_BASE ) ? ( queue_event ) : ( semaphore_event ), \
+                  ( pxQueue )->uxQueueNumber )
+
+#define traceQUEUE_CREATE( pxNewQueue ) ( pxNewQueue )->uxQueueNumber = trace_on_queue_create()
+#define traceQUEUE_REGISTRY_ADD( xQueue, pcQueueName ) \
+    trace_on_queue_registry_add( ( ( Queue_t * )( xQueue ) )->uxQueueNumber, ( pcQueueName ) )
+#define traceQUEUE_SEND( pxQueue ) TRACE_QUEUE_EVENT( pxQueue, TRACE_EVT_QUEUE_SEND, TRACE_EVT_SEM_GIVE )
+#define traceQUEUE_RECEIVE( pxQueue ) TRACE_QUEUE_EVENT( pxQueue, TRACE_EVT_QUEUE_RECEIVE, TRACE_EVT_SEM_TAKE )
+#define traceBLOCKING_ON_QUEUE_SEND( pxQueue ) \
+    trace_record( TRACE_EVT_QUEUE_BLOCK_SEND, ( pxQueue )->uxQueueNumber )
+#define traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue ) \
+    TRACE_QUEUE_EVENT( pxQueue, TRACE_EVT_QUEUE_BLOCK_RECEIVE, TRACE_EVT_SEM_BLOCK )
+#define traceQUEUE_SEND_FROM_ISR( pxQueue ) trace_record( TRACE_EVT_QUEUE_SEND_ISR, ( pxQueue )->uxQueueNumber )
+#define traceQUEUE_RECEIVE_FROM_ISR( pxQueue ) \
+    trace_record( TRACE_EVT_QUEUE_RECEIVE_ISR, ( pxQueue )->uxQueueNumber )
+
 /* USER CODE END */
 
 #endif /* FREERTOS_CONFIG_H */
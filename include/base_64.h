@@ -25,6 +25,10 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+/* Characters base64 needs for n bytes, including padding */
+#define BASE64_ENCODED_LENGTH(n) (((n) + 2) / 3 * 4)
+
+size_t base64_encode_to(const unsigned char *data, size_t input_length, char *encoded_data);
 char *base64_encode(const unsigned char *data, size_t input_length, size_t *output_length);
 unsigned char *base64_decode(const char *data, size_t input_length, size_t *output_length);
 
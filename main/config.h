@@ -30,6 +30,7 @@
 #define HAS_SD_CARD 0
 #if HAS_SD_CARD == 1
 #define SD_CARD_REFORMAT 0
+#define SD_ARRAY_MODE 0 // 0: a volume per card, 1: both cards striped as VOL0, 2: mirrored as VOL0. See sd_array.h
 #endif
 
 #define ATHENA_IS_STUBBED 1
@@ -47,6 +47,7 @@
 #include "system_tasks.h"
 #include "mocks/rtc.h"
 #include "logger/logger.h"
+#include "telemetry/telemetry_store.h"
 #include "ads7128.h"
 #include "pcal9538a.h"
 #include "skytraq_gps.h"
@@ -69,6 +70,9 @@
 #include "csp/crypto/csp_hmac.h"
 #include "crypto.h"
 #include "csp_debug_wrapper.h"
+#include "trace/trace_recorder.h"
+#include "mem_pool/mem_pool.h"
+#include "sd_array.h"
 
 #define SDR_TEST 0
 
@@ -107,7 +111,9 @@ void vAssertCalled(unsigned long ulLine, const char *const pcFileName);
 void ex2_init(void *pvParameters) {
 
     init_filesystem();
+    trace_flush_frozen();
     init_csp();
+    telemetry_store_init();
 
     /* LEOP */
 
@@ -202,6 +208,7 @@ void flatsat_test(void *pvParameters) { vTaskDelete(NULL); }
 #endif
 
 int ex2_main(void) {
+    trace_init();
     _enable_IRQ_interrupt_(); // enable inturrupts
     InitIO();
     for (int i = 0; i < 1000000; i++)
@@ -258,7 +265,7 @@ static void init_filesystem() {
         return;
     }
 
-#if IS_ATHENA_V2 == 1 // TODO: make this IS_ATHENA once V2 is actively used
+#if IS_ATHENA_V2 == 1 && SD_ARRAY_MODE == SD_ARRAY_NONE // TODO: make this IS_ATHENA once V2 is actively used
     iErr = 0;
     const char *pszVolume1 = gaRedVolConf[1].pszPathPrefix;
 
@@ -419,14 +426,12 @@ void vAssertCalled(unsigned long ulLine, const char *const pcFileName) {
     (void)pcFileName;
 
     ex2_log("ASSERT! Line %d, file %s\r\n", ulLine, pcFileName);
+    // May be inside a critical section or an interrupt, so the file system can't be used. The next boot writes it
+    trace_freeze();
     for (;;)
         ;
 }
 
-static void prvSaveTraceFile(void) {
-    // TODO: implement this with relianceEdge
-}
-
 void initializeProfiler() {
     /* Enable PMU Cycle Counter for Profiling */
     RAISE_PRIVILEGE;
@@ -446,13 +451,16 @@ uint32 getProfilerTimerCount() {
 }
 
 void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName) {
+    // Called from inside the context switch, so the file system can't be used. The next boot writes the trace
+    trace_freeze();
     for (;;)
         ;
 }
 
 void vApplicationMallocFailedHook(void) {
-    for (;;)
-        ;
+    // pvPortMalloc returns NULL after this, which callers are expected to handle. Only count it: logging could
+    // allocate again from inside the allocator. The count is shown by the memstats command
+    mem_pool_malloc_failed();
 }
 
 void vApplicationDaemonTaskStartupHook(void) { init_logger_queue(); }
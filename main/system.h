@@ -42,6 +42,12 @@
 #define BEACON_TASK_PRIO (tskIDLE_PRIORITY + 1)
 #define DIAGNOSTIC_TASK_PRIO (tskIDLE_PRIORITY + 2)
 #define SYSTEM_STATS_TASK_PRIO (tskIDLE_PRIORITY + 1)
+#define EPS_TASK_PRIO (tskIDLE_PRIORITY + 1)
+#define ATHENA_SENSOR_TASK_PRIO (tskIDLE_PRIORITY + 1)
+#define IMAGE_VERIFY_TASK_PRIO (tskIDLE_PRIORITY + 1)
+#define FW_UPDATE_TASK_PRIO (tskIDLE_PRIORITY + 1)
+#define SD_REBUILD_TASK_PRIO (tskIDLE_PRIORITY + 1)
+#define IRIS_PROGRAM_TASK_PRIO (tskIDLE_PRIORITY + 1)
 #define LOGGER_TASK_PRIO (tskIDLE_PRIORITY + 2)
 #define MOCK_RTC_TASK_PRIO (configMAX_PRIORITIES - 1)
 #define TASK_MANAGER_PRIO (tskIDLE_PRIORITY + 3)
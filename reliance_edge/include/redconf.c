@@ -9,11 +9,12 @@
 #include <redtypes.h>
 #include <redmacs.h>
 #include <redvolume.h>
+#include <sd_array.h>
 
 
 const VOLCONF gaRedVolConf[REDCONF_VOLUME_COUNT] =
 {
-    { 512U, 3717120U, 0U, false, 10000U, 3U, "VOL0:" }, //SD card is 3717120U sectors according to fdisk
+    { 512U, SD_ARRAY_SECTORS, 0U, false, 10000U, 3U, "VOL0:" }, //one card, or both as an array (sd_array.h)
     { 512U, 3717120U, 0U, false, 10000U, 3U, "VOL1:" } //SD card is 3717120U sectors according to fdisk
 
     //Sector size, number of sectors, sector offset, atomic sector write, inode (file and directory) count, number of block retries, path prefix for volume
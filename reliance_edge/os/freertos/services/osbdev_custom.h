@@ -52,6 +52,7 @@
 
 */
 #include <sd_io.h>
+#include <sd_array.h>
 
 /* @brief Initialize a disk.
 
@@ -69,12 +70,20 @@ static REDSTATUS DiskOpen(
     BDEVOPENMODE    mode)
 {
     //  Insert code here to open/initialize the block device.
+#if SD_ARRAY_MODE != SD_ARRAY_NONE
+    //  Both cards make up VOL0, so neither may be opened as a volume of its own
+    if((bVolNum == 0U) && (sd_array_open() == SD_OK)){
+        return 0;
+    }
+    return -RED_EIO;
+#else
     if(SD_Init(bVolNum)==SD_OK){
         return 0;
     }
     else{
         return -RED_EIO;
     }
+#endif
 }
 
 
@@ -138,9 +147,12 @@ static REDSTATUS DiskRead(
 
     /*  Insert code here to read sectors from the block device.*/
     //note: assumes 512 byte sectors
+#if SD_ARRAY_MODE != SD_ARRAY_NONE
+    return (sd_array_read((uint32_t)ullSectorStart, ulSectorCount, pBuffer) == SD_OK) ? 0 : -RED_EIO;
+#else
     int i;
     for(i=0; i<ulSectorCount; i++){
-        if(SD_Read(bVolNum, (BYTE *)pBuffer + (BYTE)(i*512), ullSectorStart + i, 0, 512) == SD_OK){
+        if(SD_Read(bVolNum, (BYTE *)pBuffer + (i*512), ullSectorStart + i, 0, 512) == SD_OK){
             //do nothing
         }
         else{
@@ -148,6 +160,7 @@ static REDSTATUS DiskRead(
         }
     }
     return 0;
+#endif
 }
 
 #if REDCONF_READ_ONLY == 0
@@ -181,10 +194,13 @@ static REDSTATUS DiskWrite(
     (void)pBuffer;
 
     /*  Insert code here to write sectors to the block device.*/
+#if SD_ARRAY_MODE != SD_ARRAY_NONE
+    return (sd_array_write((uint32_t)ullSectorStart, ulSectorCount, pBuffer) == SD_OK) ? 0 : -RED_EIO;
+#else
     int i;
     SDRESULTS returnval;
     for(i=0; i<ulSectorCount; i++){
-        returnval = SD_Write(bVolNum, (BYTE *)pBuffer + (BYTE)(i*512), ullSectorStart + i);
+        returnval = SD_Write(bVolNum, (BYTE *)pBuffer + (i*512), ullSectorStart + i);
         if(returnval == SD_OK){
             //do nothing
         }
@@ -193,6 +209,7 @@ static REDSTATUS DiskWrite(
         }
     }
     return 0;
+#endif
 }
 
 /** @brief Flush any caches beneath the file system.
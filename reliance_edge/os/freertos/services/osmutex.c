@@ -75,6 +75,13 @@ REDSTATUS RedOsMutexInit(void)
     }
   #endif
 
+  #if configQUEUE_REGISTRY_SIZE > 0
+    if(ret == 0)
+    {
+        vQueueAddToRegistry(xMutex, "red_fs");
+    }
+  #endif
+
     return ret;
 }
 
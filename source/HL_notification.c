@@ -68,6 +68,7 @@
 /* USER CODE BEGIN (0) */
 #include <stdint.h>
 #include "system.h"
+#include "trace/trace_recorder.h"
 
 #pragma WEAK(gps_sciNotification)
 void gps_sciNotification(sciBASE_t *sci, unsigned flags);
@@ -84,6 +85,9 @@ void adcs_sciNotification(sciBASE_t *sci, unsigned flags);
 #pragma WEAK(dfgm_sciNotification)
 void dfgm_sciNotification(sciBASE_t *sci, unsigned flags);
 
+#pragma WEAK(iris_spiEndNotification)
+void iris_spiEndNotification(spiBASE_t *spi);
+
 /* USER CODE END */
 #pragma WEAK(esmGroup1Notification)
 void esmGroup1Notification(esmBASE_t *esm, uint32 channel)
@@ -126,6 +130,7 @@ void dmaGroupANotification(dmaInterrupt_t inttype, uint32 channel)
 {
 /*  enter user code between the USER CODE BEGIN and USER CODE END. */
 /* USER CODE BEGIN (8) */
+    trace_isr(TRACE_ISR_SOURCE(TRACE_ISR_DMA, channel));
 /* USER CODE END */
 }
 
@@ -168,6 +173,7 @@ void canMessageNotification(canBASE_t *node, uint32 messageBox)
 {
 /*  enter user code between the USER CODE BEGIN and USER CODE END. */
 /* USER CODE BEGIN (18) */
+    trace_isr(TRACE_ISR_SOURCE(TRACE_ISR_CAN, (uint32_t)node >> 8));
 /* USER CODE END */
 }
 
@@ -188,6 +194,7 @@ void gioNotification(gioPORT_t *port, uint32 bit)
 {
 /*  enter user code between the USER CODE BEGIN and USER CODE END. */
 /* USER CODE BEGIN (22) */
+    trace_isr(TRACE_ISR_SOURCE(TRACE_ISR_GIO, bit));
     switch ((int) port) {
     case (int)RTC_INT_PORT: {
         switch (bit) {
@@ -221,6 +228,7 @@ void sciNotification(sciBASE_t *sci, uint32 flags)
 {
 /*  enter user code between the USER CODE BEGIN and USER CODE END. */
 /* USER CODE BEGIN (32) */
+    trace_isr(TRACE_ISR_SOURCE(TRACE_ISR_SCI, (uint32_t)sci >> 8));
     uint32_t int_reg = (uint32_t)sci;
     switch(int_reg) {
 #if IS_EXALTA2 == 1
@@ -252,6 +260,10 @@ void spiEndNotification(spiBASE_t *spi)
 {
 /*  enter user code between the USER CODE BEGIN and USER CODE END. */
 /* USER CODE BEGIN (36) */
+    trace_isr(TRACE_ISR_SOURCE(TRACE_ISR_SPI, (uint32_t)spi >> 8));
+    if (spi == IRIS_SPI) {
+        iris_spiEndNotification(spi);
+    }
 /* USER CODE END */
 }
 
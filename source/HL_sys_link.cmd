@@ -158,6 +158,8 @@ SECTIONS
     .kernelHEAP   : {} > RAM
     .bss          : {} > RAM
     .data         : {} > RAM
+    /* Kept through watchdog and software resets, see trace_recorder.c */
+    .traceNOINIT  : {} > RAM, type = NOINIT
 
 	.flashAPI :
 	    {
@@ -17,15 +17,10 @@ static int mod_table[] = {0, 2, 1};
 static void build_decoding_table();
 static void base64_cleanup();
 
-char *base64_encode(const unsigned char *data, size_t input_length, size_t *output_length) {
-
-    *output_length = (input_length + 2) * 8 / 6; /* 3-byte blocks to 4-byte */
-
-    char *encoded_data = (char *)pvPortMalloc(*output_length);
-    if (encoded_data == NULL)
-        return NULL;
+size_t base64_encode_to(const unsigned char *data, size_t input_length, char *encoded_data) {
+    size_t j = 0;
 
-    for (int i = 0, j = 0; i < input_length;) {
+    for (size_t i = 0; i < input_length;) {
 
         uint32_t octet_a = i < input_length ? (unsigned char)data[i++] : 0;
         uint32_t octet_b = i < input_length ? (unsigned char)data[i++] : 0;
@@ -40,8 +35,20 @@ char *base64_encode(const unsigned char *data, size_t input_length, size_t *outp
     }
 
     for (int i = 0; i < mod_table[input_length % 3]; i++)
-        encoded_data[*output_length - 1 - i] = '=';
+        encoded_data[j - 1 - i] = '=';
+
+    return j;
+}
+
+char *base64_encode(const unsigned char *data, size_t input_length, size_t *output_length) {
+
+    *output_length = BASE64_ENCODED_LENGTH(input_length); /* 3-byte blocks to 4-byte */
+
+    char *encoded_data = (char *)pvPortMalloc(*output_length);
+    if (encoded_data == NULL)
+        return NULL;
 
+    base64_encode_to(data, input_length, encoded_data);
     return encoded_data;
 }
 
@@ -10,6 +10,7 @@
 #include "os_semphr.h"
 #include <stdint.h>
 #include "os_task.h"
+#include "trace/trace_recorder.h"
 
 /** @struct i2Csemphr
 *   @brief Interrupt mode globals
@@ -156,6 +157,8 @@ void i2cNotification(i2cBASE_t *i2c, uint32 flags) {
     uint32 reg = i2c == i2cREG1 ? 0U : 1U;
     static BaseType_t xHigherPriorityTaskWoken=pdFALSE;
 
+    trace_isr(TRACE_ISR_SOURCE(TRACE_ISR_I2C, (uint32_t)i2c >> 8));
+
     switch (flags) {
 
     case I2C_NACK_INT: // nack received after start byte. attempt to recover. A nack on the start byte does not trigger an interrupt
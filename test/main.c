@@ -1,6 +1,12 @@
 #include "logger/test_logger.h"
 #include "test_leop.h"
 #include "test_adcs_handler.h"
+#include "test_NMEAParser.h"
+#include "test_skytraq_nav.h"
+#include "image_verify/test_image_crc.h"
+#include "nv_store/test_nv_store.h"
+#include "fw_update/test_fw_delta.h"
+#include "housekeeping/test_hk_rollup.h"
 #include "test_leop.h"
 
 int main() {
@@ -8,6 +14,12 @@ int main() {
     status += test_logger();
     status += test_leop();
     status += test_adcs_handler();
+    status += test_NMEAParser();
+    status += test_skytraq_nav();
+    status += test_image_crc();
+    status += test_nv_store();
+    status += test_fw_delta();
+    status += test_hk_rollup();
     status += test_leop();
     return status;
 }
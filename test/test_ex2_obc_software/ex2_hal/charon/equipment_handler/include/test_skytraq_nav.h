@@ -0,0 +1,6 @@
+#ifndef TEST_SKYTRAQ_NAV
+#define TEST_SKYTRAQ_NAV
+
+int test_skytraq_nav(void);
+
+#endif
@@ -0,0 +1,127 @@
+/*
+ * test_skytraq_nav.c
+ *
+ *  Created on: Oct. 19, 2026
+ */
+
+#include <cgreen/cgreen.h>
+#include <cgreen/mocks.h>
+
+#include <string.h>
+
+#include "NMEAParser.h"
+#include "skytraq_nav.h"
+
+/*
+ * Navigation data messages as sent by the receiver. 3D fix over Edmonton at
+ * GPS week 2437, 345600.12 s into the week, followed by a message without a fix.
+ */
+static const uint8_t NAV_3D_FIX[] = {
+    0xA0, 0xA1, 0x00, 0x3B, 0xA8, 0x02, 0x09, 0x09, 0x85, 0x02, 0x0F, 0x58, 0x0C, 0x1F, 0xEA, 0x7C, 0x88,
+    0xBC, 0x5A, 0x38, 0x70, 0x03, 0x47, 0x6B, 0xF9, 0x03, 0x47, 0x62, 0xD0, 0x00, 0xD2, 0x00, 0xB4, 0x00,
+    0x5F, 0x00, 0x96, 0x00, 0x6E, 0xF6, 0xC1, 0x01, 0x00, 0xEA, 0x26, 0xFE, 0x96, 0x1F, 0xA9, 0xFF, 0x07,
+    0x00, 0x07, 0xD1, 0x59, 0xFF, 0xFE, 0x1D, 0xC0, 0xFF, 0xF4, 0xCA, 0x99, 0xEF, 0x0D, 0x0A};
+
+static const uint8_t NAV_NO_FIX[] = {
+    0xA0, 0xA1, 0x00, 0x3B, 0xA8, 0x00, 0x03, 0x09, 0x85, 0x02, 0x0F, 0x58, 0x70, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x27, 0x0F, 0x27, 0x0F, 0x27,
+    0x0F, 0x27, 0x0F, 0x27, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x2A, 0x0D, 0x0A};
+
+/* 2026-09-23 23:59:42 UTC */
+#define NAV_3D_FIX_UNIX_TIME 1790207982
+
+Describe(skytraq_nav);
+BeforeEach(skytraq_nav) {
+    always_expect(xTaskGetTickCount, will_return(100));
+    NMEAParser_reset_all_values();
+}
+AfterEach(skytraq_nav) {}
+
+Ensure(skytraq_nav, decodes_navigation_data) {
+    skytraq_nav_t nav;
+    assert_that(skytraq_decode_nav(NAV_3D_FIX, sizeof(NAV_3D_FIX), &nav), is_true);
+
+    assert_that(nav.fix_mode, is_equal_to(SKYTRAQ_FIX_3D));
+    assert_that(nav.numsats, is_equal_to(9));
+    assert_that(nav.week, is_equal_to(2437));
+    assert_that(nav.tow, is_equal_to(34560012));
+    assert_that(nav.latitude, is_equal_to(535461000));
+    assert_that(nav.longitude, is_equal_to(-1134938000));
+    assert_that(nav.ellipsoid_altitude, is_equal_to(55012345));
+    assert_that(nav.altitude, is_equal_to(55010000));
+    assert_that(nav.gdop, is_equal_to(210));
+    assert_that(nav.pdop, is_equal_to(180));
+    assert_that(nav.hdop, is_equal_to(95));
+    assert_that(nav.vdop, is_equal_to(150));
+    assert_that(nav.tdop, is_equal_to(110));
+    assert_that(nav.ecef_x, is_equal_to(-155123456));
+    assert_that(nav.ecef_y, is_equal_to(-366543210));
+    assert_that(nav.ecef_z, is_equal_to(531234567));
+    assert_that(nav.ecef_vx, is_equal_to(512345));
+    assert_that(nav.ecef_vy, is_equal_to(-123456));
+    assert_that(nav.ecef_vz, is_equal_to(-734567));
+}
+
+Ensure(skytraq_nav, rejects_corrupted_frames) {
+    uint8_t frame[sizeof(NAV_3D_FIX)];
+    skytraq_nav_t nav;
+
+    memcpy(frame, NAV_3D_FIX, sizeof(frame));
+    frame[20] ^= 0x01;
+    assert_that(skytraq_decode_nav(frame, sizeof(frame), &nav), is_false);
+
+    assert_that(skytraq_decode_nav(NAV_3D_FIX, sizeof(NAV_3D_FIX) - 1, &nav), is_false);
+
+    // A valid binary message that isn't navigation data
+    static const uint8_t ack[] = {0xA0, 0xA1, 0x00, 0x02, 0x83, 0x09, 0x8A, 0x0D, 0x0A};
+    assert_that(skytraq_decode_nav(ack, sizeof(ack), &nav), is_false);
+}
+
+Ensure(skytraq_nav, converts_gps_time_to_utc) {
+    skytraq_nav_t nav;
+    skytraq_decode_nav(NAV_3D_FIX, sizeof(NAV_3D_FIX), &nav);
+
+    assert_that(skytraq_nav_unix_time(&nav, 0), is_equal_to(NAV_3D_FIX_UNIX_TIME));
+    // 0.12 s into the second, so 880 ms later is the next second
+    assert_that(skytraq_nav_unix_time(&nav, 870), is_equal_to(NAV_3D_FIX_UNIX_TIME));
+    assert_that(skytraq_nav_unix_time(&nav, 880), is_equal_to(NAV_3D_FIX_UNIX_TIME + 1));
+}
+
+Ensure(skytraq_nav, parser_publishes_fix) {
+    nmea_stats_t before, after;
+    skytraq_nav_t nav;
+    NMEAParser_get_stats(&before);
+
+    assert_that(NMEAParser_parse_nav(NAV_3D_FIX, sizeof(NAV_3D_FIX)), is_true);
+    NMEAParser_get_stats(&after);
+
+    assert_that(after.nav_parsed, is_equal_to(before.nav_parsed + 1));
+    assert_that(NMEAParser_get_nav(&nav), is_true);
+    assert_that(nav.latitude, is_equal_to(535461000));
+    assert_that(nav._logtime, is_equal_to(100));
+}
+
+Ensure(skytraq_nav, parser_counts_but_does_not_publish_no_fix) {
+    nmea_stats_t before, after;
+    skytraq_nav_t nav;
+    NMEAParser_get_stats(&before);
+
+    assert_that(NMEAParser_parse_nav(NAV_NO_FIX, sizeof(NAV_NO_FIX)), is_false);
+    assert_that(NMEAParser_parse_nav(NAV_NO_FIX, 10), is_false);
+    NMEAParser_get_stats(&after);
+
+    assert_that(after.nav_parsed, is_equal_to(before.nav_parsed + 1));
+    assert_that(after.nav_errors, is_equal_to(before.nav_errors + 1));
+    assert_that(NMEAParser_get_nav(&nav), is_false);
+}
+
+int test_skytraq_nav(void) {
+    TestSuite *suite = create_test_suite();
+    add_test_with_context(suite, skytraq_nav, decodes_navigation_data);
+    add_test_with_context(suite, skytraq_nav, rejects_corrupted_frames);
+    add_test_with_context(suite, skytraq_nav, converts_gps_time_to_utc);
+    add_test_with_context(suite, skytraq_nav, parser_publishes_fix);
+    add_test_with_context(suite, skytraq_nav, parser_counts_but_does_not_publish_no_fix);
+    return run_test_suite(suite, create_text_reporter());
+}
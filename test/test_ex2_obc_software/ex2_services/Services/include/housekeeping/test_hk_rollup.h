@@ -0,0 +1,6 @@
+#ifndef TEST_HK_ROLLUP
+#define TEST_HK_ROLLUP
+
+int test_hk_rollup(void);
+
+#endif
@@ -0,0 +1,153 @@
+/*
+ * test_hk_rollup.c
+ *
+ *  Created on: Oct. 19, 2026
+ */
+
+#include <cgreen/cgreen.h>
+#include <cgreen/mocks.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#include "housekeeping/hk_rollup.h"
+#include "housekeeping/hk_schema.h"
+#include <FreeRTOS.h>
+#include <os_semphr.h>
+#include <redposix.h>
+
+/* The rollups only need the schema, which has no dependencies of its own */
+#include "../../../../../../ex2_services/Services/source/housekeeping/hk_schema.c"
+
+/* Start of a day, so a 5 minute boundary inside it doesn't end the hour or the day */
+#define DAY_START 1798761600u
+#define FILE_5MIN 1
+
+/* The last rollup written to the 5 minute file */
+static uint8_t written[HK_ROLLUP_STATS][HK_RECORD_SIZE];
+static uint32_t written_records;
+static int64_t written_offset;
+static uint32_t flushes;
+static REDSTATUS errno_value;
+
+int32_t red_open(const char *pszPath, uint32_t ulOpenMode) {
+    if (strcmp(pszPath, "VOL0:/HKroll5m.TMP") != 0) {
+        return 2;
+    }
+    flushes++;
+    written_records = 0;
+    written_offset = -1;
+    return FILE_5MIN;
+}
+
+int64_t red_lseek(int32_t iFildes, int64_t llOffset, REDWHENCE whence) {
+    if (iFildes == FILE_5MIN) {
+        written_offset = llOffset;
+    }
+    return llOffset;
+}
+
+int32_t red_write(int32_t iFildes, const void *pBuffer, uint32_t ulLength) {
+    if (iFildes == FILE_5MIN && written_records < HK_ROLLUP_STATS && ulLength == HK_RECORD_SIZE) {
+        memcpy(written[written_records++], pBuffer, ulLength);
+    }
+    return ulLength;
+}
+
+int32_t red_read(int32_t iFildes, void *pBuffer, uint32_t ulLength) { return -1; }
+
+int32_t red_close(int32_t iFildes) { return 0; }
+
+REDSTATUS *red_errnoptr(void) { return &errno_value; }
+
+QueueHandle_t xQueueCreateMutex(const uint8_t ucQueueType) { return (QueueHandle_t)1; }
+
+BaseType_t xQueueSemaphoreTake(QueueHandle_t xQueue, TickType_t xTicksToWait) { return pdTRUE; }
+
+BaseType_t xQueueGenericSend(QueueHandle_t xQueue, const void *const pvItemToQueue, TickType_t xTicksToWait,
+                             const BaseType_t xCopyPosition) {
+    return pdTRUE;
+}
+
+BaseType_t MPU_xQueueGenericReceive(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait,
+                                    const BaseType_t xJustPeek) {
+    return pdTRUE;
+}
+
+void sys_log(SysLog_Level level, const char *format, ...) {}
+
+void *csp_buffer_get(size_t size) { return NULL; }
+
+void csp_buffer_free(void *packet) {}
+
+int csp_send(csp_conn_t *conn, csp_packet_t *packet, uint32_t timeout) { return 0; }
+
+void set_packet_length(csp_packet_t *packet, uint16_t length) {}
+
+void service_dispatcher_feed(void) {}
+
+static All_systems_housekeeping hk;
+
+static void add(uint32_t time, uint32_t freq, double eps_time) {
+    memset(&hk, 0, sizeof(hk));
+    hk.hk_timeorder.UNIXtimestamp = time;
+    hk.UHF_hk.freq = freq;
+    hk.EPS_hk.timestampInS = eps_time;
+    hk_rollup_add(&hk);
+}
+
+static const All_systems_housekeeping *stat(hk_rollup_stat which) {
+    memset(&hk, 0, sizeof(hk));
+    memcpy(&hk, written[which], HK_RECORD_SIZE);
+    return &hk;
+}
+
+Describe(hk_rollup);
+BeforeEach(hk_rollup){};
+AfterEach(hk_rollup){};
+
+Ensure(hk_rollup, writes_a_period_when_the_next_begins) {
+    // The first record may close a period left open by an earlier test
+    add(DAY_START + 300, 435000001u, 1798761900.125);
+    uint32_t before = flushes;
+    add(DAY_START + 420, 435000005u, 1798762020.25);
+    add(DAY_START + 599, 435000003u, 1798762099.5);
+    assert_that(flushes, is_equal_to(before));
+
+    add(DAY_START + 600, 437000000u, 1798762100.0);
+    assert_that(flushes, is_equal_to(before + 1));
+    assert_that(written_records, is_equal_to(HK_ROLLUP_STATS));
+    assert_that(written_offset, is_equal_to(((DAY_START + 300) / 300 % 576) * HK_ROLLUP_STATS * HK_RECORD_SIZE));
+
+    // Values this large only survive in a type wider than float
+    assert_that(stat(HK_ROLLUP_MIN)->UHF_hk.freq, is_equal_to(435000001u));
+    assert_that(stat(HK_ROLLUP_MIN)->EPS_hk.timestampInS == 1798761900.125, is_true);
+    assert_that(stat(HK_ROLLUP_MAX)->UHF_hk.freq, is_equal_to(435000005u));
+    assert_that(stat(HK_ROLLUP_MAX)->EPS_hk.timestampInS == 1798762099.5, is_true);
+    assert_that(stat(HK_ROLLUP_MEAN)->UHF_hk.freq, is_equal_to(435000003u));
+    assert_that(stat(HK_ROLLUP_LAST)->UHF_hk.freq, is_equal_to(435000003u));
+    assert_that(stat(HK_ROLLUP_LAST)->EPS_hk.timestampInS == 1798762099.5, is_true);
+
+    hk_rollup_stat which;
+    for (which = HK_ROLLUP_MIN; which < HK_ROLLUP_STATS; which++) {
+        assert_that(stat(which)->hk_timeorder.UNIXtimestamp, is_equal_to(DAY_START + 300));
+        assert_that(stat(which)->hk_timeorder.dataPosition, is_equal_to(3));
+    }
+}
+
+Ensure(hk_rollup, skips_records_without_a_timestamp) {
+    add(DAY_START + 900, 1, 1.0);
+    add(0, 2, 2.0);
+    add(DAY_START + 1200, 3, 3.0);
+    assert_that(stat(HK_ROLLUP_LAST)->hk_timeorder.UNIXtimestamp, is_equal_to(DAY_START + 900));
+    assert_that(written_records, is_equal_to(HK_ROLLUP_STATS));
+    assert_that(stat(HK_ROLLUP_LAST)->UHF_hk.freq, is_equal_to(1));
+    assert_that(stat(HK_ROLLUP_LAST)->hk_timeorder.dataPosition, is_equal_to(1));
+}
+
+int test_hk_rollup(void) {
+    TestSuite *suite = create_test_suite();
+    add_test_with_context(suite, hk_rollup, writes_a_period_when_the_next_begins);
+    add_test_with_context(suite, hk_rollup, skips_records_without_a_timestamp);
+    return run_test_suite(suite, create_text_reporter());
+}
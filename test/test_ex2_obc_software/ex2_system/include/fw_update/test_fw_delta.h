@@ -0,0 +1,6 @@
+#ifndef TEST_FW_DELTA
+#define TEST_FW_DELTA
+
+int test_fw_delta(void);
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef TEST_IMAGE_CRC
+#define TEST_IMAGE_CRC
+
+int test_image_crc(void);
+
+#endif
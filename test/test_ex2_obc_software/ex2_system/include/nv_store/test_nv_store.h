@@ -0,0 +1,6 @@
+#ifndef TEST_NV_STORE
+#define TEST_NV_STORE
+
+int test_nv_store(void);
+
+#endif
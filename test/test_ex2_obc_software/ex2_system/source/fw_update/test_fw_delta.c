@@ -0,0 +1,162 @@
+/*
+ * test_fw_delta.c
+ *
+ *  Created on: Oct. 19, 2026
+ */
+
+#include <cgreen/cgreen.h>
+#include <cgreen/mocks.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#include "fw_update/fw_delta.h"
+
+static const uint8_t old_image[] = "The quick brown fox jumps over the lazy dog";
+static const uint8_t new_image[] = "The quick red fox jumps over the lazy dog!";
+
+/* Copy "The quick ", insert "red", skip "brown", copy " fox jumps over the lazy dog", insert "!" */
+static const uint8_t patch[] = {
+    0x45, 0x58, 0x44, 0x31, 0, 0, 0, 43, 0, 0, 0, 0, 0, 42, 0, 0, 0, 0,
+    FW_DELTA_COPY, 10, 0,
+    FW_DELTA_INSERT, 3, 'r', 'e', 'd',
+    FW_DELTA_COPY, 28, 10, // move forward 5
+    FW_DELTA_INSERT, 1, '!',
+    FW_DELTA_END,
+};
+
+/* Same length as the old image with "fox" changed to "cat", sent as one ADD */
+static const uint8_t add_image[] = "The quick brown cat jumps over the lazy dog";
+static const uint8_t add_patch[] = {
+    0x45, 0x58, 0x44, 0x31, 0, 0, 0, 43, 0, 0, 0, 0, 0, 43, 0, 0, 0, 0,
+    FW_DELTA_ADD, 43, 0, 3,
+    16, (uint8_t)('c' - 'f'),
+    0, (uint8_t)('a' - 'o'),
+    0, (uint8_t)('t' - 'x'),
+    FW_DELTA_END,
+};
+
+static uint8_t output[64];
+static uint32_t output_length;
+static bool output_in_order;
+
+static bool collect(uint32_t offset, const uint8_t *data, uint32_t length) {
+    if (offset != output_length || offset + length > sizeof(output)) {
+        output_in_order = false;
+        return false;
+    }
+    memcpy(&output[offset], data, length);
+    output_length += length;
+    return true;
+}
+
+static fw_delta_ctx ctx;
+
+static void start(const uint8_t *p) {
+    fw_delta_header header;
+    fw_delta_parse_header(p, &header);
+    fw_delta_init(&ctx, &header, old_image, collect);
+}
+
+Describe(fw_delta);
+BeforeEach(fw_delta) {
+    memset(output, 0, sizeof(output));
+    output_length = 0;
+    output_in_order = true;
+}
+AfterEach(fw_delta) {}
+
+Ensure(fw_delta, parses_header) {
+    fw_delta_header header;
+    uint8_t bad[FW_DELTA_HEADER_SIZE];
+    assert_that(fw_delta_parse_header(patch, &header), is_true);
+    assert_that(header.source_size, is_equal_to(43));
+    assert_that(header.target_size, is_equal_to(42));
+    memcpy(bad, patch, sizeof(bad));
+    bad[0] = 0;
+    assert_that(fw_delta_parse_header(bad, &header), is_false);
+}
+
+Ensure(fw_delta, applies_whole_patch) {
+    start(patch);
+    assert_that(fw_delta_feed(&ctx, patch + FW_DELTA_HEADER_SIZE, sizeof(patch) - FW_DELTA_HEADER_SIZE),
+                is_equal_to(FW_DELTA_DONE));
+    assert_that(output_length, is_equal_to(42));
+    assert_that(memcmp(output, new_image, 42), is_equal_to(0));
+}
+
+Ensure(fw_delta, applies_patch_a_byte_at_a_time) {
+    uint32_t i;
+    fw_delta_result result = FW_DELTA_MORE;
+    start(patch);
+    for (i = FW_DELTA_HEADER_SIZE; i < sizeof(patch); i++) {
+        assert_that(result, is_equal_to(FW_DELTA_MORE));
+        result = fw_delta_feed(&ctx, &patch[i], 1);
+    }
+    assert_that(result, is_equal_to(FW_DELTA_DONE));
+    assert_that(output_in_order, is_true);
+    assert_that(memcmp(output, new_image, 42), is_equal_to(0));
+}
+
+Ensure(fw_delta, applies_add_a_byte_at_a_time) {
+    uint32_t i;
+    fw_delta_result result = FW_DELTA_MORE;
+    start(add_patch);
+    for (i = FW_DELTA_HEADER_SIZE; i < sizeof(add_patch); i++) {
+        assert_that(result, is_equal_to(FW_DELTA_MORE));
+        result = fw_delta_feed(&ctx, &add_patch[i], 1);
+    }
+    assert_that(result, is_equal_to(FW_DELTA_DONE));
+    assert_that(output_in_order, is_true);
+    assert_that(output_length, is_equal_to(43));
+    assert_that(memcmp(output, add_image, 43), is_equal_to(0));
+}
+
+Ensure(fw_delta, rejects_change_past_end_of_add) {
+    const uint8_t body[] = {FW_DELTA_ADD, 10, 0, 1, 10, 1}; // the changed byte would be the 11th
+    start(add_patch);
+    assert_that(fw_delta_feed(&ctx, body, sizeof(body)), is_equal_to(FW_DELTA_ERROR));
+}
+
+Ensure(fw_delta, rejects_copy_past_old_image) {
+    const uint8_t body[] = {FW_DELTA_COPY, 10, 80, FW_DELTA_END}; // move forward 40
+    start(patch);
+    assert_that(fw_delta_feed(&ctx, body, sizeof(body)), is_equal_to(FW_DELTA_ERROR));
+    assert_that(output_length, is_equal_to(0));
+}
+
+Ensure(fw_delta, rejects_output_past_new_image) {
+    const uint8_t body[] = {FW_DELTA_COPY, 43, 0};
+    start(patch);
+    assert_that(fw_delta_feed(&ctx, body, sizeof(body)), is_equal_to(FW_DELTA_ERROR));
+}
+
+Ensure(fw_delta, rejects_early_end_and_bad_operation) {
+    const uint8_t early[] = {FW_DELTA_COPY, 10, 0, FW_DELTA_END};
+    const uint8_t bad[] = {7};
+    start(patch);
+    assert_that(fw_delta_feed(&ctx, early, sizeof(early)), is_equal_to(FW_DELTA_ERROR));
+    start(patch);
+    assert_that(fw_delta_feed(&ctx, bad, sizeof(bad)), is_equal_to(FW_DELTA_ERROR));
+}
+
+Ensure(fw_delta, stops_when_output_fails) {
+    start(patch);
+    output_length = 5; // collect refuses the first piece
+    assert_that(fw_delta_feed(&ctx, patch + FW_DELTA_HEADER_SIZE, sizeof(patch) - FW_DELTA_HEADER_SIZE),
+                is_equal_to(FW_DELTA_ERROR));
+}
+
+int test_fw_delta(void) {
+    TestSuite *suite = create_test_suite();
+    add_test_with_context(suite, fw_delta, parses_header);
+    add_test_with_context(suite, fw_delta, applies_whole_patch);
+    add_test_with_context(suite, fw_delta, applies_patch_a_byte_at_a_time);
+    add_test_with_context(suite, fw_delta, applies_add_a_byte_at_a_time);
+    add_test_with_context(suite, fw_delta, rejects_change_past_end_of_add);
+    add_test_with_context(suite, fw_delta, rejects_copy_past_old_image);
+    add_test_with_context(suite, fw_delta, rejects_output_past_new_image);
+    add_test_with_context(suite, fw_delta, rejects_early_end_and_bad_operation);
+    add_test_with_context(suite, fw_delta, stops_when_output_fails);
+    return run_test_suite(suite, create_text_reporter());
+}
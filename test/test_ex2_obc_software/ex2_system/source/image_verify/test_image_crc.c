@@ -0,0 +1,92 @@
+/*
+ * test_image_crc.c
+ *
+ *  Created on: Oct. 19, 2026
+ */
+
+#include <cgreen/cgreen.h>
+#include <cgreen/mocks.h>
+
+#include <stdint.h>
+
+#include "image_verify/image_crc.h"
+
+static const uint8_t CHECK[] = "123456789";
+
+/* Bit at a time CRC-16 that bl_eeprom.c used before the table */
+static uint16_t reference_crc16(const uint8_t *ptr, int count) {
+    uint16_t crc = 0;
+    int i;
+    while (--count >= 0) {
+        crc = crc ^ ((uint16_t)*ptr++ << 8);
+        for (i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (uint16_t)(crc << 1) ^ 0x1021 : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/* The CRC module's PSA compressing one 64 bit word, as given in TI's CRC controller documentation */
+static uint64_t reference_psa(uint64_t crc, uint64_t data) {
+    int i;
+    for (i = 63; i >= 0; i--) {
+        uint64_t feedback = ((crc >> 63) ^ (data >> i)) & 1;
+        crc = (crc << 1) ^ (feedback ? 0x1B : 0);
+    }
+    return crc;
+}
+
+static uint8_t pattern[1029];
+
+Describe(image_crc);
+BeforeEach(image_crc) {
+    uint32_t i;
+    for (i = 0; i < sizeof(pattern); i++) {
+        pattern[i] = (uint8_t)(i * 37 + (i >> 3));
+    }
+}
+AfterEach(image_crc) {}
+
+Ensure(image_crc, crc16_matches_check_value) { assert_that(image_crc16(0, CHECK, 9), is_equal_to(0x31C3)); }
+
+Ensure(image_crc, crc16_matches_bitwise_version) {
+    assert_that(image_crc16(0, pattern, sizeof(pattern)),
+                is_equal_to(reference_crc16(pattern, sizeof(pattern))));
+}
+
+Ensure(image_crc, crc64_matches_hardware_signature) {
+    uint64_t psa = 0;
+    uint32_t i, j;
+    for (i = 0; i + 8 <= sizeof(pattern); i += 8) {
+        uint64_t word = 0;
+        for (j = 0; j < 8; j++) {
+            word = (word << 8) | pattern[i + j]; // big-endian, as the TMS570 reads it
+        }
+        psa = reference_psa(psa, word);
+    }
+    assert_that(image_crc64(0, pattern, i) == psa, is_true);
+}
+
+Ensure(image_crc, crc64_continues_across_pieces) {
+    uint64_t whole = image_crc64(0, pattern, sizeof(pattern));
+    uint64_t pieces = image_crc64(0, pattern, 512);
+    pieces = image_crc64(pieces, pattern + 512, 500);
+    pieces = image_crc64(pieces, pattern + 1012, sizeof(pattern) - 1012);
+    assert_that(whole == pieces, is_true);
+    assert_that(image_crc64(0, CHECK, 9) == 0xE4FFBEA588933790ULL, is_true);
+}
+
+Ensure(image_crc, crc16_continues_across_pieces) {
+    uint16_t pieces = image_crc16(image_crc16(0, pattern, 100), pattern + 100, sizeof(pattern) - 100);
+    assert_that(pieces, is_equal_to(image_crc16(0, pattern, sizeof(pattern))));
+}
+
+int test_image_crc(void) {
+    TestSuite *suite = create_test_suite();
+    add_test_with_context(suite, image_crc, crc16_matches_check_value);
+    add_test_with_context(suite, image_crc, crc16_matches_bitwise_version);
+    add_test_with_context(suite, image_crc, crc64_matches_hardware_signature);
+    add_test_with_context(suite, image_crc, crc64_continues_across_pieces);
+    add_test_with_context(suite, image_crc, crc16_continues_across_pieces);
+    return run_test_suite(suite, create_text_reporter());
+}
@@ -0,0 +1,247 @@
+/*
+ * test_nv_store.c
+ *
+ *  Created on: Oct. 19, 2026
+ */
+
+#include <cgreen/cgreen.h>
+#include <cgreen/mocks.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#include "nv_store/nv_store.h"
+
+/* Model of the flash areas. Programming only clears bits, and each word may be programmed once per erase */
+static uint8_t flash[NV_STORE_AREAS][NV_STORE_AREA_SIZE];
+static bool programmed[NV_STORE_AREAS][NV_STORE_AREA_SIZE / NV_STORE_WORD];
+static int32_t power_left; // bytes that can be programmed before the power fails, -1 for no limit
+static int32_t flip_at;    // bytes programmed before one comes out with a bit wrong, -1 for none
+static uint32_t reprogrammed;
+
+const uint8_t *nv_flash_area(uint8_t area) { return flash[area]; }
+
+bool nv_flash_erase(uint8_t area) {
+    memset(flash[area], 0xFF, sizeof(flash[area]));
+    memset(programmed[area], 0, sizeof(programmed[area]));
+    return true;
+}
+
+bool nv_flash_program(uint8_t area, uint32_t offset, const void *data, uint32_t length) {
+    const uint8_t *bytes = (const uint8_t *)data;
+    uint32_t i;
+    for (i = 0; i < length; i++) {
+        if (power_left == 0) {
+            return false;
+        }
+        if (power_left > 0) {
+            power_left--;
+        }
+        if (i % NV_STORE_WORD == 0) {
+            reprogrammed += programmed[area][(offset + i) / NV_STORE_WORD];
+            programmed[area][(offset + i) / NV_STORE_WORD] = true;
+        }
+        flash[area][offset + i] &= bytes[i];
+        if (flip_at >= 0 && flip_at-- == 0) {
+            flash[area][offset + i] ^= 0x01;
+        }
+    }
+    return true;
+}
+
+void nv_flash_lock(void) {}
+
+void nv_flash_unlock(void) {}
+
+static uint8_t value[NV_STORE_MAX_VALUE];
+static uint8_t readback[NV_STORE_MAX_VALUE];
+
+static void fill(uint8_t seed) {
+    uint32_t i;
+    for (i = 0; i < sizeof(value); i++) {
+        value[i] = (uint8_t)(seed + i * 7);
+    }
+}
+
+static bool holds(nv_key key, uint8_t seed, uint16_t length) {
+    uint16_t stored = 0;
+    fill(seed);
+    memset(readback, 0, sizeof(readback));
+    return nv_store_read(key, readback, sizeof(readback), &stored) && stored == length &&
+           memcmp(readback, value, length) == 0;
+}
+
+/* Write key 1 until the next write of this length would need a compaction */
+static uint8_t fill_area(uint16_t length) {
+    nv_store_stats stats;
+    uint8_t seed = 0;
+    nv_store_get_stats(&stats);
+    while (stats.used + 8 + length <= NV_STORE_AREA_SIZE) {
+        fill(++seed);
+        nv_store_write(NV_KEY_LEOP_STATUS, value, length);
+        nv_store_get_stats(&stats);
+    }
+    return seed;
+}
+
+Describe(nv_store);
+BeforeEach(nv_store) {
+    uint8_t area;
+    for (area = 0; area < NV_STORE_AREAS; area++) {
+        nv_flash_erase(area);
+    }
+    power_left = -1;
+    flip_at = -1;
+    reprogrammed = 0;
+    nv_store_mount();
+}
+AfterEach(nv_store) { assert_that(reprogrammed, is_equal_to(0)); }
+
+Ensure(nv_store, missing_key_is_not_found) {
+    assert_that(nv_store_read(NV_KEY_LEOP_STATUS, readback, sizeof(readback), NULL), is_false);
+    assert_that(nv_store_read(NV_KEY_NONE, readback, sizeof(readback), NULL), is_false);
+}
+
+Ensure(nv_store, reads_latest_value) {
+    fill(1);
+    nv_store_write(NV_KEY_LEOP_STATUS, value, 20);
+    fill(2);
+    nv_store_write(NV_KEY_APP_SIGNATURE, value, 40);
+    fill(3);
+    nv_store_write(NV_KEY_LEOP_STATUS, value, 13);
+    assert_that(holds(NV_KEY_LEOP_STATUS, 3, 13), is_true);
+    assert_that(holds(NV_KEY_APP_SIGNATURE, 2, 40), is_true);
+}
+
+Ensure(nv_store, values_survive_remount) {
+    fill(4);
+    nv_store_write(NV_KEY_GOLDEN_SIGNATURE, value, NV_STORE_MAX_VALUE);
+    nv_store_mount();
+    assert_that(holds(NV_KEY_GOLDEN_SIGNATURE, 4, NV_STORE_MAX_VALUE), is_true);
+}
+
+Ensure(nv_store, unchanged_value_is_not_rewritten) {
+    nv_store_stats before, after;
+    fill(5);
+    nv_store_write(NV_KEY_LEOP_STATUS, value, 30);
+    nv_store_get_stats(&before);
+    nv_store_write(NV_KEY_LEOP_STATUS, value, 30);
+    nv_store_get_stats(&after);
+    assert_that(after.used, is_equal_to(before.used));
+    assert_that(after.writes, is_equal_to(before.writes));
+}
+
+Ensure(nv_store, deleted_key_is_not_found) {
+    fill(6);
+    nv_store_write(NV_KEY_LEOP_STATUS, value, 30);
+    nv_store_write(NV_KEY_LEOP_STATUS, value, 0);
+    assert_that(nv_store_read(NV_KEY_LEOP_STATUS, readback, sizeof(readback), NULL), is_false);
+    nv_store_mount();
+    assert_that(nv_store_read(NV_KEY_LEOP_STATUS, readback, sizeof(readback), NULL), is_false);
+}
+
+Ensure(nv_store, full_area_is_compacted) {
+    nv_store_stats before, after;
+    fill(7);
+    nv_store_write(NV_KEY_APP_SIGNATURE, value, 100);
+    uint8_t seed = fill_area(120);
+    nv_store_get_stats(&before);
+
+    fill(seed + 1);
+    assert_that(nv_store_write(NV_KEY_LEOP_STATUS, value, 120), is_true);
+    nv_store_get_stats(&after);
+    assert_that(after.generation, is_equal_to(before.generation + 1));
+    assert_that(after.compactions, is_equal_to(before.compactions + 1));
+    assert_that(after.used, is_less_than(1000));
+
+    nv_store_mount();
+    assert_that(holds(NV_KEY_LEOP_STATUS, seed + 1, 120), is_true);
+    assert_that(holds(NV_KEY_APP_SIGNATURE, 7, 100), is_true);
+}
+
+Ensure(nv_store, torn_write_keeps_previous_value) {
+    fill(8);
+    nv_store_write(NV_KEY_LEOP_STATUS, value, 64);
+
+    // Power fails part way through the data, then part way through the next header
+    fill(9);
+    power_left = 20;
+    assert_that(nv_store_write(NV_KEY_LEOP_STATUS, value, 64), is_false);
+    power_left = -1;
+    nv_store_mount();
+    assert_that(holds(NV_KEY_LEOP_STATUS, 8, 64), is_true);
+
+    fill(10);
+    power_left = 3;
+    nv_store_write(NV_KEY_LEOP_STATUS, value, 64);
+    power_left = -1;
+    nv_store_mount();
+    assert_that(holds(NV_KEY_LEOP_STATUS, 8, 64), is_true);
+
+    fill(11);
+    assert_that(nv_store_write(NV_KEY_LEOP_STATUS, value, 64), is_true);
+    nv_store_mount();
+    assert_that(holds(NV_KEY_LEOP_STATUS, 11, 64), is_true);
+}
+
+Ensure(nv_store, interrupted_compaction_keeps_old_area) {
+    nv_store_stats before, after;
+    fill(12);
+    nv_store_write(NV_KEY_APP_SIGNATURE, value, 200);
+    uint8_t seed = fill_area(120);
+    nv_store_get_stats(&before);
+
+    // Everything but the new area's header gets copied
+    fill(seed + 1);
+    power_left = 8 + 200 + 8 + 120;
+    assert_that(nv_store_write(NV_KEY_LEOP_STATUS, value, 120), is_false);
+    power_left = -1;
+    nv_store_mount();
+    nv_store_get_stats(&after);
+    assert_that(after.generation, is_equal_to(before.generation));
+    assert_that(holds(NV_KEY_LEOP_STATUS, seed, 120), is_true);
+    assert_that(holds(NV_KEY_APP_SIGNATURE, 12, 200), is_true);
+
+    fill(seed + 2);
+    assert_that(nv_store_write(NV_KEY_LEOP_STATUS, value, 120), is_true);
+    nv_store_mount();
+    nv_store_get_stats(&after);
+    assert_that(after.generation, is_equal_to(before.generation + 1));
+    assert_that(holds(NV_KEY_LEOP_STATUS, seed + 2, 120), is_true);
+    assert_that(holds(NV_KEY_APP_SIGNATURE, 12, 200), is_true);
+}
+
+Ensure(nv_store, bad_copy_keeps_old_area) {
+    nv_store_stats before, after;
+    fill(13);
+    nv_store_write(NV_KEY_APP_SIGNATURE, value, 200);
+    uint8_t seed = fill_area(120);
+    nv_store_get_stats(&before);
+
+    // A bit of the first value copied doesn't take, which only its CRC shows
+    fill(seed + 1);
+    flip_at = 8 + 10;
+    assert_that(nv_store_write(NV_KEY_LEOP_STATUS, value, 120), is_false);
+    flip_at = -1;
+    nv_store_get_stats(&after);
+    assert_that(after.generation, is_equal_to(before.generation));
+    nv_store_mount();
+    nv_store_get_stats(&after);
+    assert_that(after.generation, is_equal_to(before.generation));
+    assert_that(holds(NV_KEY_LEOP_STATUS, seed, 120), is_true);
+    assert_that(holds(NV_KEY_APP_SIGNATURE, 13, 200), is_true);
+}
+
+int test_nv_store(void) {
+    TestSuite *suite = create_test_suite();
+    add_test_with_context(suite, nv_store, missing_key_is_not_found);
+    add_test_with_context(suite, nv_store, reads_latest_value);
+    add_test_with_context(suite, nv_store, values_survive_remount);
+    add_test_with_context(suite, nv_store, unchanged_value_is_not_rewritten);
+    add_test_with_context(suite, nv_store, deleted_key_is_not_found);
+    add_test_with_context(suite, nv_store, full_area_is_compacted);
+    add_test_with_context(suite, nv_store, torn_write_keeps_previous_value);
+    add_test_with_context(suite, nv_store, interrupted_compaction_keeps_old_area);
+    add_test_with_context(suite, nv_store, bad_copy_keeps_old_area);
+    return run_test_suite(suite, create_text_reporter());
+}
@@ -0,0 +1,258 @@
+#!/usr/bin/env python3
+# Copyright (C) 2026  University of Alberta
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation; either version 2
+# of the License, or (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+"""Make a patch that turns one OBC image into another, for FTP_START_DELTA_UPLOAD.
+
+The old image is the one running on the OBC, which the patch is applied
+against. The new image replaces the other image. The patch format is
+described in fw_delta.c: a header with the size and CRC-16 of both images,
+then COPY operations taking runs of bytes from the old image, INSERT
+operations carrying new bytes, and ADD operations taking runs of bytes from
+the old image with a few of them changed. Matches are found exactly, then
+extended over changed bytes as in bsdiff, which keeps code that only moved
+from being sent again because its addresses differ.
+
+usage: fw_delta.py old.bin new.bin -o patch.bin
+"""
+
+import argparse
+import struct
+import sys
+
+DELTA_MAGIC = 0x45584431
+HEADER = struct.Struct(">IIHIHH")
+
+OP_END = 0
+OP_COPY = 1
+OP_INSERT = 2
+OP_ADD = 3
+
+# Shortest run worth a COPY, shorter ones cost about as much as inserting them
+MIN_MATCH = 16
+
+# Only every INDEX_STEP-th position of the old image is indexed, matches are extended back over the gap
+INDEX_STEP = 4
+
+# Positions kept for each run of MIN_MATCH bytes, the longest match among them is used
+MAX_CANDIDATES = 8
+
+# A changed byte costs about this many unchanged bytes, its skip and its difference
+CHANGE_COST = 2
+
+# Extending a match stops once it scores this much below the best place to end it
+GIVE_UP = 32
+
+
+def crc16(data):
+    """CRC-16/XMODEM, as stored in image_info."""
+    crc = 0
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def varint(value):
+    out = bytearray()
+    while True:
+        byte = value & 0x7F
+        value >>= 7
+        if value:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return bytes(out)
+
+
+def zigzag(value):
+    return (value << 1) if value >= 0 else ((-value << 1) - 1)
+
+
+def match_length(old, old_pos, new, new_pos):
+    length = 0
+    limit = min(len(old) - old_pos, len(new) - new_pos)
+    # Compare in blocks first, byte by byte is slow in Python
+    while length + 64 <= limit:
+        if old[old_pos + length:old_pos + length + 64] != new[new_pos + length:new_pos + length + 64]:
+            break
+        length += 64
+    while length < limit and old[old_pos + length] == new[new_pos + length]:
+        length += 1
+    return length
+
+
+def extend_match(old, old_pos, new, new_pos):
+    """Length of old and new from the positions given worth sending as one ADD.
+
+    Every byte that matches scores one and every changed byte loses
+    CHANGE_COST, the length with the best score is used.
+    """
+    limit = min(len(old) - old_pos, len(new) - new_pos)
+    best_length = 0
+    best_score = 0
+    score = 0
+    length = 0
+    while length < limit:
+        if old[old_pos + length] == new[new_pos + length]:
+            score += 1
+        else:
+            score -= CHANGE_COST
+        length += 1
+        if score > best_score:
+            best_score, best_length = score, length
+        elif score < best_score - GIVE_UP:
+            break
+    return best_length
+
+
+def encode_match(old, old_pos, new, new_pos, length, move):
+    """COPY if the run is unchanged, otherwise ADD with the changed bytes."""
+    changes = bytearray()
+    count = 0
+    skip = 0
+    for i in range(length):
+        difference = (new[new_pos + i] - old[old_pos + i]) & 0xFF
+        if difference:
+            changes += varint(skip) + bytes([difference])
+            count += 1
+            skip = 0
+        else:
+            skip += 1
+    if count == 0:
+        return bytes([OP_COPY]) + varint(length) + varint(move)
+    return bytes([OP_ADD]) + varint(length) + varint(move) + varint(count) + bytes(changes)
+
+
+def make_patch(old, new):
+    index = {}
+    for pos in range(0, len(old) - MIN_MATCH + 1, INDEX_STEP):
+        candidates = index.setdefault(old[pos:pos + MIN_MATCH], [])
+        if len(candidates) < MAX_CANDIDATES:
+            candidates.append(pos)
+
+    ops = bytearray()
+    source_pos = 0
+    literal_start = 0
+    pos = 0
+    while pos + MIN_MATCH <= len(new):
+        best_length = 0
+        best_old = 0
+        # The old position following on from the last copy is the likeliest match
+        expected = source_pos + (pos - literal_start)
+        candidates = list(index.get(new[pos:pos + MIN_MATCH], []))
+        if 0 <= expected < len(old):
+            candidates.insert(0, expected)
+        for candidate in candidates:
+            length = match_length(old, candidate, new, pos)
+            if length > best_length:
+                best_length, best_old = length, candidate
+        if best_length < MIN_MATCH:
+            pos += 1
+            continue
+
+        # Take in the bytes before the match that the sparse index skipped
+        while pos > literal_start and best_old > 0 and old[best_old - 1] == new[pos - 1]:
+            pos -= 1
+            best_old -= 1
+            best_length += 1
+        # Carry on past the exact match over bytes that changed
+        best_length += extend_match(old, best_old + best_length, new, pos + best_length)
+        if pos > literal_start:
+            ops += bytes([OP_INSERT]) + varint(pos - literal_start) + new[literal_start:pos]
+        ops += encode_match(old, best_old, new, pos, best_length, zigzag(best_old - source_pos))
+        source_pos = best_old + best_length
+        pos += best_length
+        literal_start = pos
+
+    if literal_start < len(new):
+        ops += bytes([OP_INSERT]) + varint(len(new) - literal_start) + new[literal_start:]
+    ops.append(OP_END)
+    header = HEADER.pack(DELTA_MAGIC, len(old), crc16(old), len(new), crc16(new), 0)
+    return header + bytes(ops)
+
+
+def read_varint(patch, pos):
+    value = 0
+    shift = 0
+    while True:
+        byte = patch[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            return value, pos
+
+
+def apply_patch(old, patch):
+    """Apply a patch the way the OBC does, to check it."""
+    magic, old_size, old_crc, new_size, new_crc, _ = HEADER.unpack_from(patch)
+    if magic != DELTA_MAGIC or old_size != len(old) or old_crc != crc16(old):
+        raise ValueError("patch is not for this image")
+    new = bytearray()
+    source_pos = 0
+    pos = HEADER.size
+    while True:
+        op = patch[pos]
+        pos += 1
+        if op == OP_END:
+            break
+        length, pos = read_varint(patch, pos)
+        if op == OP_COPY or op == OP_ADD:
+            move, pos = read_varint(patch, pos)
+            source_pos += (move >> 1) ^ -(move & 1)
+            run = bytearray(old[source_pos:source_pos + length])
+            if op == OP_ADD:
+                count, pos = read_varint(patch, pos)
+                at = 0
+                for _ in range(count):
+                    skip, pos = read_varint(patch, pos)
+                    at += skip
+                    run[at] = (run[at] + patch[pos]) & 0xFF
+                    pos += 1
+                    at += 1
+            new += run
+            source_pos += length
+        elif op == OP_INSERT:
+            new += patch[pos:pos + length]
+            pos += length
+        else:
+            raise ValueError("bad operation %d" % op)
+    if len(new) != new_size or crc16(new) != new_crc:
+        raise ValueError("patch does not produce the new image")
+    return bytes(new)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("old", help="image running on the OBC")
+    parser.add_argument("new", help="image to uplink")
+    parser.add_argument("-o", "--output", required=True, help="patch to write")
+    args = parser.parse_args()
+
+    with open(args.old, "rb") as f:
+        old = f.read()
+    with open(args.new, "rb") as f:
+        new = f.read()
+
+    patch = make_patch(old, new)
+    if apply_patch(old, patch) != new:
+        sys.exit("patch check failed")
+    with open(args.output, "wb") as f:
+        f.write(patch)
+    print("%d byte patch, %.1f%% of the %d byte image, CRC-16 0x%04X" %
+          (len(patch), 100.0 * len(patch) / max(len(new), 1), len(new), crc16(new)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,196 @@
+#!/usr/bin/env python3
+# Copyright (C) 2026  University of Alberta
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation; either version 2
+# of the License, or (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+"""Convert an OBC kernel trace (VOL0:/trace.bin) to Chrome trace event JSON.
+
+The output can be opened in chrome://tracing or https://ui.perfetto.dev.
+Each task gets its own row showing when it was running, with its queue,
+semaphore and mutex operations as instant events. Interrupts are shown on a
+separate row. The file format is described in trace_recorder.h.
+
+usage: trace_to_chrome.py [trace.bin.old] trace.bin -o trace.json
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+TRACE_MAGIC = 0x45583254
+
+HEADER = struct.Struct(">IHBBIIII")
+TASK_NAME = struct.Struct(">B16s")
+QUEUE_NAME = struct.Struct(">H16s")
+EVENT = struct.Struct(">IBBH")
+
+EVT_TASK_SWITCH = 1
+EVT_PRIORITY_INHERIT = 11
+EVT_PRIORITY_DISINHERIT = 12
+EVT_ISR = 13
+EVT_MARK = 14
+
+EVENT_NAMES = {
+    2: "send",
+    3: "receive",
+    4: "block send",
+    5: "block receive",
+    6: "give",
+    7: "take",
+    8: "block take",
+    9: "send from ISR",
+    10: "receive from ISR",
+}
+
+ISR_NAMES = {1: "sci", 2: "gio", 3: "i2c", 4: "can", 5: "dma", 6: "spi"}
+
+ISR_TID = 1000  # task numbers are below 256
+
+
+def cstr(raw):
+    return raw.split(b"\0", 1)[0].decode("ascii", "replace")
+
+
+def read_chunks(data):
+    """Yield (header, task names, queue names, events) for each chunk in a trace file"""
+    offset = 0
+    while offset + HEADER.size <= len(data):
+        magic, version, n_tasks, n_queues, cpu_hz, uptime, n_events, dropped = HEADER.unpack_from(data, offset)
+        if magic != TRACE_MAGIC:
+            sys.stderr.write("Bad magic at offset %d, stopping\n" % offset)
+            return
+        offset += HEADER.size
+        tasks = {}
+        for _ in range(n_tasks):
+            number, name = TASK_NAME.unpack_from(data, offset)
+            tasks[number] = cstr(name)
+            offset += TASK_NAME.size
+        queues = {}
+        for _ in range(n_queues):
+            number, name = QUEUE_NAME.unpack_from(data, offset)
+            queues[number] = cstr(name)
+            offset += QUEUE_NAME.size
+        if offset + n_events * EVENT.size > len(data):
+            sys.stderr.write("Truncated chunk at offset %d\n" % offset)
+            n_events = (len(data) - offset) // EVENT.size
+        events = [EVENT.unpack_from(data, offset + i * EVENT.size) for i in range(n_events)]
+        offset += n_events * EVENT.size
+        yield {"cpu_hz": cpu_hz, "uptime": uptime, "dropped": dropped}, tasks, queues, events
+
+
+class Converter:
+    def __init__(self):
+        self.out = []
+        self.pid = 0
+        self.last_uptime = None
+        self.task_names = {}
+        self.queue_names = {}
+        self.named_tids = set()
+
+    def task_name(self, number):
+        return self.task_names.get(number, "task %d" % number)
+
+    def queue_name(self, number):
+        return self.queue_names.get(number, "queue %d" % number)
+
+    def name_thread(self, tid, name):
+        if (self.pid, tid) in self.named_tids:
+            return
+        self.named_tids.add((self.pid, tid))
+        self.out.append({"ph": "M", "name": "thread_name", "pid": self.pid, "tid": tid, "args": {"name": name}})
+
+    def instant(self, ts, tid, name, args=None):
+        evt = {"ph": "i", "s": "t", "name": name, "ts": ts, "pid": self.pid, "tid": tid}
+        if args:
+            evt["args"] = args
+        self.out.append(evt)
+
+    def new_boot(self):
+        self.pid += 1
+        name = {"name": "boot %d" % self.pid}
+        self.out.append({"ph": "M", "name": "process_name", "pid": self.pid, "args": name})
+        self.name_thread(ISR_TID, "interrupts")
+        self.cycles = 0
+        self.last_stamp = None
+        self.running = None
+
+    def add_chunk(self, header, tasks, queues, events):
+        # The uptime going backwards means the OBC rebooted between the two flushes
+        if self.last_uptime is None or header["uptime"] < self.last_uptime:
+            self.new_boot()
+        self.last_uptime = header["uptime"]
+        self.task_names.update(tasks)
+        self.queue_names.update(queues)
+        if header["dropped"]:
+            # Events are missing so the timestamps can't be carried over from the last chunk
+            sys.stderr.write("%d events dropped before uptime %ds\n" % (header["dropped"], header["uptime"]))
+            self.end_running()
+            self.last_stamp = None
+        cycles_per_us = header["cpu_hz"] / 1e6
+
+        for stamp, kind, task, obj in events:
+            # The PMU counter is 32 bits. Assume less than one wrap between consecutive events
+            if self.last_stamp is not None:
+                self.cycles += (stamp - self.last_stamp) & 0xFFFFFFFF
+            self.last_stamp = stamp
+            ts = self.cycles / cycles_per_us
+
+            if kind == EVT_TASK_SWITCH:
+                self.end_running(ts)
+                self.running = (task, ts)
+            elif kind == EVT_ISR:
+                source = ISR_NAMES.get(obj >> 8, "irq %d" % (obj >> 8))
+                self.instant(ts, ISR_TID, "%s %02x" % (source, obj & 0xFF), {"task": self.task_name(task)})
+            elif kind == EVT_MARK:
+                self.name_thread(task, self.task_name(task))
+                self.instant(ts, task, "mark %d" % obj)
+            elif kind in (EVT_PRIORITY_INHERIT, EVT_PRIORITY_DISINHERIT):
+                self.name_thread(obj, self.task_name(obj))
+                what = "inherits priority" if kind == EVT_PRIORITY_INHERIT else "priority restored"
+                self.instant(ts, obj, what, {"waiter": self.task_name(task)})
+            elif kind in EVENT_NAMES:
+                self.name_thread(task, self.task_name(task))
+                self.instant(ts, task, "%s %s" % (EVENT_NAMES[kind], self.queue_name(obj)), {"object": obj})
+
+    def end_running(self, ts=None):
+        if self.running is None:
+            return
+        task, start = self.running
+        self.running = None
+        if ts is None:
+            return
+        self.name_thread(task, self.task_name(task))
+        self.out.append({"ph": "X", "name": self.task_name(task), "ts": start, "dur": ts - start,
+                         "pid": self.pid, "tid": task})
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("files", nargs="+", help="trace files, oldest first")
+    parser.add_argument("-o", "--output", default="-", help="output JSON file (default stdout)")
+    args = parser.parse_args()
+
+    converter = Converter()
+    for path in args.files:
+        with open(path, "rb") as f:
+            for chunk in read_chunks(f.read()):
+                converter.add_chunk(*chunk)
+
+    result = {"traceEvents": converter.out, "displayTimeUnit": "ns"}
+    if args.output == "-":
+        json.dump(result, sys.stdout)
+    else:
+        with open(args.output, "w") as f:
+            json.dump(result, f)
+
+
+if __name__ == "__main__":
+    main()